@@ -0,0 +1,517 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "render/camera.h"
+#include "render/graph.h"
+#include "render/hair.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/session.h"
+#include "render/shader.h"
+#include "render/stats.h"
+
+#include "util/util_foreach.h"
+#include "util/util_guarded_allocator.h"
+#include "util/util_hash.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+#include "util/util_transform.h"
+#include "util/util_version.h"
+
+#include "app/cycles_benchmark.h"
+#include "app/cycles_many_lights.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of lights of the many lights scene. */
+static const int BENCHMARK_NUM_LIGHTS = 2000;
+
+/* Triangles of a mesh before they are added to it. */
+struct BenchmarkMeshData {
+  vector<float3> verts;
+  vector<int> triangles;
+
+  void add_triangle(int v0, int v1, int v2)
+  {
+    triangles.push_back(v0);
+    triangles.push_back(v1);
+    triangles.push_back(v2);
+  }
+
+  void add_quad(const float3 &p0, const float3 &p1, const float3 &p2, const float3 &p3)
+  {
+    const int offset = verts.size();
+    verts.push_back(p0);
+    verts.push_back(p1);
+    verts.push_back(p2);
+    verts.push_back(p3);
+
+    add_triangle(offset + 0, offset + 1, offset + 2);
+    add_triangle(offset + 0, offset + 2, offset + 3);
+  }
+
+  void add_box(const float3 &min, const float3 &max)
+  {
+    const float3 p[8] = {make_float3(min.x, min.y, min.z),
+                         make_float3(max.x, min.y, min.z),
+                         make_float3(max.x, max.y, min.z),
+                         make_float3(min.x, max.y, min.z),
+                         make_float3(min.x, min.y, max.z),
+                         make_float3(max.x, min.y, max.z),
+                         make_float3(max.x, max.y, max.z),
+                         make_float3(min.x, max.y, max.z)};
+
+    add_quad(p[0], p[3], p[2], p[1]);
+    add_quad(p[1], p[2], p[6], p[5]);
+    add_quad(p[5], p[6], p[7], p[4]);
+    add_quad(p[4], p[7], p[3], p[0]);
+    add_quad(p[3], p[7], p[6], p[2]);
+    add_quad(p[0], p[1], p[5], p[4]);
+  }
+
+  void add_sphere(const float3 &center, float radius, int segments, int rings)
+  {
+    const int offset = verts.size();
+
+    /* Rings without the poles, followed by both poles. */
+    for (int ring = 1; ring < rings; ring++) {
+      const float theta = M_PI_F * ring / rings;
+      for (int segment = 0; segment < segments; segment++) {
+        const float phi = M_2PI_F * segment / segments;
+        verts.push_back(center + radius * make_float3(sinf(theta) * cosf(phi),
+                                                      cosf(theta),
+                                                      sinf(theta) * sinf(phi)));
+      }
+    }
+
+    const int top = verts.size();
+    verts.push_back(center + make_float3(0.0f, radius, 0.0f));
+    const int bottom = verts.size();
+    verts.push_back(center - make_float3(0.0f, radius, 0.0f));
+
+    for (int segment = 0; segment < segments; segment++) {
+      const int next = (segment + 1) % segments;
+
+      add_triangle(top, offset + next, offset + segment);
+
+      for (int ring = 0; ring < rings - 2; ring++) {
+        const int v0 = offset + ring * segments + segment;
+        const int v1 = offset + ring * segments + next;
+        const int v2 = offset + (ring + 1) * segments + next;
+        const int v3 = offset + (ring + 1) * segments + segment;
+        add_triangle(v0, v1, v2);
+        add_triangle(v0, v2, v3);
+      }
+
+      add_triangle(bottom,
+                   offset + (rings - 2) * segments + segment,
+                   offset + (rings - 2) * segments + next);
+    }
+  }
+};
+
+static Shader *benchmark_add_shader(Scene *scene,
+                                    ShaderGraph *graph,
+                                    ShaderNode *node,
+                                    const char *output,
+                                    const char *input)
+{
+  graph->add(node);
+  graph->connect(node->output(output), graph->output()->input(input));
+
+  Shader *shader = scene->create_node<Shader>();
+  shader->set_graph(graph);
+  shader->tag_update(scene);
+  return shader;
+}
+
+static Shader *benchmark_add_diffuse(Scene *scene, const float3 &color)
+{
+  ShaderGraph *graph = new ShaderGraph();
+  DiffuseBsdfNode *diffuse = graph->create_node<DiffuseBsdfNode>();
+  diffuse->set_color(color);
+  return benchmark_add_shader(scene, graph, diffuse, "BSDF", "Surface");
+}
+
+static Mesh *benchmark_add_mesh(Scene *scene, const BenchmarkMeshData &data, Shader *shader)
+{
+  Mesh *mesh = scene->create_node<Mesh>();
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(shader);
+  mesh->set_used_shaders(used_shaders);
+
+  const size_t num_triangles = data.triangles.size() / 3;
+  mesh->reserve_mesh(data.verts.size(), num_triangles);
+
+  foreach (const float3 &P, data.verts) {
+    mesh->add_vertex(P);
+  }
+  for (size_t i = 0; i < num_triangles; i++) {
+    mesh->add_triangle(
+        data.triangles[i * 3 + 0], data.triangles[i * 3 + 1], data.triangles[i * 3 + 2], 0, true);
+  }
+
+  return mesh;
+}
+
+static void benchmark_add_object(Scene *scene, Geometry *geom, const Transform &tfm)
+{
+  Object *object = scene->create_node<Object>();
+  object->set_geometry(geom);
+  object->set_tfm(tfm);
+}
+
+/* Ground plane of the given half size, centered at the origin. */
+static void benchmark_add_ground(Scene *scene, float size)
+{
+  BenchmarkMeshData ground;
+  ground.add_quad(make_float3(-size, 0.0f, -size),
+                  make_float3(size, 0.0f, -size),
+                  make_float3(size, 0.0f, size),
+                  make_float3(-size, 0.0f, size));
+
+  Shader *shader = benchmark_add_diffuse(scene, make_float3(0.5f, 0.5f, 0.5f));
+  benchmark_add_object(scene, benchmark_add_mesh(scene, ground, shader), transform_identity());
+}
+
+static void benchmark_add_sun(Scene *scene, const float3 &dir, float strength)
+{
+  Light *light = scene->create_node<Light>();
+  light->set_shader(scene->default_light);
+  light->set_light_type(LIGHT_DISTANT);
+  light->set_dir(normalize(dir));
+  light->set_angle(0.05f);
+  light->set_strength(make_float3(strength, strength, strength));
+  light->set_use_mis(true);
+}
+
+/* Camera at the given height and distance from the origin, looking down on it. */
+static void benchmark_set_camera(Scene *scene, float height, float distance)
+{
+  const Transform tfm = transform_translate(make_float3(0.0f, height, -distance)) *
+                        transform_rotate(atan2f(height, distance), make_float3(1.0f, 0.0f, 0.0f));
+
+  scene->camera->set_matrix(tfm);
+  scene->camera->need_flags_update = true;
+
+  /* Dice subdivision surfaces for the same view. */
+  scene->dicing_camera->set_matrix(tfm);
+}
+
+/* Thousands of instances of a sphere, to measure the two level BVH. */
+static void benchmark_scene_instancing(Scene *scene)
+{
+  const int grid_size = 64;
+  const float spacing = 0.5f;
+  const float half_size = 0.5f * grid_size * spacing;
+
+  BenchmarkMeshData sphere;
+  sphere.add_sphere(zero_float3(), 0.2f, 48, 24);
+  Mesh *mesh = benchmark_add_mesh(
+      scene, sphere, benchmark_add_diffuse(scene, make_float3(0.8f, 0.3f, 0.2f)));
+
+  for (int x = 0; x < grid_size; x++) {
+    for (int z = 0; z < grid_size; z++) {
+      const float scale = 0.5f + hash_uint2_to_float(x, z);
+      const float height = 2.0f * hash_uint3_to_float(x, z, 1);
+      const float3 co = make_float3(
+          x * spacing - half_size, 0.2f * scale + height, z * spacing - half_size);
+      benchmark_add_object(
+          scene, mesh, transform_translate(co) * transform_scale(scale, scale, scale));
+    }
+  }
+
+  benchmark_add_ground(scene, half_size + 1.0f);
+  benchmark_add_sun(scene, make_float3(0.3f, -1.0f, 0.5f), 3.0f);
+  benchmark_set_camera(scene, 0.6f * half_size, 1.2f * half_size);
+}
+
+/* Patch of grass like curves. */
+static void benchmark_scene_hair(Scene *scene)
+{
+  const int grid_size = 256;
+  const int num_keys = 5;
+  const float half_size = 2.0f;
+  const float length = 0.3f;
+
+  ShaderGraph *graph = new ShaderGraph();
+  PrincipledHairBsdfNode *hair_bsdf = graph->create_node<PrincipledHairBsdfNode>();
+  Shader *shader = benchmark_add_shader(scene, graph, hair_bsdf, "BSDF", "Surface");
+
+  Hair *hair = scene->create_node<Hair>();
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(shader);
+  hair->set_used_shaders(used_shaders);
+  hair->reserve_curves(grid_size * grid_size, grid_size * grid_size * num_keys);
+
+  for (int x = 0; x < grid_size; x++) {
+    for (int z = 0; z < grid_size; z++) {
+      const float u = (x + hash_uint2_to_float(x, z)) / grid_size;
+      const float v = (z + hash_uint3_to_float(x, z, 1)) / grid_size;
+      const float3 root = make_float3((2.0f * u - 1.0f) * half_size,
+                                      0.0f,
+                                      (2.0f * v - 1.0f) * half_size);
+
+      /* Bend towards a random direction, more towards the tip. */
+      const float angle = M_2PI_F * hash_uint3_to_float(x, z, 2);
+      const float3 bend = 0.3f * length * make_float3(cosf(angle), 0.0f, sinf(angle));
+
+      const int first_key = hair->get_curve_keys().size();
+      for (int k = 0; k < num_keys; k++) {
+        const float t = (float)k / (num_keys - 1);
+        hair->add_curve_key(root + make_float3(0.0f, t * length, 0.0f) + t * t * bend,
+                            0.005f * (1.0f - 0.8f * t));
+      }
+      hair->add_curve(first_key, 0);
+    }
+  }
+
+  benchmark_add_object(scene, hair, transform_identity());
+  benchmark_add_ground(scene, half_size + 1.0f);
+  benchmark_add_sun(scene, make_float3(0.3f, -1.0f, 0.5f), 3.0f);
+  benchmark_set_camera(scene, 1.5f, 3.0f);
+}
+
+/* Box of heterogeneous scattering volume, lit from the side. */
+static void benchmark_scene_volume(Scene *scene)
+{
+  ShaderGraph *graph = new ShaderGraph();
+  TextureCoordinateNode *texco = graph->create_node<TextureCoordinateNode>();
+  NoiseTextureNode *noise = graph->create_node<NoiseTextureNode>();
+  noise->set_scale(2.0f);
+  noise->set_detail(4.0f);
+  ScatterVolumeNode *scatter = graph->create_node<ScatterVolumeNode>();
+
+  graph->add(texco);
+  graph->add(noise);
+  graph->connect(texco->output("Object"), noise->input("Vector"));
+  graph->connect(noise->output("Fac"), scatter->input("Density"));
+  Shader *shader = benchmark_add_shader(scene, graph, scatter, "Volume", "Volume");
+
+  BenchmarkMeshData box;
+  box.add_box(make_float3(-1.0f, 0.0f, -1.0f), make_float3(1.0f, 2.0f, 1.0f));
+  benchmark_add_object(scene, benchmark_add_mesh(scene, box, shader), transform_identity());
+
+  benchmark_add_ground(scene, 4.0f);
+  benchmark_add_sun(scene, make_float3(1.0f, -0.5f, 0.3f), 5.0f);
+  benchmark_set_camera(scene, 2.0f, 5.0f);
+}
+
+/* Subdivided plane with true displacement from a noise texture. */
+static void benchmark_scene_displacement(Scene *scene)
+{
+  const int grid_size = 32;
+  const float half_size = 2.0f;
+
+  ShaderGraph *graph = new ShaderGraph();
+  TextureCoordinateNode *texco = graph->create_node<TextureCoordinateNode>();
+  NoiseTextureNode *noise = graph->create_node<NoiseTextureNode>();
+  noise->set_scale(1.5f);
+  noise->set_detail(8.0f);
+  DisplacementNode *displacement = graph->create_node<DisplacementNode>();
+  displacement->set_scale(0.5f);
+
+  DiffuseBsdfNode *diffuse = graph->create_node<DiffuseBsdfNode>();
+
+  graph->add(texco);
+  graph->add(noise);
+  graph->add(displacement);
+  graph->connect(texco->output("Object"), noise->input("Vector"));
+  graph->connect(noise->output("Fac"), displacement->input("Height"));
+  graph->connect(displacement->output("Displacement"), graph->output()->input("Displacement"));
+  Shader *shader = benchmark_add_shader(scene, graph, diffuse, "BSDF", "Surface");
+  shader->set_displacement_method(DISPLACE_TRUE);
+
+  Mesh *mesh = scene->create_node<Mesh>();
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(shader);
+  mesh->set_used_shaders(used_shaders);
+  mesh->set_subdivision_type(Mesh::SUBDIVISION_LINEAR);
+
+  array<float3> verts;
+  for (int z = 0; z <= grid_size; z++) {
+    for (int x = 0; x <= grid_size; x++) {
+      verts.push_back_slow(make_float3((2.0f * x / grid_size - 1.0f) * half_size,
+                                       0.0f,
+                                       (2.0f * z / grid_size - 1.0f) * half_size));
+    }
+  }
+  mesh->set_verts(verts);
+
+  mesh->reserve_subd_faces(grid_size * grid_size, 0, grid_size * grid_size * 4);
+  for (int z = 0; z < grid_size; z++) {
+    for (int x = 0; x < grid_size; x++) {
+      int corners[4] = {z * (grid_size + 1) + x,
+                        (z + 1) * (grid_size + 1) + x,
+                        (z + 1) * (grid_size + 1) + x + 1,
+                        z * (grid_size + 1) + x + 1};
+      mesh->add_subd_face(corners, 4, 0, true);
+    }
+  }
+
+  mesh->set_subd_dicing_rate(1.0f);
+  mesh->set_subd_max_level(12);
+  mesh->set_subd_objecttoworld(transform_identity());
+
+  benchmark_add_object(scene, mesh, transform_identity());
+  benchmark_add_sun(scene, make_float3(0.5f, -0.6f, 0.3f), 3.0f);
+  benchmark_set_camera(scene, 1.5f, 3.5f);
+}
+
+vector<string> benchmark_scene_names()
+{
+  vector<string> names;
+  names.push_back("instancing");
+  names.push_back("hair");
+  names.push_back("volume");
+  names.push_back("many_lights");
+  names.push_back("displacement");
+  return names;
+}
+
+void benchmark_scene_create(Scene *scene, const string &name)
+{
+  if (name == "instancing") {
+    benchmark_scene_instancing(scene);
+  }
+  else if (name == "hair") {
+    benchmark_scene_hair(scene);
+  }
+  else if (name == "volume") {
+    benchmark_scene_volume(scene);
+  }
+  else if (name == "many_lights") {
+    many_lights_scene_create(scene, BENCHMARK_NUM_LIGHTS);
+  }
+  else if (name == "displacement") {
+    benchmark_scene_displacement(scene);
+  }
+  else {
+    fprintf(stderr, "Unknown benchmark scene \"%s\".\n", name.c_str());
+    return;
+  }
+
+  VLOG(1) << "Benchmark scene " << name << " with " << scene->objects.size() << " objects and "
+          << scene->geometry.size() << " geometries.";
+}
+
+/* Time of all entries containing the given name. */
+static double benchmark_stats_time(const NamedTimeStats &stats, const char *name)
+{
+  double time = 0.0;
+  foreach (const NamedTimeEntry &entry, stats.entries) {
+    if (entry.name.find(name) != string::npos) {
+      time += entry.time;
+    }
+  }
+  return time;
+}
+
+BenchmarkResult benchmark_result_get(const string &name, Session *session)
+{
+  BenchmarkResult result;
+  result.name = name;
+
+  const SceneUpdateStats *update_stats = session->scene->update_stats;
+  result.bvh_time = benchmark_stats_time(update_stats->geometry.times, "BVH");
+  result.image_time = update_stats->image.times.total_time;
+  result.svm_time = update_stats->svm.times.total_time;
+  result.light_time = update_stats->light.times.total_time;
+  result.geometry_time = update_stats->geometry.times.total_time;
+  result.object_time = update_stats->object.times.total_time;
+  result.update_time = update_stats->scene.times.total_time;
+
+  double total_time;
+  session->progress.get_time(total_time, result.render_time);
+
+  result.width = session->scene->camera->get_full_width();
+  result.height = session->scene->camera->get_full_height();
+  result.samples = session->params.samples;
+  result.mem_peak = session->stats.mem_peak;
+
+  return result;
+}
+
+/* Names are scene names and file names, only quotes and backslashes need escaping. */
+static string benchmark_json_string(const string &str)
+{
+  string escaped = "\"";
+  foreach (char c, str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+bool benchmark_write_json(const string &filepath,
+                          const string &device,
+                          const vector<BenchmarkResult> &results)
+{
+  FILE *f = fopen(filepath.c_str(), "w");
+  if (!f) {
+    return false;
+  }
+
+  fprintf(f, "{\n");
+  fprintf(f, "  \"version\": %s,\n", benchmark_json_string(CYCLES_VERSION_STRING).c_str());
+  fprintf(f, "  \"device\": %s,\n", benchmark_json_string(device).c_str());
+  fprintf(f, "  \"host_memory_peak\": %zu,\n", util_guarded_get_mem_peak());
+  fprintf(f, "  \"scenes\": [");
+
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchmarkResult &result = results[i];
+    const double samples_per_second = (result.render_time > 0.0) ?
+                                          result.samples / result.render_time :
+                                          0.0;
+
+    fprintf(f, (i == 0) ? "\n" : ",\n");
+    fprintf(f, "    {\n");
+    fprintf(f, "      \"name\": %s,\n", benchmark_json_string(result.name).c_str());
+    fprintf(f, "      \"width\": %d,\n", result.width);
+    fprintf(f, "      \"height\": %d,\n", result.height);
+    fprintf(f, "      \"samples\": %d,\n", result.samples);
+    fprintf(f, "      \"prep_time\": {\n");
+    fprintf(f, "        \"bvh\": %f,\n", result.bvh_time);
+    fprintf(f, "        \"images\": %f,\n", result.image_time);
+    fprintf(f, "        \"svm\": %f,\n", result.svm_time);
+    fprintf(f, "        \"lights\": %f,\n", result.light_time);
+    fprintf(f, "        \"geometry\": %f,\n", result.geometry_time);
+    fprintf(f, "        \"objects\": %f,\n", result.object_time);
+    fprintf(f, "        \"total\": %f\n", result.update_time);
+    fprintf(f, "      },\n");
+    fprintf(f, "      \"render_time\": %f,\n", result.render_time);
+    fprintf(f, "      \"samples_per_second\": %f,\n", samples_per_second);
+    fprintf(f,
+            "      \"pixel_samples_per_second\": %f,\n",
+            samples_per_second * result.width * result.height);
+    fprintf(f, "      \"memory_peak\": %zu\n", result.mem_peak);
+    fprintf(f, "    }");
+  }
+
+  fprintf(f, "\n  ]\n}\n");
+  fclose(f);
+
+  return true;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CYCLES_BENCHMARK_H__
+#define __CYCLES_BENCHMARK_H__
+
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Scene;
+class Session;
+
+/* Timings and memory usage of one rendered benchmark scene. */
+struct BenchmarkResult {
+  string name;
+
+  /* Scene preparation, in seconds. */
+  double bvh_time;
+  double image_time;
+  double svm_time;
+  double light_time;
+  double geometry_time;
+  double object_time;
+  double update_time;
+
+  /* Path tracing only, without scene preparation. */
+  double render_time;
+
+  int width;
+  int height;
+  int samples;
+
+  /* Peak device memory. */
+  size_t mem_peak;
+};
+
+/* Names of the generated benchmark scenes. Each covers a feature with its own preparation and
+ * render cost: instancing, hair, volumes, many lights and displacement. */
+vector<string> benchmark_scene_names();
+
+/* Generate the benchmark scene with this name. The layout is the same for every run, so results
+ * can be compared between builds. */
+void benchmark_scene_create(Scene *scene, const string &name);
+
+/* Gather the timings of a finished render, before the session is freed. The scene must have
+ * update statistics enabled. */
+BenchmarkResult benchmark_result_get(const string &name, Session *session);
+
+/* Write results as JSON for regression tracking. */
+bool benchmark_write_json(const string &filepath,
+                          const string &device,
+                          const vector<BenchmarkResult> &results);
+
+CCL_NAMESPACE_END
+
+#endif /* __CYCLES_BENCHMARK_H__ */
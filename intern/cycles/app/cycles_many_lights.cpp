@@ -0,0 +1,309 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/camera.h"
+#include "render/graph.h"
+#include "render/light.h"
+#include "render/mesh.h"
+#include "render/nodes.h"
+#include "render/object.h"
+#include "render/scene.h"
+#include "render/shader.h"
+
+#include "util/util_foreach.h"
+#include "util/util_hash.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+#include "util/util_transform.h"
+#include "util/util_vector.h"
+
+#include "app/cycles_many_lights.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Layout of the city, in meters. */
+static const float CITY_BLOCK_SIZE = 2.0f;
+static const float CITY_BUILDING_SIZE = 1.2f;
+static const float CITY_FLOOR_HEIGHT = 0.3f;
+static const int CITY_MIN_FLOORS = 2;
+static const int CITY_MAX_FLOORS = 8;
+static const int CITY_WINDOW_COLUMNS = 3;
+static const float CITY_WINDOW_WIDTH = 0.2f;
+static const float CITY_WINDOW_HEIGHT = 0.15f;
+static const float CITY_LAMP_HEIGHT = 0.6f;
+
+/* Windows have a few colors and strengths, so their power differs. */
+static const int CITY_NUM_WINDOW_SHADERS = 3;
+
+/* Triangles of a mesh before they are added to it. */
+struct ManyLightsMeshData {
+  vector<float3> verts;
+  vector<int> triangles;
+
+  void add_quad(const float3 &p0, const float3 &p1, const float3 &p2, const float3 &p3)
+  {
+    const int offset = verts.size();
+    verts.push_back(p0);
+    verts.push_back(p1);
+    verts.push_back(p2);
+    verts.push_back(p3);
+
+    triangles.push_back(offset + 0);
+    triangles.push_back(offset + 1);
+    triangles.push_back(offset + 2);
+    triangles.push_back(offset + 0);
+    triangles.push_back(offset + 2);
+    triangles.push_back(offset + 3);
+  }
+
+  void add_box(const float3 &min, const float3 &max)
+  {
+    const float3 p[8] = {make_float3(min.x, min.y, min.z),
+                         make_float3(max.x, min.y, min.z),
+                         make_float3(max.x, max.y, min.z),
+                         make_float3(min.x, max.y, min.z),
+                         make_float3(min.x, min.y, max.z),
+                         make_float3(max.x, min.y, max.z),
+                         make_float3(max.x, max.y, max.z),
+                         make_float3(min.x, max.y, max.z)};
+
+    /* Sides and roof, the bottom is never seen. */
+    add_quad(p[0], p[1], p[2], p[3]);
+    add_quad(p[1], p[5], p[6], p[2]);
+    add_quad(p[5], p[4], p[7], p[6]);
+    add_quad(p[4], p[0], p[3], p[7]);
+    add_quad(p[3], p[2], p[6], p[7]);
+  }
+};
+
+static Shader *many_lights_add_shader(Scene *scene,
+                                      ShaderGraph *graph,
+                                      ShaderNode *node,
+                                      const char *output)
+{
+  graph->add(node);
+  graph->connect(node->output(output), graph->output()->input("Surface"));
+
+  Shader *shader = scene->create_node<Shader>();
+  shader->set_graph(graph);
+  shader->tag_update(scene);
+  return shader;
+}
+
+static Shader *many_lights_add_diffuse(Scene *scene, const float3 &color)
+{
+  ShaderGraph *graph = new ShaderGraph();
+  DiffuseBsdfNode *diffuse = graph->create_node<DiffuseBsdfNode>();
+  diffuse->set_color(color);
+  return many_lights_add_shader(scene, graph, diffuse, "BSDF");
+}
+
+static Shader *many_lights_add_emission(Scene *scene, const float3 &color, float strength)
+{
+  ShaderGraph *graph = new ShaderGraph();
+  EmissionNode *emission = graph->create_node<EmissionNode>();
+  emission->set_color(color);
+  emission->set_strength(strength);
+  return many_lights_add_shader(scene, graph, emission, "Emission");
+}
+
+static void many_lights_add_mesh(Scene *scene, const ManyLightsMeshData &data, Shader *shader)
+{
+  if (data.triangles.empty()) {
+    return;
+  }
+
+  Mesh *mesh = scene->create_node<Mesh>();
+  array<Node *> used_shaders;
+  used_shaders.push_back_slow(shader);
+  mesh->set_used_shaders(used_shaders);
+
+  const size_t num_triangles = data.triangles.size() / 3;
+  mesh->reserve_mesh(data.verts.size(), num_triangles);
+
+  foreach (const float3 &P, data.verts) {
+    mesh->add_vertex(P);
+  }
+  for (size_t i = 0; i < num_triangles; i++) {
+    mesh->add_triangle(
+        data.triangles[i * 3 + 0], data.triangles[i * 3 + 1], data.triangles[i * 3 + 2], 0, false);
+  }
+
+  Object *object = scene->create_node<Object>();
+  object->set_geometry(mesh);
+  object->set_tfm(transform_identity());
+}
+
+void many_lights_scene_create(Scene *scene, int num_lights)
+{
+  /* Street lamps are a small part of the lights, each window is two emissive triangles and
+   * about half of the windows are lit. */
+  const int num_lamps = max(num_lights / 16, 1);
+  const int num_windows = max((num_lights - num_lamps) / 2, 1);
+  const float windows_per_building = 4 * CITY_WINDOW_COLUMNS * 0.5f *
+                                     (CITY_MIN_FLOORS + CITY_MAX_FLOORS) * 0.5f;
+  const int grid_size = max((int)ceilf(sqrtf(num_windows / windows_per_building)), 1);
+
+  /* Shaders. */
+  Shader *building_shader = many_lights_add_diffuse(scene, make_float3(0.3f, 0.3f, 0.3f));
+
+  const float3 window_colors[CITY_NUM_WINDOW_SHADERS] = {make_float3(1.0f, 0.8f, 0.5f),
+                                                         make_float3(0.8f, 0.9f, 1.0f),
+                                                         make_float3(1.0f, 0.6f, 0.3f)};
+  const float window_strengths[CITY_NUM_WINDOW_SHADERS] = {2.0f, 5.0f, 20.0f};
+  Shader *window_shaders[CITY_NUM_WINDOW_SHADERS];
+  for (int i = 0; i < CITY_NUM_WINDOW_SHADERS; i++) {
+    window_shaders[i] = many_lights_add_emission(scene, window_colors[i], window_strengths[i]);
+  }
+
+  Shader *lamp_shader = many_lights_add_emission(scene, one_float3(), 1.0f);
+
+  /* Ground and buildings. */
+  const float city_size = grid_size * CITY_BLOCK_SIZE;
+  ManyLightsMeshData buildings;
+  buildings.add_quad(make_float3(-CITY_BLOCK_SIZE, 0.0f, -CITY_BLOCK_SIZE),
+                     make_float3(city_size + CITY_BLOCK_SIZE, 0.0f, -CITY_BLOCK_SIZE),
+                     make_float3(city_size + CITY_BLOCK_SIZE, 0.0f, city_size + CITY_BLOCK_SIZE),
+                     make_float3(-CITY_BLOCK_SIZE, 0.0f, city_size + CITY_BLOCK_SIZE));
+
+  ManyLightsMeshData windows[CITY_NUM_WINDOW_SHADERS];
+  const float offset = 0.5f * (CITY_BLOCK_SIZE - CITY_BUILDING_SIZE);
+  const float column_width = CITY_BUILDING_SIZE / CITY_WINDOW_COLUMNS;
+  const float window_offset = 0.01f;
+  uint seed = 0;
+
+  for (int x = 0; x < grid_size; x++) {
+    for (int z = 0; z < grid_size; z++) {
+      const int num_floors = CITY_MIN_FLOORS +
+                             hash_uint2(x, z) % (CITY_MAX_FLOORS - CITY_MIN_FLOORS + 1);
+      const float3 bmin = make_float3(
+          x * CITY_BLOCK_SIZE + offset, 0.0f, z * CITY_BLOCK_SIZE + offset);
+      const float3 bmax = bmin + make_float3(CITY_BUILDING_SIZE,
+                                             num_floors * CITY_FLOOR_HEIGHT,
+                                             CITY_BUILDING_SIZE);
+      buildings.add_box(bmin, bmax);
+
+      /* Windows on all four sides, facing outwards. */
+      for (int side = 0; side < 4; side++) {
+        for (int floor = 0; floor < num_floors; floor++) {
+          for (int column = 0; column < CITY_WINDOW_COLUMNS; column++) {
+            const float lit = hash_uint2_to_float(seed, 0);
+            const int shader = hash_uint2(seed, 1) % CITY_NUM_WINDOW_SHADERS;
+            seed++;
+
+            if (lit < 0.5f) {
+              continue;
+            }
+
+            const float u0 = (column + 0.5f) * column_width - 0.5f * CITY_WINDOW_WIDTH;
+            const float u1 = u0 + CITY_WINDOW_WIDTH;
+            const float v0 = (floor + 0.5f) * CITY_FLOOR_HEIGHT - 0.5f * CITY_WINDOW_HEIGHT;
+            const float v1 = v0 + CITY_WINDOW_HEIGHT;
+
+            float3 p[4];
+            switch (side) {
+              case 0:
+                p[0] = make_float3(bmin.x + u0, v0, bmin.z - window_offset);
+                p[1] = make_float3(bmin.x + u0, v1, bmin.z - window_offset);
+                p[2] = make_float3(bmin.x + u1, v1, bmin.z - window_offset);
+                p[3] = make_float3(bmin.x + u1, v0, bmin.z - window_offset);
+                break;
+              case 1:
+                p[0] = make_float3(bmax.x + window_offset, v0, bmin.z + u0);
+                p[1] = make_float3(bmax.x + window_offset, v1, bmin.z + u0);
+                p[2] = make_float3(bmax.x + window_offset, v1, bmin.z + u1);
+                p[3] = make_float3(bmax.x + window_offset, v0, bmin.z + u1);
+                break;
+              case 2:
+                p[0] = make_float3(bmax.x - u0, v0, bmax.z + window_offset);
+                p[1] = make_float3(bmax.x - u0, v1, bmax.z + window_offset);
+                p[2] = make_float3(bmax.x - u1, v1, bmax.z + window_offset);
+                p[3] = make_float3(bmax.x - u1, v0, bmax.z + window_offset);
+                break;
+              default:
+                p[0] = make_float3(bmin.x - window_offset, v0, bmax.z - u0);
+                p[1] = make_float3(bmin.x - window_offset, v1, bmax.z - u0);
+                p[2] = make_float3(bmin.x - window_offset, v1, bmax.z - u1);
+                p[3] = make_float3(bmin.x - window_offset, v0, bmax.z - u1);
+                break;
+            }
+
+            windows[shader].add_quad(p[0], p[1], p[2], p[3]);
+          }
+        }
+      }
+    }
+  }
+
+  many_lights_add_mesh(scene, buildings, building_shader);
+  for (int i = 0; i < CITY_NUM_WINDOW_SHADERS; i++) {
+    many_lights_add_mesh(scene, windows[i], window_shaders[i]);
+  }
+
+  /* Street lamps along the streets between the buildings, every fourth one a spot light. */
+  for (int i = 0; i < num_lamps; i++) {
+    const float u = hash_uint2_to_float(i, 2);
+    const float v = hash_uint2_to_float(i, 3);
+    const int street = hash_uint2(i, 4) % (grid_size + 1);
+    const float along = (u * (grid_size + 2) - 1.0f) * CITY_BLOCK_SIZE;
+    const float across = street * CITY_BLOCK_SIZE + (v - 0.5f) * offset;
+    const float3 co = (i % 2) ? make_float3(along, CITY_LAMP_HEIGHT, across) :
+                                make_float3(across, CITY_LAMP_HEIGHT, along);
+
+    Light *light = scene->create_node<Light>();
+    light->set_shader(lamp_shader);
+    light->set_co(co);
+    light->set_size(0.05f);
+    light->set_strength(make_float3(1.0f, 0.7f, 0.4f) * 10.0f);
+    light->set_use_mis(true);
+
+    if (i % 4 == 0) {
+      light->set_light_type(LIGHT_SPOT);
+      light->set_dir(make_float3(0.0f, -1.0f, 0.0f));
+      light->set_spot_angle(M_PI_2_F);
+      light->set_spot_smooth(0.2f);
+      light->set_strength(make_float3(1.0f, 0.7f, 0.4f) * 20.0f);
+    }
+  }
+
+  /* Dim moon light. */
+  Light *moon = scene->create_node<Light>();
+  moon->set_shader(lamp_shader);
+  moon->set_light_type(LIGHT_DISTANT);
+  moon->set_dir(normalize(make_float3(0.3f, -1.0f, 0.5f)));
+  moon->set_angle(0.01f);
+  moon->set_strength(make_float3(0.05f, 0.06f, 0.08f));
+  moon->set_use_mis(true);
+
+  /* Camera above the city, looking down on it. */
+  Camera *cam = scene->camera;
+  const float3 camera_co = make_float3(
+      0.5f * city_size, 0.4f * city_size + 1.0f, -0.3f * city_size - 2.0f);
+  cam->set_matrix(transform_translate(camera_co) *
+                  transform_rotate(M_PI_F / 6.0f, make_float3(1.0f, 0.0f, 0.0f)));
+  cam->need_flags_update = true;
+  cam->update(scene);
+
+  size_t num_window_triangles = 0;
+  for (int i = 0; i < CITY_NUM_WINDOW_SHADERS; i++) {
+    num_window_triangles += windows[i].triangles.size() / 3;
+  }
+
+  VLOG(1) << "Many lights scene with " << grid_size * grid_size << " buildings, " << num_lamps
+          << " lamps and " << num_window_triangles << " emissive window triangles.";
+}
+
+CCL_NAMESPACE_END
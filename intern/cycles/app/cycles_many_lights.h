@@ -0,0 +1,31 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __CYCLES_MANY_LIGHTS_H__
+#define __CYCLES_MANY_LIGHTS_H__
+
+CCL_NAMESPACE_BEGIN
+
+class Scene;
+
+/* Procedural city at night to compare the convergence of light sampling strategies: streets of
+ * buildings with emissive windows, street lamps and a dim moon. The number of lights is
+ * approximate, the layout is the same for every run. */
+void many_lights_scene_create(Scene *scene, int num_lights);
+
+CCL_NAMESPACE_END
+
+#endif /* __CYCLES_MANY_LIGHTS_H__ */
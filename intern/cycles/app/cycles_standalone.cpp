@@ -40,6 +40,8 @@
 #  include "util/util_view.h"
 #endif
 
+#include "app/cycles_benchmark.h"
+#include "app/cycles_many_lights.h"
 #include "app/cycles_xml.h"
 
 CCL_NAMESPACE_BEGIN
@@ -54,6 +56,10 @@ struct Options {
   bool quiet;
   bool show_help, interactive, pause;
   string output_path;
+  int many_lights;
+  bool use_light_tree;
+  string benchmark_path;
+  string benchmark_scene;
 } options;
 
 static void session_print(const string &str)
@@ -128,8 +134,25 @@ static void scene_init()
 {
   options.scene = new Scene(options.scene_params, options.session->device);
 
-  /* Read XML */
-  xml_read_file(options.scene, options.filepath.c_str());
+  /* Read XML, or generate a benchmark scene */
+  if (!options.benchmark_scene.empty()) {
+    benchmark_scene_create(options.scene, options.benchmark_scene);
+  }
+  else if (options.many_lights > 0) {
+    many_lights_scene_create(options.scene, options.many_lights);
+  }
+  else {
+    xml_read_file(options.scene, options.filepath.c_str());
+  }
+
+  if (!options.benchmark_path.empty()) {
+    options.scene->enable_update_stats();
+  }
+
+  if (options.use_light_tree) {
+    options.scene->integrator->set_use_light_tree(true);
+    options.scene->integrator->tag_update(options.scene, Integrator::UPDATE_NONE);
+  }
 
   /* Camera width/height override? */
   if (!(options.width == 0 || options.height == 0)) {
@@ -178,6 +201,43 @@ static void session_exit()
   }
 }
 
+/* Render the generated scenes and the XML file if any, one session each. */
+static void benchmark_run()
+{
+  vector<string> names = benchmark_scene_names();
+  if (options.filepath != "") {
+    names.push_back("");
+  }
+
+  vector<BenchmarkResult> results;
+  string device;
+
+  foreach (const string &name, names) {
+    options.benchmark_scene = name;
+
+    session_init();
+    options.session->wait();
+
+    if (options.session->progress.get_cancel()) {
+      fprintf(stderr,
+              "Benchmark canceled: %s\n",
+              options.session->progress.get_cancel_message().c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    const string result_name = (name.empty()) ? path_filename(options.filepath) : name;
+    results.push_back(benchmark_result_get(result_name, options.session));
+    device = options.session->device->info.description;
+
+    session_exit();
+  }
+
+  if (!benchmark_write_json(options.benchmark_path, device, results)) {
+    fprintf(stderr, "Failed to write benchmark results to %s\n", options.benchmark_path.c_str());
+    exit(EXIT_FAILURE);
+  }
+}
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
 static void display_info(Progress &progress)
 {
@@ -367,6 +427,8 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.many_lights = 0;
+  options.use_light_tree = false;
 
   /* device names */
   string device_names = "";
@@ -429,6 +491,15 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--many-lights %d",
+             &options.many_lights,
+             "Render a generated city with about this many lights instead of a file",
+             "--light-tree",
+             &options.use_light_tree,
+             "Use the light tree to pick lights",
+             "--benchmark %s",
+             &options.benchmark_path,
+             "Render generated scenes and the file if any, and write timings as JSON to this file",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -476,7 +547,8 @@ static void options_parse(int argc, const char **argv)
     printf("%s\n", CYCLES_VERSION_STRING);
     exit(EXIT_SUCCESS);
   }
-  else if (help || options.filepath == "") {
+  else if (help ||
+           (options.filepath == "" && options.many_lights <= 0 && options.benchmark_path == "")) {
     ap.usage();
     exit(EXIT_SUCCESS);
   }
@@ -490,6 +562,11 @@ static void options_parse(int argc, const char **argv)
   options.session_params.background = true;
 #endif
 
+  /* Benchmarks always render without user interface. */
+  if (options.benchmark_path != "") {
+    options.session_params.background = true;
+  }
+
   /* Use progressive rendering */
   options.session_params.progressive = true;
 
@@ -503,6 +580,15 @@ static void options_parse(int argc, const char **argv)
     device_available = true;
   }
 
+  /* Spread tiles over all servers, the local CPU renders as well. Servers that run out of tiles
+   * take over the tiles still in progress on the CPU. */
+  if (device_type == DEVICE_NETWORK && device_available) {
+    vector<DeviceInfo> cpu_devices = Device::available_devices(DEVICE_MASK_CPU);
+    devices.insert(devices.end(), cpu_devices.begin(), cpu_devices.end());
+    options.session_params.device = Device::get_multi_device(
+        devices, options.session_params.threads, options.session_params.background);
+  }
+
   /* handle invalid configurations */
   if (options.session_params.device.type == DEVICE_NONE || !device_available) {
     fprintf(stderr, "Unknown device: %s\n", devicename.c_str());
@@ -523,7 +609,7 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "Invalid number of samples: %d\n", options.session_params.samples);
     exit(EXIT_FAILURE);
   }
-  else if (options.filepath == "") {
+  else if (options.filepath == "" && options.many_lights <= 0 && options.benchmark_path == "") {
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
   }
@@ -542,6 +628,11 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (options.benchmark_path != "") {
+    benchmark_run();
+    return 0;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
@@ -392,6 +392,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights and emissive meshes based on their power and distance to the shading point, "
+        "reducing noise in scenes with many lights (not used when sampling all lights)",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -688,6 +694,18 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Use special type BVH optimized for hair (uses more ram but renders faster)",
         default=True,
     )
+    debug_use_compressed_normals: BoolProperty(
+        name="Compress Normals",
+        description="Store smooth shading normals in less memory, at a small loss of precision",
+        default=False,
+    )
+    use_bvh_refit: BoolProperty(
+        name="Refit BVH",
+        description="With persistent data, update the BVH of deforming objects between frames "
+        "instead of building it again. Object transforms are no longer applied to meshes and "
+        "OptiX acceleration structures are not compacted, which uses more memory",
+        default=False,
+    )
     debug_bvh_time_steps: IntProperty(
         name="BVH Time Steps",
         description="Split BVH primitives by this number of time steps to speed up render time in cost of memory",
@@ -1353,6 +1371,18 @@ class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
         default=False,
         update=update_render_passes,
     )
+    pass_debug_sample_time: BoolProperty(
+        name="Debug Sample Time",
+        description="Render time in microseconds per sample and pixel, to find expensive parts of the image (CPU only)",
+        default=False,
+        update=update_render_passes,
+    )
+    pass_debug_shader_evaluations: BoolProperty(
+        name="Debug Shader Evaluations",
+        description="Number of surface and volume shader evaluations per sample and pixel (CPU only)",
+        default=False,
+        update=update_render_passes,
+    )
     use_pass_volume_direct: BoolProperty(
         name="Volume Direct",
         description="Deliver direct volumetric scattering pass",
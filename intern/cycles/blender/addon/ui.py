@@ -321,6 +321,7 @@ class CYCLES_RENDER_PT_sampling_advanced(CyclesButtonsPanel, Panel):
         col.prop(cscene, "min_light_bounces")
         col.prop(cscene, "min_transparent_bounces")
         col.prop(cscene, "light_sampling_threshold", text="Light Threshold")
+        col.prop(cscene, "use_light_tree")
 
         if cscene.progressive != 'PATH' and use_branched_path(context):
             col = layout.column(align=True)
@@ -760,6 +761,7 @@ class CYCLES_RENDER_PT_performance_acceleration_structure(CyclesButtonsPanel, Pa
         sub = col.column()
         sub.active = not cscene.debug_use_spatial_splits and not use_embree
         sub.prop(cscene, "debug_bvh_time_steps")
+        col.prop(cscene, "debug_use_compressed_normals")
 
 
 class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
@@ -772,12 +774,16 @@ class CYCLES_RENDER_PT_performance_final_render(CyclesButtonsPanel, Panel):
         layout.use_property_decorate = False
 
         scene = context.scene
+        cscene = scene.cycles
         rd = scene.render
 
         col = layout.column()
 
         col.prop(rd, "use_save_buffers")
         col.prop(rd, "use_persistent_data", text="Persistent Data")
+        sub = col.column()
+        sub.active = rd.use_persistent_data
+        sub.prop(cscene, "use_bvh_refit")
 
 
 class CYCLES_RENDER_PT_performance_viewport(CyclesButtonsPanel, Panel):
@@ -880,6 +886,8 @@ class CYCLES_RENDER_PT_passes_data(CyclesButtonsPanel, Panel):
         col = layout.column(heading="Debug", align=True)
         col.prop(cycles_view_layer, "pass_debug_render_time", text="Render Time")
         col.prop(cycles_view_layer, "pass_debug_sample_count", text="Sample Count")
+        col.prop(cycles_view_layer, "pass_debug_sample_time", text="Sample Time")
+        col.prop(cycles_view_layer, "pass_debug_shader_evaluations", text="Shader Evaluations")
 
         layout.prop(view_layer, "pass_alpha_threshold")
 
@@ -33,11 +33,68 @@
 #include "util/util_hash.h"
 #include "util/util_logging.h"
 #include "util/util_math.h"
+#include "util/util_task.h"
 
 #include "mikktspace.h"
 
+#include "DNA_meshdata_types.h"
+
 CCL_NAMESPACE_BEGIN
 
+/* Direct Mesh Data Access
+ *
+ * The RNA collections of vertices, loops, polygons and loop triangles wrap the arrays of the
+ * Blender mesh. Reading large meshes through RNA one element at a time is slow, so the arrays
+ * are read directly and converted in parallel. */
+
+/* Number of elements converted per task. */
+static const size_t MESH_ELEMENTS_PER_TASK = 4096;
+
+template<typename Func> static void mesh_parallel_for(size_t num_elements, const Func &func)
+{
+  parallel_for(blocked_range<size_t>(0, num_elements, MESH_ELEMENTS_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   func(i);
+                 }
+               });
+}
+
+static const MVert *mesh_vertices(BL::Mesh &b_mesh)
+{
+  return (b_mesh.vertices.length()) ? static_cast<const MVert *>(b_mesh.vertices[0].ptr.data) :
+                                      NULL;
+}
+
+static const MLoop *mesh_loops(BL::Mesh &b_mesh)
+{
+  return (b_mesh.loops.length()) ? static_cast<const MLoop *>(b_mesh.loops[0].ptr.data) : NULL;
+}
+
+static const MPoly *mesh_polygons(BL::Mesh &b_mesh)
+{
+  return (b_mesh.polygons.length()) ? static_cast<const MPoly *>(b_mesh.polygons[0].ptr.data) :
+                                      NULL;
+}
+
+static const MLoopTri *mesh_loop_triangles(BL::Mesh &b_mesh)
+{
+  return (b_mesh.loop_triangles.length()) ?
+             static_cast<const MLoopTri *>(b_mesh.loop_triangles[0].ptr.data) :
+             NULL;
+}
+
+static inline float3 mesh_vertex_co(const MVert &vert)
+{
+  return make_float3(vert.co[0], vert.co[1], vert.co[2]);
+}
+
+static inline float3 mesh_vertex_normal(const MVert &vert)
+{
+  /* Same conversion as normal_short_to_float_v3(). */
+  return make_float3(vert.no[0], vert.no[1], vert.no[2]) * (1.0f / 32767.0f);
+}
+
 /* Tangent Space */
 
 struct MikkUserData {
@@ -492,20 +549,19 @@ static void attr_create_vertex_color(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh,
       }
 
       uchar4 *cdata = vcol_attr->data_uchar4();
-
-      for (BL::MeshLoopTriangle &t : b_mesh.loop_triangles) {
-        int3 li = get_int3(t.loops());
-        float4 c1 = get_float4(l.data[li[0]].color());
-        float4 c2 = get_float4(l.data[li[1]].color());
-        float4 c3 = get_float4(l.data[li[2]].color());
-
-        /* Compress/encode vertex color using the sRGB curve. */
-        cdata[0] = color_float4_to_uchar4(c1);
-        cdata[1] = color_float4_to_uchar4(c2);
-        cdata[2] = color_float4_to_uchar4(c3);
-
-        cdata += 3;
-      }
+      const MLoopTri *b_looptris = mesh_loop_triangles(b_mesh);
+      const MLoopCol *b_cols = (l.data.length()) ?
+                                   static_cast<const MLoopCol *>(l.data[0].ptr.data) :
+                                   NULL;
+
+      mesh_parallel_for(b_mesh.loop_triangles.length(), [&](const size_t i) {
+        for (int j = 0; j < 3; j++) {
+          const MLoopCol &col = b_cols[b_looptris[i].tri[j]];
+          const float4 color = make_float4(col.r, col.g, col.b, col.a) * (1.0f / 255.0f);
+          /* Compress/encode vertex color using the sRGB curve. */
+          cdata[i * 3 + j] = color_float4_to_uchar4(color);
+        }
+      });
     }
   }
 }
@@ -542,14 +598,17 @@ static void attr_create_uv_map(Scene *scene, Mesh *mesh, BL::Mesh &b_mesh)
         }
 
         float2 *fdata = uv_attr->data_float2();
-
-        for (BL::MeshLoopTriangle &t : b_mesh.loop_triangles) {
-          int3 li = get_int3(t.loops());
-          fdata[0] = get_float2(l.data[li[0]].uv());
-          fdata[1] = get_float2(l.data[li[1]].uv());
-          fdata[2] = get_float2(l.data[li[2]].uv());
-          fdata += 3;
-        }
+        const MLoopTri *b_looptris = mesh_loop_triangles(b_mesh);
+        const MLoopUV *b_uvs = (l.data.length()) ?
+                                   static_cast<const MLoopUV *>(l.data[0].ptr.data) :
+                                   NULL;
+
+        mesh_parallel_for(b_mesh.loop_triangles.length(), [&](const size_t i) {
+          for (int j = 0; j < 3; j++) {
+            const MLoopUV &uv = b_uvs[b_looptris[i].tri[j]];
+            fdata[i * 3 + j] = make_float2(uv.uv[0], uv.uv[1]);
+          }
+        });
       }
 
       /* UV tangent */
@@ -876,13 +935,17 @@ static void create_mesh(Scene *scene,
     return;
   }
 
+  const MVert *b_verts = mesh_vertices(b_mesh);
+  const MLoop *b_loops = mesh_loops(b_mesh);
+  const MPoly *b_polys = mesh_polygons(b_mesh);
+
   if (!subdivision) {
     numtris = numfaces;
   }
   else {
-    for (BL::MeshPolygon &p : b_mesh.polygons) {
-      numngons += (p.loop_total() == 4) ? 0 : 1;
-      numcorners += p.loop_total();
+    for (int i = 0; i < numfaces; i++) {
+      numngons += (b_polys[i].totloop == 4) ? 0 : 1;
+      numcorners += b_polys[i].totloop;
     }
   }
 
@@ -891,20 +954,28 @@ static void create_mesh(Scene *scene,
     mesh->reserve_subd_faces(numfaces, numngons, numcorners);
   }
 
-  mesh->reserve_mesh(numverts, numtris);
+  mesh->resize_mesh(numverts, numtris);
 
   /* create vertex coordinates and normals */
-  BL::Mesh::vertices_iterator v;
-  for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v)
-    mesh->add_vertex(get_float3(v->co()));
+  float3 *verts = mesh->get_verts().data();
 
   AttributeSet &attributes = (subdivision) ? mesh->subd_attributes : mesh->attributes;
   Attribute *attr_N = attributes.add(ATTR_STD_VERTEX_NORMAL);
   float3 *N = attr_N->data_float3();
 
-  for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v, ++N)
-    *N = get_float3(v->normal());
-  N = attr_N->data_float3();
+  mesh_parallel_for(numverts, [&](const size_t i) {
+    verts[i] = mesh_vertex_co(b_verts[i]);
+    N[i] = mesh_vertex_normal(b_verts[i]);
+  });
+  mesh->tag_verts_modified();
+
+  if (subdivision) {
+    array<float2> &vert_patch_uv = mesh->get_vert_patch_uv();
+    for (size_t i = 0; i < vert_patch_uv.size(); i++) {
+      vert_patch_uv[i] = zero_float2();
+    }
+    mesh->tag_vert_patch_uv_modified();
+  }
 
   /* create generated coordinates from undeformed coordinates */
   const bool need_default_tangent = (subdivision == false) && (b_mesh.uv_layers.length() == 0) &&
@@ -919,47 +990,66 @@ static void create_mesh(Scene *scene,
     float3 *generated = attr->data_float3();
     size_t i = 0;
 
+    BL::Mesh::vertices_iterator v;
     for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end(); ++v) {
       generated[i++] = get_float3(v->undeformed_co()) * size - loc;
     }
   }
 
   /* create faces */
-  if (!subdivision) {
-    for (BL::MeshLoopTriangle &t : b_mesh.loop_triangles) {
-      BL::MeshPolygon p = b_mesh.polygons[t.polygon_index()];
-      int3 vi = get_int3(t.vertices());
-
-      int shader = clamp(p.material_index(), 0, used_shaders.size() - 1);
-      bool smooth = p.use_smooth() || use_loop_normals;
+  const int max_shader = used_shaders.size() - 1;
 
-      if (use_loop_normals) {
+  if (!subdivision) {
+    const MLoopTri *b_looptris = mesh_loop_triangles(b_mesh);
+    int *triangles = mesh->get_triangles().data();
+    int *shader = mesh->get_shader().data();
+    bool *smooth = mesh->get_smooth().data();
+
+    /* Create triangles.
+     *
+     * NOTE: Autosmooth is already taken care about.
+     */
+    mesh_parallel_for(numtris, [&](const size_t i) {
+      const MLoopTri &looptri = b_looptris[i];
+      const MPoly &poly = b_polys[looptri.poly];
+
+      triangles[i * 3 + 0] = b_loops[looptri.tri[0]].v;
+      triangles[i * 3 + 1] = b_loops[looptri.tri[1]].v;
+      triangles[i * 3 + 2] = b_loops[looptri.tri[2]].v;
+      shader[i] = clamp((int)poly.mat_nr, 0, max_shader);
+      smooth[i] = (poly.flag & ME_SMOOTH) || use_loop_normals;
+    });
+
+    mesh->tag_triangles_modified();
+    mesh->tag_shader_modified();
+    mesh->tag_smooth_modified();
+
+    /* Split normals are not stored in an array, and vertices shared by multiple triangles get
+     * the normal of the last one. */
+    if (use_loop_normals) {
+      for (BL::MeshLoopTriangle &t : b_mesh.loop_triangles) {
+        int3 vi = get_int3(t.vertices());
         BL::Array<float, 9> loop_normals = t.split_normals();
         for (int i = 0; i < 3; i++) {
           N[vi[i]] = make_float3(
               loop_normals[i * 3], loop_normals[i * 3 + 1], loop_normals[i * 3 + 2]);
         }
       }
-
-      /* Create triangles.
-       *
-       * NOTE: Autosmooth is already taken care about.
-       */
-      mesh->add_triangle(vi[0], vi[1], vi[2], shader, smooth);
     }
   }
   else {
     vector<int> vi;
 
-    for (BL::MeshPolygon &p : b_mesh.polygons) {
-      int n = p.loop_total();
-      int shader = clamp(p.material_index(), 0, used_shaders.size() - 1);
-      bool smooth = p.use_smooth() || use_loop_normals;
+    for (int face = 0; face < numfaces; face++) {
+      const MPoly &poly = b_polys[face];
+      int n = poly.totloop;
+      int shader = clamp((int)poly.mat_nr, 0, max_shader);
+      bool smooth = (poly.flag & ME_SMOOTH) || use_loop_normals;
 
       vi.resize(n);
       for (int i = 0; i < n; i++) {
         /* NOTE: Autosmooth is already taken care about. */
-        vi[i] = b_mesh.loops[p.loop_start() + i].vertex_index();
+        vi[i] = b_loops[poly.loopstart + i].v;
       }
 
       /* create subd faces */
@@ -1263,13 +1353,12 @@ void BlenderSync::sync_mesh_motion(BL::Depsgraph b_depsgraph,
     /* NOTE: We don't copy more that existing amount of vertices to prevent
      * possible memory corruption.
      */
-    BL::Mesh::vertices_iterator v;
-    int i = 0;
-    for (b_mesh.vertices.begin(v); v != b_mesh.vertices.end() && i < numverts; ++v, ++i) {
-      mP[i] = get_float3(v->co());
+    const MVert *b_verts = mesh_vertices(b_mesh);
+    mesh_parallel_for(min((size_t)b_mesh.vertices.length(), numverts), [&](const size_t i) {
+      mP[i] = mesh_vertex_co(b_verts[i]);
       if (mN)
-        mN[i] = get_float3(v->normal());
-    }
+        mN[i] = mesh_vertex_normal(b_verts[i]);
+    });
     if (new_attribute) {
       /* In case of new attribute, we verify if there really was any motion. */
       if (b_mesh.vertices.length() != numverts ||
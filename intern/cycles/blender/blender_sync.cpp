@@ -334,6 +334,7 @@ void BlenderSync::sync_integrator()
   integrator->set_sample_all_lights_direct(get_boolean(cscene, "sample_all_lights_direct"));
   integrator->set_sample_all_lights_indirect(get_boolean(cscene, "sample_all_lights_indirect"));
   integrator->set_light_sampling_threshold(get_float(cscene, "light_sampling_threshold"));
+  integrator->set_use_light_tree(get_boolean(cscene, "use_light_tree"));
 
   SamplingPattern sampling_pattern = (SamplingPattern)get_enum(
       cscene, "sampling_pattern", SAMPLING_NUM_PATTERNS, SAMPLING_PATTERN_SOBOL);
@@ -553,6 +554,8 @@ PassType BlenderSync::get_pass_type(BL::RenderPass &b_pass)
   MAP_PASS("Debug Render Time", PASS_RENDER_TIME);
   MAP_PASS("AdaptiveAuxBuffer", PASS_ADAPTIVE_AUX_BUFFER);
   MAP_PASS("Debug Sample Count", PASS_SAMPLE_COUNT);
+  MAP_PASS("Debug Sample Time", PASS_SAMPLE_TIME);
+  MAP_PASS("Debug Shader Evaluations", PASS_SHADER_EVALUATIONS);
   if (string_startswith(name, cryptomatte_prefix)) {
     return PASS_CRYPTOMATTE;
   }
@@ -671,6 +674,14 @@ vector<Pass> BlenderSync::sync_render_passes(BL::Scene &b_scene,
     b_engine.add_pass("Debug Sample Count", 1, "X", b_view_layer.name().c_str());
     Pass::add(PASS_SAMPLE_COUNT, passes, "Debug Sample Count");
   }
+  if (get_boolean(crl, "pass_debug_sample_time")) {
+    b_engine.add_pass("Debug Sample Time", 1, "X", b_view_layer.name().c_str());
+    Pass::add(PASS_SAMPLE_TIME, passes, "Debug Sample Time");
+  }
+  if (get_boolean(crl, "pass_debug_shader_evaluations")) {
+    b_engine.add_pass("Debug Shader Evaluations", 1, "X", b_view_layer.name().c_str());
+    Pass::add(PASS_SHADER_EVALUATIONS, passes, "Debug Shader Evaluations");
+  }
   if (get_boolean(crl, "use_pass_volume_direct")) {
     b_engine.add_pass("VolumeDir", 3, "RGB", b_view_layer.name().c_str());
     Pass::add(PASS_VOLUME_DIRECT, passes, "VolumeDir");
@@ -804,6 +815,12 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  params.use_compressed_normals = RNA_boolean_get(&cscene, "debug_use_compressed_normals");
+  /* With persistent data the scene is kept between frames, so deforming geometry can be refit
+   * instead of building its BVH again. This keeps object transforms separate from meshes and
+   * disables OptiX compaction, so it is an explicit option. */
+  params.use_bvh_refit = background && b_scene.render().use_persistent_data() &&
+                         RNA_boolean_get(&cscene, "use_bvh_refit");
 
   PointerRNA csscene = RNA_pointer_get(&b_scene.ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
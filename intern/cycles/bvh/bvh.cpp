@@ -78,10 +78,16 @@ BVHLayout BVHParams::best_bvh_layout(BVHLayout requested_layout, BVHLayoutMask s
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_), geometry(geometry_), objects(objects_), num_refits(0)
 {
 }
 
+bool BVH::refit_degraded() const
+{
+  /* Without a measure of the quality of the BVH, build it again after a number of refits. */
+  return num_refits >= BVH_MAX_REFITS;
+}
+
 BVH *BVH::create(const BVHParams &params,
                  const vector<Geometry *> &geometry,
                  const vector<Object *> &objects,
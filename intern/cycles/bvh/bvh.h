@@ -38,6 +38,8 @@ class Stats;
 
 #define BVH_ALIGN 4096
 #define TRI_NODE_SIZE 3
+/* Refits after which a BVH is built again, when its quality can not be measured. */
+#define BVH_MAX_REFITS 16
 /* Packed BVH
  *
  * BVH stored as it will be used for traversal on the rendering device. */
@@ -83,6 +85,9 @@ class BVH {
   vector<Geometry *> geometry;
   vector<Object *> objects;
 
+  /* Number of times the BVH was refit since it was built. */
+  int num_refits;
+
   static BVH *create(const BVHParams &params,
                      const vector<Geometry *> &geometry,
                      const vector<Object *> &objects,
@@ -91,6 +96,11 @@ class BVH {
   {
   }
 
+  /* Refitting keeps the structure of the BVH, which gets slower to trace the further the
+   * geometry moves away from the shape it was built for. Returns true when it is better to
+   * build the BVH again than to refit it once more. */
+  virtual bool refit_degraded() const;
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
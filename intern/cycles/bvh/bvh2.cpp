@@ -42,7 +42,7 @@ int BVHStackEntry::encodeIdx() const
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
-    : BVH(params_, geometry_, objects_)
+    : BVH(params_, geometry_, objects_), build_area(0.0f)
 {
 }
 
@@ -94,6 +94,10 @@ void BVH2::build(Progress &progress, Stats *)
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root);
 
+  if (!params.top_level) {
+    build_area = nodes_area();
+  }
+
   /* free build nodes */
   root->deleteSubtree();
 }
@@ -322,6 +326,43 @@ void BVH2::refit_nodes()
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
 }
 
+/* Sum of the surface areas of the children of inner nodes, which the cost of tracing a ray
+ * through the BVH is proportional to. Unaligned nodes are skipped, their bounds are lost when
+ * refitting. */
+float BVH2::nodes_area() const
+{
+  float area = 0.0f;
+  size_t idx = 0;
+
+  while (idx < pack.nodes.size()) {
+    const int4 *data = &pack.nodes[idx];
+
+    if (data[0].x & PATH_RAY_NODE_UNALIGNED) {
+      idx += BVH_UNALIGNED_NODE_SIZE;
+      continue;
+    }
+
+    for (int i = 0; i < 2; i++) {
+      BoundBox bbox(make_float3(__int_as_float(data[1][i]),
+                                __int_as_float(data[2][i]),
+                                __int_as_float(data[3][i])),
+                    make_float3(__int_as_float(data[1][i + 2]),
+                                __int_as_float(data[2][i + 2]),
+                                __int_as_float(data[3][i + 2])));
+      area += bbox.safe_area();
+    }
+
+    idx += BVH_NODE_SIZE;
+  }
+
+  return area;
+}
+
+bool BVH2::refit_degraded() const
+{
+  return build_area > 0.0f && nodes_area() > build_area * BVH_MAX_REFIT_AREA_RATIO;
+}
+
 void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
 {
   if (leaf) {
@@ -388,7 +429,7 @@ void BVH2::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility
       /* Primitives. */
       if (pack.prim_type[prim] & PRIMITIVE_ALL_CURVE) {
         /* Curves. */
-        const Hair *hair = static_cast<const Hair *>(ob->get_geometry());
+        const Hair *hair = static_cast<const Hair *>(ob->get_render_geometry());
         int prim_offset = (params.top_level) ? hair->prim_offset : 0;
         Hair::Curve curve = hair->get_curve(pidx - prim_offset);
         int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
@@ -411,7 +452,7 @@ void BVH2::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility
       }
       else {
         /* Triangles. */
-        const Mesh *mesh = static_cast<const Mesh *>(ob->get_geometry());
+        const Mesh *mesh = static_cast<const Mesh *>(ob->get_render_geometry());
         int prim_offset = (params.top_level) ? mesh->prim_offset : 0;
         Mesh::Triangle triangle = mesh->get_triangle(pidx - prim_offset);
         const float3 *vpos = &mesh->verts[0];
@@ -443,7 +484,7 @@ void BVH2::pack_triangle(int idx, float4 tri_verts[3])
 {
   int tob = pack.prim_object[idx];
   assert(tob >= 0 && tob < objects.size());
-  const Mesh *mesh = static_cast<const Mesh *>(objects[tob]->get_geometry());
+  const Mesh *mesh = static_cast<const Mesh *>(objects[tob]->get_render_geometry());
 
   int tidx = pack.prim_index[idx];
   Mesh::Triangle t = mesh->get_triangle(tidx);
@@ -508,7 +549,7 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
    */
   for (size_t i = 0; i < pack.prim_index.size(); i++) {
     if (pack.prim_index[i] != -1) {
-      pack.prim_index[i] += objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      pack.prim_index[i] += objects[pack.prim_object[i]]->get_render_geometry()->prim_offset;
     }
   }
 
@@ -569,7 +610,7 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 
   /* merge */
   foreach (Object *ob, objects) {
-    Geometry *geom = ob->get_geometry();
+    Geometry *geom = ob->get_render_geometry();
 
     /* We assume that if mesh doesn't need own BVH it was already included
      * into a top-level BVH and no packing here is needed.
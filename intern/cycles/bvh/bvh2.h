@@ -29,6 +29,8 @@ CCL_NAMESPACE_BEGIN
 #define BVH_NODE_SIZE 4
 #define BVH_NODE_LEAF_SIZE 1
 #define BVH_UNALIGNED_NODE_SIZE 7
+/* Growth of the node area after which refitting is considered worse than a new build. */
+#define BVH_MAX_REFIT_AREA_RATIO 1.5f
 
 /* Pack Utility */
 struct BVHStackEntry {
@@ -48,6 +50,8 @@ class BVH2 : public BVH {
   void build(Progress &progress, Stats *stats);
   void refit(Progress &progress);
 
+  bool refit_degraded() const override;
+
   PackedBVH pack;
 
  protected:
@@ -92,6 +96,10 @@ class BVH2 : public BVH {
 
   /* refit */
   void refit_nodes();
+  float nodes_area() const;
+
+  /* Area of the nodes right after building. */
+  float build_area;
   void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
 
   /* Refit range of primitives. */
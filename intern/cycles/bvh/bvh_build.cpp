@@ -321,14 +321,14 @@ void BVHBuild::add_references(BVHRange &root)
       if (!ob->is_traceable()) {
         continue;
       }
-      if (!ob->get_geometry()->is_instanced()) {
-        num_alloc_references += count_primitives(ob->get_geometry());
+      if (!ob->get_render_geometry()->is_instanced()) {
+        num_alloc_references += count_primitives(ob->get_render_geometry());
       }
       else
         num_alloc_references++;
     }
     else {
-      num_alloc_references += count_primitives(ob->get_geometry());
+      num_alloc_references += count_primitives(ob->get_render_geometry());
     }
   }
 
@@ -344,13 +344,13 @@ void BVHBuild::add_references(BVHRange &root)
         ++i;
         continue;
       }
-      if (!ob->get_geometry()->is_instanced())
-        add_reference_geometry(bounds, center, ob->get_geometry(), i);
+      if (!ob->get_render_geometry()->is_instanced())
+        add_reference_geometry(bounds, center, ob->get_render_geometry(), i);
       else
         add_reference_object(bounds, center, ob, i);
     }
     else
-      add_reference_geometry(bounds, center, ob->get_geometry(), i);
+      add_reference_geometry(bounds, center, ob->get_render_geometry(), i);
 
     i++;
 
@@ -223,14 +223,22 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
 
 static void rtc_filter_func_thick_curve(const RTCFilterFunctionNArguments *args)
 {
-  const RTCRay *ray = (RTCRay *)args->ray;
-  RTCHit *hit = (RTCHit *)args->hit;
+  /* Called for packets of rays when the split kernel traces ray streams. */
+  for (unsigned int i = 0; i < args->N; i++) {
+    if (args->valid[i] == 0) {
+      continue;
+    }
 
-  /* Always ignore backfacing intersections. */
-  if (dot(make_float3(ray->dir_x, ray->dir_y, ray->dir_z),
-          make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z)) > 0.0f) {
-    *args->valid = 0;
-    return;
+    /* Always ignore backfacing intersections. */
+    const float3 dir = make_float3(RTCRayN_dir_x(args->ray, args->N, i),
+                                   RTCRayN_dir_y(args->ray, args->N, i),
+                                   RTCRayN_dir_z(args->ray, args->N, i));
+    const float3 Ng = make_float3(RTCHitN_Ng_x(args->hit, args->N, i),
+                                  RTCHitN_Ng_y(args->hit, args->N, i),
+                                  RTCHitN_Ng_z(args->hit, args->N, i));
+    if (dot(dir, Ng) > 0.0f) {
+      args->valid[i] = 0;
+    }
   }
 }
 
@@ -347,7 +355,7 @@ void BVHEmbree::build(Progress &progress, Stats *stats, RTCDevice rtc_device_)
         ++i;
         continue;
       }
-      if (!ob->get_geometry()->is_instanced()) {
+      if (!ob->get_render_geometry()->is_instanced()) {
         add_object(ob, i);
       }
       else {
@@ -372,7 +380,7 @@ void BVHEmbree::build(Progress &progress, Stats *stats, RTCDevice rtc_device_)
 
 void BVHEmbree::add_object(Object *ob, int i)
 {
-  Geometry *geom = ob->get_geometry();
+  Geometry *geom = ob->get_render_geometry();
 
   if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
     Mesh *mesh = static_cast<Mesh *>(geom);
@@ -390,7 +398,7 @@ void BVHEmbree::add_object(Object *ob, int i)
 
 void BVHEmbree::add_instance(Object *ob, int i)
 {
-  BVHEmbree *instance_bvh = (BVHEmbree *)(ob->get_geometry()->bvh);
+  BVHEmbree *instance_bvh = (BVHEmbree *)(ob->get_render_geometry()->bvh);
   assert(instance_bvh != NULL);
 
   const size_t num_object_motion_steps = ob->use_motion() ? ob->get_motion().size() : 1;
@@ -671,8 +679,8 @@ void BVHEmbree::refit(Progress &progress)
   /* Update all vertex buffers, then tell Embree to rebuild/-fit the BVHs. */
   unsigned geom_id = 0;
   foreach (Object *ob, objects) {
-    if (!params.top_level || (ob->is_traceable() && !ob->get_geometry()->is_instanced())) {
-      Geometry *geom = ob->get_geometry();
+    if (!params.top_level || (ob->is_traceable() && !ob->get_render_geometry()->is_instanced())) {
+      Geometry *geom = ob->get_render_geometry();
 
       if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -680,6 +688,12 @@ void BVHEmbree::refit(Progress &progress)
           RTCGeometry geom = rtcGetGeometry(scene, geom_id);
           set_tri_vertex_buffer(geom, mesh, true);
           rtcSetGeometryUserData(geom, (void *)mesh->optix_prim_offset);
+          /* With refit enabled for final renders, update the bounds of the existing nodes
+           * instead of building the BVH again, the geometry manager builds a new BVH once it
+           * degraded too much. Viewport updates keep the build quality of the scene. */
+          if (params.use_refit && !params.top_level) {
+            rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+          }
           rtcCommitGeometry(geom);
         }
       }
@@ -34,4 +34,15 @@ BVHMulti::~BVHMulti()
   }
 }
 
+bool BVHMulti::refit_degraded() const
+{
+  foreach (BVH *bvh, sub_bvhs) {
+    if (bvh->refit_degraded()) {
+      return true;
+    }
+  }
+
+  return BVH::refit_degraded();
+}
+
 CCL_NAMESPACE_END
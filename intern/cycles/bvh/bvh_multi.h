@@ -26,6 +26,8 @@ class BVHMulti : public BVH {
  public:
   vector<BVH *> sub_bvhs;
 
+  bool refit_degraded() const override;
+
  protected:
   friend class BVH;
   BVHMulti(const BVHParams &params,
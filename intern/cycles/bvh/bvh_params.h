@@ -88,6 +88,9 @@ class BVHParams {
   /* Same as in SceneParams. */
   int bvh_type;
 
+  /* Build the BVH such that it can be refit later, instead of built again. */
+  bool use_refit;
+
   /* These are needed for Embree. */
   int curve_subdivisions;
 
@@ -120,6 +123,7 @@ class BVHParams {
     num_motion_triangle_steps = 0;
 
     bvh_type = 0;
+    use_refit = false;
 
     curve_subdivisions = 4;
   }
@@ -456,7 +456,7 @@ void BVHSpatialSplit::split_curve_reference(const BVHReference &ref,
 void BVHSpatialSplit::split_object_reference(
     const Object *object, int dim, float pos, BoundBox &left_bounds, BoundBox &right_bounds)
 {
-  Geometry *geom = object->get_geometry();
+  Geometry *geom = object->get_render_geometry();
 
   if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
     Mesh *mesh = static_cast<Mesh *>(geom);
@@ -492,11 +492,11 @@ void BVHSpatialSplit::split_reference(const BVHBuild &builder,
   const Object *ob = builder.objects[ref.prim_object()];
 
   if (ref.prim_type() & PRIMITIVE_ALL_TRIANGLE) {
-    Mesh *mesh = static_cast<Mesh *>(ob->get_geometry());
+    Mesh *mesh = static_cast<Mesh *>(ob->get_render_geometry());
     split_triangle_reference(ref, mesh, dim, pos, left_bounds, right_bounds);
   }
   else if (ref.prim_type() & PRIMITIVE_ALL_CURVE) {
-    Hair *hair = static_cast<Hair *>(ob->get_geometry());
+    Hair *hair = static_cast<Hair *>(ob->get_render_geometry());
     split_curve_reference(ref, hair, dim, pos, left_bounds, right_bounds);
   }
   else {
@@ -409,9 +409,17 @@ Device *Device::create(DeviceInfo &info, Stats &stats, Profiler &profiler, bool
       break;
 #endif
 #ifdef WITH_NETWORK
-    case DEVICE_NETWORK:
-      device = device_network_create(info, stats, profiler, "127.0.0.1");
+    case DEVICE_NETWORK: {
+      /* The server address follows the prefix of the ID, see device_network_info(). */
+      const string prefix = "NETWORK_";
+      if (!string_startswith(info.id, prefix.c_str())) {
+        LOG(ERROR) << "Network device ID \"" << info.id << "\" has no server address.";
+        break;
+      }
+      const string address = info.id.substr(prefix.size());
+      device = device_network_create(info, stats, profiler, address.c_str());
       break;
+    }
 #endif
 #ifdef WITH_OPENCL
     case DEVICE_OPENCL:
@@ -431,7 +431,7 @@ class Device {
 
 #ifdef WITH_NETWORK
   /* networking */
-  void server_run();
+  void server_run(int port);
 #endif
 
   /* multi device */
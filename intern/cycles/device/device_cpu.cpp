@@ -64,6 +64,7 @@
 #include "util/util_system.h"
 #include "util/util_task.h"
 #include "util/util_thread.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -876,6 +877,27 @@ class CPUDevice : public Device {
     return true;
   }
 
+  /* Path trace a pixel and accumulate its cost into the sample time and shader evaluations
+   * passes. Measured around the kernel call, timers are not available inside kernels. */
+  void path_trace_pixel_cost(KernelGlobals *kg, RenderTile &tile, int sample, int x, int y)
+  {
+    float *buffer = (float *)tile.buffer +
+                    (tile.offset + x + y * tile.stride) * kernel_data.film.pass_stride;
+
+    kg->num_shader_evaluations = 0;
+    const double start_time = time_dt();
+
+    path_trace_kernel()(kg, (float *)tile.buffer, sample, x, y, tile.offset, tile.stride);
+
+    if (kernel_data.film.pass_sample_time) {
+      /* In microseconds, seconds are too small to be readable in a float pass. */
+      buffer[kernel_data.film.pass_sample_time] += (float)((time_dt() - start_time) * 1e6);
+    }
+    if (kernel_data.film.pass_shader_evaluations) {
+      buffer[kernel_data.film.pass_shader_evaluations] += (float)kg->num_shader_evaluations;
+    }
+  }
+
   bool adaptive_sampling_filter(KernelGlobals *kg, RenderTile &tile, int sample)
   {
     WorkTile wtile;
@@ -934,6 +956,8 @@ class CPUDevice : public Device {
   void render(DeviceTask &task, RenderTile &tile, KernelGlobals *kg)
   {
     const bool use_coverage = kernel_data.film.cryptomatte_passes & CRYPT_ACCURATE;
+    const bool use_pixel_cost = kernel_data.film.pass_sample_time ||
+                                kernel_data.film.pass_shader_evaluations;
 
     scoped_timer timer(&tile.buffers->render_time);
 
@@ -966,7 +990,12 @@ class CPUDevice : public Device {
             if (use_coverage) {
               coverage.init_pixel(x, y);
             }
-            path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+            if (use_pixel_cost) {
+              path_trace_pixel_cost(kg, tile, sample, x, y);
+            }
+            else {
+              path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+            }
           }
         }
       }
@@ -1483,6 +1512,7 @@ class CPUDevice : public Device {
     }
     kg.decoupled_volume_steps_index = 0;
     kg.coverage_asset = kg.coverage_object = kg.coverage_material = NULL;
+    kg.num_shader_evaluations = 0;
 #ifdef WITH_OSL
     OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
@@ -1621,11 +1651,21 @@ int2 CPUSplitKernel::split_kernel_local_size()
   return make_int2(1, 1);
 }
 
-int2 CPUSplitKernel::split_kernel_global_size(device_memory & /*kg*/,
-                                              device_memory & /*data*/,
+int2 CPUSplitKernel::split_kernel_global_size(device_memory &kg,
+                                              device_memory &data,
                                               DeviceTask & /*task*/)
 {
-  return make_int2(1, 1);
+  /* Keep a wavefront of paths per thread, so every kernel stage runs over many rays at once.
+   * This is what allows scene intersection to trace rays as a stream and shader evaluation to
+   * group rays by shader. The memory used for the state of all paths stays bounded. */
+  const size_t max_elements = max_elements_for_max_buffer_size(kg, data, 16 * 1024 * 1024);
+  int size = 32;
+  while (size > 1 && (size_t)(size * size) > max_elements) {
+    size /= 2;
+  }
+
+  VLOG(1) << "Global size: (" << size << ", " << size << ").";
+  return make_int2(size, size);
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory &kernel_globals,
@@ -14,12 +14,18 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+
 #include "device/device_network.h"
 #include "device/device.h"
 #include "device/device_intern.h"
 
+#include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_murmurhash.h"
+#include "util/util_thread.h"
+#include "util/util_time.h"
 
 #if defined(WITH_NETWORK)
 
@@ -32,6 +38,45 @@ typedef map<device_ptr, DataVector> DataMap;
 /* tile list */
 typedef vector<RenderTile> TileList;
 
+/* Contents of a buffer when it was last uploaded to the server. */
+struct NetworkUpload {
+  size_t size;
+  uint64_t hash;
+};
+
+/* Work done by a server, accumulated over all tasks. */
+struct NetworkNodeStats {
+  int num_tiles = 0;
+  uint64_t num_pixel_samples = 0;
+  double render_time = 0.0;
+  size_t bytes_uploaded = 0;
+  size_t bytes_skipped = 0;
+};
+
+/* Two 32 bit hashes with different seeds, so that changed contents are not mistaken for the
+ * previous upload. */
+static uint64_t network_hash_data(const void *data, size_t size)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  const size_t chunk_size = (size_t)1 << 30;
+  uint32_t h1 = 0, h2 = 0x9e3779b9;
+
+  for (size_t offset = 0; offset < size; offset += chunk_size) {
+    const int len = (int)min(chunk_size, size - offset);
+    h1 = util_murmur_hash3(bytes + offset, len, h1);
+    h2 = util_murmur_hash3(bytes + offset, len, h2);
+  }
+
+  return ((uint64_t)h1 << 32) | h2;
+}
+
+/* Only memory the kernels don't write to can skip uploads, otherwise the copy on the server may
+ * differ from what was last uploaded. */
+static bool network_memory_cacheable(const device_memory &mem)
+{
+  return mem.type == MEM_READ_ONLY || mem.type == MEM_GLOBAL || mem.type == MEM_TEXTURE;
+}
+
 /* search a list of tiles and find the one that matches the passed render tile */
 static TileList::iterator tile_list_find(TileList &tile_list, RenderTile &tile)
 {
@@ -45,25 +90,47 @@ class NetworkDevice : public Device {
  public:
   boost::asio::io_service io_service;
   tcp::socket socket;
+  string address;
   device_ptr mem_counter;
   DeviceTask the_task; /* todo: handle multiple tasks */
 
   thread_mutex rpc_lock;
 
+  /* Serves the tile requests of the server while a task runs. */
+  thread *tile_thread;
+  double task_start_time;
+
+  /* Scene data uploaded to the server, to skip uploading it again when unchanged. */
+  map<device_ptr, NetworkUpload> mem_uploads;
+  map<string, NetworkUpload> const_uploads;
+
+  NetworkNodeStats node_stats;
+
   virtual bool show_samples() const
   {
     return false;
   }
 
   NetworkDevice(DeviceInfo &info, Stats &stats, Profiler &profiler, const char *address)
-      : Device(info, stats, profiler, true), socket(io_service)
+      : Device(info, stats, profiler, true),
+        socket(io_service),
+        address(address),
+        tile_thread(NULL),
+        task_start_time(0.0)
   {
     error_func = NetworkError();
-    stringstream portstr;
-    portstr << SERVER_PORT;
+
+    /* Address is "host[:port]". */
+    string host = address;
+    string port = string_printf("%d", SERVER_PORT);
+    const size_t port_separator = host.rfind(':');
+    if (port_separator != string::npos) {
+      port = host.substr(port_separator + 1);
+      host = host.substr(0, port_separator);
+    }
 
     tcp::resolver resolver(io_service);
-    tcp::resolver::query query(address, portstr.str());
+    tcp::resolver::query query(host, port);
     tcp::resolver::iterator endpoint_iterator = resolver.resolve(query);
     tcp::resolver::iterator end;
 
@@ -81,6 +148,12 @@ class NetworkDevice : public Device {
 
   ~NetworkDevice()
   {
+    task_wait();
+
+    VLOG(1) << "Network node " << address << " total: " << node_stats.num_tiles << " tiles, "
+            << string_human_readable_size(node_stats.bytes_uploaded) << " uploaded, "
+            << string_human_readable_size(node_stats.bytes_skipped) << " unchanged.";
+
     RPCSend snd(socket, &error_func, "stop");
     snd.write();
   }
@@ -109,13 +182,26 @@ class NetworkDevice : public Device {
 
   void mem_copy_to(device_memory &mem)
   {
+    const size_t data_size = mem.memory_size();
+    const bool cacheable = network_memory_cacheable(mem);
+    const uint64_t hash = (cacheable) ? network_hash_data(mem.host_pointer, data_size) : 0;
+
     thread_scoped_lock lock(rpc_lock);
 
+    /* Textures are allocated by the copy, the server maps the pointer on first use. */
+    if (!mem.device_pointer) {
+      mem.device_pointer = ++mem_counter;
+    }
+
+    if (cacheable && upload_is_cached(mem_uploads, mem.device_pointer, data_size, hash)) {
+      return;
+    }
+
     RPCSend snd(socket, &error_func, "mem_copy_to");
 
     snd.add(mem);
     snd.write();
-    snd.write_buffer(mem.host_pointer, mem.memory_size());
+    snd.write_buffer(mem.host_pointer, data_size);
   }
 
   void mem_copy_from(device_memory &mem, int y, int w, int h, int elem)
@@ -141,6 +227,11 @@ class NetworkDevice : public Device {
   {
     thread_scoped_lock lock(rpc_lock);
 
+    if (!mem.device_pointer) {
+      mem.device_pointer = ++mem_counter;
+    }
+    mem_uploads.erase(mem.device_pointer);
+
     RPCSend snd(socket, &error_func, "mem_zero");
 
     snd.add(mem);
@@ -157,17 +248,23 @@ class NetworkDevice : public Device {
       snd.add(mem);
       snd.write();
 
+      mem_uploads.erase(mem.device_pointer);
       mem.device_pointer = 0;
     }
   }
 
   void const_copy_to(const char *name, void *host, size_t size)
   {
+    string name_string(name);
+    const uint64_t hash = network_hash_data(host, size);
+
     thread_scoped_lock lock(rpc_lock);
 
-    RPCSend snd(socket, &error_func, "const_copy_to");
+    if (upload_is_cached(const_uploads, name_string, size, hash)) {
+      return;
+    }
 
-    string name_string(name);
+    RPCSend snd(socket, &error_func, "const_copy_to");
 
     snd.add(name_string);
     snd.add(size);
@@ -184,7 +281,6 @@ class NetworkDevice : public Device {
 
     RPCSend snd(socket, &error_func, "load_kernels");
     snd.add(requested_features.experimental);
-    snd.add(requested_features.max_closure);
     snd.add(requested_features.max_nodes_group);
     snd.add(requested_features.nodes_features);
     snd.write();
@@ -198,41 +294,89 @@ class NetworkDevice : public Device {
 
   void task_add(DeviceTask &task)
   {
+    /* The server runs one task at a time. */
+    task_wait();
+
     thread_scoped_lock lock(rpc_lock);
 
     the_task = task;
+    task_start_time = time_dt();
 
     RPCSend snd(socket, &error_func, "task_add");
     snd.add(task);
     snd.write();
+
+    RPCSend snd_wait(socket, &error_func, "task_wait");
+    snd_wait.write();
+
+    lock.unlock();
+
+    /* Serve tiles from a thread, so that all servers of a multi device render at the same time
+     * rather than one after the other in task_wait(). */
+    tile_thread = new thread(function_bind(&NetworkDevice::serve_tiles, this));
   }
 
   void task_wait()
   {
-    thread_scoped_lock lock(rpc_lock);
+    if (tile_thread) {
+      tile_thread->join();
+      delete tile_thread;
+      tile_thread = NULL;
+    }
+  }
 
-    RPCSend snd(socket, &error_func, "task_wait");
+  void task_cancel()
+  {
+    thread_scoped_lock lock(rpc_lock);
+    RPCSend snd(socket, &error_func, "task_cancel");
     snd.write();
+  }
 
-    lock.unlock();
+  int get_split_task_count(DeviceTask &)
+  {
+    return 1;
+  }
 
+ protected:
+  template<typename K>
+  bool upload_is_cached(map<K, NetworkUpload> &uploads, const K &key, size_t size, uint64_t hash)
+  {
+    typename map<K, NetworkUpload>::iterator it = uploads.find(key);
+    if (it != uploads.end() && it->second.size == size && it->second.hash == hash) {
+      node_stats.bytes_skipped += size;
+      return true;
+    }
+
+    uploads[key] = {size, hash};
+    node_stats.bytes_uploaded += size;
+    return false;
+  }
+
+  void serve_tiles()
+  {
+    thread_scoped_lock lock(rpc_lock, std::defer_lock);
     TileList the_tiles;
+    int num_tiles = 0;
+    uint64_t num_pixel_samples = 0;
 
-    /* todo: run this threaded for connecting to multiple clients */
     for (;;) {
       if (error_func.have_error())
         break;
 
       RenderTile tile;
 
-      lock.lock();
+      /* Only this thread receives while the task runs, the lock is for sending. Block without
+       * it, so task_cancel() can send while the server is rendering. */
       RPCReceive rcv(socket, &error_func);
 
       if (rcv.name == "acquire_tile") {
-        lock.unlock();
+        /* The server asks for the tile types of the task it is rendering, e.g. only denoising
+         * tiles once the path tracing tiles are done. */
+        uint tile_types;
+        rcv.read(tile_types);
 
         /* todo: watch out for recursive calls! */
-        if (the_task.acquire_tile(this, tile)) { /* write return as bool */
+        if (the_task.acquire_tile(this, tile, tile_types)) {
           the_tiles.push_back(tile);
 
           lock.lock();
@@ -250,16 +394,21 @@ class NetworkDevice : public Device {
       }
       else if (rcv.name == "release_tile") {
         rcv.read(tile);
-        lock.unlock();
 
+        /* Only the progress of the tile comes back from the server. */
         TileList::iterator it = tile_list_find(the_tiles, tile);
         if (it != the_tiles.end()) {
-          tile.buffers = it->buffers;
+          const int sample = tile.sample;
+          tile = *it;
+          tile.sample = sample;
           the_tiles.erase(it);
         }
 
         assert(tile.buffers != NULL);
 
+        num_tiles++;
+        num_pixel_samples += (uint64_t)tile.w * tile.h * (tile.sample - tile.start_sample);
+
         the_task.release_tile(tile);
 
         lock.lock();
@@ -268,24 +417,22 @@ class NetworkDevice : public Device {
         lock.unlock();
       }
       else if (rcv.name == "task_wait_done") {
-        lock.unlock();
         break;
       }
-      else
-        lock.unlock();
     }
-  }
-
-  void task_cancel()
-  {
-    thread_scoped_lock lock(rpc_lock);
-    RPCSend snd(socket, &error_func, "task_cancel");
-    snd.write();
-  }
 
-  int get_split_task_count(DeviceTask &)
-  {
-    return 1;
+    /* Throughput of the node, to see how evenly the work was spread. */
+    const double time = time_dt() - task_start_time;
+    node_stats.num_tiles += num_tiles;
+    node_stats.num_pixel_samples += num_pixel_samples;
+    node_stats.render_time += time;
+
+    if (num_tiles) {
+      VLOG(1) << "Network node " << address << ": " << num_tiles << " tiles in " << time
+              << " seconds, "
+              << string_human_readable_number((size_t)(num_pixel_samples / max(time, 1e-6)))
+              << " samples/s.";
+    }
   }
 
  private:
@@ -302,20 +449,40 @@ Device *device_network_create(DeviceInfo &info,
 
 void device_network_info(vector<DeviceInfo> &devices)
 {
-  DeviceInfo info;
+  /* Servers are listed as "host[:port]" separated by commas, to run several on one machine or
+   * reach them outside the local network. Otherwise look for servers on the local network. */
+  vector<string> servers;
+  const char *servers_env = getenv("CYCLES_NETWORK_SERVERS");
+  if (servers_env) {
+    string_split(servers, servers_env, ",");
+  }
+  else {
+    ServerDiscovery discovery(true);
+    time_sleep(1.0);
+    servers = discovery.get_server_list();
+  }
 
-  info.type = DEVICE_NETWORK;
-  info.description = "Network Device";
-  info.id = "NETWORK";
-  info.num = 0;
+  if (servers.empty()) {
+    servers.push_back("127.0.0.1");
+  }
 
-  /* todo: get this info from device */
-  info.has_volume_decoupled = false;
-  info.has_adaptive_stop_per_sample = false;
-  info.has_osl = false;
-  info.denoisers = DENOISER_NONE;
+  for (size_t num = 0; num < servers.size(); num++) {
+    DeviceInfo info;
 
-  devices.push_back(info);
+    info.type = DEVICE_NETWORK;
+    info.description = "Network Device " + servers[num];
+    /* The address is needed to create the device, see Device::create(). */
+    info.id = "NETWORK_" + servers[num];
+    info.num = num;
+
+    /* todo: get this info from device */
+    info.has_volume_decoupled = false;
+    info.has_adaptive_stop_per_sample = false;
+    info.has_osl = false;
+    info.denoisers = DENOISER_NONE;
+
+    devices.push_back(info);
+  }
 }
 
 class DeviceServer {
@@ -344,7 +511,7 @@ class DeviceServer {
     for (;;) {
       listen_step();
 
-      if (stop)
+      if (stop || have_error())
         break;
     }
   }
@@ -401,6 +568,11 @@ class DeviceServer {
     assert(mapins.second);
   }
 
+  bool client_pointer_mapped(device_ptr client_pointer)
+  {
+    return ptr_map.find(client_pointer) != ptr_map.end();
+  }
+
   device_ptr device_ptr_from_client_pointer(device_ptr client_pointer)
   {
     PtrMap::iterator i = ptr_map.find(client_pointer);
@@ -465,8 +637,9 @@ class DeviceServer {
 
       size_t data_size = mem.memory_size();
       device_ptr client_pointer = mem.device_pointer;
+      const bool mapped = client_pointer_mapped(client_pointer);
 
-      if (client_pointer) {
+      if (mapped) {
         /* Lookup existing host side data buffer. */
         DataVector &data_v = data_vector_find(client_pointer);
         mem.host_pointer = (void *)&data_v[0];
@@ -475,9 +648,10 @@ class DeviceServer {
         mem.device_pointer = device_ptr_from_client_pointer(client_pointer);
       }
       else {
-        /* Allocate host side data buffer. */
+        /* Allocate host side data buffer, textures are allocated by the copy. */
         DataVector &data_v = data_vector_insert(client_pointer, data_size);
         mem.host_pointer = (data_size) ? (void *)&(data_v[0]) : 0;
+        mem.device_pointer = 0;
       }
 
       /* Copy data from network into memory buffer. */
@@ -486,7 +660,7 @@ class DeviceServer {
       /* Copy the data from the memory buffer to the device buffer. */
       device->mem_copy_to(mem);
 
-      if (!client_pointer) {
+      if (!mapped) {
         /* Store a mapping to/from client_pointer and real device pointer. */
         pointer_mapping_insert(client_pointer, mem.device_pointer);
       }
@@ -507,7 +681,7 @@ class DeviceServer {
 
       DataVector &data_v = data_vector_find(client_pointer);
 
-      mem.host_pointer = (device_ptr) & (data_v[0]);
+      mem.host_pointer = (void *)&(data_v[0]);
 
       device->mem_copy_from(mem, y, w, h, elem);
 
@@ -526,8 +700,9 @@ class DeviceServer {
 
       size_t data_size = mem.memory_size();
       device_ptr client_pointer = mem.device_pointer;
+      const bool mapped = client_pointer_mapped(client_pointer);
 
-      if (client_pointer) {
+      if (mapped) {
         /* Lookup existing host side data buffer. */
         DataVector &data_v = data_vector_find(client_pointer);
         mem.host_pointer = (void *)&data_v[0];
@@ -538,13 +713,14 @@ class DeviceServer {
       else {
         /* Allocate host side data buffer. */
         DataVector &data_v = data_vector_insert(client_pointer, data_size);
-        mem.host_pointer = (void *) ? (device_ptr) & (data_v[0]) : 0;
+        mem.host_pointer = (data_size) ? (void *)&(data_v[0]) : 0;
+        mem.device_pointer = 0;
       }
 
       /* Zero memory. */
       device->mem_zero(mem);
 
-      if (!client_pointer) {
+      if (!mapped) {
         /* Store a mapping to/from client_pointer and real device pointer. */
         pointer_mapping_insert(client_pointer, mem.device_pointer);
       }
@@ -578,7 +754,6 @@ class DeviceServer {
     else if (rcv.name == "load_kernels") {
       DeviceRequestedFeatures requested_features;
       rcv.read(requested_features.experimental);
-      rcv.read(requested_features.max_closure);
       rcv.read(requested_features.max_nodes_group);
       rcv.read(requested_features.nodes_features);
 
@@ -610,7 +785,8 @@ class DeviceServer {
       if (task.shader_output)
         task.shader_output = device_ptr_from_client_pointer(task.shader_output);
 
-      task.acquire_tile = function_bind(&DeviceServer::task_acquire_tile, this, _1, _2);
+      task.acquire_tile = function_bind(
+          &DeviceServer::task_acquire_tile, this, _1, _2, _3);
       task.release_tile = function_bind(&DeviceServer::task_release_tile, this, _1);
       task.update_progress_sample = function_bind(&DeviceServer::task_update_progress_sample,
                                                   this);
@@ -660,13 +836,14 @@ class DeviceServer {
     }
   }
 
-  bool task_acquire_tile(Device *, RenderTile &tile)
+  bool task_acquire_tile(Device *, RenderTile &tile, uint tile_types)
   {
     thread_scoped_lock acquire_lock(acquire_mutex);
 
     bool result = false;
 
     RPCSend snd(socket, &error_func, "acquire_tile");
+    snd.add(tile_types);
     snd.write();
 
     do {
@@ -779,7 +956,13 @@ class DeviceServer {
   /* todo: free memory and device (osl) on network error */
 };
 
-void Device::server_run()
+void device_network_serve(Device *device, tcp::socket &socket)
+{
+  DeviceServer server(device, socket);
+  server.listen();
+}
+
+void Device::server_run(int port)
 {
   try {
     /* starts thread that responds to discovery requests */
@@ -788,7 +971,7 @@ void Device::server_run()
     for (;;) {
       /* accept connection */
       boost::asio::io_service io_service;
-      tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), SERVER_PORT));
+      tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), port));
 
       tcp::socket socket(io_service);
       acceptor.accept(socket);
@@ -796,8 +979,7 @@ void Device::server_run()
       string remote_address = socket.remote_endpoint().address().to_string();
       printf("Connected to remote client at: %s\n", remote_address.c_str());
 
-      DeviceServer server(this, socket);
-      server.listen();
+      device_network_serve(this, socket);
 
       printf("Disconnected.\n");
     }
@@ -26,6 +26,7 @@
 #  include <boost/array.hpp>
 #  include <boost/asio.hpp>
 #  include <boost/bind.hpp>
+#  include <boost/serialization/binary_object.hpp>
 #  include <boost/serialization/vector.hpp>
 #  include <boost/thread.hpp>
 
@@ -33,6 +34,8 @@
 #  include <iostream>
 #  include <sstream>
 
+#  include "device/device.h"
+
 #  include "render/buffers.h"
 
 #  include "util/util_foreach.h"
@@ -64,17 +67,22 @@ typedef boost::archive::binary_oarchive o_archive;
 typedef boost::archive::binary_iarchive i_archive;
 #  endif
 
-/* Serialization of device memory */
+/* Serialization of device memory. A texture, so image textures can be allocated on the server
+ * device as well, other memory types don't use the texture members. */
 
-class network_device_memory : public device_memory {
+class network_device_memory : public device_texture {
  public:
-  network_device_memory(Device *device) : device_memory(device, "", MEM_READ_ONLY)
+  network_device_memory(Device *device)
+      : device_texture(device, "", 0, IMAGE_DATA_TYPE_FLOAT, INTERPOLATION_NONE, EXTENSION_REPEAT)
   {
+    type = MEM_READ_ONLY;
   }
 
   ~network_device_memory()
   {
+    /* Memory is owned by the server. */
     device_pointer = 0;
+    host_pointer = 0;
   };
 
   vector<char> local_data;
@@ -130,8 +138,13 @@ class RPCSend {
     archive &mem.data_type &mem.data_elements &mem.data_size;
     archive &mem.data_width &mem.data_height &mem.data_depth &mem.device_pointer;
     archive &mem.type &string(mem.name);
-    archive &mem.interpolation &mem.extension;
     archive &mem.device_pointer;
+
+    if (mem.type == MEM_TEXTURE) {
+      const device_texture &tex = (const device_texture &)mem;
+      archive &tex.slot;
+      archive &boost::serialization::make_binary_object((void *)&tex.info, sizeof(TextureInfo));
+    }
   }
 
   template<typename T> void add(const T &data)
@@ -147,12 +160,13 @@ class RPCSend {
     archive &task.offset &task.stride;
     archive &task.shader_input &task.shader_output &task.shader_eval_type;
     archive &task.shader_x &task.shader_w;
-    archive &task.need_finish_queue;
+    archive &task.need_finish_queue &task.tile_types;
   }
 
   void add(const RenderTile &tile)
   {
-    archive &tile.x &tile.y &tile.w &tile.h;
+    int task = (int)tile.task;
+    archive &task &tile.x &tile.y &tile.w &tile.h;
     archive &tile.start_sample &tile.num_samples &tile.sample;
     archive &tile.resolution &tile.offset &tile.stride;
     archive &tile.buffer;
@@ -272,9 +286,13 @@ class RPCReceive {
     *archive &mem.data_type &mem.data_elements &mem.data_size;
     *archive &mem.data_width &mem.data_height &mem.data_depth &mem.device_pointer;
     *archive &mem.type &name;
-    *archive &mem.interpolation &mem.extension;
     *archive &mem.device_pointer;
 
+    if (mem.type == MEM_TEXTURE) {
+      boost::serialization::binary_object info_object(&mem.info, sizeof(TextureInfo));
+      *archive &mem.slot &info_object;
+    }
+
     mem.name = name.c_str();
     mem.host_pointer = 0;
 
@@ -311,18 +329,20 @@ class RPCReceive {
     *archive &task.offset &task.stride;
     *archive &task.shader_input &task.shader_output &task.shader_eval_type;
     *archive &task.shader_x &task.shader_w;
-    *archive &task.need_finish_queue;
+    *archive &task.need_finish_queue &task.tile_types;
 
     task.type = (DeviceTask::Type)type;
   }
 
   void read(RenderTile &tile)
   {
-    *archive &tile.x &tile.y &tile.w &tile.h;
+    int task;
+    *archive &task &tile.x &tile.y &tile.w &tile.h;
     *archive &tile.start_sample &tile.num_samples &tile.sample;
     *archive &tile.resolution &tile.offset &tile.stride;
     *archive &tile.buffer;
 
+    tile.task = (RenderTile::Task)task;
     tile.buffers = NULL;
   }
 
@@ -483,6 +503,10 @@ class ServerDiscovery {
   vector<string> servers;
 };
 
+/* Serve the remote calls of the client connected to the socket with the device, until the client
+ * stops or the connection fails. */
+void device_network_serve(Device *device, tcp::socket &socket);
+
 CCL_NAMESPACE_END
 
 #endif
@@ -1200,9 +1200,13 @@ class OptiXDevice : public CUDADevice {
     OptixAccelBufferSizes sizes = {};
     OptixAccelBuildOptions options = {};
     options.operation = operation;
+    // Compacted acceleration structures can not be updated in place
+    const bool use_compaction = background && !bvh->params.use_refit;
     if (background) {
       // Prefer best performance and lowest memory consumption in background
-      options.buildFlags = OPTIX_BUILD_FLAG_PREFER_FAST_TRACE | OPTIX_BUILD_FLAG_ALLOW_COMPACTION;
+      options.buildFlags = OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+      options.buildFlags |= use_compaction ? OPTIX_BUILD_FLAG_ALLOW_COMPACTION :
+                                             OPTIX_BUILD_FLAG_ALLOW_UPDATE;
     }
     else {
       // Prefer fast updates in viewport
@@ -1253,15 +1257,15 @@ class OptiXDevice : public CUDADevice {
                                            out_data.device_pointer,
                                            sizes.outputSizeInBytes,
                                            &out_handle,
-                                           background ? &compacted_size_prop : NULL,
-                                           background ? 1 : 0));
+                                           use_compaction ? &compacted_size_prop : NULL,
+                                           use_compaction ? 1 : 0));
     bvh->traversable_handle = static_cast<uint64_t>(out_handle);
 
     // Wait for all operations to finish
     check_result_cuda_ret(cuStreamSynchronize(NULL));
 
     // Compact acceleration structure to save memory (do not do this in viewport for faster builds)
-    if (background) {
+    if (use_compaction) {
       uint64_t compacted_size = sizes.outputSizeInBytes;
       check_result_cuda_ret(
           cuMemcpyDtoH(&compacted_size, compacted_size_prop.result, sizeof(compacted_size)));
@@ -1315,10 +1319,10 @@ class OptiXDevice : public CUDADevice {
     if (!bvh->params.top_level) {
       assert(bvh->objects.size() == 1 && bvh->geometry.size() == 1);
 
-      // Refit is only possible in viewport for now (because AS is built with
-      // OPTIX_BUILD_FLAG_ALLOW_UPDATE only there, see above)
+      // Refit is only possible in viewport, or when refitting was requested for final renders
+      // (because AS is built with OPTIX_BUILD_FLAG_ALLOW_UPDATE only then, see above)
       OptixBuildOperation operation = OPTIX_BUILD_OPERATION_BUILD;
-      if (refit && !background) {
+      if (refit && (!background || bvh->params.use_refit)) {
         assert(bvh_optix->traversable_handle != 0);
         operation = OPTIX_BUILD_OPERATION_UPDATE;
       }
@@ -1618,7 +1622,7 @@ class OptiXDevice : public CUDADevice {
         if (!ob->is_traceable())
           continue;
 
-        BVHOptiX *const blas = static_cast<BVHOptiX *>(ob->get_geometry()->bvh);
+        BVHOptiX *const blas = static_cast<BVHOptiX *>(ob->get_render_geometry()->bvh);
         OptixTraversableHandle handle = blas->traversable_handle;
 
 #  if OPTIX_ABI_VERSION < 41
@@ -1645,19 +1649,19 @@ class OptiXDevice : public CUDADevice {
         // Have to have at least one bit in the mask, or else instance would always be culled
         instance.visibilityMask = 1;
 
-        if (ob->get_geometry()->has_volume) {
+        if (ob->get_render_geometry()->has_volume) {
           // Volumes have a special bit set in the visibility mask so a trace can mask only volumes
           instance.visibilityMask |= 2;
         }
 
-        if (ob->get_geometry()->geometry_type == Geometry::HAIR) {
+        if (ob->get_render_geometry()->geometry_type == Geometry::HAIR) {
           // Same applies to curves (so they can be skipped in local trace calls)
           instance.visibilityMask |= 4;
 
 #  if OPTIX_ABI_VERSION >= 36
-          if (motion_blur && ob->get_geometry()->has_motion_blur() &&
+          if (motion_blur && ob->get_render_geometry()->has_motion_blur() &&
               DebugFlags().optix.curves_api &&
-              static_cast<const Hair *>(ob->get_geometry())->curve_shape == CURVE_THICK) {
+              static_cast<const Hair *>(ob->get_render_geometry())->curve_shape == CURVE_THICK) {
             // Select between motion blur and non-motion blur built-in intersection module
             instance.sbtOffset = PG_HITD_MOTION - PG_HITD;
           }
@@ -1739,7 +1743,7 @@ class OptiXDevice : public CUDADevice {
         else {
           instance.traversableHandle = handle;
 
-          if (ob->get_geometry()->is_instanced()) {
+          if (ob->get_render_geometry()->is_instanced()) {
             // Set transform matrix
             memcpy(instance.transform, &ob->get_tfm(), sizeof(instance.transform));
           }
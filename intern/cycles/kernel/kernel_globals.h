@@ -86,6 +86,9 @@ typedef struct KernelGlobals {
   int2 global_id;
 
   ProfilingState profiler;
+
+  /* Shader evaluations counted for the shader evaluations pass. */
+  uint num_shader_evaluations;
 } KernelGlobals;
 
 #endif /* __KERNEL_CPU__ */
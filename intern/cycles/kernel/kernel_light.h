@@ -15,6 +15,7 @@
  */
 
 #include "kernel_light_background.h"
+#include "kernel_light_tree.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -171,11 +172,26 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
-
   return (ls->pdf > 0.0f);
 }
 
+/* Probability of picking the lamp as light for a shading point at P. */
+ccl_device_inline float lamp_light_select_pdf(KernelGlobals *kg,
+                                              int lamp,
+                                              LightType type,
+                                              float3 P)
+{
+  if (kernel_data.integrator.use_light_tree && type != LIGHT_DISTANT &&
+      type != LIGHT_BACKGROUND) {
+    /* Lamps come after the triangles in the light distribution. */
+    const int index = kernel_data.integrator.num_distribution -
+                      kernel_data.integrator.num_all_lights + lamp;
+    return light_tree_emitter_pdf(kg, index, P);
+  }
+
+  return kernel_data.integrator.pdf_lights;
+}
+
 ccl_device bool lamp_light_eval(
     KernelGlobals *kg, int lamp, float3 P, float3 D, float t, LightSample *ls)
 {
@@ -328,7 +344,7 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= lamp_light_select_pdf(kg, lamp, type, P);
 
   return true;
 }
@@ -365,12 +381,12 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
+ccl_device_inline float triangle_light_pdf_area(const float pdf_triangles,
                                                 const float3 Ng,
                                                 const float3 I,
                                                 float t)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
+  float pdf = pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
@@ -385,6 +401,17 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
    * and simple area sampling, comparing the distance to the triangle plane
    * to the length of the edges of the triangle. */
 
+  /* Probability density over the triangle area of picking it as light. */
+  float pdf_triangles = kernel_data.integrator.pdf_triangles;
+  if (kernel_data.integrator.use_light_tree) {
+    const int index = light_tree_triangle_index(kg, sd->object, sd->prim);
+    if (index == -1) {
+      return 0.0f;
+    }
+    const float3 Px = sd->P + sd->I * t;
+    pdf_triangles = light_tree_pdf_triangles(kg, index, light_tree_emitter_pdf(kg, index, Px));
+  }
+
   float3 V[3];
   bool has_motion = triangle_world_space_vertices(kg, sd->object, sd->prim, sd->time, V);
 
@@ -426,12 +453,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
       else {
         area = 0.5f * len(N);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_triangles;
       return pdf / solid_angle;
     }
   }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+    float pdf = triangle_light_pdf_area(pdf_triangles, sd->Ng, sd->I, t);
     if (has_motion) {
       const float area = 0.5f * len(N);
       if (UNLIKELY(area == 0.0f)) {
@@ -454,6 +481,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
                                                   float randu,
                                                   float randv,
                                                   float time,
+                                                  const float pdf_triangles,
                                                   LightSample *ls,
                                                   const float3 P)
 {
@@ -579,7 +607,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
         triangle_world_space_vertices(kg, object, prim, -1.0f, V);
         area = triangle_area(V[0], V[1], V[2]);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_triangles;
       ls->pdf = pdf / solid_angle;
     }
   }
@@ -601,7 +629,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
+    ls->pdf = triangle_light_pdf_area(pdf_triangles, ls->Ng, -ls->D, ls->t);
     if (has_motion && area != 0.0f) {
       /* scale the PDF.
        * area = the area the sample was taken from
@@ -653,6 +681,29 @@ ccl_device int light_distribution_sample(KernelGlobals *kg, float *randu)
   return index;
 }
 
+/* Picks an emitter from the light distribution, either from the light tree or one of the distant
+ * and background lights. Returns the index and the probability of picking it. */
+ccl_device int light_tree_distribution_sample(KernelGlobals *kg,
+                                              float3 P,
+                                              float *randu,
+                                              float *pdf)
+{
+  const float tree_pdf = kernel_data.integrator.light_tree_pdf;
+  float r = *randu;
+
+  if (r < tree_pdf) {
+    *randu = r / tree_pdf;
+    const int index = light_tree_sample(kg, P, randu, pdf);
+    *pdf *= tree_pdf;
+    return index;
+  }
+
+  /* Only distant and background lights cover the CDF of the light distribution. */
+  *randu = min((r - tree_pdf) / (1.0f - tree_pdf), 1.0f - FLT_EPSILON);
+  *pdf = kernel_data.integrator.pdf_lights;
+  return light_distribution_sample(kg, randu);
+}
+
 /* Generic Light */
 
 ccl_device_inline bool light_select_reached_max_bounces(KernelGlobals *kg, int index, int bounce)
@@ -669,9 +720,21 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       int bounce,
                                       LightSample *ls)
 {
+  /* Probability of picking the light, for triangles it follows from pdf_triangles. */
+  float pdf_select = kernel_data.integrator.pdf_lights;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+    if (kernel_data.integrator.use_light_tree) {
+      index = light_tree_distribution_sample(kg, P, &randu, &pdf_select);
+      if (index == -1) {
+        return false;
+      }
+    }
+    else {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -682,7 +745,11 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
       int object = kdistribution->mesh_light.object_id;
       int shader_flag = kdistribution->mesh_light.shader_flag;
 
-      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+      const float pdf_triangles = (kernel_data.integrator.use_light_tree) ?
+                                      light_tree_pdf_triangles(kg, index, pdf_select) :
+                                      kernel_data.integrator.pdf_triangles;
+
+      triangle_light_sample(kg, prim, object, randu, randv, time, pdf_triangles, ls, P);
       ls->shader |= shader_flag;
       return (ls->pdf > 0.0f);
     }
@@ -694,7 +761,12 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  if (!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+    return false;
+  }
+
+  ls->pdf *= pdf_select;
+  return (ls->pdf > 0.0f);
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Hierarchy over the emissive triangles, point, spot and area lights of the light distribution.
+ * Walking down from the root, a child is picked proportional to an estimate of how much light it
+ * contributes to the shading point, based on the bounds, orientation and power of its emitters.
+ * Distant and background lights are not part of the tree, they are picked uniformly.
+ *
+ * See "Importance Sampling of Many Lights with Adaptive Tree Splitting",
+ * Alejandro Conty Estevez and Christopher Kulla, 2018. */
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, int node_index, float3 P)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes,
+                                                                  node_index);
+  if (knode->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius = 0.5f * len(bbox_max - bbox_min);
+
+  const float3 centroid_to_P = P - centroid;
+  const float distance_squared = len_squared(centroid_to_P);
+
+  /* Inside the bounding sphere nothing is known about the direction of the emitters. Clamp the
+   * distance so nodes close to the shading point don't get all the importance. */
+  if (distance_squared <= radius * radius) {
+    return knode->energy / max(radius * radius, 1e-8f);
+  }
+
+  /* Smallest angle between the emission cone and the direction to the shading point, taking the
+   * extent of the node into account. */
+  const float distance = sqrtf(distance_squared);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+  const float theta = fast_acosf(clamp(dot(axis, centroid_to_P) / distance, -1.0f, 1.0f));
+  const float theta_u = fast_asinf(min(radius / distance, 1.0f));
+  const float theta_prime = max(theta - knode->theta_o - theta_u, 0.0f);
+
+  if (theta_prime > knode->theta_e) {
+    return 0.0f;
+  }
+
+  return knode->energy * fast_cosf(theta_prime) / distance_squared;
+}
+
+/* Picks a leaf of the light tree for the shading point. Returns the index in the light
+ * distribution and the probability of picking it, randu is rescaled so it can be reused. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float3 P, float *randu, float *pdf)
+{
+  int node_index = 0;
+  float node_pdf = 1.0f;
+  float r = *randu;
+
+  while (kernel_tex_fetch(__light_tree_nodes, node_index).child_index != -1) {
+    const int left = node_index + 1;
+    const int right = kernel_tex_fetch(__light_tree_nodes, node_index).child_index;
+    const float left_importance = light_tree_node_importance(kg, left, P);
+    const float right_importance = light_tree_node_importance(kg, right, P);
+    const float total_importance = left_importance + right_importance;
+
+    if (total_importance == 0.0f) {
+      *pdf = 0.0f;
+      return -1;
+    }
+
+    const float left_pdf = left_importance / total_importance;
+    if (r < left_pdf) {
+      node_index = left;
+      node_pdf *= left_pdf;
+      r = r / left_pdf;
+    }
+    else {
+      node_index = right;
+      node_pdf *= 1.0f - left_pdf;
+      r = (r - left_pdf) / (1.0f - left_pdf);
+    }
+    r = min(r, 1.0f - FLT_EPSILON);
+  }
+
+  *randu = r;
+  *pdf = node_pdf;
+  return kernel_tex_fetch(__light_tree_nodes, node_index).emitter;
+}
+
+/* Probability of picking the leaf of an emitter for the shading point, the inverse of
+ * light_tree_sample(). */
+ccl_device float light_tree_pdf(KernelGlobals *kg, int index, float3 P)
+{
+  int node_index = kernel_tex_fetch(__light_tree_leaves, index);
+  float pdf = 1.0f;
+
+  while (node_index != 0) {
+    const int parent = kernel_tex_fetch(__light_tree_nodes, node_index).parent;
+    const int sibling = (node_index == parent + 1) ?
+                            kernel_tex_fetch(__light_tree_nodes, parent).child_index :
+                            parent + 1;
+
+    const float importance = light_tree_node_importance(kg, node_index, P);
+    if (importance == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= importance / (importance + light_tree_node_importance(kg, sibling, P));
+    node_index = parent;
+  }
+
+  return pdf;
+}
+
+/* Probability of picking an emitter of the light tree, including the choice for the tree. */
+ccl_device_inline float light_tree_emitter_pdf(KernelGlobals *kg, int index, float3 P)
+{
+  return kernel_data.integrator.light_tree_pdf * light_tree_pdf(kg, index, P);
+}
+
+/* Selection probability of a triangle converted to a density over its area, like
+ * pdf_triangles is for the light distribution. */
+ccl_device_inline float light_tree_pdf_triangles(KernelGlobals *kg, int index, float pdf)
+{
+  const int node_index = kernel_tex_fetch(__light_tree_leaves, index);
+  const float area = kernel_tex_fetch(__light_tree_nodes, node_index).area;
+  return (area > 0.0f) ? pdf / area : 0.0f;
+}
+
+/* Index of an emissive triangle in the light distribution, -1 if it is not part of it. */
+ccl_device int light_tree_triangle_index(KernelGlobals *kg, int object, int prim)
+{
+  /* Triangles come first in the light distribution, ordered by object and primitive. */
+  int first = 0;
+  int len = kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights;
+
+  while (len > 0) {
+    const int half_len = len >> 1;
+    const int middle = first + half_len;
+    const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, middle);
+    const int middle_object = kdistribution->mesh_light.object_id;
+
+    if (middle_object < object || (middle_object == object && kdistribution->prim < prim)) {
+      first = middle + 1;
+      len = len - half_len - 1;
+    }
+    else {
+      len = half_len;
+    }
+  }
+
+  if (first < kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights) {
+    const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, first);
+    if (kdistribution->mesh_light.object_id == object && kdistribution->prim == prim) {
+      return first;
+    }
+  }
+
+  return -1;
+}
+
+CCL_NAMESPACE_END
@@ -34,11 +34,14 @@ CCL_NAMESPACE_BEGIN
     if ((object) != PRIM_NONE) { \
       profiling_helper.set_object(object); \
     }
+/* Shader evaluations of the current pixel, for the shader evaluations pass. */
+#  define PROFILING_COUNT_SHADER_EVAL(kg) (kg)->num_shader_evaluations++
 #else
 #  define PROFILING_INIT(kg, event)
 #  define PROFILING_EVENT(event)
 #  define PROFILING_SHADER(shader)
 #  define PROFILING_OBJECT(object)
+#  define PROFILING_COUNT_SHADER_EVAL(kg)
 #endif /* __KERNEL_CPU__ */
 
 CCL_NAMESPACE_END
@@ -1060,6 +1060,7 @@ ccl_device void shader_eval_surface(KernelGlobals *kg,
                                     int path_flag)
 {
   PROFILING_INIT(kg, PROFILING_SHADER_EVAL);
+  PROFILING_COUNT_SHADER_EVAL(kg);
 
   /* If path is being terminated, we are tracing a shadow ray or evaluating
    * emission, then we don't need to store closures. The emission and shadow
@@ -1291,6 +1292,7 @@ ccl_device_inline void shader_eval_volume(KernelGlobals *kg,
     }
 
     /* evaluate shader */
+    PROFILING_COUNT_SHADER_EVAL(kg);
 #  ifdef __SVM__
 #    ifdef __OSL__
     if (kg->osl) {
@@ -368,6 +368,8 @@ typedef enum PassType {
   PASS_AOV_VALUE,
   PASS_ADAPTIVE_AUX_BUFFER,
   PASS_SAMPLE_COUNT,
+  PASS_SAMPLE_TIME,
+  PASS_SHADER_EVALUATIONS,
   PASS_CATEGORY_MAIN_END = 31,
 
   PASS_MIST = 32,
@@ -1250,7 +1252,11 @@ typedef struct KernelFilm {
   int pass_aov_value;
   int pass_aov_color_num;
   int pass_aov_value_num;
-  int pad1, pad2, pad3;
+
+  /* Per-pixel cost, only written by the CPU device. */
+  int pass_sample_time;
+  int pass_shader_evaluations;
+  int pad1;
 
   /* XYZ to rendering color space transform. float4 instead of float3 to
    * ensure consistent padding/alignment across devices. */
@@ -1385,7 +1391,11 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1, pad2;
+  /* light tree */
+  int use_light_tree;
+  float light_tree_pdf;
+
+  int pad1, pad2, pad3, pad4;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1411,6 +1421,9 @@ typedef struct KernelBVH {
   int bvh_layout;
   int use_bvh_steps;
   int curve_subdivisions;
+  /* Vertex normals are octahedral encoded in __tri_vnormal_oct. */
+  int use_compressed_normals;
+  int pad3, pad4, pad5;
 
   /* Custom BVH */
 #ifdef __KERNEL_OPTIX__
@@ -1546,6 +1559,25 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+typedef struct KernelLightTreeNode {
+  /* Bounds and estimated power of all emitters in the node. */
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  /* Emission is within theta_o of the axis, and spreads out from there by at most theta_e. */
+  float theta_o;
+  float axis[3];
+  float theta_e;
+  /* Second child of inner nodes, the first one directly follows the node. -1 for leaves. */
+  int child_index;
+  /* Index in the light distribution for leaves. */
+  int emitter;
+  int parent;
+  /* Area of triangle emitters, which the light distribution of triangles is based on. */
+  float area;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -16,33 +16,24 @@
 
 CCL_NAMESPACE_BEGIN
 
-/* This kernel takes care of scene_intersect function.
- *
- * This kernel changes the ray_state of RAY_REGENERATED rays to RAY_ACTIVE.
- * This kernel processes rays of ray state RAY_ACTIVE
- * This kernel determines the rays that have hit the background and changes
- * their ray state to RAY_HIT_BACKGROUND.
- */
-ccl_device void kernel_scene_intersect(KernelGlobals *kg)
+ccl_device_inline int kernel_scene_intersect_ray_index(KernelGlobals *kg,
+                                                       int thread_index,
+                                                       char use_queues_flag)
 {
-  /* Fetch use_queues_flag */
-  char local_use_queues_flag = *kernel_split_params.use_queues_flag;
-  ccl_barrier(CCL_LOCAL_MEM_FENCE);
-
-  int ray_index = ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0);
-  if (local_use_queues_flag) {
-    ray_index = get_ray_index(kg,
-                              ray_index,
-                              QUEUE_ACTIVE_AND_REGENERATED_RAYS,
-                              kernel_split_state.queue_data,
-                              kernel_split_params.queue_size,
-                              0);
-
-    if (ray_index == QUEUE_EMPTY_SLOT) {
-      return;
-    }
+  if (use_queues_flag) {
+    return get_ray_index(kg,
+                         thread_index,
+                         QUEUE_ACTIVE_AND_REGENERATED_RAYS,
+                         kernel_split_state.queue_data,
+                         kernel_split_params.queue_size,
+                         0);
   }
+  return thread_index;
+}
 
+/* Returns whether the ray is active and needs to be intersected. */
+ccl_device_inline bool kernel_scene_intersect_ray_activate(KernelGlobals *kg, int ray_index)
+{
   /* All regenerated rays become active here */
   if (IS_STATE(kernel_split_state.ray_state, ray_index, RAY_REGENERATED)) {
 #ifdef __BRANCHED_PATH__
@@ -56,17 +47,15 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
     }
   }
 
-  if (!IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE)) {
-    return;
-  }
-
-  ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
-  Ray ray = kernel_split_state.ray[ray_index];
-  PathRadiance *L = &kernel_split_state.path_radiance[ray_index];
+  return IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE);
+}
 
-  Intersection isect;
-  bool hit = kernel_path_scene_intersect(kg, state, &ray, &isect, L);
-  kernel_split_state.isect[ray_index] = isect;
+ccl_device_inline void kernel_scene_intersect_ray_result(KernelGlobals *kg,
+                                                         int ray_index,
+                                                         const Intersection *isect,
+                                                         bool hit)
+{
+  kernel_split_state.isect[ray_index] = *isect;
 
   if (!hit) {
     /* Change the state of rays that hit the background;
@@ -77,4 +66,107 @@ ccl_device void kernel_scene_intersect(KernelGlobals *kg)
   }
 }
 
+#if defined(__KERNEL_CPU__) && defined(__EMBREE__) && !defined(__KERNEL_DEBUG__)
+#  define __SPLIT_KERNEL_RAY_STREAM__
+
+/* Intersect all active rays of the work as one stream, Embree then traces coherent rays
+ * together in packets instead of one ray at a time. */
+ccl_device void kernel_scene_intersect_stream(KernelGlobals *kg, char use_queues_flag)
+{
+  PROFILING_INIT(kg, PROFILING_SCENE_INTERSECT);
+
+  const int global_size = ccl_global_size(0) * ccl_global_size(1);
+  RTCRayHit *stream = kernel_split_state.rtc_rayhit;
+  uint stream_size = 0;
+
+  for (int thread_index = 0; thread_index < global_size; thread_index++) {
+    const int ray_index = kernel_scene_intersect_ray_index(kg, thread_index, use_queues_flag);
+    if (ray_index == QUEUE_EMPTY_SLOT || !kernel_scene_intersect_ray_activate(kg, ray_index)) {
+      continue;
+    }
+
+    ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
+    Ray ray = kernel_split_state.ray[ray_index];
+
+    const uint visibility = path_state_ray_visibility(kg, state);
+    if (path_state_ao_bounce(kg, state)) {
+      ray.t = kernel_data.background.ao_distance;
+    }
+
+    if (!scene_intersect_valid(&ray)) {
+      Intersection isect;
+      isect.t = ray.t;
+      kernel_scene_intersect_ray_result(kg, ray_index, &isect, false);
+      continue;
+    }
+
+    RTCRayHit *ray_hit = &stream[stream_size++];
+    kernel_embree_setup_rayhit(ray, *ray_hit, visibility);
+    ray_hit->ray.id = ray_index;
+  }
+
+  if (stream_size == 0) {
+    return;
+  }
+
+  CCLIntersectContext ctx(kg, CCLIntersectContext::RAY_REGULAR);
+  IntersectContext rtc_ctx(&ctx);
+  rtcIntersect1M(
+      kernel_data.bvh.scene, &rtc_ctx.context, stream, stream_size, sizeof(RTCRayHit));
+
+  for (uint i = 0; i < stream_size; i++) {
+    const RTCRayHit *ray_hit = &stream[i];
+    const bool hit = ray_hit->hit.geomID != RTC_INVALID_GEOMETRY_ID &&
+                     ray_hit->hit.primID != RTC_INVALID_GEOMETRY_ID;
+
+    Intersection isect;
+    isect.t = ray_hit->ray.tfar;
+    if (hit) {
+      kernel_embree_convert_hit(kg, &ray_hit->ray, &ray_hit->hit, &isect);
+    }
+
+    kernel_scene_intersect_ray_result(kg, ray_hit->ray.id, &isect, hit);
+  }
+}
+#endif
+
+/* This kernel takes care of scene_intersect function.
+ *
+ * This kernel changes the ray_state of RAY_REGENERATED rays to RAY_ACTIVE.
+ * This kernel processes rays of ray state RAY_ACTIVE
+ * This kernel determines the rays that have hit the background and changes
+ * their ray state to RAY_HIT_BACKGROUND.
+ */
+ccl_device void kernel_scene_intersect(KernelGlobals *kg)
+{
+  /* Fetch use_queues_flag */
+  char local_use_queues_flag = *kernel_split_params.use_queues_flag;
+  ccl_barrier(CCL_LOCAL_MEM_FENCE);
+
+#ifdef __SPLIT_KERNEL_RAY_STREAM__
+  /* On the CPU work items are executed one after the other, so the first one handles all rays
+   * and the others have nothing left to do. */
+  if (kernel_data.bvh.scene) {
+    if (ccl_global_id(0) == 0 && ccl_global_id(1) == 0) {
+      kernel_scene_intersect_stream(kg, local_use_queues_flag);
+    }
+    return;
+  }
+#endif
+
+  const int ray_index = kernel_scene_intersect_ray_index(
+      kg, ccl_global_id(1) * ccl_global_size(0) + ccl_global_id(0), local_use_queues_flag);
+  if (ray_index == QUEUE_EMPTY_SLOT || !kernel_scene_intersect_ray_activate(kg, ray_index)) {
+    return;
+  }
+
+  ccl_global PathState *state = &kernel_split_state.path_state[ray_index];
+  Ray ray = kernel_split_state.ray[ray_index];
+  PathRadiance *L = &kernel_split_state.path_radiance[ray_index];
+
+  Intersection isect;
+  bool hit = kernel_path_scene_intersect(kg, state, &ray, &isect, L);
+  kernel_scene_intersect_ray_result(kg, ray_index, &isect, hit);
+}
+
 CCL_NAMESPACE_END
@@ -16,6 +16,38 @@
 
 CCL_NAMESPACE_BEGIN
 
+#ifdef __KERNEL_CPU__
+/* Order by shader, invalid entries have the largest key and end up last. Ties are broken by the
+ * original position so the result does not depend on the sort. */
+ccl_device_inline bool kernel_shader_sort_less(ccl_local uint *local_value,
+                                               ushort a,
+                                               ushort b)
+{
+  return (local_value[a] < local_value[b]) || (local_value[a] == local_value[b] && a < b);
+}
+
+ccl_device_inline void kernel_shader_sort_sift_down(ccl_local uint *local_value,
+                                                    ccl_local ushort *local_index,
+                                                    uint root,
+                                                    uint size)
+{
+  while (2 * root + 1 < size) {
+    uint child = 2 * root + 1;
+    if (child + 1 < size &&
+        kernel_shader_sort_less(local_value, local_index[child], local_index[child + 1])) {
+      child++;
+    }
+    if (!kernel_shader_sort_less(local_value, local_index[root], local_index[child])) {
+      return;
+    }
+    ushort tmp = local_index[root];
+    local_index[root] = local_index[child];
+    local_index[child] = tmp;
+    root = child;
+  }
+}
+#endif /* __KERNEL_CPU__ */
+
 ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSortLocals *locals)
 {
 #ifndef __KERNEL_CUDA__
@@ -54,7 +86,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
   }
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-  /* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
   /* bitonic sort */
@@ -77,6 +108,19 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       }
     }
   }
+#  elif defined(__KERNEL_CPU__)
+  /* A single work item handles the whole block, heap sort it in place. Only the part of the
+   * block that is inside the queue needs to be sorted. */
+  const uint size = min(qsize - offset, (uint)SHADER_SORT_BLOCK_SIZE);
+  for (uint i = size / 2; i > 0; i--) {
+    kernel_shader_sort_sift_down(local_value, local_index, i - 1, size);
+  }
+  for (uint end = size - 1; end > 0; end--) {
+    ushort tmp = local_index[0];
+    local_index[0] = local_index[end];
+    local_index[end] = tmp;
+    kernel_shader_sort_sift_down(local_value, local_index, 0, end);
+  }
 #  endif /* __KERNEL_OPENCL__ */
 
   /* copy to destination */
@@ -95,6 +95,13 @@ typedef ccl_global struct SplitBranchedState {
 #  define SPLIT_DATA_VOLUME_ENTRIES
 #endif /* __VOLUME__ */
 
+#if defined(__KERNEL_CPU__) && defined(__EMBREE__)
+/* Rays traced as one stream, see #kernel_scene_intersect. */
+#  define SPLIT_DATA_EMBREE_ENTRIES SPLIT_DATA_ENTRY(RTCRayHit, rtc_rayhit, 1)
+#else
+#  define SPLIT_DATA_EMBREE_ENTRIES
+#endif /* __KERNEL_CPU__ && __EMBREE__ */
+
 #define SPLIT_DATA_ENTRIES \
   SPLIT_DATA_ENTRY(ccl_global float3, throughput, 1) \
   SPLIT_DATA_ENTRY(PathRadiance, path_radiance, 1) \
@@ -110,6 +117,7 @@ typedef ccl_global struct SplitBranchedState {
   SPLIT_DATA_ENTRY(ShaderDataTinyStorage, sd_DL_shadow, 1) \
   SPLIT_DATA_SUBSURFACE_ENTRIES \
   SPLIT_DATA_VOLUME_ENTRIES \
+  SPLIT_DATA_EMBREE_ENTRIES \
   SPLIT_DATA_BRANCHED_ENTRIES \
   SPLIT_DATA_ENTRY(ShaderData, _sd, 0)
 
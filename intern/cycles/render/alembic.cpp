@@ -25,7 +25,10 @@
 #include "render/shader.h"
 
 #include "util/util_foreach.h"
+#include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_string.h"
+#include "util/util_task.h"
 #include "util/util_transform.h"
 #include "util/util_vector.h"
 
@@ -157,6 +160,35 @@ bool CachedData::is_constant() const
 #  undef CHECK_IF_CONSTANT
 }
 
+size_t CachedData::memory_used() const
+{
+  size_t mem_used = 0;
+
+  mem_used += curve_first_key.memory_used();
+  mem_used += curve_keys.memory_used();
+  mem_used += curve_radius.memory_used();
+  mem_used += curve_shader.memory_used();
+  mem_used += num_ngons.memory_used();
+  mem_used += shader.memory_used();
+  mem_used += subd_creases_edge.memory_used();
+  mem_used += subd_creases_weight.memory_used();
+  mem_used += subd_face_corners.memory_used();
+  mem_used += subd_num_corners.memory_used();
+  mem_used += subd_ptex_offset.memory_used();
+  mem_used += subd_smooth.memory_used();
+  mem_used += subd_start_corner.memory_used();
+  mem_used += transforms.memory_used();
+  mem_used += triangles.memory_used();
+  mem_used += uv_loops.memory_used();
+  mem_used += vertices.memory_used();
+
+  for (const CachedAttribute &attr : attributes) {
+    mem_used += attr.data.memory_used();
+  }
+
+  return mem_used;
+}
+
 void CachedData::invalidate_last_loaded_time(bool attributes_only)
 {
   if (attributes_only) {
@@ -674,6 +706,8 @@ NODE_DEFINE(AlembicProcedural)
   SOCKET_FLOAT(frame_offset, "Frame Offset", 0.0f);
   SOCKET_FLOAT(default_radius, "Default Radius", 0.01f);
   SOCKET_FLOAT(scale, "Scale", 1.0f);
+  SOCKET_BOOLEAN(use_prefetch, "Use Prefetch", true);
+  SOCKET_INT(prefetch_cache_size, "Prefetch Cache Size", 4096);
 
   SOCKET_NODE_ARRAY(objects, "Objects", AlembicObject::get_node_type());
 
@@ -684,6 +718,8 @@ AlembicProcedural::AlembicProcedural() : Procedural(get_node_type())
 {
   objects_loaded = false;
   scene_ = nullptr;
+  is_streaming_ = false;
+  streamed_frame_ = 0.0f;
 }
 
 AlembicProcedural::~AlembicProcedural()
@@ -764,6 +800,8 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
   if (!archive.valid()) {
     Alembic::AbcCoreFactory::IFactory factory;
     factory.setPolicy(Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+    /* Objects and frames are read from multiple threads, give each of them its own stream. */
+    factory.setOgawaNumStreams(TaskScheduler::num_threads());
     archive = factory.getArchive(filepath.c_str());
 
     if (!archive.valid()) {
@@ -781,6 +819,17 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
 
   const chrono_t frame_time = (chrono_t)((frame - frame_offset) / frame_rate);
 
+  if (use_prefetch_is_modified() || prefetch_cache_size_is_modified()) {
+    is_streaming_ = !use_prefetch;
+    streamed_frame_ = frame - frame_offset;
+    invalidate_caches();
+  }
+  else if (is_streaming_ && streamed_frame_ != frame - frame_offset) {
+    /* Load the frames around the new current frame. */
+    streamed_frame_ = frame - frame_offset;
+    invalidate_caches();
+  }
+
   build_caches(progress);
 
   foreach (Node *node, objects) {
@@ -790,9 +839,9 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
       return;
     }
 
-    /* skip constant objects */
+    /* Skip constant objects, streamed data is only constant for the frames that were loaded. */
     if (object->is_constant() && !object->is_modified() && !object->need_shader_update &&
-        !scale_is_modified()) {
+        !scale_is_modified() && !is_streaming_) {
       continue;
     }
 
@@ -1278,62 +1327,134 @@ void AlembicProcedural::walk_hierarchy(
   }
 }
 
+float AlembicProcedural::get_cache_start_frame() const
+{
+  if (is_streaming_) {
+    return streamed_frame_ - 1.0f;
+  }
+
+  return start_frame;
+}
+
+float AlembicProcedural::get_cache_end_frame() const
+{
+  if (is_streaming_) {
+    return streamed_frame_ + 1.0f;
+  }
+
+  return end_frame;
+}
+
+void AlembicProcedural::invalidate_caches()
+{
+  for (Node *node : objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+    object->data_loaded = false;
+  }
+}
+
 void AlembicProcedural::build_caches(Progress &progress)
 {
+  std::atomic<size_t> memory_used(0);
+
+  TaskPool pool;
+
   for (Node *node : objects) {
     AlembicObject *object = static_cast<AlembicObject *>(node);
+    pool.push(function_bind(
+        &AlembicProcedural::build_object_cache, this, object, &memory_used, &progress));
+  }
 
-    if (progress.get_cancel()) {
-      return;
+  pool.wait_work();
+
+  if (progress.get_cancel() || is_streaming_) {
+    return;
+  }
+
+  const size_t prefetch_cache_size_bytes = static_cast<size_t>(prefetch_cache_size) * 1024 *
+                                           1024;
+
+  if (memory_used > prefetch_cache_size_bytes) {
+    /* Only keep the frames around the current one in memory. */
+    VLOG(1) << "Alembic data for " << filepath.string() << " does not fit in the prefetch cache ("
+            << string_human_readable_size(memory_used) << "), streaming the data instead.";
+
+    for (Node *node : objects) {
+      AlembicObject *object = static_cast<AlembicObject *>(node);
+      object->get_cached_data().clear();
     }
 
-    if (object->schema_type == AlembicObject::POLY_MESH) {
-      if (!object->has_data_loaded()) {
-        IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
-        IPolyMeshSchema schema = polymesh.getSchema();
-        object->load_data_in_cache(object->get_cached_data(), this, schema, progress);
-      }
-      else if (object->need_shader_update) {
-        IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
-        IPolyMeshSchema schema = polymesh.getSchema();
-        read_attributes(this,
-                        object->get_cached_data(),
-                        schema,
-                        schema.getUVsParam(),
-                        object->get_requested_attributes(),
-                        progress);
-      }
+    is_streaming_ = true;
+    streamed_frame_ = frame - frame_offset;
+    invalidate_caches();
+    build_caches(progress);
+  }
+}
+
+void AlembicProcedural::build_object_cache(AlembicObject *object,
+                                           std::atomic<size_t> *memory_used,
+                                           Progress *progress)
+{
+  if (progress->get_cancel()) {
+    return;
+  }
+
+  const size_t prefetch_cache_size_bytes = static_cast<size_t>(prefetch_cache_size) * 1024 *
+                                           1024;
+
+  /* No need to load more data if it will be discarded to stream the data instead. */
+  if (!is_streaming_ && *memory_used > prefetch_cache_size_bytes) {
+    return;
+  }
+
+  if (object->schema_type == AlembicObject::POLY_MESH) {
+    if (!object->has_data_loaded()) {
+      IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
+      IPolyMeshSchema schema = polymesh.getSchema();
+      object->load_data_in_cache(object->get_cached_data(), this, schema, *progress);
     }
-    else if (object->schema_type == AlembicObject::CURVES) {
-      if (!object->has_data_loaded() || default_radius_is_modified() ||
-          object->radius_scale_is_modified()) {
-        ICurves curves(object->iobject, Alembic::Abc::kWrapExisting);
-        ICurvesSchema schema = curves.getSchema();
-        object->load_data_in_cache(object->get_cached_data(), this, schema, progress);
-      }
+    else if (object->need_shader_update) {
+      IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
+      IPolyMeshSchema schema = polymesh.getSchema();
+      read_attributes(this,
+                      object->get_cached_data(),
+                      schema,
+                      schema.getUVsParam(),
+                      object->get_requested_attributes(),
+                      *progress);
     }
-    else if (object->schema_type == AlembicObject::SUBD) {
-      if (!object->has_data_loaded()) {
-        ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
-        ISubDSchema schema = subd_mesh.getSchema();
-        object->load_data_in_cache(object->get_cached_data(), this, schema, progress);
-      }
-      else if (object->need_shader_update) {
-        ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
-        ISubDSchema schema = subd_mesh.getSchema();
-        read_attributes(this,
-                        object->get_cached_data(),
-                        schema,
-                        schema.getUVsParam(),
-                        object->get_requested_attributes(),
-                        progress);
-      }
+  }
+  else if (object->schema_type == AlembicObject::CURVES) {
+    if (!object->has_data_loaded() || default_radius_is_modified() ||
+        object->radius_scale_is_modified()) {
+      ICurves curves(object->iobject, Alembic::Abc::kWrapExisting);
+      ICurvesSchema schema = curves.getSchema();
+      object->load_data_in_cache(object->get_cached_data(), this, schema, *progress);
     }
-
-    if (scale_is_modified() || object->get_cached_data().transforms.size() == 0) {
-      object->setup_transform_cache(object->get_cached_data(), scale);
+  }
+  else if (object->schema_type == AlembicObject::SUBD) {
+    if (!object->has_data_loaded()) {
+      ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
+      ISubDSchema schema = subd_mesh.getSchema();
+      object->load_data_in_cache(object->get_cached_data(), this, schema, *progress);
+    }
+    else if (object->need_shader_update) {
+      ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
+      ISubDSchema schema = subd_mesh.getSchema();
+      read_attributes(this,
+                      object->get_cached_data(),
+                      schema,
+                      schema.getUVsParam(),
+                      object->get_requested_attributes(),
+                      *progress);
     }
   }
+
+  if (scale_is_modified() || object->get_cached_data().transforms.size() == 0) {
+    object->setup_transform_cache(object->get_cached_data(), scale);
+  }
+
+  *memory_used += object->get_cached_data().memory_used();
 }
 
 CCL_NAMESPACE_END
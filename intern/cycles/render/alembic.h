@@ -28,6 +28,9 @@
 #  include <Alembic/AbcCoreFactory/All.h>
 #  include <Alembic/AbcGeom/All.h>
 
+#  include <algorithm>
+#  include <atomic>
+
 CCL_NAMESPACE_BEGIN
 
 class AlembicProcedural;
@@ -244,6 +247,23 @@ template<typename T> class DataStore {
     return data.size();
   }
 
+  /* Number of bytes used by the stored data, frames reusing the data of a previous frame are not
+   * counted. */
+  size_t memory_used() const
+  {
+    if constexpr (is_array<T>::value) {
+      size_t mem_used = 0;
+
+      for (const T &array : data) {
+        mem_used += array.size() * sizeof(*array.data());
+      }
+
+      return mem_used;
+    }
+
+    return data.size() * sizeof(T);
+  }
+
   void clear()
   {
     invalidate_last_loaded_time();
@@ -275,9 +295,23 @@ template<typename T> class DataStore {
  private:
   const TimeIndexPair &get_index_for_time(double time) const
   {
-    std::pair<size_t, Alembic::Abc::chrono_t> index_pair;
-    index_pair = time_sampling.getNearIndex(time, index_data_map.size());
-    return index_data_map[index_pair.first];
+    /* The entries do not necessarily start at the first sample of the time sampling (e.g. when
+     * only the frames around the current one are loaded), so look for the nearest entry. */
+    auto it = std::lower_bound(
+        index_data_map.begin(),
+        index_data_map.end(),
+        time,
+        [](const TimeIndexPair &pair, double time_) { return pair.time < time_; });
+
+    if (it == index_data_map.end()) {
+      return index_data_map.back();
+    }
+
+    if (it != index_data_map.begin() && time - (it - 1)->time < it->time - time) {
+      --it;
+    }
+
+    return *it;
   }
 };
 
@@ -329,6 +363,8 @@ struct CachedData {
 
   bool is_constant() const;
 
+  size_t memory_used() const;
+
   void invalidate_last_loaded_time(bool attributes_only = false);
 
   void set_time_sampling(Alembic::AbcCoreAbstract::TimeSampling time_sampling);
@@ -434,7 +470,9 @@ class AlembicObject : public Node {
  *
  * This procedural will load the data set for the entire animation in memory on the first frame,
  * and directly set the data for the new frames on the created Nodes if needed. This allows for
- * faster updates between frames as it avoids reseeking the data on disk.
+ * faster updates between frames as it avoids reseeking the data on disk. If the data does not fit
+ * in the prefetch cache, only the frames around the current one are kept in memory and the data
+ * is reloaded when the current frame moves out of them.
  */
 class AlembicProcedural : public Procedural {
   Alembic::AbcGeom::IArchive archive;
@@ -473,6 +511,13 @@ class AlembicProcedural : public Procedural {
    * software. */
   NODE_SOCKET_API(float, scale)
 
+  /* Load the data for the whole frame range in memory upfront. If disabled, or if the data does
+   * not fit in the cache, only the frames around the current one are loaded. */
+  NODE_SOCKET_API(bool, use_prefetch)
+
+  /* Maximum memory in megabytes used to prefetch the data for the whole frame range. */
+  NODE_SOCKET_API(int, prefetch_cache_size)
+
   AlembicProcedural();
   ~AlembicProcedural();
 
@@ -493,7 +538,19 @@ class AlembicProcedural : public Procedural {
    * Returns a pointer to an existing or a newly created AlembicObject for the given path. */
   AlembicObject *get_or_create_object(const ustring &path);
 
+  /* Range of frames to load data for in the caches. This is either the entire animation, or only
+   * the frames around the current one when streaming the data. */
+  float get_cache_start_frame() const;
+  float get_cache_end_frame() const;
+
  private:
+  /* Set if the caches only hold the frames around the current one, either because prefetching
+   * is disabled or because the data for the whole animation did not fit in the cache. */
+  bool is_streaming_;
+
+  /* Frame the streamed data was loaded around. */
+  float streamed_frame_;
+
   /* Add an object to our list of objects, and tag the socket as modified. */
   void add_object(AlembicObject *object);
 
@@ -521,7 +578,17 @@ class AlembicProcedural : public Procedural {
    * Object Nodes in the Cycles scene if none exist yet. */
   void read_subd(AlembicObject *abc_object, Alembic::AbcGeom::Abc::chrono_t frame_time);
 
+  /* Load the data of all the objects in the caches, every object is loaded in its own task. */
   void build_caches(Progress &progress);
+
+  /* Load the data of a single object in its cache, and add the memory used by the cache to
+   * `memory_used`. Nothing is loaded anymore once the prefetch cache size was exceeded. */
+  void build_object_cache(AlembicObject *object,
+                          std::atomic<size_t> *memory_used,
+                          Progress *progress);
+
+  /* Tag all objects for reloading their data in the caches. */
+  void invalidate_caches();
 };
 
 CCL_NAMESPACE_END
@@ -20,6 +20,8 @@
 #include "render/mesh.h"
 
 #include "util/util_progress.h"
+#include "util/util_task.h"
+#include "util/util_tbb.h"
 
 #ifdef WITH_ALEMBIC
 
@@ -44,9 +46,9 @@ static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
     return result;
   }
 
-  // load the data for the entire animation
-  const double start_frame = static_cast<double>(proc->get_start_frame());
-  const double end_frame = static_cast<double>(proc->get_end_frame());
+  // load the data for the entire animation, or the frames around the current one if streaming
+  const double start_frame = static_cast<double>(proc->get_cache_start_frame());
+  const double end_frame = static_cast<double>(proc->get_cache_end_frame());
 
   const double frame_rate = static_cast<double>(proc->get_frame_rate());
   const double start_time = start_frame / frame_rate;
@@ -64,6 +66,10 @@ static set<chrono_t> get_relevant_sample_times(AlembicProcedural *proc,
 
 /* Main function to read data, this will iterate over all the relevant sample times for the
  * duration of the requested animation, and call the DataReadingFunc for each of those sample time.
+ *
+ * Reading and decompressing the positions is the most expensive part, so it is done in parallel
+ * for batches of frames. The data is then added to the cache in chronological order, as every
+ * frame is compared against the previous one to deduplicate the data.
  */
 template<typename Params, typename DataReadingFunc>
 static void read_data_loop(AlembicProcedural *proc,
@@ -72,17 +78,34 @@ static void read_data_loop(AlembicProcedural *proc,
                            DataReadingFunc &&func,
                            Progress &progress)
 {
-  const std::set<chrono_t> times = get_relevant_sample_times(
+  const std::set<chrono_t> times_set = get_relevant_sample_times(
       proc, *params.time_sampling, params.num_samples);
+  const vector<chrono_t> times(times_set.begin(), times_set.end());
 
   cached_data.set_time_sampling(*params.time_sampling);
 
-  for (chrono_t time : times) {
-    if (progress.get_cancel()) {
-      return;
-    }
+  const size_t batch_size = max(TaskScheduler::num_threads(), 1);
+  vector<P3fArraySamplePtr> positions(batch_size);
+
+  for (size_t batch_start = 0; batch_start < times.size(); batch_start += batch_size) {
+    const size_t batch_end = min(batch_start + batch_size, times.size());
 
-    func(cached_data, params, time);
+    parallel_for(blocked_range<size_t>(batch_start, batch_end, 1),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     const ISampleSelector iss = ISampleSelector(times[i]);
+                     positions[i - batch_start] = params.positions.getValue(iss);
+                   }
+                 });
+
+    for (size_t i = batch_start; i < batch_end; i++) {
+      if (progress.get_cancel()) {
+        return;
+      }
+
+      func(cached_data, params, times[i], positions[i - batch_start]);
+      positions[i - batch_start].reset();
+    }
   }
 }
 
@@ -219,12 +242,24 @@ static void add_normals(const Int32ArraySamplePtr face_indices,
   }
 }
 
-static void add_positions(const P3fArraySamplePtr positions, double time, CachedData &cached_data)
+/* Add the positions for the given time, reusing the positions of the previous frame if they did
+ * not change. Returns whether new positions were added. */
+static bool add_positions(const P3fArraySamplePtr positions, double time, CachedData &cached_data)
 {
   if (!positions) {
-    return;
+    return true;
   }
 
+  /* Compare key with last one to check whether the positions changed. */
+  const ArraySample::Key key = positions->getKey();
+
+  if (cached_data.vertices.size() > 0 && key == cached_data.vertices.key1) {
+    cached_data.vertices.reuse_data_for_last_time(time);
+    return false;
+  }
+
+  cached_data.vertices.key1 = key;
+
   array<float3> vertices;
   vertices.reserve(positions->size());
 
@@ -234,6 +269,7 @@ static void add_positions(const P3fArraySamplePtr positions, double time, Cached
   }
 
   cached_data.vertices.add_data(vertices, time);
+  return true;
 }
 
 static void add_triangles(const Int32ArraySamplePtr face_counts,
@@ -334,11 +370,13 @@ static array<int> compute_polygon_to_shader_map(
 
 static void read_poly_mesh_geometry(CachedData &cached_data,
                                     const PolyMeshSchemaData &data,
-                                    chrono_t time)
+                                    chrono_t time,
+                                    const P3fArraySamplePtr &positions)
 {
   const ISampleSelector iss = ISampleSelector(time);
 
-  add_positions(data.positions.getValue(iss), time, cached_data);
+  const bool positions_changed = add_positions(positions, time, cached_data);
+  bool topology_changed = false;
 
   const Int32ArraySamplePtr face_counts = data.face_counts.getValue(iss);
   const Int32ArraySamplePtr face_indices = data.face_indices.getValue(iss);
@@ -362,6 +400,7 @@ static void read_poly_mesh_geometry(CachedData &cached_data,
       const array<int> polygon_to_shader = compute_polygon_to_shader_map(
           face_counts, data.shader_face_sets, iss);
       add_triangles(face_counts, face_indices, time, cached_data, polygon_to_shader);
+      topology_changed = true;
     }
     else {
       cached_data.triangles.reuse_data_for_last_time(time);
@@ -378,9 +417,15 @@ static void read_poly_mesh_geometry(CachedData &cached_data,
   if (data.normals.valid()) {
     add_normals(face_indices, data.normals, time, cached_data);
   }
-  else {
+  else if (positions_changed || topology_changed) {
     compute_vertex_normals(cached_data, time);
   }
+  else {
+    /* The normals are the same as for the previous frame. */
+    CachedData::CachedAttribute &attr_normal = cached_data.add_attribute(
+        ustring("N"), cached_data.vertices.get_time_sampling());
+    attr_normal.data.reuse_data_for_last_time(time);
+  }
 }
 
 void read_geometry_data(AlembicProcedural *proc,
@@ -507,11 +552,12 @@ static void add_subd_creases(CachedData &cached_data, const SubDSchemaData &data
   }
 }
 
-static void read_subd_geometry(CachedData &cached_data, const SubDSchemaData &data, chrono_t time)
+static void read_subd_geometry(CachedData &cached_data,
+                               const SubDSchemaData &data,
+                               chrono_t time,
+                               const P3fArraySamplePtr &positions)
 {
-  const ISampleSelector iss = ISampleSelector(time);
-
-  add_positions(data.positions.getValue(iss), time, cached_data);
+  add_positions(positions, time, cached_data);
 
   if (data.topology_variance != kHomogenousTopology || cached_data.shader.size() == 0) {
     add_subd_polygons(cached_data, data, time);
@@ -529,12 +575,14 @@ void read_geometry_data(AlembicProcedural *proc,
 
 /* Curve Geometries. */
 
-static void read_curves_data(CachedData &cached_data, const CurvesSchemaData &data, chrono_t time)
+static void read_curves_data(CachedData &cached_data,
+                             const CurvesSchemaData &data,
+                             chrono_t time,
+                             const P3fArraySamplePtr &position)
 {
   const ISampleSelector iss = ISampleSelector(time);
 
   const Int32ArraySamplePtr curves_num_vertices = data.num_vertices.getValue(iss);
-  const P3fArraySamplePtr position = data.positions.getValue(iss);
 
   FloatArraySamplePtr radiuses;
 
@@ -63,6 +63,8 @@ static NodeEnum *get_pass_type_enum()
   pass_type_enum.insert("aov_value", PASS_AOV_VALUE);
   pass_type_enum.insert("adaptive_aux_buffer", PASS_ADAPTIVE_AUX_BUFFER);
   pass_type_enum.insert("sample_count", PASS_SAMPLE_COUNT);
+  pass_type_enum.insert("sample_time", PASS_SAMPLE_TIME);
+  pass_type_enum.insert("shader_evaluations", PASS_SHADER_EVALUATIONS);
   pass_type_enum.insert("mist", PASS_MIST);
   pass_type_enum.insert("emission", PASS_EMISSION);
   pass_type_enum.insert("background", PASS_BACKGROUND);
@@ -249,6 +251,8 @@ void Pass::add(PassType type, vector<Pass> &passes, const char *name)
       pass.components = 4;
       break;
     case PASS_SAMPLE_COUNT:
+    case PASS_SAMPLE_TIME:
+    case PASS_SHADER_EVALUATIONS:
       pass.components = 1;
       pass.exposure = false;
       break;
@@ -454,6 +458,8 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
   kfilm->use_light_pass = use_light_visibility;
   kfilm->pass_aov_value_num = 0;
   kfilm->pass_aov_color_num = 0;
+  kfilm->pass_sample_time = 0;
+  kfilm->pass_shader_evaluations = 0;
 
   bool have_cryptomatte = false;
 
@@ -598,6 +604,12 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
       case PASS_SAMPLE_COUNT:
         kfilm->pass_sample_count = kfilm->pass_stride;
         break;
+      case PASS_SAMPLE_TIME:
+        kfilm->pass_sample_time = kfilm->pass_stride;
+        break;
+      case PASS_SHADER_EVALUATIONS:
+        kfilm->pass_shader_evaluations = kfilm->pass_stride;
+        break;
       case PASS_AOV_COLOR:
         if (kfilm->pass_aov_color_num == 0) {
           kfilm->pass_aov_color = kfilm->pass_stride;
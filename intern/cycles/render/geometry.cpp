@@ -39,8 +39,11 @@
 
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_murmurhash.h"
 #include "util/util_progress.h"
+#include "util/util_set.h"
 #include "util/util_task.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -77,6 +80,9 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
   has_volume = false;
   has_surface_bssrdf = false;
 
+  content_hash = 0;
+  duplicate_of = NULL;
+
   bvh = NULL;
   attr_map_offset = 0;
   optix_prim_offset = 0;
@@ -171,6 +177,10 @@ int Geometry::motion_step(float time) const
 
 bool Geometry::need_build_bvh(BVHLayout layout) const
 {
+  if (duplicate_of) {
+    return false;
+  }
+
   return is_instanced() || layout == BVH_LAYOUT_OPTIX || layout == BVH_LAYOUT_MULTI_OPTIX ||
          layout == BVH_LAYOUT_MULTI_OPTIX_EMBREE;
 }
@@ -222,13 +232,17 @@ void Geometry::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    /* Only a BVH built for refitting is rebuilt when refitting degraded it, others are refit
+     * as before. */
+    const bool refit_degraded = bvh && bvh->params.use_refit && bvh->refit_degraded();
+    if (bvh && !need_update_rebuild && !refit_degraded) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
       bvh->objects = objects;
 
       device->build_bvh(bvh, *progress, true);
+      bvh->num_refits++;
     }
     else {
       progress->set_status(msg, "Building BVH");
@@ -241,6 +255,7 @@ void Geometry::compute_bvh(
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
+      bparams.use_refit = params->use_bvh_refit;
       bparams.curve_subdivisions = params->curve_subdivisions();
 
       delete bvh;
@@ -344,8 +359,9 @@ void GeometryManager::update_osl_attributes(Device *device,
     }
 
     /* find geometry attributes */
-    size_t j = object->geometry->index;
-    assert(j < scene->geometry.size() && scene->geometry[j] == object->geometry);
+    Geometry *geom = object->get_render_geometry();
+    size_t j = geom->index;
+    assert(j < scene->geometry.size() && scene->geometry[j] == geom);
 
     AttributeRequestSet &attributes = geom_attributes[j];
 
@@ -531,14 +547,15 @@ void GeometryManager::update_svm_attributes(Device *,
 
     /* set object attributes */
     if (attributes.size() > 0) {
+      Geometry *geom = object->get_render_geometry();
       int index = object->attr_map_offset;
 
       foreach (AttributeRequest &req, attributes.requests) {
-        emit_attribute_mapping(attr_map, index, scene, req, object->geometry);
+        emit_attribute_mapping(attr_map, index, scene, req, geom);
         index += ATTR_PRIM_TYPES;
       }
 
-      emit_attribute_map_terminator(attr_map, index, true, object->geometry->attr_map_offset);
+      emit_attribute_map_terminator(attr_map, index, true, geom->attr_map_offset);
     }
   }
 
@@ -745,7 +762,7 @@ void GeometryManager::device_update_attributes(Device *device,
 
   for (size_t i = 0; i < scene->objects.size(); i++) {
     Object *object = scene->objects[i];
-    Geometry *geom = object->geometry;
+    Geometry *geom = object->get_render_geometry();
     size_t geom_idx = geom->index;
 
     assert(geom_idx < scene->geometry.size() && scene->geometry[geom_idx] == geom);
@@ -815,7 +832,7 @@ void GeometryManager::device_update_attributes(Device *device,
     Object *object = scene->objects[i];
 
     foreach (Attribute &attr, object_attribute_values[i].attributes) {
-      update_attribute_element_size(object->geometry,
+      update_attribute_element_size(object->get_render_geometry(),
                                     &attr,
                                     ATTR_PRIM_GEOMETRY,
                                     &attr_float_size,
@@ -913,7 +930,7 @@ void GeometryManager::device_update_attributes(Device *device,
         attr->modified |= attributes_need_realloc[Attribute::kernel_type(*attr)];
       }
 
-      update_attribute_element_offset(object->geometry,
+      update_attribute_element_offset(object->get_render_geometry(),
                                       dscene->attributes_float,
                                       attr_float_offset,
                                       dscene->attributes_float2,
@@ -1098,15 +1115,24 @@ void GeometryManager::device_update_mesh(
     /* normals */
     progress.set_status("Updating Mesh", "Computing normals");
 
+    /* Only one of the normal arrays is used, depending on compression. Set here rather than
+     * with the BVH, displacement already evaluates shaders with smooth normals. */
+    const bool use_compressed_normals = scene->params.use_compressed_normals;
+    dscene->data.bvh.use_compressed_normals = use_compressed_normals;
+    device_vector<float4> &tri_vnormal = dscene->tri_vnormal;
+    device_vector<uint> &tri_vnormal_oct = dscene->tri_vnormal_oct;
+
     uint *tri_shader = dscene->tri_shader.alloc(tri_size);
-    float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
+    float4 *vnormal = (use_compressed_normals) ? NULL : tri_vnormal.alloc(vert_size);
+    uint *vnormal_oct = (use_compressed_normals) ? tri_vnormal_oct.alloc(vert_size) : NULL;
     uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
 
     const bool copy_all_data = dscene->tri_shader.need_realloc() ||
                                dscene->tri_vindex.need_realloc() ||
-                               dscene->tri_vnormal.need_realloc() ||
+                               ((use_compressed_normals) ? tri_vnormal_oct.need_realloc() :
+                                                           tri_vnormal.need_realloc()) ||
                                dscene->tri_patch.need_realloc() ||
                                dscene->tri_patch_uv.need_realloc();
 
@@ -1120,7 +1146,12 @@ void GeometryManager::device_update_mesh(
         }
 
         if (mesh->verts_is_modified() || copy_all_data) {
-          mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          if (use_compressed_normals) {
+            mesh->pack_normals_compressed(&vnormal_oct[mesh->vert_offset]);
+          }
+          else {
+            mesh->pack_normals(&vnormal[mesh->vert_offset]);
+          }
         }
 
         if (mesh->triangles_is_modified() || mesh->vert_patch_uv_is_modified() || copy_all_data) {
@@ -1141,7 +1172,12 @@ void GeometryManager::device_update_mesh(
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
     dscene->tri_shader.copy_to_device_if_modified();
-    dscene->tri_vnormal.copy_to_device_if_modified();
+    if (use_compressed_normals) {
+      tri_vnormal_oct.copy_to_device_if_modified();
+    }
+    else {
+      tri_vnormal.copy_to_device_if_modified();
+    }
     dscene->tri_vindex.copy_to_device_if_modified();
     dscene->tri_patch.copy_to_device_if_modified();
     dscene->tri_patch_uv.copy_to_device_if_modified();
@@ -1320,7 +1356,7 @@ void GeometryManager::device_update_bvh(Device *device,
     unordered_map<const Geometry *, pair<int, uint>> geometry_to_object_info;
     geometry_to_object_info.reserve(scene->geometry.size());
     foreach (Object *ob, scene->objects) {
-      const Geometry *const geom = ob->get_geometry();
+      const Geometry *const geom = ob->get_render_geometry();
       pair<int, uint> &info = geometry_to_object_info[geom];
       info.second |= ob->visibility_for_tracing();
       if (!geom->is_instanced()) {
@@ -1478,6 +1514,259 @@ static void update_attribute_realloc_flags(uint32_t &device_update_flags,
   }
 }
 
+/* Mesh Deduplication
+ *
+ * Realized instances and copies of objects end up as separate meshes with identical data. Such
+ * meshes are found by hashing their data, and objects using them are rendered with a single mesh
+ * which then becomes instanced, so only one BVH is built and stored. The geometry of the objects
+ * is left as set by the host, see Object::get_render_geometry(). */
+
+static uint32_t hash_bytes(const void *data, size_t size, uint32_t hash)
+{
+  /* Hash in chunks, as util_murmur_hash3() takes the length as int. */
+  const size_t chunk_size = (size_t)1 << 30;
+  const char *bytes = (const char *)data;
+
+  for (size_t offset = 0; offset < size; offset += chunk_size) {
+    hash = util_murmur_hash3(bytes + offset, (int)std::min(chunk_size, size - offset), hash);
+  }
+
+  return hash;
+}
+
+/* Only the first components of float3 are hashed and compared, the padding is not always
+ * initialized. */
+static uint32_t hash_float3s(const float3 *data, size_t size, int num_components, uint32_t hash)
+{
+  for (size_t i = 0; i < size; i++) {
+    hash = util_murmur_hash3(&data[i], sizeof(float) * num_components, hash);
+  }
+
+  return hash;
+}
+
+static bool float3s_equal(const float3 *a, const float3 *b, size_t size, int num_components)
+{
+  for (size_t i = 0; i < size; i++) {
+    if (memcmp(&a[i], &b[i], sizeof(float) * num_components) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template<typename T> static bool arrays_equal(const array<T> &a, const array<T> &b)
+{
+  return a.size() == b.size() &&
+         (a.size() == 0 || memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0);
+}
+
+static int attribute_float3_components(const Attribute &attr)
+{
+  if (attr.data_sizeof() != sizeof(float3)) {
+    return 0;
+  }
+
+  return (attr.type == TypeRGBA) ? 4 : 3;
+}
+
+static uint32_t mesh_content_hash(Mesh *mesh)
+{
+  const array<float3> &verts = mesh->get_verts();
+  uint32_t hash = hash_float3s(verts.data(), verts.size(), 3, 0);
+  const array<int> &triangles = mesh->get_triangles();
+  const array<int> &shader = mesh->get_shader();
+  const array<bool> &smooth = mesh->get_smooth();
+  hash = hash_bytes(triangles.data(), sizeof(int) * triangles.size(), hash);
+  hash = hash_bytes(shader.data(), sizeof(int) * shader.size(), hash);
+  hash = hash_bytes(smooth.data(), sizeof(bool) * smooth.size(), hash);
+
+  foreach (const Attribute &attr, mesh->attributes.attributes) {
+    hash = hash_bytes(attr.name.c_str(), attr.name.length(), hash);
+
+    const int num_components = attribute_float3_components(attr);
+    if (num_components) {
+      hash = hash_float3s((const float3 *)attr.buffer.data(),
+                          attr.buffer.size() / sizeof(float3),
+                          num_components,
+                          hash);
+    }
+    else {
+      hash = hash_bytes(attr.buffer.data(), attr.buffer.size(), hash);
+    }
+  }
+
+  return hash;
+}
+
+static bool mesh_content_equal(const Mesh *a, const Mesh *b)
+{
+  if (a->get_verts().size() != b->get_verts().size() ||
+      !arrays_equal(a->get_used_shaders(), b->get_used_shaders()) ||
+      a->get_motion_steps() != b->get_motion_steps() ||
+      a->get_use_motion_blur() != b->get_use_motion_blur() ||
+      !arrays_equal(a->get_triangles(), b->get_triangles()) ||
+      !arrays_equal(a->get_shader(), b->get_shader()) ||
+      !arrays_equal(a->get_smooth(), b->get_smooth()) ||
+      a->attributes.attributes.size() != b->attributes.attributes.size()) {
+    return false;
+  }
+
+  if (!float3s_equal(a->get_verts().data(), b->get_verts().data(), a->get_verts().size(), 3)) {
+    return false;
+  }
+
+  foreach (const Attribute &attr_a, a->attributes.attributes) {
+    const Attribute *attr_b = b->attributes.find(attr_a.name);
+
+    if (attr_b == NULL || attr_a.std != attr_b->std || attr_a.element != attr_b->element ||
+        attr_a.type != attr_b->type || attr_a.buffer.size() != attr_b->buffer.size()) {
+      return false;
+    }
+
+    const int num_components = attribute_float3_components(attr_a);
+    if (num_components) {
+      if (!float3s_equal((const float3 *)attr_a.buffer.data(),
+                         (const float3 *)attr_b->buffer.data(),
+                         attr_a.buffer.size() / sizeof(float3),
+                         num_components)) {
+        return false;
+      }
+    }
+    else if (memcmp(attr_a.buffer.data(), attr_b->buffer.data(), attr_a.buffer.size()) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool mesh_content_modified(Mesh *mesh)
+{
+  if (mesh->is_modified()) {
+    return true;
+  }
+
+  foreach (const Attribute &attr, mesh->attributes.attributes) {
+    if (attr.modified) {
+      return true;
+    }
+  }
+
+  return mesh->attributes.modified(AttrKernelDataType::FLOAT) ||
+         mesh->attributes.modified(AttrKernelDataType::FLOAT2) ||
+         mesh->attributes.modified(AttrKernelDataType::FLOAT3) ||
+         mesh->attributes.modified(AttrKernelDataType::UCHAR4);
+}
+
+static bool mesh_can_deduplicate(const Mesh *mesh)
+{
+  /* Meshes with applied transform are in world space, and displacement and subdivision modify
+   * the mesh later in the update. */
+  return !mesh->transform_applied && mesh->num_triangles() > 0 &&
+         mesh->get_subdivision_type() == Mesh::SUBDIVISION_NONE &&
+         !mesh->has_true_displacement();
+}
+
+void GeometryManager::deduplicate_meshes(Scene *scene, Progress &progress)
+{
+  scoped_callback_timer timer([scene](double time) {
+    if (scene->update_stats) {
+      scene->update_stats->geometry.times.add_entry(
+          {"device_update_preprocess (deduplicate meshes)", time});
+    }
+  });
+
+  vector<Mesh *> meshes;
+  foreach (Geometry *geom, scene->geometry) {
+    if (geom->is_mesh()) {
+      meshes.push_back(static_cast<Mesh *>(geom));
+    }
+  }
+
+  /* Hash modified meshes, all of them so the hash is valid when a mesh becomes eligible later
+   * on. A full comparison is done before sharing, so an outdated hash only misses duplicates. */
+  vector<char> modified(meshes.size());
+  parallel_for(blocked_range<size_t>(0, meshes.size(), 1), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      modified[i] = mesh_content_modified(meshes[i]);
+      if (modified[i]) {
+        meshes[i]->content_hash = mesh_content_hash(meshes[i]);
+      }
+    }
+  });
+
+  if (progress.get_cancel()) {
+    return;
+  }
+
+  /* The first mesh with given data in the scene is shared with the others. */
+  unordered_map<uint32_t, vector<size_t>> unique_meshes;
+  unordered_set<Geometry *> scene_meshes(meshes.begin(), meshes.end());
+  unordered_set<Geometry *> changed_meshes;
+  size_t num_duplicates = 0;
+
+  for (size_t i = 0; i < meshes.size(); i++) {
+    Mesh *mesh = meshes[i];
+    Geometry *duplicate_of = NULL;
+
+    if (mesh_can_deduplicate(mesh)) {
+      vector<size_t> &candidates = unique_meshes[mesh->content_hash];
+
+      foreach (size_t j, candidates) {
+        /* Skip the comparison when the meshes were already found to be identical. */
+        const bool unchanged = mesh->duplicate_of == meshes[j] && !modified[i] && !modified[j];
+        if (unchanged || mesh_content_equal(mesh, meshes[j])) {
+          duplicate_of = meshes[j];
+          break;
+        }
+      }
+
+      if (duplicate_of) {
+        num_duplicates++;
+      }
+      else {
+        candidates.push_back(i);
+      }
+    }
+
+    if (mesh->duplicate_of != duplicate_of) {
+      /* Rebuild the scene BVH, and the BVH of the mesh if it is no longer a duplicate. The
+       * meshes shared with gain or lose users, which changes whether their transform gets
+       * applied, so their BVH is rebuilt too. */
+      if (mesh->duplicate_of == NULL) {
+        delete mesh->bvh;
+        mesh->bvh = NULL;
+      }
+      else if (scene_meshes.find(mesh->duplicate_of) != scene_meshes.end()) {
+        /* The mesh shared with may have been removed from the scene since. */
+        mesh->duplicate_of->tag_bvh_update(true);
+      }
+      if (duplicate_of) {
+        duplicate_of->tag_bvh_update(true);
+      }
+      mesh->duplicate_of = duplicate_of;
+      mesh->tag_bvh_update(true);
+      changed_meshes.insert(mesh);
+    }
+  }
+
+  /* Objects render with another mesh now, their device data and the mesh lights need updating. */
+  if (!changed_meshes.empty()) {
+    foreach (Object *object, scene->objects) {
+      if (changed_meshes.find(object->get_geometry()) != changed_meshes.end()) {
+        object->tag_geometry_modified();
+        object->tag_update(scene);
+      }
+    }
+
+    scene->light_manager->tag_update(scene, LightManager::MESH_NEED_REBUILD);
+  }
+
+  VLOG(1) << "Deduplicated " << num_duplicates << " meshes.";
+}
+
 void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Progress &progress)
 {
   if (!need_update() && !need_flags_update) {
@@ -1494,6 +1783,8 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
 
   progress.set_status("Updating Meshes Flags");
 
+  deduplicate_meshes(scene, progress);
+
   /* Update flags. */
   bool volume_images_updated = false;
 
@@ -1633,6 +1924,7 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
 
     if (device_update_flags & DEVICE_MESH_DATA_NEEDS_REALLOC) {
       dscene->tri_vnormal.tag_realloc();
+      dscene->tri_vnormal_oct.tag_realloc();
       dscene->tri_vindex.tag_realloc();
       dscene->tri_patch.tag_realloc();
       dscene->tri_patch_uv.tag_realloc();
@@ -1686,6 +1978,7 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     /* if anything else than vertices or shaders are modified, we would need to reallocate, so
      * these are the only arrays that can be updated */
     dscene->tri_vnormal.tag_modified();
+    dscene->tri_vnormal_oct.tag_modified();
     dscene->tri_shader.tag_modified();
   }
 
@@ -1839,6 +2132,9 @@ void GeometryManager::device_update(Device *device,
         dicing_camera->get_full_width(), dicing_camera->get_full_height(), 1);
     dicing_camera->update(scene);
 
+    /* Meshes are tessellated in parallel, and dicing of each mesh is parallel too. */
+    TaskPool pool;
+
     size_t i = 0;
     foreach (Geometry *geom, scene->geometry) {
       if (!(geom->is_modified() && geom->is_mesh())) {
@@ -1854,20 +2150,27 @@ void GeometryManager::device_update(Device *device,
           msg += string_printf(
               "%s %u/%u", mesh->name.c_str(), (uint)(i + 1), (uint)total_tess_needed);
 
-        progress.set_status("Updating Mesh", msg);
-
         mesh->subd_params->camera = dicing_camera;
-        DiagSplit dsplit(*mesh->subd_params);
-        mesh->tessellate(&dsplit);
 
-        i++;
+        pool.push([mesh, msg, &progress] {
+          if (progress.get_cancel()) {
+            return;
+          }
 
-        if (progress.get_cancel()) {
-          return;
-        }
+          progress.set_status("Updating Mesh", msg);
+
+          const double start_time = time_dt();
+          DiagSplit dsplit(*mesh->subd_params);
+          mesh->tessellate(&dsplit);
+          mesh->tessellation_time = time_dt() - start_time;
+        });
+
+        i++;
       }
     }
 
+    pool.wait_work();
+
     if (progress.get_cancel()) {
       return;
     }
@@ -2096,6 +2399,7 @@ void GeometryManager::device_update(Device *device,
   dscene->tri_vindex.clear_modified();
   dscene->tri_patch.clear_modified();
   dscene->tri_vnormal.clear_modified();
+  dscene->tri_vnormal_oct.clear_modified();
   dscene->tri_patch_uv.clear_modified();
   dscene->curves.clear_modified();
   dscene->curve_keys.clear_modified();
@@ -2121,6 +2425,7 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool forc
   dscene->prim_time.free_if_need_realloc(force_free);
   dscene->tri_shader.free_if_need_realloc(force_free);
   dscene->tri_vnormal.free_if_need_realloc(force_free);
+  dscene->tri_vnormal_oct.free_if_need_realloc(force_free);
   dscene->tri_vindex.free_if_need_realloc(force_free);
   dscene->tri_patch.free_if_need_realloc(force_free);
   dscene->tri_patch_uv.free_if_need_realloc(force_free);
@@ -2169,6 +2474,14 @@ void GeometryManager::collect_statistics(const Scene *scene, RenderStats *stats)
   foreach (Geometry *geometry, scene->geometry) {
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(geometry->name.c_str()), geometry->get_total_size_in_bytes()));
+
+    if (geometry->is_mesh()) {
+      const Mesh *mesh = static_cast<const Mesh *>(geometry);
+      if (mesh->get_subdivision_type() != Mesh::SUBDIVISION_NONE) {
+        stats->mesh.tessellation.add_entry(
+            NamedTimeEntry(string(mesh->name.c_str()), mesh->tessellation_time));
+      }
+    }
   }
 }
 
@@ -106,6 +106,14 @@ class Geometry : public Node {
   bool has_volume;         /* Set in the device_update_flags(). */
   bool has_surface_bssrdf; /* Set in the device_update_flags(). */
 
+  /* Deduplication
+   *
+   * Hash of the mesh data, updated when the geometry is modified. When the data is identical to
+   * another mesh, objects using this geometry are rendered with that one so they share its BVH,
+   * and no BVH is built for this geometry. */
+  uint content_hash;
+  Geometry *duplicate_of;
+
   /* Update Flags */
   bool need_update_rebuild;
   bool need_update_bvh_for_offset;
@@ -245,6 +253,9 @@ class GeometryManager {
 
   void create_volume_mesh(Volume *volume, Progress &progress);
 
+  /* Share identical meshes between objects. */
+  void deduplicate_meshes(Scene *scene, Progress &progress);
+
   /* Attributes */
   void update_osl_attributes(Device *device,
                              Scene *scene,
@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -258,7 +259,7 @@ void LightManager::test_enabled_lights(Scene *scene)
 
 bool LightManager::object_usable_as_light(Object *object)
 {
-  Geometry *geom = object->get_geometry();
+  Geometry *geom = object->get_render_geometry();
   if (geom->geometry_type != Geometry::MESH && geom->geometry_type != Geometry::VOLUME) {
     return false;
   }
@@ -284,13 +285,60 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
-void LightManager::device_update_distribution(Device *,
+static LightTreeEmitter light_tree_lamp_emitter(Light *light, int index)
+{
+  LightTreeEmitter emitter;
+  const float3 co = light->get_co();
+
+  if (light->get_light_type() == LIGHT_AREA) {
+    const float3 axisu = light->get_axisu() * (light->get_sizeu() * light->get_size());
+    const float3 axisv = light->get_axisv() * (light->get_sizev() * light->get_size());
+    emitter.bounds = BoundBox(co - 0.5f * axisu - 0.5f * axisv);
+    emitter.bounds.grow(co + 0.5f * axisu - 0.5f * axisv);
+    emitter.bounds.grow(co - 0.5f * axisu + 0.5f * axisv);
+    emitter.bounds.grow(co + 0.5f * axisu + 0.5f * axisv);
+    /* Area lights only emit to the front. */
+    emitter.cone = LightTreeCone(safe_normalize(light->get_dir()), 0.0f, M_PI_2_F);
+  }
+  else {
+    emitter.bounds = BoundBox(co);
+    emitter.bounds.grow(co, light->get_size());
+
+    if (light->get_light_type() == LIGHT_SPOT) {
+      emitter.cone = LightTreeCone(
+          safe_normalize(light->get_dir()), min(0.5f * light->get_spot_angle(), M_PI_F), 0.0f);
+    }
+    else {
+      emitter.cone = LightTreeCone::sphere();
+    }
+  }
+
+  emitter.energy = average(fabs(light->get_strength()));
+  emitter.area = 0.0f;
+  emitter.index = index;
+  return emitter;
+}
+
+void LightManager::device_update_distribution(Device *device,
                                               DeviceScene *dscene,
                                               Scene *scene,
                                               Progress &progress)
 {
   progress.set_status("Updating Lights", "Computing distribution");
 
+  /* Branched path tracing sampling all lights relies on picking lights from the distribution
+   * with fixed probabilities, the light tree is not used then. */
+  Integrator *integrator = scene->integrator;
+  const bool sample_all_lights = integrator->get_method() == Integrator::BRANCHED_PATH &&
+                                 device->info.has_branched_path &&
+                                 (integrator->get_sample_all_lights_direct() ||
+                                  integrator->get_sample_all_lights_indirect());
+  const bool use_light_tree = integrator->get_use_light_tree() && !sample_all_lights;
+
+  /* Emitters in the light tree, and the distant and background lights that are not. */
+  vector<LightTreeEmitter> light_tree_emitters;
+  vector<size_t> distant_lights;
+
   /* count */
   size_t num_lights = 0;
   size_t num_portals = 0;
@@ -317,7 +365,7 @@ void LightManager::device_update_distribution(Device *,
     }
 
     /* Count triangles. */
-    Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+    Mesh *mesh = static_cast<Mesh *>(object->get_render_geometry());
     size_t mesh_num_triangles = mesh->num_triangles();
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->get_shader()[i];
@@ -342,6 +390,10 @@ void LightManager::device_update_distribution(Device *,
   size_t offset = 0;
   int j = 0;
 
+  /* Emission estimate of the last shader, triangles of a mesh mostly share one. */
+  Shader *emission_shader = NULL;
+  float emission_estimate = 0.0f;
+
   foreach (Object *object, scene->objects) {
     if (progress.get_cancel())
       return;
@@ -351,7 +403,7 @@ void LightManager::device_update_distribution(Device *,
       continue;
     }
     /* Sum area. */
-    Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+    Mesh *mesh = static_cast<Mesh *>(object->get_render_geometry());
     bool transform_applied = mesh->transform_applied;
     Transform tfm = object->get_tfm();
     int object_id = j;
@@ -382,6 +434,7 @@ void LightManager::device_update_distribution(Device *,
                            scene->default_surface;
 
       if (shader->get_use_mis() && shader->has_surface_emission) {
+        const size_t distribution_index = offset;
         distribution[offset].totarea = totarea;
         distribution[offset].prim = i + mesh->prim_offset;
         distribution[offset].mesh_light.shader_flag = shader_flag;
@@ -402,7 +455,26 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_light_tree) {
+          if (shader != emission_shader) {
+            emission_shader = shader;
+            emission_estimate = average(shader->estimate_emission());
+          }
+
+          LightTreeEmitter emitter;
+          emitter.bounds = BoundBox(p1);
+          emitter.bounds.grow(p2);
+          emitter.bounds.grow(p3);
+          /* Mesh emission is two sided. */
+          emitter.cone = LightTreeCone::sphere();
+          emitter.energy = area * emission_estimate;
+          emitter.area = area;
+          emitter.index = distribution_index;
+          light_tree_emitters.push_back(emitter);
+        }
       }
     }
 
@@ -440,6 +512,15 @@ void LightManager::device_update_distribution(Device *,
       background_mis |= light->use_mis;
     }
 
+    if (use_light_tree) {
+      if (light->light_type == LIGHT_DISTANT || light->light_type == LIGHT_BACKGROUND) {
+        distant_lights.push_back(offset);
+      }
+      else {
+        light_tree_emitters.push_back(light_tree_lamp_emitter(light, offset));
+      }
+    }
+
     light_index++;
     offset++;
   }
@@ -456,6 +537,45 @@ void LightManager::device_update_distribution(Device *,
     distribution[num_distribution].totarea = 1.0f;
   }
 
+  if (progress.get_cancel())
+    return;
+
+  /* light tree */
+  const bool build_light_tree = use_light_tree && !light_tree_emitters.empty() && totarea > 0.0f;
+
+  if (build_light_tree) {
+    progress.set_status("Updating Lights", "Building light tree");
+
+    LightTree light_tree(light_tree_emitters);
+    const vector<KernelLightTreeNode> &nodes = light_tree.get_nodes();
+    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+    memcpy(knodes, nodes.data(), sizeof(KernelLightTreeNode) * nodes.size());
+
+    /* Leaf of every emitter, to find the probability of picking lights hit by rays. Entries of
+     * invalid triangles and distant lights are not used. */
+    uint *leaves = dscene->light_tree_leaves.alloc(num_distribution);
+    memset(leaves, 0, sizeof(uint) * num_distribution);
+    for (size_t i = 0; i < nodes.size(); i++) {
+      if (nodes[i].child_index == -1) {
+        leaves[nodes[i].emitter] = i;
+      }
+    }
+
+    /* Only distant and background lights are picked from the distribution, uniformly. */
+    for (size_t i = 0; i <= num_distribution; i++) {
+      distribution[i].totarea = 0.0f;
+    }
+    for (size_t i = 0; i < distant_lights.size(); i++) {
+      for (size_t k = distant_lights[i] + 1; k <= num_distribution; k++) {
+        distribution[k].totarea += 1.0f / distant_lights.size();
+      }
+    }
+    distribution[num_distribution].totarea = distant_lights.empty() ? 0.0f : 1.0f;
+
+    VLOG(1) << "Light tree with " << light_tree_emitters.size() << " emitters and "
+            << nodes.size() << " nodes.";
+  }
+
   if (progress.get_cancel())
     return;
 
@@ -490,6 +610,20 @@ void LightManager::device_update_distribution(Device *,
 
     kintegrator->use_lamp_mis = use_lamp_mis;
 
+    /* With the light tree, distant and background lights are picked half of the time. */
+    kintegrator->use_light_tree = build_light_tree;
+    kintegrator->light_tree_pdf = 0.0f;
+
+    if (build_light_tree) {
+      kintegrator->light_tree_pdf = (distant_lights.empty()) ? 1.0f : 0.5f;
+      kintegrator->pdf_lights = (distant_lights.empty()) ?
+                                    0.0f :
+                                    (1.0f - kintegrator->light_tree_pdf) / distant_lights.size();
+
+      dscene->light_tree_nodes.copy_to_device();
+      dscene->light_tree_leaves.copy_to_device();
+    }
+
     /* bit of an ugly hack to compensate for emitting triangles influencing
      * amount of samples we get for this pass */
     kfilm->pass_shadow_scale = 1.0f;
@@ -520,12 +654,16 @@ void LightManager::device_update_distribution(Device *,
   }
   else {
     dscene->light_distribution.free();
+    dscene->light_tree_nodes.free();
+    dscene->light_tree_leaves.free();
 
     kintegrator->num_distribution = 0;
     kintegrator->num_all_lights = 0;
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
+    kintegrator->light_tree_pdf = 0.0f;
 
     kbackground->num_portals = 0;
     kbackground->portal_offset = 0;
@@ -1026,6 +1164,8 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_leaves.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "render/light_tree.h"
+
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of buckets the centroids are binned into when looking for a split. */
+static const int LIGHT_TREE_NUM_BINS = 12;
+
+/* Beyond this depth nodes are split in the middle, to keep the tree balanced. */
+static const int LIGHT_TREE_MAX_BINNED_DEPTH = 48;
+
+/* Smallest cone containing both cones, see "Importance Sampling of Many Lights with Adaptive
+ * Tree Splitting" by Conty Estevez and Kulla. */
+static LightTreeCone light_tree_cone_merge(const LightTreeCone &a, const LightTreeCone &b)
+{
+  if (a.is_empty()) {
+    return b;
+  }
+  if (b.is_empty()) {
+    return a;
+  }
+
+  const LightTreeCone &wide = (a.theta_o >= b.theta_o) ? a : b;
+  const LightTreeCone &narrow = (a.theta_o >= b.theta_o) ? b : a;
+  const float theta_e = max(a.theta_e, b.theta_e);
+  const float theta_d = safe_acosf(dot(wide.axis, narrow.axis));
+
+  if (min(theta_d + narrow.theta_o, M_PI_F) <= wide.theta_o) {
+    return LightTreeCone(wide.axis, wide.theta_o, theta_e);
+  }
+
+  const float theta_o = 0.5f * (wide.theta_o + theta_d + narrow.theta_o);
+  if (theta_o >= M_PI_F) {
+    return LightTreeCone(wide.axis, M_PI_F, theta_e);
+  }
+
+  /* Rotate the axis of the wide cone towards the narrow one. */
+  const float3 ortho = narrow.axis - wide.axis * dot(wide.axis, narrow.axis);
+  const float ortho_len = len(ortho);
+  if (ortho_len < 1e-6f) {
+    return LightTreeCone(wide.axis, M_PI_F, theta_e);
+  }
+
+  const float theta_r = theta_o - wide.theta_o;
+  const float3 axis = normalize(wide.axis * cosf(theta_r) + (ortho / ortho_len) * sinf(theta_r));
+  return LightTreeCone(axis, theta_o, theta_e);
+}
+
+/* Measure of the solid angle the cone covers, used in the cost of a split. */
+static float light_tree_cone_measure(const LightTreeCone &cone)
+{
+  const float theta_o = cone.theta_o;
+  const float theta_w = min(theta_o + cone.theta_e, M_PI_F);
+  return M_2PI_F * (1.0f - cosf(theta_o)) +
+         M_PI_2_F * (2.0f * theta_w * sinf(theta_o) - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sinf(theta_o) + cosf(theta_o));
+}
+
+namespace {
+
+/* Bounds of a set of emitters. */
+struct LightTreeBounds {
+  BoundBox bbox = BoundBox(BoundBox::empty);
+  LightTreeCone cone;
+  float energy = 0.0f;
+  int num_emitters = 0;
+
+  void add(const LightTreeEmitter &emitter)
+  {
+    bbox.grow(emitter.bounds);
+    cone = light_tree_cone_merge(cone, emitter.cone);
+    energy += emitter.energy;
+    num_emitters++;
+  }
+
+  void add(const LightTreeBounds &other)
+  {
+    bbox.grow(other.bbox);
+    cone = light_tree_cone_merge(cone, other.cone);
+    energy += other.energy;
+    num_emitters += other.num_emitters;
+  }
+
+  /* Surface area orientation heuristic. */
+  float cost() const
+  {
+    return energy * bbox.area() * light_tree_cone_measure(cone);
+  }
+};
+
+}  // namespace
+
+LightTree::LightTree(vector<LightTreeEmitter> &emitters)
+{
+  if (emitters.empty()) {
+    return;
+  }
+
+  nodes.reserve(2 * emitters.size() - 1);
+  build(emitters, 0, emitters.size(), -1, 0);
+}
+
+int LightTree::build(
+    vector<LightTreeEmitter> &emitters, int start, int end, int parent, int depth)
+{
+  const int node_index = nodes.size();
+  nodes.push_back(KernelLightTreeNode());
+
+  LightTreeBounds bounds;
+  for (int i = start; i < end; i++) {
+    bounds.add(emitters[i]);
+  }
+
+  KernelLightTreeNode knode;
+  knode.bbox_min[0] = bounds.bbox.min.x;
+  knode.bbox_min[1] = bounds.bbox.min.y;
+  knode.bbox_min[2] = bounds.bbox.min.z;
+  knode.bbox_max[0] = bounds.bbox.max.x;
+  knode.bbox_max[1] = bounds.bbox.max.y;
+  knode.bbox_max[2] = bounds.bbox.max.z;
+  knode.energy = bounds.energy;
+  knode.axis[0] = bounds.cone.axis.x;
+  knode.axis[1] = bounds.cone.axis.y;
+  knode.axis[2] = bounds.cone.axis.z;
+  knode.theta_o = bounds.cone.theta_o;
+  knode.theta_e = bounds.cone.theta_e;
+  knode.parent = parent;
+
+  if (end - start == 1) {
+    knode.child_index = -1;
+    knode.emitter = emitters[start].index;
+    knode.area = emitters[start].area;
+  }
+  else {
+    const int middle = split(emitters, start, end, depth);
+    build(emitters, start, middle, node_index, depth + 1);
+    knode.child_index = build(emitters, middle, end, node_index, depth + 1);
+    knode.emitter = -1;
+    knode.area = 0.0f;
+  }
+
+  nodes[node_index] = knode;
+  return node_index;
+}
+
+int LightTree::split(vector<LightTreeEmitter> &emitters, int start, int end, int depth)
+{
+  BoundBox centroid_bounds = BoundBox::empty;
+  for (int i = start; i < end; i++) {
+    centroid_bounds.grow(emitters[i].bounds.center());
+  }
+
+  const float3 extent = centroid_bounds.size();
+  const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 :
+                   (extent.y >= extent.z)                         ? 1 :
+                                                                    2;
+  const float axis_min = centroid_bounds.min[axis];
+  const float axis_extent = extent[axis];
+
+  /* Fallback, split in the middle along the axis. */
+  auto split_middle = [&]() {
+    const int middle = (start + end) / 2;
+    std::nth_element(emitters.begin() + start,
+                     emitters.begin() + middle,
+                     emitters.begin() + end,
+                     [axis](const LightTreeEmitter &a, const LightTreeEmitter &b) {
+                       return a.bounds.center()[axis] < b.bounds.center()[axis];
+                     });
+    return middle;
+  };
+
+  if (axis_extent == 0.0f || depth >= LIGHT_TREE_MAX_BINNED_DEPTH) {
+    return split_middle();
+  }
+
+  auto bin_index = [&](const LightTreeEmitter &emitter) {
+    const float offset = (emitter.bounds.center()[axis] - axis_min) / axis_extent;
+    return clamp((int)(offset * LIGHT_TREE_NUM_BINS), 0, LIGHT_TREE_NUM_BINS - 1);
+  };
+
+  LightTreeBounds bins[LIGHT_TREE_NUM_BINS];
+  for (int i = start; i < end; i++) {
+    bins[bin_index(emitters[i])].add(emitters[i]);
+  }
+
+  /* Costs of all emitters up to a bin from the right, then find the cheapest split walking from
+   * the left. */
+  float right_cost[LIGHT_TREE_NUM_BINS];
+  LightTreeBounds right;
+  for (int i = LIGHT_TREE_NUM_BINS - 1; i > 0; i--) {
+    right.add(bins[i]);
+    right_cost[i] = (right.num_emitters) ? right.cost() : FLT_MAX;
+  }
+
+  int best_split = -1;
+  float best_cost = FLT_MAX;
+  LightTreeBounds left;
+  for (int i = 1; i < LIGHT_TREE_NUM_BINS; i++) {
+    left.add(bins[i - 1]);
+    if (left.num_emitters == 0 || right_cost[i] == FLT_MAX) {
+      continue;
+    }
+
+    const float cost = left.cost() + right_cost[i];
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_split = i;
+    }
+  }
+
+  if (best_split != -1) {
+    auto split_it = std::partition(
+        emitters.begin() + start, emitters.begin() + end, [&](const LightTreeEmitter &emitter) {
+          return bin_index(emitter) < best_split;
+        });
+    const int split_index = split_it - emitters.begin();
+    if (split_index != start && split_index != end) {
+      return split_index;
+    }
+  }
+
+  return split_middle();
+}
+
+CCL_NAMESPACE_END
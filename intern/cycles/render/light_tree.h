@@ -0,0 +1,89 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounds on the directions light is emitted in: all emission is within theta_o of the axis,
+ * and spreads out from there by at most theta_e. */
+struct LightTreeCone {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  LightTreeCone() : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(-1.0f), theta_e(0.0f)
+  {
+  }
+
+  LightTreeCone(const float3 &axis, float theta_o, float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  /* Emission in all directions. */
+  static LightTreeCone sphere()
+  {
+    return LightTreeCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+  }
+
+  bool is_empty() const
+  {
+    return theta_o < 0.0f;
+  }
+};
+
+/* Emissive triangle, point, spot or area light of the light distribution. */
+struct LightTreeEmitter {
+  BoundBox bounds;
+  LightTreeCone cone;
+  /* Estimated power. */
+  float energy;
+  /* Area of triangles. */
+  float area;
+  /* Index in the light distribution. */
+  int index;
+};
+
+/* Hierarchy over the emitters, see kernel_light_tree.h for how it is used to pick lights.
+ * Nodes are stored depth first, the first child of an inner node directly follows it. */
+class LightTree {
+ public:
+  /* Reorders the emitters. */
+  explicit LightTree(vector<LightTreeEmitter> &emitters);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes;
+  }
+
+ protected:
+  int build(vector<LightTreeEmitter> &emitters, int start, int end, int parent, int depth);
+  int split(vector<LightTreeEmitter> &emitters, int start, int end, int depth);
+
+  vector<KernelLightTreeNode> nodes;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
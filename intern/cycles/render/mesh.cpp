@@ -194,6 +194,8 @@ Mesh::Mesh(const NodeType *node_type, Type geom_type_)
   num_subd_verts = 0;
   num_subd_faces = 0;
 
+  tessellation_time = 0.0;
+
   num_ngons = 0;
 
   subdivision_type = SUBDIVISION_NONE;
@@ -705,19 +707,22 @@ void Mesh::pack_shaders(Scene *scene, uint *tri_shader)
   }
 }
 
-void Mesh::pack_normals(float4 *vnormal)
+/* Write the vertex normals, in world space when the transform is applied, in the layout of the
+ * device array. */
+template<typename T, typename PackFunc>
+static void mesh_pack_normals(Mesh *mesh, T *vnormal, const PackFunc &pack)
 {
-  Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
+  Attribute *attr_vN = mesh->attributes.find(ATTR_STD_VERTEX_NORMAL);
   if (attr_vN == NULL) {
     /* Happens on objects with just hair. */
     return;
   }
 
-  bool do_transform = transform_applied;
-  Transform ntfm = transform_normal;
+  bool do_transform = mesh->transform_applied;
+  Transform ntfm = mesh->transform_normal;
 
   float3 *vN = attr_vN->data_float3();
-  size_t verts_size = verts.size();
+  size_t verts_size = mesh->get_verts().size();
 
   for (size_t i = 0; i < verts_size; i++) {
     float3 vNi = vN[i];
@@ -725,10 +730,21 @@ void Mesh::pack_normals(float4 *vnormal)
     if (do_transform)
       vNi = safe_normalize(transform_direction(&ntfm, vNi));
 
-    vnormal[i] = make_float4(vNi.x, vNi.y, vNi.z, 0.0f);
+    vnormal[i] = pack(vNi);
   }
 }
 
+void Mesh::pack_normals(float4 *vnormal)
+{
+  mesh_pack_normals(
+      this, vnormal, [](const float3 N) { return make_float4(N.x, N.y, N.z, 0.0f); });
+}
+
+void Mesh::pack_normals_compressed(uint *vnormal)
+{
+  mesh_pack_normals(this, vnormal, [](const float3 N) { return float3_to_octahedral(N); });
+}
+
 void Mesh::pack_verts(const vector<uint> &tri_prim_index,
                       uint4 *tri_vindex,
                       uint *tri_patch,
@@ -180,6 +180,9 @@ class Mesh : public Geometry {
   size_t num_subd_verts;
   size_t num_subd_faces;
 
+  /* Time spent in the last tessellation, for statistics. */
+  double tessellation_time;
+
   unordered_map<int, int> vert_to_stitching_key_map; /* real vert index -> stitching index */
   unordered_multimap<int, int>
       vert_stitching_map; /* stitching index -> multiple real vert indices */
@@ -224,6 +227,7 @@ class Mesh : public Geometry {
 
   void pack_shaders(Scene *scene, uint *shader);
   void pack_normals(float4 *vnormal);
+  void pack_normals_compressed(uint *vnormal);
   void pack_verts(const vector<uint> &tri_prim_index,
                   uint4 *tri_vindex,
                   uint *tri_patch,
@@ -153,6 +153,7 @@ void Object::update_motion()
 
 void Object::compute_bounds(bool motion_blur)
 {
+  const Geometry *geometry = get_render_geometry();
   BoundBox mbounds = geometry->bounds;
 
   if (motion_blur && use_motion()) {
@@ -203,6 +204,11 @@ void Object::apply_transform(bool apply_to_motion)
    * transform_applied boolean */
 }
 
+Geometry *Object::get_render_geometry() const
+{
+  return (geometry && geometry->duplicate_of) ? geometry->duplicate_of : geometry;
+}
+
 void Object::tag_update(Scene *scene)
 {
   uint32_t flag = ObjectManager::UPDATE_NONE;
@@ -403,7 +409,7 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
   KernelObject &kobject = state->objects[ob->index];
   Transform *object_motion_pass = state->object_motion_pass;
 
-  Geometry *geom = ob->geometry;
+  Geometry *geom = ob->get_render_geometry();
   uint flag = 0;
 
   /* Compute transformations. */
@@ -789,7 +795,7 @@ void ObjectManager::device_update_mesh_offsets(Device *, DeviceScene *dscene, Sc
   bool update = false;
 
   foreach (Object *object, scene->objects) {
-    Geometry *geom = object->geometry;
+    Geometry *geom = object->get_render_geometry();
 
     if (geom->geometry_type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
@@ -845,10 +851,11 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
   int i = 0;
 
   foreach (Object *object, scene->objects) {
-    map<Geometry *, int>::iterator it = geometry_users.find(object->geometry);
+    Geometry *render_geometry = object->get_render_geometry();
+    map<Geometry *, int>::iterator it = geometry_users.find(render_geometry);
 
     if (it == geometry_users.end())
-      geometry_users[object->geometry] = 1;
+      geometry_users[render_geometry] = 1;
     else
       it->second++;
   }
@@ -869,6 +876,14 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
     bool apply = (geometry_users[geom] == 1) && !geom->has_surface_bssrdf &&
                  !geom->has_true_displacement();
 
+    /* Deduplicated geometry is rendered through the mesh it is shared with, so it stays
+     * instanced. */
+    apply = apply && geom->duplicate_of == NULL;
+
+    /* When BVHs are kept between frames, keep the geometry in object space so moving objects
+     * do not need their geometry synced and their BVH built again. */
+    apply = apply && !scene->params.use_bvh_refit;
+
     if (geom->geometry_type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
       apply = apply && mesh->get_subdivision_type() == Mesh::SUBDIVISION_NONE;
@@ -80,6 +80,10 @@ class Object : public Node {
   void compute_bounds(bool motion_blur);
   void apply_transform(bool apply_to_motion);
 
+  /* Geometry the object is rendered with. This is the geometry socket, unless the geometry manager
+   * found that geometry to be identical to another mesh, which is then shared instead. */
+  Geometry *get_render_geometry() const;
+
   /* Convert between normalized -1..1 motion time and index
    * in the motion array. */
   bool use_motion() const;
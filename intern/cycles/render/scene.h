@@ -85,6 +85,7 @@ class DeviceScene {
   /* mesh */
   device_vector<uint> tri_shader;
   device_vector<float4> tri_vnormal;
+  device_vector<uint> tri_vnormal_oct;
   device_vector<uint4> tri_vindex;
   device_vector<uint> tri_patch;
   device_vector<float2> tri_patch_uv;
@@ -113,6 +114,8 @@ class DeviceScene {
 
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<uint> light_tree_leaves;
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
@@ -176,6 +179,13 @@ class SceneParams {
   bool use_bvh_spatial_split;
   bool use_bvh_unaligned_nodes;
   int num_bvh_time_steps;
+  /* Refit the BVH of geometry that deforms without changing topology, also in final renders
+   * where the scene is kept between frames. Object transforms are not applied to meshes, and
+   * some devices use more memory for such BVHs, so this is opt-in. */
+  bool use_bvh_refit;
+  /* Store vertex normals octahedral encoded in 32 bits instead of as float4, a quarter of the
+   * memory for a small loss of precision in smooth shading. */
+  bool use_compressed_normals;
   int hair_subdivisions;
   CurveShapeType hair_shape;
   int texture_limit;
@@ -190,6 +200,8 @@ class SceneParams {
     use_bvh_spatial_split = false;
     use_bvh_unaligned_nodes = true;
     num_bvh_time_steps = 0;
+    use_bvh_refit = false;
+    use_compressed_normals = false;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
@@ -203,6 +215,8 @@ class SceneParams {
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
+             use_bvh_refit == params.use_bvh_refit &&
+             use_compressed_normals == params.use_compressed_normals &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
              texture_limit == params.texture_limit);
   }
@@ -275,6 +275,69 @@ bool Shader::is_constant_emission(float3 *emission)
   return true;
 }
 
+static float3 output_estimate_emission(ShaderOutput *output)
+{
+  ShaderNode *node = output->parent;
+
+  if (node->type == EmissionNode::get_node_type()) {
+    EmissionNode *emission_node = (EmissionNode *)node;
+    ShaderInput *color_in = node->input("Color");
+    ShaderInput *strength_in = node->input("Strength");
+
+    float3 estimate = (color_in->link) ? one_float3() : emission_node->get_color();
+    if (!strength_in->link) {
+      estimate *= emission_node->get_strength();
+    }
+    return estimate;
+  }
+  else if (node->type == AddClosureNode::get_node_type()) {
+    ShaderInput *closure1_in = node->input("Closure1");
+    ShaderInput *closure2_in = node->input("Closure2");
+
+    return ((closure1_in->link) ? output_estimate_emission(closure1_in->link) : zero_float3()) +
+           ((closure2_in->link) ? output_estimate_emission(closure2_in->link) : zero_float3());
+  }
+  else if (node->type == MixClosureNode::get_node_type()) {
+    ShaderInput *closure1_in = node->input("Closure1");
+    ShaderInput *closure2_in = node->input("Closure2");
+
+    const float3 estimate1 = (closure1_in->link) ? output_estimate_emission(closure1_in->link) :
+                                                   zero_float3();
+    const float3 estimate2 = (closure2_in->link) ? output_estimate_emission(closure2_in->link) :
+                                                   zero_float3();
+    if (node->input("Fac")->link) {
+      return max(estimate1, estimate2);
+    }
+
+    const float fac = ((MixClosureNode *)node)->get_fac();
+    return (1.0f - fac) * estimate1 + fac * estimate2;
+  }
+  else if (node->has_surface_emission()) {
+    return one_float3();
+  }
+
+  return zero_float3();
+}
+
+float3 Shader::estimate_emission()
+{
+  if (!has_surface_emission) {
+    return zero_float3();
+  }
+
+  ShaderInput *surf = graph->output()->input("Surface");
+  if (surf->link == NULL) {
+    return zero_float3();
+  }
+
+  /* The shader is known to emit, the emission may come from OSL or nodes not understood here. */
+  const float3 estimate = fabs(output_estimate_emission(surf->link));
+  if (is_zero(estimate)) {
+    return one_float3();
+  }
+  return estimate;
+}
+
 void Shader::set_graph(ShaderGraph *graph_)
 {
   /* do this here already so that we can detect if mesh or object attributes
@@ -150,6 +150,10 @@ class Shader : public Node {
    * then used for speeding up light evaluation. */
   bool is_constant_emission(float3 *emission);
 
+  /* Rough estimate of the surface emission, for the light tree. Only a few nodes are
+   * understood, other shaders are assumed to emit with unit strength. */
+  float3 estimate_emission();
+
   void set_graph(ShaderGraph *graph);
   void tag_update(Scene *scene);
   void tag_used(Scene *scene);
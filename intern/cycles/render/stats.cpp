@@ -235,6 +235,9 @@ string MeshStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  if (!tessellation.entries.empty()) {
+    result += indent + "Tessellation:\n" + tessellation.full_report(indent_level + 1);
+  }
   return result;
 }
 
@@ -160,6 +160,9 @@ class MeshStats {
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Time spent tessellating meshes with adaptive subdivision. */
+  NamedTimeStats tessellation;
 };
 
 /* Statistics about images held in memory. */
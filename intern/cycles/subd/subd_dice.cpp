@@ -20,6 +20,8 @@
 #include "subd/subd_dice.h"
 #include "subd/subd_patch.h"
 
+#include "util/util_task.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* EdgeDice Base */
@@ -45,8 +47,11 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->get_verts().size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+  mesh->resize_mesh(vert_offset + num_verts, tri_offset + num_triangles);
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+  mesh->tag_triangle_patch_modified();
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -69,17 +74,22 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::set_triangle(Patch *patch, int index, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  const size_t triangle = tri_offset + index;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(triangle < mesh->num_triangles());
 
-  tri_offset++;
+  mesh->triangles[triangle * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[triangle * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[triangle * 3 + 2] = v2 + vert_offset;
+  mesh->shader[triangle] = patch->shader;
+  mesh->smooth[triangle] = true;
+  mesh->triangle_patch[triangle] = patch->patch_index;
 }
 
-void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
+void EdgeDice::stitch_triangles(Subpatch &sub, int edge, int &triangle)
 {
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
   int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
@@ -122,7 +132,7 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
         v2 = sub.get_vert_along_grid_edge(edge, ++i);
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    set_triangle(sub.patch, triangle++, v1, v0, v2);
   }
 }
 
@@ -157,12 +167,17 @@ void QuadDice::set_vert(Subpatch &sub, int index, float u, float v)
   EdgeDice::set_vert(sub.patch, index, map_uv(sub, u, v));
 }
 
-void QuadDice::set_side(Subpatch &sub, int edge)
+void QuadDice::set_side(Subpatch &sub, int edge, int sub_index, const vector<int> &edge_vert_owner)
 {
   int t = sub.edges[edge].T;
 
   /* set verts on the edge of the patch */
   for (int i = 0; i < t; i++) {
+    const int vert = sub.get_vert_along_edge(edge, i);
+    if (edge_vert_owner[vert] != sub_index) {
+      continue;
+    }
+
     float f = i / (float)t;
 
     float u, v;
@@ -186,7 +201,7 @@ void QuadDice::set_side(Subpatch &sub, int edge)
         break;
     }
 
-    set_vert(sub, sub.get_vert_along_edge(edge, i), u, v);
+    set_vert(sub, vert, u, v);
   }
 }
 
@@ -224,7 +239,7 @@ float QuadDice::scale_factor(Subpatch &sub, int Mu, int Mv)
   return S;
 }
 
-void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
+void QuadDice::add_grid_verts(Subpatch &sub, int Mu, int Mv, int offset)
 {
   /* create inner grid */
   float du = 1.0f / (float)Mu;
@@ -236,25 +251,30 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
       float v = j * dv;
 
       set_vert(sub, offset + (i - 1) + (j - 1) * (Mu - 1), u, v);
+    }
+  }
+}
 
-      if (i < Mu - 1 && j < Mv - 1) {
-        int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
-        int i2 = offset + i + (j - 1) * (Mu - 1);
-        int i3 = offset + i + j * (Mu - 1);
-        int i4 = offset + (i - 1) + j * (Mu - 1);
-
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
-      }
+void QuadDice::add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset, int &triangle)
+{
+  for (int j = 1; j < Mv - 1; j++) {
+    for (int i = 1; i < Mu - 1; i++) {
+      int i1 = offset + (i - 1) + (j - 1) * (Mu - 1);
+      int i2 = offset + i + (j - 1) * (Mu - 1);
+      int i3 = offset + i + j * (Mu - 1);
+      int i4 = offset + (i - 1) + j * (Mu - 1);
+
+      set_triangle(sub.patch, triangle++, i1, i2, i3);
+      set_triangle(sub.patch, triangle++, i1, i3, i4);
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::grid_size(Subpatch &sub, int &Mu, int &Mv)
 {
   /* compute inner grid size with scale factor */
-  int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
-  int Mv = max(sub.edge_v0.T, sub.edge_v1.T);
+  Mu = max(sub.edge_u0.T, sub.edge_u1.T);
+  Mv = max(sub.edge_v0.T, sub.edge_v1.T);
 
 #if 0 /* Doesn't work very well, especially at grazing angles. */
   float S = scale_factor(sub, ef, Mu, Mv);
@@ -264,20 +284,75 @@ void QuadDice::dice(Subpatch &sub)
 
   Mu = max((int)ceilf(S * Mu), 2);  // XXX handle 0 & 1?
   Mv = max((int)ceilf(S * Mv), 2);  // XXX handle 0 & 1?
+}
+
+void QuadDice::dice(vector<Subpatch> &subpatches, int num_edge_verts)
+{
+  const size_t num_subpatches = subpatches.size();
+  vector<int> triangle_offsets(num_subpatches);
+
+  int num_verts = num_edge_verts;
+  int num_triangles = 0;
+
+  for (size_t i = 0; i < num_subpatches; i++) {
+    Subpatch &sub = subpatches[i];
 
-  /* inner grid */
-  add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+    sub.edge_u0.T = max(sub.edge_u0.T, 1);
+    sub.edge_u1.T = max(sub.edge_u1.T, 1);
+    sub.edge_v0.T = max(sub.edge_v0.T, 1);
+    sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-  /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
+    sub.inner_grid_vert_offset = num_verts;
+    num_verts += sub.calc_num_inner_verts();
+    triangle_offsets[i] = num_triangles;
+    num_triangles += sub.calc_num_triangles();
+  }
+
+  reserve(num_verts, num_triangles);
+
+  /* Vertices along edges are shared by subpatches, let the last subpatch using a vertex evaluate
+   * it so the result is the same as dicing one subpatch after the other. */
+  vector<int> edge_vert_owner(num_edge_verts, -1);
+  for (size_t i = 0; i < num_subpatches; i++) {
+    const Subpatch &sub = subpatches[i];
+    for (int edge = 0; edge < 4; edge++) {
+      for (int n = 0; n < sub.edges[edge].T; n++) {
+        edge_vert_owner[sub.get_vert_along_edge(edge, n)] = (int)i;
+      }
+    }
+  }
+
+  /* Evaluate all vertices first, stitching reads the vertices of neighboring subpatches. */
+  parallel_for(blocked_range<size_t>(0, num_subpatches, 16), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      Subpatch &sub = subpatches[i];
+      int Mu, Mv;
+      grid_size(sub, Mu, Mv);
+
+      add_grid_verts(sub, Mu, Mv, sub.inner_grid_vert_offset);
 
-  stitch_triangles(sub, 0);
-  stitch_triangles(sub, 1);
-  stitch_triangles(sub, 2);
-  stitch_triangles(sub, 3);
+      for (int edge = 0; edge < 4; edge++) {
+        set_side(sub, edge, i, edge_vert_owner);
+      }
+    }
+  });
+
+  parallel_for(blocked_range<size_t>(0, num_subpatches, 16), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      Subpatch &sub = subpatches[i];
+      int Mu, Mv;
+      grid_size(sub, Mu, Mv);
+
+      int triangle = triangle_offsets[i];
+      add_grid_triangles(sub, Mu, Mv, sub.inner_grid_vert_offset, triangle);
+
+      for (int edge = 0; edge < 4; edge++) {
+        stitch_triangles(sub, edge, triangle);
+      }
+
+      assert(triangle == triangle_offsets[i] + sub.calc_num_triangles());
+    }
+  });
 }
 
 CCL_NAMESPACE_END
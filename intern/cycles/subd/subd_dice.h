@@ -71,10 +71,11 @@ class EdgeDice {
 
   void reserve(int num_verts, int num_triangles);
 
+  /* Both write to the index given, so they can be called in parallel. */
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void set_triangle(Patch *patch, int index, int v0, int v1, int v2);
 
-  void stitch_triangles(Subpatch &sub, int edge);
+  void stitch_triangles(Subpatch &sub, int edge, int &triangle);
 };
 
 /* Quad EdgeDice */
@@ -88,14 +89,18 @@ class QuadDice : public EdgeDice {
   float2 map_uv(Subpatch &sub, float u, float v);
   void set_vert(Subpatch &sub, int index, float u, float v);
 
-  void add_grid(Subpatch &sub, int Mu, int Mv, int offset);
+  void add_grid_verts(Subpatch &sub, int Mu, int Mv, int offset);
+  void add_grid_triangles(Subpatch &sub, int Mu, int Mv, int offset, int &triangle);
 
-  void set_side(Subpatch &sub, int edge);
+  void set_side(Subpatch &sub, int edge, int sub_index, const vector<int> &edge_vert_owner);
 
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
+  void grid_size(Subpatch &sub, int &Mu, int &Mv);
 
-  void dice(Subpatch &sub);
+  /* Dice all subpatches in parallel, the result does not depend on the number of threads.
+   * Vertices along edges come first, followed by the inner grids of the subpatches. */
+  void dice(vector<Subpatch> &subpatches, int num_edge_verts);
 };
 
 CCL_NAMESPACE_END
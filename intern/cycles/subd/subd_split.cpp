@@ -717,28 +717,7 @@ void DiagSplit::post_split()
 
   /* Dice; TODO(mai): Move this out of split. */
   QuadDice dice(params);
-
-  int num_verts = num_alloced_verts;
-  int num_triangles = 0;
-
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    Subpatch &sub = subpatches[i];
-
-    sub.edge_u0.T = max(sub.edge_u0.T, 1);
-    sub.edge_u1.T = max(sub.edge_u1.T, 1);
-    sub.edge_v0.T = max(sub.edge_v0.T, 1);
-    sub.edge_v1.T = max(sub.edge_v1.T, 1);
-
-    dice.dice(sub);
-  }
+  dice.dice(subpatches, num_alloced_verts);
 
   /* Cleanup */
   subpatches.clear();
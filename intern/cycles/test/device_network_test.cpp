@@ -0,0 +1,132 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+#include "device/device_network.h"
+
+#include "render/buffers.h"
+
+#include "util/util_function.h"
+#include "util/util_stats.h"
+#include "util/util_string.h"
+#include "util/util_thread.h"
+
+#include <string.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* A client and a server device in the same process, connected over loopback. */
+class DeviceNetworkLoopback : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  Device *server_device;
+  Device *client_device;
+
+  boost::asio::io_service io_service;
+  tcp::acceptor *acceptor;
+  thread *server_thread;
+
+  thread_mutex tile_types_mutex;
+  vector<uint> acquired_tile_types;
+
+  virtual void SetUp()
+  {
+    DeviceInfo cpu_info;
+    server_device = Device::create(cpu_info, stats, profiler, true);
+
+    /* Any free port, so tests can run in parallel. */
+    acceptor = new tcp::acceptor(
+        io_service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    const int port = acceptor->local_endpoint().port();
+
+    server_thread = new thread([this]() {
+      tcp::socket socket(io_service);
+      acceptor->accept(socket);
+      device_network_serve(server_device, socket);
+    });
+
+    DeviceInfo network_info;
+    network_info.type = DEVICE_NETWORK;
+    network_info.id = string_printf("NETWORK_127.0.0.1:%d", port);
+    client_device = Device::create(network_info, stats, profiler, true);
+  }
+
+  virtual void TearDown()
+  {
+    /* Stops the server. */
+    delete client_device;
+
+    server_thread->join();
+    delete server_thread;
+    delete acceptor;
+    delete server_device;
+  }
+
+ public:
+  bool acquire_tile(Device *, RenderTile &, uint tile_types)
+  {
+    thread_scoped_lock lock(tile_types_mutex);
+    acquired_tile_types.push_back(tile_types);
+    return false;
+  }
+};
+
+TEST_F(DeviceNetworkLoopback, memory_round_trip)
+{
+  ASSERT_EQ(client_device->info.type, DEVICE_NETWORK);
+
+  device_vector<int> data(client_device, "test_data", MEM_READ_WRITE);
+  int *values = data.alloc(16);
+  for (int i = 0; i < 16; i++) {
+    values[i] = i * 3;
+  }
+  data.copy_to_device();
+
+  memset(values, 0, sizeof(int) * 16);
+  data.copy_from_device(0, 16, 1);
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ(values[i], i * 3);
+  }
+
+  data.zero_to_device();
+  data.copy_from_device(0, 16, 1);
+  for (int i = 0; i < 16; i++) {
+    EXPECT_EQ(values[i], 0);
+  }
+
+  data.free();
+}
+
+TEST_F(DeviceNetworkLoopback, acquire_tile_types)
+{
+  DeviceTask task(DeviceTask::RENDER);
+  task.tile_types = RenderTile::PATH_TRACE;
+  task.acquire_tile = function_bind(&DeviceNetworkLoopback::acquire_tile, this, _1, _2, _3);
+
+  client_device->task_add(task);
+  client_device->task_wait();
+
+  /* Every render thread of the server asked for tiles, with the types it renders. */
+  EXPECT_FALSE(acquired_tile_types.empty());
+  for (const uint tile_types : acquired_tile_types) {
+    EXPECT_EQ(tile_types, (uint)RenderTile::PATH_TRACE);
+  }
+}
+
+CCL_NAMESPACE_END
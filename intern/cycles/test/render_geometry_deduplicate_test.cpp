@@ -0,0 +1,172 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "render/geometry.h"
+#include "render/mesh.h"
+#include "render/object.h"
+#include "render/scene.h"
+
+#include "util/util_array.h"
+#include "util/util_foreach.h"
+#include "util/util_progress.h"
+#include "util/util_stats.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class RenderGeometryDeduplicate : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    device_cpu = Device::create(device_info, stats, profiler, true);
+    scene = new Scene(scene_params, device_cpu);
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+
+  static array<float3> triangle_verts(float offset)
+  {
+    array<float3> verts;
+    verts.push_back_slow(make_float3(offset, 0.0f, 0.0f));
+    verts.push_back_slow(make_float3(1.0f, 0.0f, 0.0f));
+    verts.push_back_slow(make_float3(0.0f, 1.0f, 0.0f));
+    return verts;
+  }
+
+  Mesh *create_triangle()
+  {
+    Mesh *mesh = scene->create_node<Mesh>();
+
+    array<Node *> used_shaders;
+    used_shaders.push_back_slow(scene->default_surface);
+    mesh->set_used_shaders(used_shaders);
+
+    array<float3> verts = triangle_verts(0.0f);
+    mesh->set_verts(verts);
+    mesh->add_triangle(0, 1, 2, 0, false);
+
+    return mesh;
+  }
+
+  Object *create_object(Mesh *mesh)
+  {
+    Object *object = scene->create_node<Object>();
+    object->set_geometry(mesh);
+    return object;
+  }
+
+  void update()
+  {
+    scene->geometry_manager->device_update_preprocess(device_cpu, scene, progress);
+
+    /* Like at the end of a scene update, so only the next changes are seen. */
+    foreach (Geometry *geom, scene->geometry) {
+      geom->clear_modified();
+    }
+    foreach (Object *object, scene->objects) {
+      object->clear_modified();
+    }
+  }
+};
+
+TEST_F(RenderGeometryDeduplicate, identical_meshes_shared)
+{
+  Mesh *mesh_a = create_triangle();
+  Mesh *mesh_b = create_triangle();
+  Object *object_a = create_object(mesh_a);
+  Object *object_b = create_object(mesh_b);
+
+  update();
+
+  EXPECT_EQ(mesh_a->duplicate_of, (Geometry *)NULL);
+  EXPECT_EQ(mesh_b->duplicate_of, mesh_a);
+
+  /* The geometry set by the host is kept, only the rendered geometry is shared. */
+  EXPECT_EQ(object_a->get_geometry(), mesh_a);
+  EXPECT_EQ(object_b->get_geometry(), mesh_b);
+  EXPECT_EQ(object_a->get_render_geometry(), mesh_a);
+  EXPECT_EQ(object_b->get_render_geometry(), mesh_a);
+}
+
+TEST_F(RenderGeometryDeduplicate, edited_duplicate_unshared)
+{
+  Mesh *mesh_a = create_triangle();
+  Mesh *mesh_b = create_triangle();
+  Object *object_a = create_object(mesh_a);
+  Object *object_b = create_object(mesh_b);
+
+  update();
+
+  ASSERT_EQ(object_b->get_render_geometry(), mesh_a);
+
+  /* Edit the duplicate like a host would, without assigning the geometry again. */
+  array<float3> verts = triangle_verts(0.5f);
+  mesh_b->set_verts(verts);
+  mesh_b->tag_update(scene, true);
+
+  update();
+
+  EXPECT_EQ(mesh_b->duplicate_of, (Geometry *)NULL);
+  EXPECT_EQ(object_a->get_render_geometry(), mesh_a);
+  EXPECT_EQ(object_b->get_geometry(), mesh_b);
+  EXPECT_EQ(object_b->get_render_geometry(), mesh_b);
+
+  /* Editing it back shares the mesh again. */
+  verts = triangle_verts(0.0f);
+  mesh_b->set_verts(verts);
+  mesh_b->tag_update(scene, true);
+
+  update();
+
+  EXPECT_EQ(mesh_b->duplicate_of, mesh_a);
+  EXPECT_EQ(object_b->get_render_geometry(), mesh_a);
+}
+
+TEST_F(RenderGeometryDeduplicate, shared_mesh_removed)
+{
+  Mesh *mesh_a = create_triangle();
+  Mesh *mesh_b = create_triangle();
+  Object *object_b = create_object(mesh_b);
+
+  update();
+
+  ASSERT_EQ(object_b->get_render_geometry(), mesh_a);
+
+  scene->delete_node(mesh_a);
+
+  update();
+
+  EXPECT_EQ(mesh_b->duplicate_of, (Geometry *)NULL);
+  EXPECT_EQ(object_b->get_render_geometry(), mesh_b);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_math.h"
+
+#include <random>
+
+CCL_NAMESPACE_BEGIN
+
+/* Largest distance between a unit vector and its decoded octahedral encoding, two 16 bit
+ * components are accurate to a few 1e-5. */
+static const float octahedral_epsilon = 1e-4f;
+
+static void expect_octahedral_round_trip(const float3 n)
+{
+  const float3 decoded = octahedral_to_float3(float3_to_octahedral(n));
+  EXPECT_NEAR(len(decoded), 1.0f, 1e-6f);
+  EXPECT_LT(len(decoded - n), octahedral_epsilon)
+      << "n = (" << n.x << ", " << n.y << ", " << n.z << "), decoded = (" << decoded.x << ", "
+      << decoded.y << ", " << decoded.z << ")";
+}
+
+TEST(util_math_float3, octahedral_axis_aligned)
+{
+  expect_octahedral_round_trip(make_float3(1.0f, 0.0f, 0.0f));
+  expect_octahedral_round_trip(make_float3(-1.0f, 0.0f, 0.0f));
+  expect_octahedral_round_trip(make_float3(0.0f, 1.0f, 0.0f));
+  expect_octahedral_round_trip(make_float3(0.0f, -1.0f, 0.0f));
+  expect_octahedral_round_trip(make_float3(0.0f, 0.0f, 1.0f));
+  /* Folded into the corners of the square. */
+  expect_octahedral_round_trip(make_float3(0.0f, 0.0f, -1.0f));
+}
+
+TEST(util_math_float3, octahedral_lower_hemisphere)
+{
+  /* The lower hemisphere is folded over the diagonals, the signs of x and y must survive. */
+  const float s = 1.0f / sqrtf(3.0f);
+  expect_octahedral_round_trip(make_float3(s, s, -s));
+  expect_octahedral_round_trip(make_float3(-s, s, -s));
+  expect_octahedral_round_trip(make_float3(s, -s, -s));
+  expect_octahedral_round_trip(make_float3(-s, -s, -s));
+
+  /* Close to the equator, where both halves meet. */
+  expect_octahedral_round_trip(normalize(make_float3(0.6f, -0.8f, -1e-4f)));
+  expect_octahedral_round_trip(normalize(make_float3(-0.6f, 0.8f, 1e-4f)));
+}
+
+TEST(util_math_float3, octahedral_random)
+{
+  /* Fixed seed, so failures can be reproduced. */
+  std::mt19937 rng(12345);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+  for (int i = 0; i < 10000; i++) {
+    /* Uniform on the sphere. */
+    const float z = 1.0f - 2.0f * distribution(rng);
+    const float phi = M_2PI_F * distribution(rng);
+    const float r = safe_sqrtf(1.0f - z * z);
+    expect_octahedral_round_trip(make_float3(r * cosf(phi), r * sinf(phi), z));
+  }
+}
+
+CCL_NAMESPACE_END
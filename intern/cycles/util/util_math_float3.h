@@ -533,6 +533,39 @@ ccl_device_inline float3 ensure_finite3(float3 v)
   return v;
 }
 
+/* Octahedral encoding of a unit vector into two 16 bit components, see "A Survey of Efficient
+ * Representations for Independent Unit Vectors" by Cigolle et al. */
+ccl_device_inline uint float3_to_octahedral(const float3 n)
+{
+  const float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+  float u = (l1 > 0.0f) ? n.x / l1 : 0.0f;
+  float v = (l1 > 0.0f) ? n.y / l1 : 0.0f;
+
+  if (n.z < 0.0f) {
+    const float fold_u = (1.0f - fabsf(v)) * signf(u);
+    v = (1.0f - fabsf(u)) * signf(v);
+    u = fold_u;
+  }
+
+  const uint qu = (uint)(clamp(u * 0.5f + 0.5f, 0.0f, 1.0f) * 65535.0f + 0.5f);
+  const uint qv = (uint)(clamp(v * 0.5f + 0.5f, 0.0f, 1.0f) * 65535.0f + 0.5f);
+  return qu | (qv << 16);
+}
+
+ccl_device_inline float3 octahedral_to_float3(const uint packed)
+{
+  const float u = (float)(packed & 0xFFFF) * (2.0f / 65535.0f) - 1.0f;
+  const float v = (float)(packed >> 16) * (2.0f / 65535.0f) - 1.0f;
+  float3 n = make_float3(u, v, 1.0f - fabsf(u) - fabsf(v));
+
+  if (n.z < 0.0f) {
+    n.x = (1.0f - fabsf(v)) * signf(u);
+    n.y = (1.0f - fabsf(u)) * signf(v);
+  }
+
+  return normalize(n);
+}
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_MATH_FLOAT3_H__ */
@@ -244,6 +244,23 @@ void MEM_enable_fail_on_memleak(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_lockfree_allocator(void);
 
+/* Make the lock-free allocator count allocations per thread.
+ *
+ * Instead of updating shared atomic counters on every allocation (which contends on one cache
+ * line when many threads allocate), each thread keeps its own counters which are only added to
+ * the shared ones every megabyte or so. Queries like #MEM_get_memory_in_use sum all threads and
+ * remain exact, the peak memory may lag behind by less than a megabyte per thread.
+ *
+ * With `use_thread_cache`, freed blocks up to 512 bytes are also kept in small per-thread caches
+ * for reuse, grouped in size classes of 16 bytes.
+ *
+ * Unlike switching the allocator type, this can be called at any time. */
+void MEM_use_lockfree_thread_local_stats(bool use_thread_cache);
+
+/* Go back to shared counters and no per-thread caches, undoing
+ * #MEM_use_lockfree_thread_local_stats. Counts stay exact. */
+void MEM_use_lockfree_shared_stats(void);
+
 /* Switch allocator to slow fully guarded mode.
  *
  * Use for debug purposes. This allocator contains lock section around every allocator call, which
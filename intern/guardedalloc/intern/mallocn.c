@@ -145,6 +145,16 @@ void MEM_use_lockfree_allocator(void)
 #endif
 }
 
+void MEM_use_lockfree_thread_local_stats(bool use_thread_cache)
+{
+  MEM_lockfree_use_thread_local_stats(use_thread_cache);
+}
+
+void MEM_use_lockfree_shared_stats(void)
+{
+  MEM_lockfree_use_shared_stats();
+}
+
 void MEM_use_guarded_allocator(void)
 {
   assert_for_allocator_change();
@@ -112,6 +112,22 @@ void aligned_free(void *ptr);
 extern bool leak_detector_has_run;
 extern char free_after_leak_detection_message[];
 
+/* Size classes of the thread local block caches, in steps of 16 bytes. */
+#define MEM_THREAD_CACHE_CLASS_SIZE 16
+#define MEM_THREAD_CACHE_CLASS_NUM 32
+#define MEM_THREAD_CACHE_MAX_LEN (MEM_THREAD_CACHE_CLASS_SIZE * MEM_THREAD_CACHE_CLASS_NUM)
+
+/* Memory usage counters (memory_usage.cc). */
+void memory_usage_use_local_counters(bool use_local_counters);
+void memory_usage_block_alloc(size_t size);
+void memory_usage_block_free(size_t size);
+size_t memory_usage_block_num(void);
+size_t memory_usage_current(void);
+size_t memory_usage_peak(void);
+void memory_usage_peak_reset(void);
+void *memory_usage_thread_cache_pop(int size_class);
+bool memory_usage_thread_cache_push(void *memh, int size_class);
+
 /* Prototypes for counted allocator functions */
 size_t MEM_lockfree_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
 void MEM_lockfree_freeN(void *vmemh);
@@ -151,6 +167,8 @@ size_t MEM_lockfree_get_memory_in_use(void);
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void);
 void MEM_lockfree_reset_peak_memory(void);
 size_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+void MEM_lockfree_use_thread_local_stats(bool use_cache);
+void MEM_lockfree_use_shared_stats(void);
 #ifndef NDEBUG
 const char *MEM_lockfree_name_ptr(void *vmemh);
 #endif
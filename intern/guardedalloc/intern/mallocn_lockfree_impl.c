@@ -20,6 +20,7 @@
  * Memory allocation which keeps track on allocated memory counters
  */
 
+#include <assert.h>
 #include <stdarg.h>
 #include <stdio.h> /* printf */
 #include <stdlib.h>
@@ -31,7 +32,6 @@
 /* to ensure strict conversions */
 #include "../../source/blender/blenlib/BLI_strict_flags.h"
 
-#include "atomic_ops.h"
 #include "mallocn_intern.h"
 
 typedef struct MemHead {
@@ -44,31 +44,62 @@ typedef struct MemHeadAligned {
   size_t len;
 } MemHeadAligned;
 
-static unsigned int totblock = 0;
-static size_t mem_in_use = 0, peak_mem = 0;
 static bool malloc_debug_memset = false;
+static bool use_thread_cache = false;
 
 static void (*error_callback)(const char *) = NULL;
 
 enum {
   MEMHEAD_ALIGN_FLAG = 1,
+  /* Block was allocated with the full length of its thread cache size class. */
+  MEMHEAD_CACHE_FLAG = 2,
 };
 
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_CACHED(memhead) ((memhead)->len & (size_t)MEMHEAD_CACHE_FLAG)
+#define MEMHEAD_FLAGS ((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_CACHE_FLAG))
 
-/* Uncomment this to have proper peak counter. */
-#define USE_ATOMIC_MAX
+MEM_INLINE int thread_cache_size_class(size_t len)
+{
+  return len ? (int)((len - 1) / MEM_THREAD_CACHE_CLASS_SIZE) : 0;
+}
 
-MEM_INLINE void update_maximum(size_t *maximum_value, size_t value)
+/**
+ * Allocate a block which is not aligned, from the thread cache when enabled and possible.
+ * \note The returned #MemHead has its length (and flags) set.
+ */
+static MemHead *memhead_alloc(size_t len, bool clear)
 {
-#ifdef USE_ATOMIC_MAX
-  atomic_fetch_and_update_max_z(maximum_value, value);
-#else
-  *maximum_value = value > *maximum_value ? value : *maximum_value;
-#endif
+  MemHead *memh;
+
+  if (use_thread_cache && len <= MEM_THREAD_CACHE_MAX_LEN) {
+    const int size_class = thread_cache_size_class(len);
+    const size_t class_len = (size_t)(size_class + 1) * MEM_THREAD_CACHE_CLASS_SIZE;
+
+    memh = (MemHead *)memory_usage_thread_cache_pop(size_class);
+    if (memh) {
+      if (clear) {
+        memset(memh + 1, 0, len);
+      }
+    }
+    else {
+      memh = (MemHead *)(clear ? calloc(1, class_len + sizeof(MemHead)) :
+                                 malloc(class_len + sizeof(MemHead)));
+    }
+    if (LIKELY(memh)) {
+      memh->len = len | (size_t)MEMHEAD_CACHE_FLAG;
+    }
+    return memh;
+  }
+
+  memh = (MemHead *)(clear ? calloc(1, len + sizeof(MemHead)) : malloc(len + sizeof(MemHead)));
+  if (LIKELY(memh)) {
+    memh->len = len;
+  }
+  return memh;
 }
 
 #ifdef __GNUC__
@@ -93,7 +124,7 @@ print_error(const char *str, ...)
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
   if (vmemh) {
-    return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG));
+    return MEMHEAD_FROM_PTR(vmemh)->len & ~MEMHEAD_FLAGS;
   }
 
   return 0;
@@ -116,8 +147,7 @@ void MEM_lockfree_freeN(void *vmemh)
     return;
   }
 
-  atomic_sub_and_fetch_u(&totblock, 1);
-  atomic_sub_and_fetch_z(&mem_in_use, len);
+  memory_usage_block_free(len);
 
   if (UNLIKELY(malloc_debug_memset && len)) {
     memset(memh + 1, 255, len);
@@ -126,6 +156,10 @@ void MEM_lockfree_freeN(void *vmemh)
     MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
     aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
   }
+  else if (MEMHEAD_IS_CACHED(memh) && use_thread_cache &&
+           memory_usage_thread_cache_push(memh, thread_cache_size_class(len))) {
+    /* Kept for reuse by this thread. */
+  }
   else {
     free(memh);
   }
@@ -233,20 +267,17 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+  memh = memhead_alloc(len, true);
 
   if (LIKELY(memh)) {
-    memh->len = len;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)memory_usage_current());
   return NULL;
 }
 
@@ -260,7 +291,7 @@ void *MEM_lockfree_calloc_arrayN(size_t len, size_t size, const char *str)
         SIZET_ARG(len),
         SIZET_ARG(size),
         str,
-        (unsigned int)mem_in_use);
+        (unsigned int)memory_usage_current());
     abort();
     return NULL;
   }
@@ -274,24 +305,21 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)malloc(len + sizeof(MemHead));
+  memh = memhead_alloc(len, false);
 
   if (LIKELY(memh)) {
     if (UNLIKELY(malloc_debug_memset && len)) {
       memset(memh + 1, 255, len);
     }
 
-    memh->len = len;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)memory_usage_current());
   return NULL;
 }
 
@@ -305,7 +333,7 @@ void *MEM_lockfree_malloc_arrayN(size_t len, size_t size, const char *str)
         SIZET_ARG(len),
         SIZET_ARG(size),
         str,
-        (unsigned int)mem_in_use);
+        (unsigned int)memory_usage_current());
     abort();
     return NULL;
   }
@@ -353,16 +381,14 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 
     memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
     memh->alignment = (short)alignment;
-    atomic_add_and_fetch_u(&totblock, 1);
-    atomic_add_and_fetch_z(&mem_in_use, len);
-    update_maximum(&peak_mem, mem_in_use);
+    memory_usage_block_alloc(len);
 
     return PTR_FROM_MEMHEAD(memh);
   }
   print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
               SIZET_ARG(len),
               str,
-              (unsigned int)mem_in_use);
+              (unsigned int)memory_usage_current());
   return NULL;
 }
 
@@ -382,8 +408,9 @@ void MEM_lockfree_callbackmemlist(void (*func)(void *))
 
 void MEM_lockfree_printmemlist_stats(void)
 {
-  printf("\ntotal memory len: %.3f MB\n", (double)mem_in_use / (double)(1024 * 1024));
-  printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)memory_usage_current() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n", (double)memory_usage_peak() / (double)(1024 * 1024));
   printf(
       "\nFor more detailed per-block statistics run Blender with memory debugging command line "
       "argument.\n");
@@ -411,23 +438,37 @@ void MEM_lockfree_set_memory_debug(void)
 
 size_t MEM_lockfree_get_memory_in_use(void)
 {
-  return mem_in_use;
+  return memory_usage_current();
 }
 
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 {
-  return totblock;
+  return (unsigned int)memory_usage_block_num();
 }
 
 /* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
-  peak_mem = mem_in_use;
+  memory_usage_peak_reset();
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
 {
-  return peak_mem;
+  return memory_usage_peak();
+}
+
+void MEM_lockfree_use_thread_local_stats(bool use_cache)
+{
+  memory_usage_use_local_counters(true);
+  use_thread_cache = use_cache;
+}
+
+void MEM_lockfree_use_shared_stats(void)
+{
+  /* Pending changes of threads are still summed by the queries, blocks flagged as cached are
+   * freed normally from now on. */
+  use_thread_cache = false;
+  memory_usage_use_local_counters(false);
 }
 
 #ifndef NDEBUG
@@ -0,0 +1,282 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup MEM
+ *
+ * Memory usage counters of the lock-free allocator.
+ *
+ * By default every allocation updates global atomic counters. With thread local counters
+ * enabled, each thread accumulates the change it caused in its own counters and only adds them
+ * to the global ones once they grow larger than a threshold (or the thread exits). Queries sum
+ * the global counters and the pending changes of all threads, so they stay exact.
+ *
+ * Threads also own caches of recently freed small blocks, grouped by size class.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#include "MEM_guardedalloc.h"
+#include "mallocn_intern.h"
+
+namespace {
+
+/** Pending changes are added to the global counters once they exceed this many bytes. */
+constexpr int64_t flush_threshold_bytes = 1024 * 1024;
+
+/** Cached blocks per size class and thread. */
+constexpr int thread_cache_blocks_max = 64;
+
+struct Local;
+
+/** Set once the thread local counters are gone, e.g. for frees from static destructors. */
+thread_local bool local_is_destroyed = false;
+
+/** Cached blocks are linked through the first bytes of their data, after the #MemHead. */
+void **cache_link(void *memh)
+{
+  return (void **)((char *)memh + MEM_SIZE_OVERHEAD);
+}
+
+/**
+ * Never destructed, threads may still exit (and flush their counters) while static
+ * variables are destructed.
+ */
+struct Global {
+  std::mutex mutex;
+  /** All threads with counters, protected by #mutex. */
+  Local *locals = nullptr;
+
+  std::atomic<int64_t> blocks_num = 0;
+  std::atomic<int64_t> mem_in_use = 0;
+  std::atomic<int64_t> peak = 0;
+
+  std::atomic<bool> use_local_counters = false;
+};
+
+Global &get_global()
+{
+  /* Placement new in static storage: a plain `new` goes through the guarded `operator new`
+   * (with WITH_CXX_GUARDEDALLOC), which would call back into this function while the static is
+   * still being initialized. */
+  alignas(Global) static char global_buffer[sizeof(Global)];
+  static Global *global = new (global_buffer) Global();
+  return *global;
+}
+
+struct Local {
+  Local *prev = nullptr;
+  Local *next = nullptr;
+
+  /* Only written by the owning thread, read by any thread while holding the global mutex. */
+  std::atomic<int64_t> blocks_num = 0;
+  std::atomic<int64_t> mem_in_use = 0;
+
+  /** Singly linked lists of cached blocks, linked through the first bytes of their data. */
+  void *cache[MEM_THREAD_CACHE_CLASS_NUM] = {nullptr};
+  int cache_len[MEM_THREAD_CACHE_CLASS_NUM] = {0};
+
+  Local()
+  {
+    Global &global = get_global();
+    std::lock_guard<std::mutex> lock(global.mutex);
+    next = global.locals;
+    if (next) {
+      next->prev = this;
+    }
+    global.locals = this;
+  }
+
+  ~Local()
+  {
+    Global &global = get_global();
+    local_is_destroyed = true;
+    {
+      std::lock_guard<std::mutex> lock(global.mutex);
+      this->flush_locked(global);
+      if (prev) {
+        prev->next = next;
+      }
+      else {
+        global.locals = next;
+      }
+      if (next) {
+        next->prev = prev;
+      }
+    }
+
+    /* Cached blocks were already counted as freed. */
+    for (int i = 0; i < MEM_THREAD_CACHE_CLASS_NUM; i++) {
+      while (cache[i]) {
+        void *memh = cache[i];
+        cache[i] = *cache_link(memh);
+        free(memh);
+      }
+    }
+  }
+
+  void flush_locked(Global &global)
+  {
+    global.blocks_num.fetch_add(blocks_num.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    const int64_t mem_in_use_new = global.mem_in_use.fetch_add(
+                                       mem_in_use.load(std::memory_order_relaxed),
+                                       std::memory_order_relaxed) +
+                                   mem_in_use.load(std::memory_order_relaxed);
+    blocks_num.store(0, std::memory_order_relaxed);
+    mem_in_use.store(0, std::memory_order_relaxed);
+    update_peak(global, mem_in_use_new);
+  }
+
+  void add(Global &global, int64_t blocks, int64_t size)
+  {
+    /* Single writer, plain read-modify-write without a locked instruction. */
+    blocks_num.store(blocks_num.load(std::memory_order_relaxed) + blocks,
+                     std::memory_order_relaxed);
+    const int64_t mem_in_use_new = mem_in_use.load(std::memory_order_relaxed) + size;
+    mem_in_use.store(mem_in_use_new, std::memory_order_relaxed);
+
+    if (mem_in_use_new > flush_threshold_bytes || mem_in_use_new < -flush_threshold_bytes) {
+      std::lock_guard<std::mutex> lock(global.mutex);
+      this->flush_locked(global);
+    }
+  }
+
+  static void update_peak(Global &global, int64_t value)
+  {
+    int64_t peak = global.peak.load(std::memory_order_relaxed);
+    while (value > peak && !global.peak.compare_exchange_weak(peak, value)) {
+      /* pass */
+    }
+  }
+};
+
+Local *get_local()
+{
+  if (local_is_destroyed) {
+    return nullptr;
+  }
+  static thread_local Local local;
+  return &local;
+}
+
+}  // namespace
+
+void memory_usage_use_local_counters(bool use_local_counters)
+{
+  get_global().use_local_counters.store(use_local_counters, std::memory_order_relaxed);
+}
+
+void memory_usage_block_alloc(size_t size)
+{
+  Global &global = get_global();
+  if (global.use_local_counters.load(std::memory_order_relaxed)) {
+    if (Local *local = get_local()) {
+      local->add(global, 1, (int64_t)size);
+      return;
+    }
+  }
+  global.blocks_num.fetch_add(1, std::memory_order_relaxed);
+  const int64_t mem_in_use_new = global.mem_in_use.fetch_add((int64_t)size,
+                                                             std::memory_order_relaxed) +
+                                 (int64_t)size;
+  Local::update_peak(global, mem_in_use_new);
+}
+
+void memory_usage_block_free(size_t size)
+{
+  Global &global = get_global();
+  if (global.use_local_counters.load(std::memory_order_relaxed)) {
+    if (Local *local = get_local()) {
+      local->add(global, -1, -(int64_t)size);
+      return;
+    }
+  }
+  global.blocks_num.fetch_sub(1, std::memory_order_relaxed);
+  global.mem_in_use.fetch_sub((int64_t)size, std::memory_order_relaxed);
+}
+
+static void memory_usage_sum(int64_t *r_blocks_num, int64_t *r_mem_in_use)
+{
+  Global &global = get_global();
+  std::lock_guard<std::mutex> lock(global.mutex);
+  int64_t blocks_num = global.blocks_num.load(std::memory_order_relaxed);
+  int64_t mem_in_use = global.mem_in_use.load(std::memory_order_relaxed);
+  for (Local *local = global.locals; local; local = local->next) {
+    blocks_num += local->blocks_num.load(std::memory_order_relaxed);
+    mem_in_use += local->mem_in_use.load(std::memory_order_relaxed);
+  }
+  *r_blocks_num = blocks_num;
+  *r_mem_in_use = mem_in_use;
+}
+
+size_t memory_usage_block_num(void)
+{
+  int64_t blocks_num, mem_in_use;
+  memory_usage_sum(&blocks_num, &mem_in_use);
+  return (size_t)std::max<int64_t>(blocks_num, 0);
+}
+
+size_t memory_usage_current(void)
+{
+  int64_t blocks_num, mem_in_use;
+  memory_usage_sum(&blocks_num, &mem_in_use);
+  return (size_t)std::max<int64_t>(mem_in_use, 0);
+}
+
+size_t memory_usage_peak(void)
+{
+  /* Pending changes are not part of the peak yet, the current usage may be above it. */
+  Global &global = get_global();
+  const size_t current = memory_usage_current();
+  Local::update_peak(global, (int64_t)current);
+  return (size_t)global.peak.load(std::memory_order_relaxed);
+}
+
+void memory_usage_peak_reset(void)
+{
+  get_global().peak.store((int64_t)memory_usage_current(), std::memory_order_relaxed);
+}
+
+void *memory_usage_thread_cache_pop(int size_class)
+{
+  Local *local = get_local();
+  if (local == nullptr) {
+    return nullptr;
+  }
+  void *memh = local->cache[size_class];
+  if (memh) {
+    local->cache[size_class] = *cache_link(memh);
+    local->cache_len[size_class]--;
+  }
+  return memh;
+}
+
+bool memory_usage_thread_cache_push(void *memh, int size_class)
+{
+  Local *local = get_local();
+  if (local == nullptr || local->cache_len[size_class] >= thread_cache_blocks_max) {
+    return false;
+  }
+  *cache_link(memh) = local->cache[size_class];
+  local->cache[size_class] = memh;
+  local->cache_len[size_class]++;
+  return true;
+}
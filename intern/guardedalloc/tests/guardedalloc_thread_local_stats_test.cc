@@ -0,0 +1,85 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "guardedalloc_test_base.h"
+
+namespace {
+
+constexpr int threads_num = 4;
+constexpr int blocks_per_thread = 4096;
+
+/* Deterministic mix of small (thread cached) and larger blocks. */
+size_t block_size(int thread, int i)
+{
+  return (i % 7 == 0) ? 1000 + (size_t)thread : 8 + (size_t)(i % 61) * 8;
+}
+
+}  // namespace
+
+TEST_F(LockFreeAllocatorTest, MEM_use_lockfree_thread_local_stats)
+{
+  MEM_use_lockfree_thread_local_stats(true);
+
+  const unsigned int blocks_start = MEM_get_memory_blocks_in_use();
+  const size_t mem_start = MEM_get_memory_in_use();
+
+  size_t mem_expected = 0;
+  for (int thread = 0; thread < threads_num; thread++) {
+    for (int i = 0; i < blocks_per_thread; i++) {
+      mem_expected += (block_size(thread, i) + 3) & ~(size_t)3;
+    }
+  }
+
+  std::vector<std::vector<void *>> blocks(threads_num);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < threads_num; thread++) {
+    threads.emplace_back([thread, &blocks]() {
+      for (int i = 0; i < blocks_per_thread; i++) {
+        /* Allocate and free some blocks first, so later ones come from the cache. */
+        void *tmp = MEM_mallocN(block_size(thread, i), __func__);
+        memset(tmp, 0xff, block_size(thread, i));
+        MEM_freeN(tmp);
+      }
+      for (int i = 0; i < blocks_per_thread; i++) {
+        char *data = (char *)MEM_callocN(block_size(thread, i), __func__);
+        for (size_t j = 0; j < block_size(thread, i); j++) {
+          EXPECT_EQ(data[j], 0);
+        }
+        blocks[thread].push_back(data);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  /* Counters of exited threads and of the still running main thread are all included. */
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_start + threads_num * blocks_per_thread);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_start + mem_expected);
+  EXPECT_GE(MEM_get_peak_memory(), mem_start + mem_expected);
+
+  /* Free from another thread than the one which allocated. */
+  for (std::vector<void *> &thread_blocks : blocks) {
+    for (void *data : thread_blocks) {
+      MEM_freeN(data);
+    }
+  }
+
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_start);
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_start);
+
+  /* Other tests expect the shared counters of the default configuration. */
+  MEM_use_lockfree_shared_stats();
+
+  void *data = MEM_mallocN(16, __func__);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_start + 1);
+  MEM_freeN(data);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_start);
+}
@@ -468,6 +468,10 @@ class TOPBAR_MT_file_import(Menu):
                                  text="Collada (Default) (.dae)")
         if bpy.app.build_options.alembic:
             self.layout.operator("wm.alembic_import", text="Alembic (.abc)")
+        if bpy.app.build_options.usd:
+            self.layout.operator(
+                "wm.usd_import", text="Universal Scene Description (.usd, .usdc, .usda)")
+        self.layout.operator("wm.obj_import", text="Wavefront (.obj) (experimental)")
 
         self.layout.operator("wm.gpencil_import_svg", text="SVG as Grease Pencil")
 
@@ -486,6 +490,7 @@ class TOPBAR_MT_file_export(Menu):
         if bpy.app.build_options.usd:
             self.layout.operator(
                 "wm.usd_export", text="Universal Scene Description (.usd, .usdc, .usda)")
+        self.layout.operator("wm.obj_export", text="Wavefront (.obj) (experimental)")
 
         # Pugixml lib dependency
         if bpy.app.build_options.pugixml:
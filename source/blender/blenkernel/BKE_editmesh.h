@@ -82,6 +82,19 @@ typedef struct BMEditMesh {
    */
   char needs_flush_to_id;
 
+  /**
+   * Identifies the mesh undo step this edit-mesh matches (zero when unknown),
+   * set by the undo system when encoding & decoding steps.
+   */
+  int undo_partial_state_id;
+  /**
+   * Sorted vertex indices, when set these are the only vertices modified since the
+   * undo step identified by `undo_partial_state_id` (only coordinates & normals may change).
+   * This allows the next undo push to store only these vertices.
+   */
+  int *undo_partial_verts;
+  int undo_partial_verts_len;
+
 } BMEditMesh;
 
 /* editmesh.c */
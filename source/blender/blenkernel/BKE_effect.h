@@ -56,6 +56,10 @@ typedef struct EffectedPoint {
   int index;
 
   struct ParticleSystem *psys; /* particle system the point belongs to */
+
+  /* Random numbers for effector noise, for points evaluated from multiple threads.
+   * When NULL, the shared generator of each effector is used. */
+  struct RNG *rng;
 } EffectedPoint;
 
 typedef struct GuideEffectorData {
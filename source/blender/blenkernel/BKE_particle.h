@@ -96,6 +96,9 @@ typedef struct ParticleSimulationData {
   float courant_num;
   /* Only valid during dynamics_step(). */
   struct RNG *rng;
+  /* Random numbers for effector noise of a particle stepped on its own thread, see
+   * #EffectedPoint.rng. Only set by the threaded Newtonian step. */
+  struct RNG *effector_rng;
 } ParticleSimulationData;
 
 typedef struct SPHData {
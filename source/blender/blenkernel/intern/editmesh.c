@@ -69,6 +69,11 @@ BMEditMesh *BKE_editmesh_copy(BMEditMesh *em)
    * tessellation only when/if that copy ends up getting used. */
   em_copy->looptris = NULL;
 
+  /* Undo hints only apply to the original. */
+  em_copy->undo_partial_state_id = 0;
+  em_copy->undo_partial_verts = NULL;
+  em_copy->undo_partial_verts_len = 0;
+
   /* Copy various settings. */
   em_copy->selectmode = em->selectmode;
   em_copy->mat_nr = em->mat_nr;
@@ -179,6 +184,8 @@ void BKE_editmesh_free(BMEditMesh *em)
     MEM_freeN(em->looptris);
   }
 
+  MEM_SAFE_FREE(em->undo_partial_verts);
+
   if (em->bm) {
     BM_mesh_free(em->bm);
   }
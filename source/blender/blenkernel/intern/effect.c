@@ -433,6 +433,7 @@ void pd_point_from_particle(ParticleSimulationData *sim,
   }
 
   point->psys = sim->psys;
+  point->rng = NULL;
 }
 
 void pd_point_from_loc(Scene *scene, float *loc, float *vel, int index, EffectedPoint *point)
@@ -449,6 +450,7 @@ void pd_point_from_loc(Scene *scene, float *loc, float *vel, int index, Effected
 
   point->ave = point->rot = NULL;
   point->psys = NULL;
+  point->rng = NULL;
 }
 void pd_point_from_soft(Scene *scene, float *loc, float *vel, int index, EffectedPoint *point)
 {
@@ -465,6 +467,7 @@ void pd_point_from_soft(Scene *scene, float *loc, float *vel, int index, Effecte
   point->ave = point->rot = NULL;
 
   point->psys = NULL;
+  point->rng = NULL;
 }
 /************************************************/
 /*          Effectors       */
@@ -974,7 +977,7 @@ static void do_physical_effector(EffectorCache *eff,
                                  float *total_force)
 {
   PartDeflect *pd = eff->pd;
-  RNG *rng = pd->rng;
+  RNG *rng = point->rng ? point->rng : pd->rng;
   float force[3] = {0, 0, 0};
   float temp[3];
   float fac;
@@ -811,12 +811,10 @@ static void exec_distribute_child(TaskPool *__restrict UNUSED(pool), void *taskd
   int p;
 
   /* RNG skipping at the beginning */
-  cpa = psys->child;
-  for (p = 0; p < task->begin; p++, cpa++) {
-    BLI_rng_skip(task->rng, PSYS_RND_DIST_SKIP);
-  }
+  BLI_rng_skip(task->rng, PSYS_RND_DIST_SKIP * task->begin);
 
-  for (; p < task->end; p++, cpa++) {
+  cpa = psys->child + task->begin;
+  for (p = task->begin; p < task->end; p++, cpa++) {
     distribute_children_exec(task, cpa, p);
   }
 }
@@ -878,6 +876,53 @@ static void distribute_invalid(ParticleSimulationData *sim, int from)
 }
 
 /* Creates a distribution of coordinates on a Mesh */
+/* Number of particles drawing their element in one go, see #distribute_random_elements_chunk_cb. */
+#define PSYS_DISTRIBUTE_CHUNK_SIZE 4096
+
+typedef struct DistributeRandomElementsData {
+  /** Random number sequence all particles draw from, one value each, in order. */
+  RNG *rng;
+  const float *element_sum;
+  const int *element_map;
+  int totmapped;
+  int totpart;
+
+  int *particle_element;
+  float *particle_pos;
+} DistributeRandomElementsData;
+
+/**
+ * Random element assignment for a fixed range of particles.
+ * Each chunk jumps ahead in the shared random sequence, so the result is the same as
+ * drawing all values in order on one thread.
+ */
+static void distribute_random_elements_chunk_cb(void *__restrict userdata,
+                                                const int chunk,
+                                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DistributeRandomElementsData *data = userdata;
+  const float *element_sum = data->element_sum;
+  const int totmapped = data->totmapped;
+  const int start = chunk * PSYS_DISTRIBUTE_CHUNK_SIZE;
+  const int end = min_ii(start + PSYS_DISTRIBUTE_CHUNK_SIZE, data->totpart);
+
+  RNG *rng = BLI_rng_copy(data->rng);
+  BLI_rng_skip(rng, start);
+
+  for (int p = start; p < end; p++) {
+    /* In theory element_sum[totmapped - 1] should be 1.0,
+     * but due to float errors this is not necessarily always true, so scale pos accordingly. */
+    const float pos = BLI_rng_get_float(rng) * element_sum[totmapped - 1];
+    const int eidx = distribute_binary_search(element_sum, totmapped, pos);
+    data->particle_element[p] = data->element_map[eidx];
+    BLI_assert(pos <= element_sum[eidx]);
+    BLI_assert(eidx ? (pos > element_sum[eidx - 1]) : (pos >= 0.0f));
+    data->particle_pos[p] = pos;
+  }
+
+  BLI_rng_free(rng);
+}
+
 static int psys_thread_context_init_distribute(ParticleThreadContext *ctx,
                                                ParticleSimulationData *sim,
                                                int from)
@@ -1194,16 +1239,31 @@ static int psys_thread_context_init_distribute(ParticleThreadContext *ctx,
 
   /* Finally assign elements to particles */
   if (part->flag & PART_TRAND) {
+    float *particle_pos = MEM_mallocN(sizeof(*particle_pos) * totpart, __func__);
+    DistributeRandomElementsData random_data = {
+        .rng = rng,
+        .element_sum = element_sum,
+        .element_map = element_map,
+        .totmapped = totmapped,
+        .totpart = totpart,
+        .particle_element = particle_element,
+        .particle_pos = particle_pos,
+    };
+    const int totchunk = (totpart + PSYS_DISTRIBUTE_CHUNK_SIZE - 1) / PSYS_DISTRIBUTE_CHUNK_SIZE;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (totchunk > 1);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(
+        0, totchunk, &random_data, distribute_random_elements_chunk_cb, &settings);
+    BLI_rng_skip(rng, totpart);
+
+    /* Several particles can land in the same element, the last one wins as before. */
     for (p = 0; p < totpart; p++) {
-      /* In theory element_sum[totmapped - 1] should be 1.0,
-       * but due to float errors this is not necessarily always true, so scale pos accordingly. */
-      const float pos = BLI_rng_get_float(rng) * element_sum[totmapped - 1];
-      const int eidx = distribute_binary_search(element_sum, totmapped, pos);
-      particle_element[p] = element_map[eidx];
-      BLI_assert(pos <= element_sum[eidx]);
-      BLI_assert(eidx ? (pos > element_sum[eidx - 1]) : (pos >= 0.0f));
-      jitter_offset[particle_element[p]] = pos;
+      jitter_offset[particle_element[p]] = particle_pos[p];
     }
+    MEM_freeN(particle_pos);
   }
   else {
     double step, pos;
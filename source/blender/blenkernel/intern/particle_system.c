@@ -459,6 +459,10 @@ void psys_calc_dmcache(Object *ob, Mesh *mesh_final, Mesh *mesh_original, Partic
 }
 
 /* threaded child particle distribution and path caching */
+
+/* Upper bound of particles handled by one task of #psys_tasks_create. */
+#define PSYS_TASK_MAX_PARTICLES 16384
+
 void psys_thread_context_init(ParticleThreadContext *ctx, ParticleSimulationData *sim)
 {
   memset(ctx, 0, sizeof(ParticleThreadContext));
@@ -474,7 +478,12 @@ void psys_tasks_create(ParticleThreadContext *ctx,
                        int *r_numtasks)
 {
   ParticleTask *tasks;
-  int numtasks = min_ii(BLI_system_thread_count() * 4, endpart - startpart);
+  /* A few tasks per thread, but keep them small enough to balance uneven work
+   * (e.g. kinked or clumped children next to plain ones) for very large counts. */
+  const int totpart = endpart - startpart;
+  int numtasks = min_ii(max_ii(BLI_system_thread_count() * 4,
+                               (totpart + PSYS_TASK_MAX_PARTICLES - 1) / PSYS_TASK_MAX_PARTICLES),
+                        totpart);
   int particles_per_task = numtasks > 0 ? (endpart - startpart) / numtasks : 0;
   int remainder = numtasks > 0 ? (endpart - startpart) - particles_per_task * numtasks : 0;
 
@@ -2247,6 +2256,7 @@ static void basic_force_cb(void *efdata_v, ParticleKey *state, float *force, flo
 
   /* add effectors */
   pd_point_from_particle(efdata->sim, efdata->pa, state, &epoint);
+  epoint.rng = sim->effector_rng;
   if (part->type != PART_HAIR || part->effector_weights->flag & EFF_WEIGHT_DO_HAIR) {
     BKE_effectors_apply(sim->psys->effectors,
                         sim->colliders,
@@ -3694,8 +3704,63 @@ typedef struct DynamicStepSolverTaskData {
   float dtime;
 
   SpinLock spin;
+
+  /** Base seed of the per particle random numbers (Newtonian physics only). */
+  uint rng_seed;
 } DynamicStepSolverTaskData;
 
+typedef struct DynamicStepNewtonTLS {
+  /** Created on first use, re-seeded for every particle. */
+  RNG *rng;
+} DynamicStepNewtonTLS;
+
+static void dynamics_step_newton_task_cb_ex(void *__restrict userdata,
+                                            const int p,
+                                            const TaskParallelTLS *__restrict tls)
+{
+  DynamicStepSolverTaskData *data = userdata;
+  DynamicStepNewtonTLS *newton_tls = tls->userdata_chunk;
+  ParticleSystem *psys = data->sim->psys;
+  ParticleSettings *part = psys->part;
+  ParticleData *pa;
+
+  if ((pa = psys->particles + p)->state.time <= 0.0f) {
+    return;
+  }
+
+  /* Brownian motion, collision permeability and effector noise draw random numbers, seed them
+   * per particle so the result doesn't depend on how particles are split between threads. */
+  if (newton_tls->rng == NULL) {
+    newton_tls->rng = BLI_rng_new(0);
+  }
+  BLI_rng_srandom(newton_tls->rng, data->rng_seed + (uint)p);
+
+  ParticleSimulationData sim = *data->sim;
+  sim.rng = newton_tls->rng;
+  sim.effector_rng = newton_tls->rng;
+
+  /* do global forces & effectors */
+  basic_integrate(&sim, p, pa->state.time, data->cfra);
+
+  /* deflection */
+  if (sim.colliders) {
+    collision_check(&sim, p, pa->state.time, data->cfra);
+  }
+
+  /* rotations */
+  basic_rotate(part, pa, pa->state.time, data->timestep);
+}
+
+static void dynamics_step_newton_free(const void *__restrict UNUSED(userdata),
+                                      void *__restrict chunk)
+{
+  DynamicStepNewtonTLS *newton_tls = chunk;
+  if (newton_tls->rng) {
+    BLI_rng_free(newton_tls->rng);
+    newton_tls->rng = NULL;
+  }
+}
+
 static void dynamics_step_sphdata_reduce(const void *__restrict UNUSED(userdata),
                                          void *__restrict join_v,
                                          void *__restrict chunk_v)
@@ -3944,19 +4009,23 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 
   switch (part->phystype) {
     case PART_PHYS_NEWTON: {
-      LOOP_DYNAMIC_PARTICLES
-      {
-        /* do global forces & effectors */
-        basic_integrate(sim, p, pa->state.time, cfra);
-
-        /* deflection */
-        if (sim->colliders) {
-          collision_check(sim, p, pa->state.time, cfra);
-        }
-
-        /* rotations */
-        basic_rotate(part, pa, pa->state.time, timestep);
-      }
+      DynamicStepSolverTaskData task_data = {
+          .sim = sim,
+          .cfra = cfra,
+          .timestep = timestep,
+          .dtime = dtime,
+          .rng_seed = 31415926 + (uint)cfra + (uint)psys->seed,
+      };
+      DynamicStepNewtonTLS newton_tls = {NULL};
+
+      TaskParallelSettings settings;
+      BLI_parallel_range_settings_defaults(&settings);
+      settings.use_threading = (psys->totpart > 100);
+      settings.userdata_chunk = &newton_tls;
+      settings.userdata_chunk_size = sizeof(newton_tls);
+      settings.func_free = dynamics_step_newton_free;
+      BLI_task_parallel_range(
+          0, psys->totpart, &task_data, dynamics_step_newton_task_cb_ex, &settings);
       break;
     }
     case PART_PHYS_BOIDS: {
@@ -40,6 +40,11 @@ BArrayState *BLI_array_store_state_add(BArrayStore *bs,
                                        const void *data,
                                        const size_t data_len,
                                        const BArrayState *state_reference);
+BArrayState *BLI_array_store_state_add_patched(BArrayStore *bs,
+                                               const BArrayState *state_reference,
+                                               const unsigned int *patch_index,
+                                               const void *patch_data,
+                                               const size_t patch_len);
 void BLI_array_store_state_remove(BArrayStore *bs, BArrayState *state);
 
 size_t BLI_array_store_state_size_get(BArrayState *state);
@@ -49,6 +49,15 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
 
 void *BLI_mmap_get_pointer(BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 
+/* Hints that length bytes at the given offset will be read soon, so the OS can read them
+ * from disk in large requests instead of one page fault at a time. */
+void BLI_mmap_prefetch(BLI_mmap_file *file, size_t offset, size_t length) ATTR_NONNULL(1);
+
+/* Returns whether an IO error occurred while accessing the mapped memory, needs to be checked
+ * after reading from the pointer returned by BLI_mmap_get_pointer. On Windows, errors are only
+ * detected by BLI_mmap_read. */
+bool BLI_mmap_any_io_error(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+
 void BLI_mmap_free(BLI_mmap_file *file) ATTR_NONNULL(1);
 
 #ifdef __cplusplus
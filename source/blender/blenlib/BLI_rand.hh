@@ -123,22 +123,18 @@ class RandomNumberGenerator {
 
   /**
    * Simulate getting \a n random values.
+   * Runs in logarithmic time, so threads can cheaply jump to the values of their own range.
    */
-  void skip(int64_t n)
-  {
-    while (n--) {
-      this->step();
-    }
-  }
+  void skip(int64_t n);
 
  private:
+  static constexpr uint64_t multiplier_ = 0x5DEECE66Dll;
+  static constexpr uint64_t addend_ = 0xB;
+  static constexpr uint64_t mask_ = 0x0000FFFFFFFFFFFFll;
+
   void step()
   {
-    constexpr uint64_t multiplier = 0x5DEECE66Dll;
-    constexpr uint64_t addend = 0xB;
-    constexpr uint64_t mask = 0x0000FFFFFFFFFFFFll;
-
-    x_ = (multiplier * x_ + addend) & mask;
+    x_ = (multiplier_ * x_ + addend_) & mask_;
   }
 };
 
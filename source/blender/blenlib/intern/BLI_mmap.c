@@ -24,6 +24,7 @@
 #include "BLI_mmap.h"
 #include "BLI_fileops.h"
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"
 
 #include <string.h>
@@ -73,6 +74,11 @@ static struct error_handler_data {
   void (*next_handler)(int, siginfo_t *, void *);
 } error_handler = {0};
 
+/* Files may be opened and closed from multiple threads (e.g. when reading libraries in
+ * parallel). Protects configuring the handler and changing the list of files. The handler itself
+ * can't lock, it reads the list as is. */
+static ThreadMutex error_handler_lock = BLI_MUTEX_INITIALIZER;
+
 static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 {
   /* We only handle SIGBUS here for now. */
@@ -111,6 +117,7 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 /* Ensures that the error handler is set up and ready. */
 static bool sigbus_handler_setup(void)
 {
+  BLI_mutex_lock(&error_handler_lock);
   if (!error_handler.configured) {
     struct sigaction newact = {0}, oldact = {0};
 
@@ -118,6 +125,7 @@ static bool sigbus_handler_setup(void)
     newact.sa_flags = SA_SIGINFO;
 
     if (sigaction(SIGBUS, &newact, &oldact)) {
+      BLI_mutex_unlock(&error_handler_lock);
       return false;
     }
 
@@ -126,6 +134,7 @@ static bool sigbus_handler_setup(void)
     error_handler.next_handler = oldact.sa_sigaction;
     error_handler.configured = 1;
   }
+  BLI_mutex_unlock(&error_handler_lock);
 
   return true;
 }
@@ -133,14 +142,20 @@ static bool sigbus_handler_setup(void)
 /* Adds a file to the list that the error handler checks. */
 static void sigbus_handler_add(BLI_mmap_file *file)
 {
-  BLI_addtail(&error_handler.open_mmaps, BLI_genericNodeN(file));
+  LinkData *link = BLI_genericNodeN(file);
+  BLI_mutex_lock(&error_handler_lock);
+  BLI_addtail(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&error_handler_lock);
 }
 
 /* Removes a file from the list that the error handler checks. */
 static void sigbus_handler_remove(BLI_mmap_file *file)
 {
+  BLI_mutex_lock(&error_handler_lock);
   LinkData *link = BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data));
-  BLI_freelinkN(&error_handler.open_mmaps, link);
+  BLI_remlink(&error_handler.open_mmaps, link);
+  BLI_mutex_unlock(&error_handler_lock);
+  MEM_freeN(link);
 }
 #endif
 
@@ -223,6 +238,29 @@ void *BLI_mmap_get_pointer(BLI_mmap_file *file)
   return file->memory;
 }
 
+void BLI_mmap_prefetch(BLI_mmap_file *file, size_t offset, size_t length)
+{
+  if (file->io_error || offset >= file->length) {
+    return;
+  }
+  length = MIN2(length, file->length - offset);
+
+#ifndef WIN32
+  /* The advised range has to start at a page boundary, the mapping itself does. */
+  const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t offset_page = offset - (offset % page_size);
+  madvise(file->memory + offset_page, length + (offset - offset_page), MADV_WILLNEED);
+#else
+  /* Not supported, pages are read as they are accessed. */
+  UNUSED_VARS(length);
+#endif
+}
+
+bool BLI_mmap_any_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error;
+}
+
 void BLI_mmap_free(BLI_mmap_file *file)
 {
 #ifndef WIN32
@@ -1601,6 +1601,80 @@ BArrayState *BLI_array_store_state_add(BArrayStore *bs,
   return state;
 }
 
+/**
+ * Add a state which is a copy of \a state_reference with some of its elements replaced.
+ *
+ * Unlike #BLI_array_store_state_add, the cost of this function is proportional
+ * to the number of chunks and the size of the patch, not the size of the array,
+ * as only chunks containing patched elements are copied (all others are shared).
+ *
+ * \param patch_index: Sorted (ascending) & unique element indices (in units of the stride).
+ * \param patch_data: Data to write for each index (`patch_len * stride` bytes).
+ * \param patch_len: The number of patched elements,
+ * when zero the chunk-list of \a state_reference is shared as-is.
+ */
+BArrayState *BLI_array_store_state_add_patched(BArrayStore *bs,
+                                               const BArrayState *state_reference,
+                                               const uint *patch_index,
+                                               const void *patch_data,
+                                               const size_t patch_len)
+{
+#ifdef USE_PARANOID_CHECKS
+  BLI_assert(BLI_findindex(&bs->states, state_reference) != -1);
+#endif
+
+  const size_t stride = bs->info.chunk_stride;
+  BChunkList *chunk_list;
+
+  if (patch_len == 0) {
+    chunk_list = state_reference->chunk_list;
+  }
+  else {
+    const BChunkList *chunk_list_reference = state_reference->chunk_list;
+    const uchar *patch_data_step = (const uchar *)patch_data;
+    size_t patch_step = 0;
+    size_t offset = 0;
+
+    chunk_list = bchunk_list_new(&bs->memory, chunk_list_reference->total_size);
+
+    LISTBASE_FOREACH (const BChunkRef *, cref, &chunk_list_reference->chunk_refs) {
+      BChunk *chunk = cref->link;
+      const size_t offset_end = offset + chunk->data_len;
+
+      if ((patch_step < patch_len) && ((size_t)patch_index[patch_step] * stride < offset_end)) {
+        uchar *data_copy = MEM_mallocN(chunk->data_len, __func__);
+        memcpy(data_copy, chunk->data, chunk->data_len);
+        while ((patch_step < patch_len) &&
+               ((size_t)patch_index[patch_step] * stride < offset_end)) {
+          const size_t patch_offset = (size_t)patch_index[patch_step] * stride;
+          BLI_assert(patch_offset >= offset);
+          BLI_assert((patch_step == 0) || (patch_index[patch_step - 1] < patch_index[patch_step]));
+          memcpy(&data_copy[patch_offset - offset], patch_data_step, stride);
+          patch_data_step += stride;
+          patch_step += 1;
+        }
+        chunk = bchunk_new(&bs->memory, data_copy, chunk->data_len);
+      }
+
+      bchunk_list_append_only(&bs->memory, chunk_list, chunk);
+      offset = offset_end;
+    }
+
+    /* Indices out of range are a bug in the caller. */
+    BLI_assert(patch_step == patch_len);
+    ASSERT_CHUNKLIST_SIZE(chunk_list, chunk_list_reference->total_size);
+  }
+
+  chunk_list->users += 1;
+
+  BArrayState *state = MEM_callocN(sizeof(BArrayState), __func__);
+  state->chunk_list = chunk_list;
+
+  BLI_addtail(&bs->states, state);
+
+  return state;
+}
+
 /**
  * Remove a state and free any unused #BChunk data.
  *
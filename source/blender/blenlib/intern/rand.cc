@@ -450,6 +450,33 @@ float3 RandomNumberGenerator::get_triangle_sample_3d(float3 v1, float3 v2, float
   return sample;
 }
 
+/**
+ * Advancing the linear congruential generator \a n times is itself a linear congruential step,
+ * `x = (A * x + C) mod m` with `A = a^n` and `C = c * (a^(n-1) + ... + a + 1)`.
+ * Both are built by squaring, see F. Brown, "Random Number Generation with Arbitrary Strides".
+ */
+void RandomNumberGenerator::skip(int64_t n)
+{
+  uint64_t cur_mult = multiplier_;
+  uint64_t cur_plus = addend_;
+  uint64_t acc_mult = 1;
+  uint64_t acc_plus = 0;
+
+  /* Unsigned overflow wraps modulo 2^64, which is a multiple of the modulus 2^48. */
+  uint64_t steps = static_cast<uint64_t>(n);
+  while (steps > 0) {
+    if (steps & 1) {
+      acc_mult = (acc_mult * cur_mult) & mask_;
+      acc_plus = (acc_plus * cur_mult + cur_plus) & mask_;
+    }
+    cur_plus = ((cur_mult + 1) * cur_plus) & mask_;
+    cur_mult = (cur_mult * cur_mult) & mask_;
+    steps >>= 1;
+  }
+
+  x_ = (acc_mult * x_ + acc_plus) & mask_;
+}
+
 void RandomNumberGenerator::get_bytes(MutableSpan<char> r_bytes)
 {
   constexpr int64_t mask_bytes = 2;
@@ -384,6 +384,48 @@ TEST(array_store, DoubleDiff)
   BLI_array_store_destroy(bs);
 }
 
+TEST(array_store, Patched)
+{
+  BArrayStore *bs = BLI_array_store_create(2, 4);
+  const char data_src[] = "aabbccddeeffgghhiijjkkllmmnnoopp";
+  const char data_expect[] = "aaXXccddeeffgghhiijjkkllmmYYZZpp";
+  const uint patch_index[] = {1, 13, 14};
+  const char patch_data[] = "XXYYZZ";
+  const char *data_dst;
+  size_t data_dst_len;
+
+  BArrayState *state_a = BLI_array_store_state_add(bs, data_src, sizeof(data_src) - 1, nullptr);
+  BArrayState *state_b = BLI_array_store_state_add_patched(
+      bs, state_a, patch_index, patch_data, ARRAY_SIZE(patch_index));
+  BArrayState *state_c = BLI_array_store_state_add_patched(bs, state_b, nullptr, nullptr, 0);
+
+  /* Only the chunks containing patched elements are duplicated. */
+  EXPECT_EQ(BLI_array_store_calc_size_compacted_get(bs), (sizeof(data_src) - 1) + (8 * 2));
+  EXPECT_TRUE(BLI_array_store_is_valid(bs));
+
+  data_dst = (char *)BLI_array_store_state_data_get_alloc(state_a, &data_dst_len);
+  EXPECT_EQ(data_dst_len, sizeof(data_src) - 1);
+  EXPECT_EQ(memcmp(data_src, data_dst, data_dst_len), 0);
+  MEM_freeN((void *)data_dst);
+
+  data_dst = (char *)BLI_array_store_state_data_get_alloc(state_b, &data_dst_len);
+  EXPECT_EQ(data_dst_len, sizeof(data_expect) - 1);
+  EXPECT_EQ(memcmp(data_expect, data_dst, data_dst_len), 0);
+  MEM_freeN((void *)data_dst);
+
+  /* Removing the reference state must not affect states created from it. */
+  BLI_array_store_state_remove(bs, state_a);
+  BLI_array_store_state_remove(bs, state_b);
+
+  data_dst = (char *)BLI_array_store_state_data_get_alloc(state_c, &data_dst_len);
+  EXPECT_EQ(data_dst_len, sizeof(data_expect) - 1);
+  EXPECT_EQ(memcmp(data_expect, data_dst, data_dst_len), 0);
+  MEM_freeN((void *)data_dst);
+
+  EXPECT_TRUE(BLI_array_store_is_valid(bs));
+  BLI_array_store_destroy(bs);
+}
+
 TEST(array_store, TextMixed)
 {
   TESTBUFFER_STRINGS(1, 4, "", );
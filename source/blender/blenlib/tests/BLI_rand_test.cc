@@ -0,0 +1,42 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.h"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+TEST(rand, SkipMatchesStepping)
+{
+  const int64_t counts[] = {0, 1, 2, 3, 7, 64, 1000, 12345};
+  for (const int64_t count : counts) {
+    RandomNumberGenerator rng_step(42);
+    RandomNumberGenerator rng_skip(42);
+    for (int64_t i = 0; i < count; i++) {
+      rng_step.get_uint32();
+    }
+    rng_skip.skip(count);
+    for (int i = 0; i < 8; i++) {
+      EXPECT_EQ(rng_step.get_uint32(), rng_skip.get_uint32());
+    }
+  }
+}
+
+TEST(rand, SkipCApi)
+{
+  RNG *rng_step = BLI_rng_new(31415926);
+  RNG *rng_skip = BLI_rng_copy(rng_step);
+  float value = 0.0f;
+  for (int i = 0; i < 3 * 1000; i++) {
+    value = BLI_rng_get_float(rng_step);
+  }
+  EXPECT_LT(value, 1.0f);
+  BLI_rng_skip(rng_skip, 1000);
+  BLI_rng_skip(rng_skip, 2000);
+  EXPECT_EQ(BLI_rng_get_float(rng_step), BLI_rng_get_float(rng_skip));
+  BLI_rng_free(rng_step);
+  BLI_rng_free(rng_skip);
+}
+
+}  // namespace blender::tests
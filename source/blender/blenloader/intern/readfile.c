@@ -61,6 +61,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "PIL_time.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
@@ -70,6 +72,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -969,6 +972,65 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Blocks at least this large are prefetched from memory mapped files,
+ * so their pages are read in bulk instead of faulting them in one by one while copying.
+ */
+#  define BHEAD_MMAP_PREFETCH_SIZE (256 * 1024)
+
+/**
+ * Read the data of a block, when the file is memory mapped it's copied straight from the
+ * mapped memory, without moving the read position.
+ */
+static bool blo_bhead_read_data_direct(FileData *fd, BHead *thisblock, void *buf)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+
+  if (fd->mmap_file == NULL) {
+    return blo_bhead_read_data(fd, thisblock, buf);
+  }
+
+  const size_t len = (size_t)thisblock->len;
+  if (len >= BHEAD_MMAP_PREFETCH_SIZE) {
+    BLI_mmap_prefetch(fd->mmap_file, (size_t)new_bhead->file_offset, len);
+  }
+  return BLI_mmap_read(fd->mmap_file, buf, (size_t)new_bhead->file_offset, len);
+}
+
+/**
+ * Access the data of a block in place when the file is memory mapped,
+ * to avoid copying data that is converted before use anyway.
+ *
+ * \return NULL when the data can't be accessed in place,
+ * otherwise #BLI_mmap_any_io_error must be checked after reading the data.
+ */
+static const void *blo_bhead_peek_data_mmap(FileData *fd, BHead *thisblock)
+{
+#  ifndef WIN32
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+
+  if (fd->mmap_file == NULL || BLI_mmap_any_io_error(fd->mmap_file)) {
+    return NULL;
+  }
+
+  const size_t offset = (size_t)new_bhead->file_offset;
+  const size_t len = (size_t)thisblock->len;
+  if (offset + len > fd->buffersize) {
+    return NULL;
+  }
+  if (len >= BHEAD_MMAP_PREFETCH_SIZE) {
+    BLI_mmap_prefetch(fd->mmap_file, offset, len);
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), offset);
+#  else
+  /* Errors accessing mapped memory are only handled by #BLI_mmap_read. */
+  UNUSED_VARS(fd, thisblock);
+  return NULL;
+#  endif
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -2199,6 +2261,18 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+          /* Reconstruct straight from the mapped file, the data is only read. */
+          const void *data_mmap = blo_bhead_peek_data_mmap(fd, bh);
+          if (data_mmap) {
+            temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, data_mmap);
+            if (UNLIKELY(BLI_mmap_any_io_error(fd->mmap_file))) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              MEM_freeN(temp);
+              return NULL;
+            }
+            return temp;
+          }
+
           bh = blo_bhead_read_full(fd, bh);
           if (UNLIKELY(bh == NULL)) {
             fd->flags &= ~FD_FLAGS_FILE_OK;
@@ -2218,7 +2292,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
         else {
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
-          if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
+          if (UNLIKELY(!blo_bhead_read_data_direct(fd, bh, temp))) {
             fd->flags &= ~FD_FLAGS_FILE_OK;
             MEM_freeN(temp);
             temp = NULL;
@@ -5423,10 +5497,134 @@ static void read_library_clear_weak_links(FileData *basefd, ListBase *mainlist,
   }
 }
 
+/**
+ * Open the file of a library, only uses the library and \a reports
+ * so it can run for multiple libraries in parallel.
+ */
+static FileData *read_library_file_open(Library *lib, ReportList *reports)
+{
+  FileData *fd;
+
+  if (lib->packedfile) {
+    /* Read packed file. */
+    PackedFile *pf = lib->packedfile;
+    fd = blo_filedata_from_memory(pf->data, pf->size, reports);
+
+    if (fd) {
+      /* Needed for library_append and read_libraries. */
+      BLI_strncpy(fd->relabase, lib->filepath_abs, sizeof(fd->relabase));
+    }
+  }
+  else {
+    /* Read file on disk. */
+    fd = blo_filedata_from_file(lib->filepath_abs, reports);
+  }
+
+#ifdef USE_GHASH_BHEAD
+  if (fd) {
+    read_file_bhead_idname_map_create(fd);
+  }
+#endif
+
+  return fd;
+}
+
+/** A library file opened ahead of time, see #read_library_files_open. */
+typedef struct LibraryFileOpenTask {
+  Main *mainptr;
+  FileData *fd;
+  /**
+   * Reports of opening the file, moved to the reports of the base file once it's used.
+   * Report lists are not thread safe, so each file has its own.
+   */
+  ReportList reports;
+  bool use_reports;
+  /** Time spent opening the file, in seconds. */
+  double time;
+  bool is_used;
+} LibraryFileOpenTask;
+
+static void read_library_file_open_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  LibraryFileOpenTask *task = taskdata;
+  const double time_start = PIL_check_seconds_timer();
+
+  task->fd = read_library_file_open(task->mainptr->curlib,
+                                    task->use_reports ? &task->reports : NULL);
+  task->time = PIL_check_seconds_timer() - time_start;
+}
+
+/**
+ * Open the files of all libraries that have data-blocks to read in parallel,
+ * reading and decompressing a file and its DNA doesn't depend on other libraries.
+ *
+ * \return An array of opened files, ordered like the library mains after \a mainl,
+ * or NULL when there is nothing to gain over opening the files one by one.
+ */
+static LibraryFileOpenTask *read_library_files_open(FileData *basefd,
+                                                    Main *mainl,
+                                                    int *r_tasks_len)
+{
+  int tasks_len = 0;
+  for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+    if (mainptr->curlib->filedata == NULL && has_linked_ids_to_read(mainptr)) {
+      tasks_len++;
+    }
+  }
+
+  *r_tasks_len = 0;
+  if (tasks_len < 2) {
+    return NULL;
+  }
+
+  LibraryFileOpenTask *tasks = MEM_calloc_arrayN(tasks_len, sizeof(*tasks), __func__);
+  TaskPool *task_pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH, TASK_ISOLATION_ON);
+
+  int task_index = 0;
+  for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+    if (mainptr->curlib->filedata == NULL && has_linked_ids_to_read(mainptr)) {
+      LibraryFileOpenTask *task = &tasks[task_index++];
+      task->mainptr = mainptr;
+
+      if (basefd->reports) {
+        BKE_reports_init(&task->reports, basefd->reports->flag);
+        task->reports.storelevel = basefd->reports->storelevel;
+        task->reports.printlevel = basefd->reports->printlevel;
+        task->use_reports = true;
+      }
+
+      BLI_task_pool_push(task_pool, read_library_file_open_task, task, false, NULL);
+    }
+  }
+
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+
+  *r_tasks_len = tasks_len;
+  return tasks;
+}
+
+static void read_library_files_open_free(LibraryFileOpenTask *tasks, const int tasks_len)
+{
+  for (int i = 0; i < tasks_len; i++) {
+    if (!tasks[i].is_used) {
+      /* Placeholders are only cleared when reading their own library,
+       * so every opened file is expected to be used. */
+      BLI_assert_unreachable();
+      if (tasks[i].fd) {
+        blo_filedata_free(tasks[i].fd);
+      }
+      BKE_reports_clear(&tasks[i].reports);
+    }
+  }
+  MEM_freeN(tasks);
+}
+
 static FileData *read_library_file_data(FileData *basefd,
                                         ListBase *mainlist,
                                         Main *mainl,
-                                        Main *mainptr)
+                                        Main *mainptr,
+                                        LibraryFileOpenTask *opened)
 {
   FileData *fd = mainptr->curlib->filedata;
 
@@ -5436,28 +5634,37 @@ static FileData *read_library_file_data(FileData *basefd,
   }
 
   if (mainptr->curlib->packedfile) {
-    /* Read packed file. */
-    PackedFile *pf = mainptr->curlib->packedfile;
-
     BLO_reportf_wrap(basefd->reports,
                      RPT_INFO,
                      TIP_("Read packed library:  '%s', parent '%s'"),
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_memory(pf->data, pf->size, basefd->reports);
-
-    /* Needed for library_append and read_libraries. */
-    BLI_strncpy(fd->relabase, mainptr->curlib->filepath_abs, sizeof(fd->relabase));
   }
   else {
-    /* Read file on disk. */
     BLO_reportf_wrap(basefd->reports,
                      RPT_INFO,
                      TIP_("Read library:  '%s', '%s', parent '%s'"),
                      mainptr->curlib->filepath_abs,
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports);
+  }
+
+  double time_open;
+  if (opened) {
+    /* Opened in parallel with other libraries, the reports were already printed,
+     * only add them in the order libraries are read. */
+    BLI_assert(opened->mainptr == mainptr && !opened->is_used);
+    opened->is_used = true;
+    fd = opened->fd;
+    time_open = opened->time;
+    if (opened->use_reports) {
+      BLI_movelisttolist(&basefd->reports->list, &opened->reports.list);
+    }
+  }
+  else {
+    const double time_start = PIL_check_seconds_timer();
+    fd = read_library_file_open(mainptr->curlib, basefd->reports);
+    time_open = PIL_check_seconds_timer() - time_start;
   }
 
   if (fd) {
@@ -5468,6 +5675,7 @@ static FileData *read_library_file_data(FileData *basefd,
     fd->mainlist = mainlist;
 
     fd->reports = basefd->reports;
+    fd->library_read_time = time_open;
 
     if (fd->libmap) {
       oldnewmap_free(fd->libmap);
@@ -5480,9 +5688,6 @@ static FileData *read_library_file_data(FileData *basefd,
 
     /* subversion */
     read_file_version(fd, mainptr);
-#ifdef USE_GHASH_BHEAD
-    read_file_bhead_idname_map_create(fd);
-#endif
   }
   else {
     mainptr->curlib->filedata = NULL;
@@ -5519,6 +5724,12 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
   while (do_it) {
     do_it = false;
 
+    /* Open the files of the libraries known so far in parallel, libraries found while reading
+     * this pass are opened when they are reached. */
+    int opened_len;
+    LibraryFileOpenTask *opened = read_library_files_open(basefd, mainl, &opened_len);
+    int opened_index = 0;
+
     /* Loop over mains of all library blend files encountered so far. Note
      * this list gets longer as more indirectly library blends are found. */
     for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
@@ -5530,8 +5741,14 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
           mainptr->curlib->filepath);
 #endif
 
+        LibraryFileOpenTask *opened_file = NULL;
+        if (opened_index < opened_len && opened[opened_index].mainptr == mainptr) {
+          opened_file = &opened[opened_index++];
+        }
+
         /* Open file if it has not been done yet. */
-        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr);
+        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr, opened_file);
+        const double time_start = PIL_check_seconds_timer();
 
         if (fd) {
           do_it = true;
@@ -5544,12 +5761,22 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
         /* Test if linked data-locks need to read further linked data-locks
          * and create link placeholders for them. */
         BLO_expand_main(fd, mainptr);
+
+        if (fd) {
+          fd->library_read_time += PIL_check_seconds_timer() - time_start;
+        }
       }
     }
+
+    if (opened) {
+      read_library_files_open_free(opened, opened_len);
+    }
   }
 
   Main *main_newid = BKE_main_new();
   for (Main *mainptr = mainl->next; mainptr; mainptr = mainptr->next) {
+    const double time_start = PIL_check_seconds_timer();
+
     /* Drop weak links for which no data-block was found. */
     read_library_clear_weak_links(basefd, mainlist, mainptr);
 
@@ -5584,7 +5811,15 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 
     /* Free file data we no longer need. */
     if (mainptr->curlib->filedata) {
-      blo_filedata_free(mainptr->curlib->filedata);
+      FileData *fd = mainptr->curlib->filedata;
+      if (G.debug & G_DEBUG_IO) {
+        BLO_reportf_wrap(basefd->reports,
+                         RPT_INFO,
+                         TIP_("Read library '%s' in %.3f seconds"),
+                         mainptr->curlib->filepath_abs,
+                         fd->library_read_time + (PIL_check_seconds_timer() - time_start));
+      }
+      blo_filedata_free(fd);
     }
     mainptr->curlib->filedata = NULL;
   }
@@ -150,6 +150,9 @@ typedef struct FileData {
    * Used to generate a synthetic report in the UI. */
   int library_file_missing_count;
   int library_id_missing_count;
+
+  /** Time spent reading this file as a library (in seconds), reported with `--debug-io`. */
+  double library_read_time;
 } FileData;
 
 #define SIZEOFBLENDERHEADER 12
@@ -26,6 +26,7 @@
 #include "BLI_utildefines.h"
 
 #include "DNA_brush_types.h"
+#include "DNA_cachefile_types.h"
 #include "DNA_genfile.h"
 #include "DNA_listBase.h"
 #include "DNA_modifier_types.h"
@@ -259,5 +260,12 @@ void blo_do_versions_300(FileData *fd, Library *UNUSED(lib), Main *bmain)
         }
       }
     }
+
+    if (!DNA_struct_elem_find(fd->filesdna, "CacheFile", "int", "prefetch_cache_size")) {
+      LISTBASE_FOREACH (CacheFile *, cache_file, &bmain->cachefiles) {
+        cache_file->use_prefetch = 1;
+        cache_file->prefetch_cache_size = 1024;
+      }
+    }
   }
 }
@@ -154,6 +154,8 @@ void EDBM_automerge_and_split(struct Object *ob,
 
 /* editmesh_undo.c */
 void ED_mesh_undosys_type(struct UndoType *ut);
+void EDBM_undo_partial_hint_set(struct BMEditMesh *em, struct BMVert **verts, const int verts_len);
+void EDBM_undo_partial_hint_clear(struct BMEditMesh *em);
 
 /* editmesh_select.c */
 void EDBM_select_mirrored(struct BMEditMesh *em,
@@ -0,0 +1,405 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup editor/io
+ */
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_space_types.h"
+
+#include "BKE_context.h"
+#include "BKE_main.h"
+#include "BKE_report.h"
+
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BLT_translation.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "RNA_access.h"
+#include "RNA_define.h"
+#include "RNA_enum_types.h"
+
+#include "ED_object.h"
+
+#include "UI_interface.h"
+#include "UI_resources.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "DEG_depsgraph.h"
+
+#include "IO_wavefront_obj.h"
+#include "io_obj.h"
+
+static const EnumPropertyItem io_obj_export_evaluation_mode_items[] = {
+    {DAG_EVAL_RENDER,
+     "RENDER",
+     0,
+     "Render",
+     "Use Render settings for object visibility, modifier settings, etc"},
+    {DAG_EVAL_VIEWPORT,
+     "VIEWPORT",
+     0,
+     "Viewport",
+     "Use Viewport settings for object visibility, modifier settings, etc"},
+    {0, NULL, 0, NULL, NULL},
+};
+
+static bool io_obj_axes_are_valid(wmOperator *op)
+{
+  const int forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  const int up_axis = RNA_enum_get(op->ptr, "up_axis");
+  if (forward_axis % 3 == up_axis % 3) {
+    BKE_report(op->reports, RPT_ERROR, "Forward and up axes must be different");
+    return false;
+  }
+  return true;
+}
+
+static void io_obj_def_axes(wmOperatorType *ot)
+{
+  RNA_def_enum(ot->srna,
+               "forward_axis",
+               rna_enum_object_axis_items,
+               OB_NEGZ,
+               "Forward Axis",
+               "Axis of the file that points forward in Blender");
+  RNA_def_enum(ot->srna,
+               "up_axis",
+               rna_enum_object_axis_items,
+               OB_POSY,
+               "Up Axis",
+               "Axis of the file that points up in Blender");
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Export
+ * \{ */
+
+static int wm_obj_export_invoke(bContext *C, wmOperator *op, const wmEvent *UNUSED(event))
+{
+  Scene *scene = CTX_data_scene(C);
+  if (!RNA_struct_property_is_set(op->ptr, "start_frame")) {
+    RNA_int_set(op->ptr, "start_frame", SFRA);
+  }
+  if (!RNA_struct_property_is_set(op->ptr, "end_frame")) {
+    RNA_int_set(op->ptr, "end_frame", EFRA);
+  }
+
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    Main *bmain = CTX_data_main(C);
+    char filepath[FILE_MAX];
+    const char *main_blendfile_path = BKE_main_blendfile_path(bmain);
+
+    if (main_blendfile_path[0] == '\0') {
+      BLI_strncpy(filepath, "untitled", sizeof(filepath));
+    }
+    else {
+      BLI_strncpy(filepath, main_blendfile_path, sizeof(filepath));
+    }
+
+    BLI_path_extension_replace(filepath, sizeof(filepath), ".obj");
+    RNA_string_set(op->ptr, "filepath", filepath);
+  }
+
+  WM_event_add_fileselect(C, op);
+
+  return OPERATOR_RUNNING_MODAL;
+}
+
+static int wm_obj_export_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+  if (!io_obj_axes_are_valid(op)) {
+    return OPERATOR_CANCELLED;
+  }
+
+  Scene *scene = CTX_data_scene(C);
+  struct OBJExportParams params;
+  RNA_string_get(op->ptr, "filepath", params.filepath);
+  BLI_path_extension_ensure(params.filepath, sizeof(params.filepath), ".obj");
+
+  params.export_animation = RNA_boolean_get(op->ptr, "export_animation");
+  params.start_frame = RNA_struct_property_is_set(op->ptr, "start_frame") ?
+                           RNA_int_get(op->ptr, "start_frame") :
+                           SFRA;
+  params.end_frame = RNA_struct_property_is_set(op->ptr, "end_frame") ?
+                         RNA_int_get(op->ptr, "end_frame") :
+                         EFRA;
+  params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  params.up_axis = RNA_enum_get(op->ptr, "up_axis");
+  params.scaling_factor = RNA_float_get(op->ptr, "scaling_factor");
+  params.export_selected_objects = RNA_boolean_get(op->ptr, "export_selected_objects");
+  params.export_eval_mode = RNA_enum_get(op->ptr, "export_eval_mode");
+  params.export_uv = RNA_boolean_get(op->ptr, "export_uv");
+  params.export_normals = RNA_boolean_get(op->ptr, "export_normals");
+  params.export_materials = RNA_boolean_get(op->ptr, "export_materials");
+  params.export_triangulated_mesh = RNA_boolean_get(op->ptr, "export_triangulated_mesh");
+  params.export_object_groups = RNA_boolean_get(op->ptr, "export_object_groups");
+  params.export_smooth_groups = RNA_boolean_get(op->ptr, "export_smooth_groups");
+
+  const bool ok = OBJ_export(C, &params);
+
+  return ok ? OPERATOR_FINISHED : OPERATOR_CANCELLED;
+}
+
+static void wm_obj_export_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  uiLayout *col, *sub;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+  uiLayoutSetPropDecorate(layout, false);
+
+  uiLayout *box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "export_selected_objects", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_eval_mode", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_animation", 0, NULL, ICON_NONE);
+  sub = uiLayoutColumn(col, true);
+  uiLayoutSetEnabled(sub, RNA_boolean_get(ptr, "export_animation"));
+  uiItemR(sub, ptr, "start_frame", 0, IFACE_("Frame Start"), ICON_NONE);
+  uiItemR(sub, ptr, "end_frame", 0, IFACE_("End"), ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "forward_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "up_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "scaling_factor", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "export_uv", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_normals", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_materials", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_triangulated_mesh", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_object_groups", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "export_smooth_groups", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_obj_export(struct wmOperatorType *ot)
+{
+  ot->name = "Export Wavefront OBJ";
+  ot->description = "Save the scene to a Wavefront OBJ file";
+  ot->idname = "WM_OT_obj_export";
+
+  ot->invoke = wm_obj_export_invoke;
+  ot->exec = wm_obj_export_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_obj_export_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_OBJECT_IO,
+                                 FILE_BLENDER,
+                                 FILE_SAVE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  RNA_def_boolean(ot->srna,
+                  "export_animation",
+                  false,
+                  "Export Animation",
+                  "Write one file per frame, with the frame number added to the file name");
+  RNA_def_int(ot->srna,
+              "start_frame",
+              INT_MIN,
+              INT_MIN,
+              INT_MAX,
+              "Start Frame",
+              "The first frame to be exported, the scene start frame when not set",
+              MINAFRAME,
+              MAXFRAME);
+  RNA_def_int(ot->srna,
+              "end_frame",
+              INT_MAX,
+              INT_MIN,
+              INT_MAX,
+              "End Frame",
+              "The last frame to be exported, the scene end frame when not set",
+              MINAFRAME,
+              MAXFRAME);
+  io_obj_def_axes(ot);
+  RNA_def_float(ot->srna,
+                "scaling_factor",
+                1.0f,
+                0.001f,
+                10000.0f,
+                "Scale",
+                "Scale all data by this factor",
+                0.01f,
+                1000.0f);
+  RNA_def_boolean(ot->srna,
+                  "export_selected_objects",
+                  false,
+                  "Selected Only",
+                  "Only export the selected objects");
+  RNA_def_enum(ot->srna,
+               "export_eval_mode",
+               io_obj_export_evaluation_mode_items,
+               DAG_EVAL_VIEWPORT,
+               "Use Settings for",
+               "Determines visibility of objects, modifier settings, and other areas where there "
+               "are different settings for viewport and rendering");
+  RNA_def_boolean(ot->srna, "export_uv", true, "UV Coordinates", "Write the active UV map");
+  RNA_def_boolean(ot->srna, "export_normals", true, "Normals", "Write the face corner normals");
+  RNA_def_boolean(ot->srna,
+                  "export_materials",
+                  true,
+                  "Materials",
+                  "Write the viewport settings of the materials to an MTL file");
+  RNA_def_boolean(ot->srna,
+                  "export_triangulated_mesh",
+                  false,
+                  "Triangulate Faces",
+                  "Write triangles instead of the faces of the meshes");
+  RNA_def_boolean(ot->srna,
+                  "export_object_groups",
+                  false,
+                  "Object Groups",
+                  "Write a group for every object, in addition to the object statement");
+  RNA_def_boolean(ot->srna,
+                  "export_smooth_groups",
+                  false,
+                  "Smooth Groups",
+                  "Write smooth shading of faces");
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Import
+ * \{ */
+
+static int wm_obj_import_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+  if (!io_obj_axes_are_valid(op)) {
+    return OPERATOR_CANCELLED;
+  }
+
+  struct OBJImportParams params;
+  RNA_string_get(op->ptr, "filepath", params.filepath);
+  params.clamp_size = RNA_float_get(op->ptr, "clamp_size");
+  params.forward_axis = RNA_enum_get(op->ptr, "forward_axis");
+  params.up_axis = RNA_enum_get(op->ptr, "up_axis");
+  params.split_by_object = RNA_boolean_get(op->ptr, "split_by_object");
+  params.split_by_group = RNA_boolean_get(op->ptr, "split_by_group");
+  params.import_edges = RNA_boolean_get(op->ptr, "import_edges");
+  params.validate_meshes = RNA_boolean_get(op->ptr, "validate_meshes");
+
+  /* Switch out of edit mode to avoid being stuck in it (T54326). */
+  Object *obedit = CTX_data_edit_object(C);
+  if (obedit) {
+    ED_object_mode_set(C, OB_MODE_OBJECT);
+  }
+
+  const bool ok = OBJ_import(C, &params);
+
+  WM_event_add_notifier(C, NC_SCENE | ND_OB_ACTIVE, CTX_data_scene(C));
+  return ok ? OPERATOR_FINISHED : OPERATOR_CANCELLED;
+}
+
+static void wm_obj_import_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  uiLayout *col;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+  uiLayoutSetPropDecorate(layout, false);
+
+  uiLayout *box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "clamp_size", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "forward_axis", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "up_axis", 0, NULL, ICON_NONE);
+
+  box = uiLayoutBox(layout);
+  col = uiLayoutColumn(box, false);
+  uiItemR(col, ptr, "split_by_object", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "split_by_group", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "import_edges", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "validate_meshes", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_obj_import(struct wmOperatorType *ot)
+{
+  ot->name = "Import Wavefront OBJ";
+  ot->description = "Load a Wavefront OBJ file";
+  ot->idname = "WM_OT_obj_import";
+  ot->flag = OPTYPE_REGISTER | OPTYPE_UNDO;
+
+  ot->invoke = WM_operator_filesel;
+  ot->exec = wm_obj_import_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_obj_import_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_OBJECT_IO,
+                                 FILE_BLENDER,
+                                 FILE_OPENFILE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  RNA_def_float(ot->srna,
+                "clamp_size",
+                0.0f,
+                0.0f,
+                1000.0f,
+                "Clamp Bounding Box",
+                "Scale the objects down by powers of ten until they fit in this size, "
+                "0 to disable",
+                0.0f,
+                1000.0f);
+  io_obj_def_axes(ot);
+  RNA_def_boolean(ot->srna,
+                  "split_by_object",
+                  true,
+                  "Split by Object",
+                  "Create a new object for every object statement ('o')");
+  RNA_def_boolean(ot->srna,
+                  "split_by_group",
+                  false,
+                  "Split by Group",
+                  "Create a new object for every group statement ('g')");
+  RNA_def_boolean(ot->srna, "import_edges", true, "Lines", "Import lines ('l') as loose edges");
+  RNA_def_boolean(ot->srna,
+                  "validate_meshes",
+                  true,
+                  "Validate Meshes",
+                  "Check the imported meshes for invalid data, e.g. faces using a vertex twice");
+}
+
+/** \} */
@@ -39,6 +39,7 @@
 
 #include "io_cache.h"
 #include "io_gpencil.h"
+#include "io_obj.h"
 
 void ED_operatortypes_io(void)
 {
@@ -53,8 +54,12 @@ void ED_operatortypes_io(void)
 #endif
 #ifdef WITH_USD
   WM_operatortype_append(WM_OT_usd_export);
+  WM_operatortype_append(WM_OT_usd_import);
 #endif
 
+  WM_operatortype_append(WM_OT_obj_export);
+  WM_operatortype_append(WM_OT_obj_import);
+
   WM_operatortype_append(WM_OT_gpencil_import_svg);
 
 #ifdef WITH_PUGIXML
@@ -242,4 +242,125 @@ void WM_OT_usd_export(struct wmOperatorType *ot)
                "are different settings for viewport and rendering");
 }
 
+/* ====== USD Import ====== */
+
+static int wm_usd_import_invoke(bContext *C, wmOperator *op, const wmEvent *event)
+{
+  eUSDOperatorOptions *options = MEM_callocN(sizeof(eUSDOperatorOptions), "eUSDOperatorOptions");
+  options->as_background_job = true;
+  op->customdata = options;
+
+  return WM_operator_filesel(C, op, event);
+}
+
+static int wm_usd_import_exec(bContext *C, wmOperator *op)
+{
+  if (!RNA_struct_property_is_set(op->ptr, "filepath")) {
+    BKE_report(op->reports, RPT_ERROR, "No filename given");
+    return OPERATOR_CANCELLED;
+  }
+
+  char filename[FILE_MAX];
+  RNA_string_get(op->ptr, "filepath", filename);
+
+  eUSDOperatorOptions *options = (eUSDOperatorOptions *)op->customdata;
+  const bool as_background_job = (options != NULL && options->as_background_job);
+  MEM_SAFE_FREE(op->customdata);
+
+  const float scale = RNA_float_get(op->ptr, "scale");
+  const bool set_frame_range = RNA_boolean_get(op->ptr, "set_frame_range");
+  const bool import_instancing = RNA_boolean_get(op->ptr, "import_instancing");
+  const bool load_payloads = RNA_boolean_get(op->ptr, "load_payloads");
+  const bool validate_meshes = RNA_boolean_get(op->ptr, "validate_meshes");
+
+  struct USDImportParams params = {
+      scale,
+      set_frame_range,
+      import_instancing,
+      load_payloads,
+      validate_meshes,
+  };
+
+  bool ok = USD_import(C, filename, &params, as_background_job);
+
+  return as_background_job || ok ? OPERATOR_FINISHED : OPERATOR_CANCELLED;
+}
+
+static void wm_usd_import_draw(bContext *UNUSED(C), wmOperator *op)
+{
+  uiLayout *layout = op->layout;
+  uiLayout *col;
+  struct PointerRNA *ptr = op->ptr;
+
+  uiLayoutSetPropSep(layout, true);
+
+  uiLayout *box = uiLayoutBox(layout);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "scale", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "set_frame_range", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "validate_meshes", 0, NULL, ICON_NONE);
+
+  col = uiLayoutColumn(box, true);
+  uiItemR(col, ptr, "import_instancing", 0, NULL, ICON_NONE);
+  uiItemR(col, ptr, "load_payloads", 0, NULL, ICON_NONE);
+}
+
+void WM_OT_usd_import(struct wmOperatorType *ot)
+{
+  ot->name = "Import USD";
+  ot->description = "Import a USD file as new objects";
+  ot->idname = "WM_OT_usd_import";
+
+  ot->invoke = wm_usd_import_invoke;
+  ot->exec = wm_usd_import_exec;
+  ot->poll = WM_operator_winactive;
+  ot->ui = wm_usd_import_draw;
+
+  WM_operator_properties_filesel(ot,
+                                 FILE_TYPE_FOLDER | FILE_TYPE_USD,
+                                 FILE_BLENDER,
+                                 FILE_OPENFILE,
+                                 WM_FILESEL_FILEPATH | WM_FILESEL_SHOW_PROPS,
+                                 FILE_DEFAULTDISPLAY,
+                                 FILE_SORT_DEFAULT);
+
+  RNA_def_float(ot->srna,
+                "scale",
+                1.0f,
+                0.0001f,
+                1000.0f,
+                "Scale",
+                "Value by which to enlarge or shrink the objects with respect to the world's "
+                "origin",
+                0.0001f,
+                1000.0f);
+
+  RNA_def_boolean(ot->srna,
+                  "set_frame_range",
+                  true,
+                  "Set Frame Range",
+                  "If checked, update scene's start and end frame to match those of the stage");
+
+  RNA_def_boolean(ot->srna,
+                  "import_instancing",
+                  true,
+                  "Instancing",
+                  "When checked, instanced prims share the objects of a collection that is "
+                  "instanced. When unchecked, every instance is imported as real objects");
+
+  RNA_def_boolean(ot->srna,
+                  "load_payloads",
+                  true,
+                  "Load Payloads",
+                  "When checked, payloads are loaded and imported. When unchecked, prims with "
+                  "payloads are imported as placeholder empties sized to their bounds");
+
+  RNA_def_boolean(ot->srna,
+                  "validate_meshes",
+                  false,
+                  "Validate Meshes",
+                  "Check imported mesh objects for invalid data (slow)");
+}
+
 #endif /* WITH_USD */
@@ -26,3 +26,4 @@
 struct wmOperatorType;
 
 void WM_OT_usd_export(struct wmOperatorType *ot);
+void WM_OT_usd_import(struct wmOperatorType *ot);
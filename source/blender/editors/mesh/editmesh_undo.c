@@ -31,6 +31,7 @@
 
 #include "BLI_array_utils.h"
 #include "BLI_listbase.h"
+#include "BLI_math_vector.h"
 
 #include "BKE_context.h"
 #include "BKE_editmesh.h"
@@ -39,6 +40,7 @@
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
 #include "BKE_object.h"
 #include "BKE_undo_system.h"
 
@@ -67,6 +69,12 @@
 #  define ARRAY_CHUNK_SIZE 256
 
 #  define USE_ARRAY_STORE_THREAD
+
+/**
+ * Support creating undo steps from the previous step,
+ * only storing vertices known to be modified (see #EDBM_undo_partial_hint_set).
+ */
+#  define USE_ARRAY_STORE_PARTIAL
 #endif
 
 #ifdef USE_ARRAY_STORE_THREAD
@@ -119,6 +127,9 @@ typedef struct UndoMesh {
     BArrayState **keyblocks;
     BArrayState *mselect;
   } store;
+
+  /** Unique (non-zero) identifier, see #BMEditMesh.undo_partial_state_id. */
+  int state_id;
 #endif /* USE_ARRAY_STORE */
 
   size_t undo_size;
@@ -144,6 +155,9 @@ static struct {
   TaskPool *task_pool;
 #  endif
 
+  /** Used to generate #UndoMesh.state_id. */
+  int state_id_last;
+
 } um_arraystore = {{NULL}};
 
 static void um_arraystore_cd_compact(struct CustomData *cdata,
@@ -529,6 +543,207 @@ static void um_arraystore_free(UndoMesh *um)
 
 /** \} */
 
+#  ifdef USE_ARRAY_STORE_PARTIAL
+
+/* -------------------------------------------------------------------- */
+/** \name Array Store Partial Steps
+ *
+ * When only some vertices have been moved since the previous undo step (transform for e.g.),
+ * the new step is created from the previous one's states, replacing only the modified vertices.
+ *
+ * This avoids converting the whole #BMesh into a #Mesh & de-duplicating all its arrays,
+ * so the cost of the undo push is proportional to the edit instead of the mesh size.
+ * \{ */
+
+static int um_partial_cmp_int(const void *a_, const void *b_)
+{
+  const int a = *(const int *)a_;
+  const int b = *(const int *)b_;
+  return (a > b) - (a < b);
+}
+
+/**
+ * Copy the layers of a compacted mesh (their data is always NULL).
+ */
+static void um_partial_cd_layout_copy(const CustomData *cdata_src, CustomData *cdata_dst)
+{
+  BLI_assert(cdata_src->pool == NULL);
+  *cdata_dst = *cdata_src;
+  if (cdata_src->layers) {
+    cdata_dst->layers = MEM_dupallocN(cdata_src->layers);
+    for (int i = 0; i < cdata_dst->totlayer; i++) {
+      BLI_assert(cdata_dst->layers[i].data == NULL);
+    }
+  }
+  if (cdata_src->external) {
+    cdata_dst->external = MEM_dupallocN(cdata_src->external);
+  }
+}
+
+/**
+ * Create states from `bcd_reference`, the first layer of `patch_type` is patched
+ * (pass -1 for no patching), all other non-dynamic layers share their data.
+ */
+static BArrayCustomData *um_partial_cd_copy(const BArrayCustomData *bcd_reference,
+                                            const size_t data_len,
+                                            const int patch_type,
+                                            const uint *patch_index,
+                                            const void *patch_data,
+                                            const size_t patch_len)
+{
+  BArrayCustomData *bcd_first = NULL, *bcd_prev = NULL;
+  for (const BArrayCustomData *bcd_src = bcd_reference; bcd_src; bcd_src = bcd_src->next) {
+    const CustomDataType type = bcd_src->type;
+    const int stride = CustomData_sizeof(type);
+    BArrayStore *bs = BLI_array_store_at_size_get(&um_arraystore.bs_stride, stride);
+
+    BArrayCustomData *bcd = MEM_callocN(
+        sizeof(BArrayCustomData) + (bcd_src->states_len * sizeof(BArrayState *)), __func__);
+    bcd->next = NULL;
+    bcd->type = type;
+    bcd->states_len = bcd_src->states_len;
+
+    if (bcd_prev) {
+      bcd_prev->next = bcd;
+    }
+    else {
+      bcd_first = bcd;
+    }
+    bcd_prev = bcd;
+
+    for (int i = 0; i < bcd_src->states_len; i++) {
+      BArrayState *state_src = bcd_src->states[i];
+      if (state_src == NULL) {
+        bcd->states[i] = NULL;
+      }
+      else if (CustomData_layertype_is_dynamic(type)) {
+        /* Dynamic layers reference memory owned by each undo step,
+         * sharing the states would free this memory twice, so copy them. */
+        size_t state_len;
+        void *data_src = BLI_array_store_state_data_get_alloc(state_src, &state_len);
+        void *data_dst = MEM_mallocN(state_len, __func__);
+        BLI_assert(state_len == data_len * stride);
+        CustomData_copy_elements(type, data_src, data_dst, (int)data_len);
+        bcd->states[i] = BLI_array_store_state_add(bs, data_dst, state_len, state_src);
+        MEM_freeN(data_src);
+        MEM_freeN(data_dst);
+      }
+      else if ((type == patch_type) && (i == 0)) {
+        bcd->states[i] = BLI_array_store_state_add_patched(
+            bs, state_src, patch_index, patch_data, patch_len);
+      }
+      else {
+        bcd->states[i] = BLI_array_store_state_add_patched(bs, state_src, NULL, NULL, 0);
+      }
+    }
+  }
+  return bcd_first;
+}
+
+static bool um_partial_cd_has_layer(const BArrayCustomData *bcd, const CustomDataType type)
+{
+  for (; bcd; bcd = bcd->next) {
+    if (bcd->type == type) {
+      return (bcd->states_len != 0) && (bcd->states[0] != NULL);
+    }
+  }
+  return false;
+}
+
+/**
+ * Create `um` from `um_ref` and the vertices in #BMEditMesh.undo_partial_verts.
+ *
+ * \return false when the edit-mesh can't be stored as a partial step,
+ * the caller must perform a full conversion in this case.
+ */
+static bool um_arraystore_partial_from_editmesh(UndoMesh *um,
+                                                BMEditMesh *em,
+                                                const Key *key,
+                                                const UndoMesh *um_ref)
+{
+  BMesh *bm = em->bm;
+
+  if ((em->undo_partial_verts == NULL) || (um_ref == NULL) ||
+      (um_ref->state_id != em->undo_partial_state_id)) {
+    return false;
+  }
+
+  const Mesh *me_ref = &um_ref->me;
+
+  /* Shape keys are stored in full by each step, not worth supporting. */
+  if ((key != NULL) || (me_ref->key != NULL)) {
+    return false;
+  }
+
+  /* Paranoid checks, the hint should have been cleared on any topology change. */
+  if ((me_ref->totvert != bm->totvert) || (me_ref->totedge != bm->totedge) ||
+      (me_ref->totloop != bm->totloop) || (me_ref->totpoly != bm->totface) ||
+      (um_ref->selectmode != em->selectmode) || (um_ref->shapenr != bm->shapenr)) {
+    return false;
+  }
+
+  if (!um_partial_cd_has_layer(um_ref->store.vdata, CD_MVERT)) {
+    return false;
+  }
+
+  const int patch_len = em->undo_partial_verts_len;
+  uint *patch_index = (uint *)em->undo_partial_verts;
+  MVert *mvert_patch = MEM_mallocN(sizeof(*mvert_patch) * (size_t)max_ii(patch_len, 1),
+                                   __func__);
+
+  BM_mesh_elem_table_ensure(bm, BM_VERT);
+  const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+  for (int i = 0; i < patch_len; i++) {
+    BMVert *v = BM_vert_at_index(bm, (int)patch_index[i]);
+    MVert *mv = &mvert_patch[i];
+    /* Matches #BM_mesh_bm_to_me. */
+    copy_v3_v3(mv->co, v->co);
+    normal_float_to_short_v3(mv->no, v->no);
+    mv->flag = BM_vert_flag_to_mflag(v);
+    mv->bweight = (cd_vert_bweight_offset != -1) ?
+                      BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset) :
+                      0;
+  }
+
+  /* The mesh data-blocks of undo steps are never evaluated,
+   * only the custom-data layout & settings are needed. */
+  um->me = *me_ref;
+  BKE_mesh_runtime_reset(&um->me);
+  um_partial_cd_layout_copy(&me_ref->vdata, &um->me.vdata);
+  um_partial_cd_layout_copy(&me_ref->edata, &um->me.edata);
+  um_partial_cd_layout_copy(&me_ref->fdata, &um->me.fdata);
+  um_partial_cd_layout_copy(&me_ref->ldata, &um->me.ldata);
+  um_partial_cd_layout_copy(&me_ref->pdata, &um->me.pdata);
+  BLI_assert(me_ref->mselect == NULL);
+
+  um->store.vdata = um_partial_cd_copy(
+      um_ref->store.vdata, me_ref->totvert, CD_MVERT, patch_index, mvert_patch, patch_len);
+  um->store.edata = um_partial_cd_copy(um_ref->store.edata, me_ref->totedge, -1, NULL, NULL, 0);
+  um->store.ldata = um_partial_cd_copy(um_ref->store.ldata, me_ref->totloop, -1, NULL, NULL, 0);
+  um->store.pdata = um_partial_cd_copy(um_ref->store.pdata, me_ref->totpoly, -1, NULL, NULL, 0);
+
+  if (um_ref->store.mselect) {
+    BArrayStore *bs = BLI_array_store_at_size_get(&um_arraystore.bs_stride, sizeof(MSelect));
+    um->store.mselect = BLI_array_store_state_add_patched(
+        bs, um_ref->store.mselect, NULL, NULL, 0);
+  }
+
+  MEM_freeN(mvert_patch);
+
+  um->selectmode = um_ref->selectmode;
+  um->shapenr = um_ref->shapenr;
+
+  um_arraystore.users += 1;
+
+  BKE_mesh_update_customdata_pointers(&um->me, false);
+
+  return true;
+}
+
+/** \} */
+
+#  endif /* USE_ARRAY_STORE_PARTIAL */
+
 /* -------------------------------------------------------------------- */
 /** \name Array Store Utilities
  * \{ */
@@ -594,6 +809,16 @@ static void *undomesh_from_editmesh(UndoMesh *um, BMEditMesh *em, Key *key, Undo
     BLI_task_pool_work_and_wait(um_arraystore.task_pool);
   }
 #endif
+#ifdef USE_ARRAY_STORE_PARTIAL
+  if (um_arraystore_partial_from_editmesh(um, em, key, um_ref)) {
+    um->state_id = ++um_arraystore.state_id_last;
+    em->undo_partial_state_id = um->state_id;
+    EDBM_undo_partial_hint_clear(em);
+    BLI_addtail(&um_arraystore.local_links, um);
+    return um;
+  }
+#endif
+
   /* make sure shape keys work */
   if (key != NULL) {
     um->me.key = (Key *)BKE_id_copy_ex(
@@ -621,6 +846,10 @@ static void *undomesh_from_editmesh(UndoMesh *um, BMEditMesh *em, Key *key, Undo
 
 #ifdef USE_ARRAY_STORE
   {
+    um->state_id = ++um_arraystore.state_id_last;
+    em->undo_partial_state_id = um->state_id;
+    EDBM_undo_partial_hint_clear(em);
+
     /* Add ourselves. */
     BLI_addtail(&um_arraystore.local_links, um);
 
@@ -691,6 +920,10 @@ static void undomesh_to_editmesh(UndoMesh *um, Object *ob, BMEditMesh *em, Key *
   em->selectmode = um->selectmode;
   bm->selectmode = um->selectmode;
 
+#ifdef USE_ARRAY_STORE
+  em->undo_partial_state_id = um->state_id;
+#endif
+
   bm->spacearr_dirty = BM_SPACEARR_DIRTY_ALL;
 
   /* T35170: Restore the active key on the RealMesh. Otherwise 'fake' offset propagation happens
@@ -768,6 +1001,59 @@ static Object *editmesh_object_from_context(bContext *C)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Partial Undo Hints
+ * \{ */
+
+/**
+ * Let the next undo push know only `verts` have been modified since the last undo step,
+ * only their coordinates & normals may have changed (no topology or selection changes).
+ *
+ * Only call this when the undo step is pushed right after, as transform does when it's
+ * confirmed and not nested in another operator.
+ * Any operation which invalidates this must call #EDBM_undo_partial_hint_clear
+ * (done by #EDBM_update_generic, #EDBM_op_finish & the selection flushing functions).
+ */
+void EDBM_undo_partial_hint_set(BMEditMesh *em, BMVert **verts, const int verts_len)
+{
+  EDBM_undo_partial_hint_clear(em);
+
+#ifdef USE_ARRAY_STORE_PARTIAL
+  if (em->undo_partial_state_id == 0) {
+    return;
+  }
+
+  BM_mesh_elem_index_ensure(em->bm, BM_VERT);
+
+  int *verts_index = MEM_mallocN(sizeof(*verts_index) * (size_t)max_ii(verts_len, 1), __func__);
+  for (int i = 0; i < verts_len; i++) {
+    verts_index[i] = BM_elem_index_get(verts[i]);
+  }
+  qsort(verts_index, (size_t)verts_len, sizeof(*verts_index), um_partial_cmp_int);
+
+  /* Callers may pass in duplicates. */
+  int verts_index_len = 0;
+  for (int i = 0; i < verts_len; i++) {
+    if ((verts_index_len == 0) || (verts_index[verts_index_len - 1] != verts_index[i])) {
+      verts_index[verts_index_len++] = verts_index[i];
+    }
+  }
+
+  em->undo_partial_verts = verts_index;
+  em->undo_partial_verts_len = verts_index_len;
+#else
+  UNUSED_VARS(verts, verts_len);
+#endif
+}
+
+void EDBM_undo_partial_hint_clear(BMEditMesh *em)
+{
+  MEM_SAFE_FREE(em->undo_partial_verts);
+  em->undo_partial_verts_len = 0;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  *
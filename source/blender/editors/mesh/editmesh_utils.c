@@ -88,6 +88,8 @@ void EDBM_redo_state_restore(BMBackup backup, BMEditMesh *em, int recalctess)
   MEM_freeN(tmpbm);
   tmpbm = NULL;
 
+  EDBM_undo_partial_hint_clear(em);
+
   if (recalctess) {
     BKE_editmesh_looptri_calc(em);
   }
@@ -149,6 +151,9 @@ bool EDBM_op_finish(BMEditMesh *em, BMOperator *bmop, wmOperator *op, const bool
 
   BMO_op_finish(em->bm, bmop);
 
+  /* Operators may change anything, any hint for partial undo is no longer valid. */
+  EDBM_undo_partial_hint_clear(em);
+
   if (BMO_error_get(em->bm, &errmsg, NULL)) {
     BMEditMesh *emcopy = em->emcopy;
 
@@ -439,6 +444,8 @@ void EDBM_selectmode_to_scene(bContext *C)
 void EDBM_selectmode_flush_ex(BMEditMesh *em, const short selectmode)
 {
   BM_mesh_select_mode_flush_ex(em->bm, selectmode);
+  /* Selection isn't included in partial undo hints. */
+  EDBM_undo_partial_hint_clear(em);
 }
 
 void EDBM_selectmode_flush(BMEditMesh *em)
@@ -451,6 +458,7 @@ void EDBM_deselect_flush(BMEditMesh *em)
   /* function below doesn't use. just do this to keep the values in sync */
   em->bm->selectmode = em->selectmode;
   BM_mesh_deselect_flush(em->bm);
+  EDBM_undo_partial_hint_clear(em);
 }
 
 void EDBM_select_flush(BMEditMesh *em)
@@ -458,6 +466,7 @@ void EDBM_select_flush(BMEditMesh *em)
   /* function below doesn't use. just do this to keep the values in sync */
   em->bm->selectmode = em->selectmode;
   BM_mesh_select_flush(em->bm);
+  EDBM_undo_partial_hint_clear(em);
 }
 
 void EDBM_select_more(BMEditMesh *em, const bool use_face_step)
@@ -510,11 +519,13 @@ void EDBM_select_less(BMEditMesh *em, const bool use_face_step)
 void EDBM_flag_disable_all(BMEditMesh *em, const char hflag)
 {
   BM_mesh_elem_hflag_disable_all(em->bm, BM_VERT | BM_EDGE | BM_FACE, hflag, false);
+  EDBM_undo_partial_hint_clear(em);
 }
 
 void EDBM_flag_enable_all(BMEditMesh *em, const char hflag)
 {
   BM_mesh_elem_hflag_enable_all(em->bm, BM_VERT | BM_EDGE | BM_FACE, hflag, true);
+  EDBM_undo_partial_hint_clear(em);
 }
 
 /** \} */
@@ -1408,6 +1419,7 @@ bool EDBM_mesh_reveal(BMEditMesh *em, bool select)
 void EDBM_mesh_normals_update(BMEditMesh *em)
 {
   BM_mesh_normals_update(em->bm);
+  EDBM_undo_partial_hint_clear(em);
 }
 
 void EDBM_stats_update(BMEditMesh *em)
@@ -1452,6 +1464,9 @@ void EDBM_update_generic(Mesh *mesh, const bool do_tessellation, const bool is_d
     BKE_editmesh_looptri_calc(em);
   }
 
+  /* Any hint for partial undo is no longer valid. */
+  EDBM_undo_partial_hint_clear(em);
+
   if (is_destructive) {
     /* TODO. we may be able to remove this now! - Campbell */
     // BM_mesh_elem_table_free(em->bm, BM_ALL_NOLOOP);
@@ -149,6 +149,9 @@ typedef enum {
   T_AUTOMERGE = 1 << 20,
   /** Runs auto-merge & splits. */
   T_AUTOSPLIT = 1 << 21,
+
+  /** The operator pushes an undo step when it finishes (it's not nested in another operator). */
+  T_UNDO_PUSH = 1 << 22,
 } eTFlag;
 
 /** #TransInfo.modifiers */
@@ -1858,6 +1858,43 @@ void recalcData_mesh(TransInfo *t)
 /** \name Special After Transform Mesh
  * \{ */
 
+/**
+ * When only vertex locations changed, let the undo system know which vertices were modified,
+ * so it can avoid storing the entire mesh.
+ */
+static void tc_mesh_undo_partial_hint_set(TransDataContainer *tc)
+{
+  struct TransCustomDataMesh *tcmd = tc->custom.type.data;
+  if ((tcmd == NULL) || (tcmd->partial_update.cache == NULL) ||
+      (tcmd->cd_layer_correct != NULL)) {
+    return;
+  }
+
+  BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
+  const BMPartialUpdate *bmpinfo = tcmd->partial_update.cache;
+
+  /* The partial update only contains vertices used by faces,
+   * also include transformed vertices in case they're loose. */
+  int verts_len = 0;
+  BMVert **verts = MEM_mallocN(
+      sizeof(*verts) * (size_t)(bmpinfo->verts_len + tc->data_len + tc->data_mirror_len),
+      __func__);
+  for (int i = 0; i < bmpinfo->verts_len; i++) {
+    verts[verts_len++] = bmpinfo->verts[i];
+  }
+  TransData *td = tc->data;
+  for (int i = 0; i < tc->data_len; i++, td++) {
+    verts[verts_len++] = (BMVert *)td->extra;
+  }
+  TransDataMirror *td_mirror = tc->data_mirror;
+  for (int i = 0; i < tc->data_mirror_len; i++, td_mirror++) {
+    verts[verts_len++] = (BMVert *)td_mirror->extra;
+  }
+
+  EDBM_undo_partial_hint_set(em, verts, verts_len);
+  MEM_freeN(verts);
+}
+
 void special_aftertrans_update__mesh(bContext *UNUSED(C), TransInfo *t)
 {
   const bool is_canceling = (t->state == TRANS_CANCEL);
@@ -1910,6 +1947,17 @@ void special_aftertrans_update__mesh(bContext *UNUSED(C), TransInfo *t)
     }
   }
 
+  /* Only tell undo which vertices were modified when its step is pushed right after transform,
+   * otherwise the mesh may be changed further before the push. */
+  const bool use_undo_partial = !is_canceling && !use_automerge && (t->flag & T_UNDO_PUSH) &&
+                                (t->data_type == TC_MESH_VERTS);
+  FOREACH_TRANS_DATA_CONTAINER (t, tc) {
+    EDBM_undo_partial_hint_clear(BKE_editmesh_from_object(tc->obedit));
+    if (use_undo_partial) {
+      tc_mesh_undo_partial_hint_set(tc);
+    }
+  }
+
   FOREACH_TRANS_DATA_CONTAINER (t, tc) {
     /* table needs to be created for each edit command, since vertices can move etc */
     ED_mesh_mirror_spatial_table_end(tc->obedit);
@@ -197,6 +197,13 @@ void initTransInfo(bContext *C, TransInfo *t, wmOperator *op, const wmEvent *eve
     t->flag |= T_MODAL;
   }
 
+  /* The undo depth includes this operator, when it's the only one the window-manager pushes
+   * an undo step once it finishes. Macros push their undo step after all operators ran. */
+  if (op && (op->type->flag & OPTYPE_UNDO) && (op->opm == NULL) &&
+      (CTX_wm_manager(C)->op_undo_depth == 1)) {
+    t->flag |= T_UNDO_PUSH;
+  }
+
   /* Crease needs edge flag */
   if (ELEM(t->mode, TFM_CREASE, TFM_BWEIGHT)) {
     t->options |= CTX_EDGE_DATA;
@@ -123,6 +123,11 @@ bool ABC_mesh_topology_changed(struct CacheReader *reader,
                                const float time,
                                const char **err_str);
 
+/* Decode upcoming samples of an animated mesh on worker threads in ABC_read_mesh. The decoded
+ * samples of all meshes of the archive share memory_limit_mb megabytes. Zero disables
+ * prefetching. */
+void ABC_mesh_prefetch_set(struct CacheReader *reader, int memory_limit_mb);
+
 void CacheReader_incref(struct CacheReader *reader);
 void CacheReader_free(struct CacheReader *reader);
 
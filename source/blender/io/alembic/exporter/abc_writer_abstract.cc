@@ -71,6 +71,20 @@ void ABCAbstractWriter::write(HierarchyContext &context)
   frame_has_been_written_ = true;
 }
 
+void ABCAbstractWriter::prepare(HierarchyContext &context)
+{
+  /* Same check as in write(); on the first frame `is_animated_` is not known yet, but the frame
+   * is always written. */
+  if (frame_has_been_written_ && !is_animated_) {
+    return;
+  }
+  do_prepare(context);
+}
+
+void ABCAbstractWriter::do_prepare(HierarchyContext & /*context*/)
+{
+}
+
 void ABCAbstractWriter::ensure_custom_properties_exporter(const HierarchyContext &context)
 {
   if (!args_.export_params->export_custom_properties) {
@@ -52,6 +52,8 @@ class ABCAbstractWriter : public AbstractHierarchyWriter {
   explicit ABCAbstractWriter(const ABCWriterConstructorArgs &args);
 
   virtual void write(HierarchyContext &context) override;
+  /* Calls do_prepare() when write() is going to write the current frame. */
+  virtual void prepare(HierarchyContext &context) override;
 
   /* Returns true if the data to be written is actually supported. This would, for example, allow a
    * hypothetical camera writer accept a perspective camera but reject an orthogonal one.
@@ -83,6 +85,8 @@ class ABCAbstractWriter : public AbstractHierarchyWriter {
 
  protected:
   virtual void do_write(HierarchyContext &context) = 0;
+  /* Only called when supports_prepare() returns true. */
+  virtual void do_prepare(HierarchyContext &context);
 
   virtual void update_bounding_box(Object *object);
 
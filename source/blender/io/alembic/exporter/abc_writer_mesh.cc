@@ -44,6 +44,8 @@
 #include "DNA_object_fluidsim_types.h"
 #include "DNA_particle_types.h"
 
+#include "MEM_guardedalloc.h"
+
 #include "CLG_log.h"
 static CLG_LogRef LOG = {"io.alembic"};
 
@@ -84,8 +86,16 @@ static void get_loop_normals(struct Mesh *mesh,
                              bool has_flat_shaded_poly);
 
 ABCGenericMeshWriter::ABCGenericMeshWriter(const ABCWriterConstructorArgs &args)
-    : ABCAbstractWriter(args), is_subd_(false)
+    : ABCAbstractWriter(args), is_subd_(false), frame_is_prepared_(false)
+{
+}
+
+ABCGenericMeshWriter::~ABCGenericMeshWriter()
 {
+  /* The mesh of a frame that was prepared but not written, because writing threw an exception
+   * before do_write() was reached (for this or another writer). The derived class is already
+   * destroyed, so this uses the #free_export_mesh() of this class. */
+  free_frame_mesh();
 }
 
 void ABCGenericMeshWriter::create_alembic_objects(const HierarchyContext *context)
@@ -167,8 +177,17 @@ bool ABCGenericMeshWriter::is_supported(const HierarchyContext *context) const
   return true;
 }
 
-void ABCGenericMeshWriter::do_write(HierarchyContext &context)
+bool ABCGenericMeshWriter::supports_prepare() const
+{
+  return true;
+}
+
+void ABCGenericMeshWriter::do_prepare(HierarchyContext &context)
 {
+  /* Not written when writing the previous frame threw an exception. */
+  free_frame_mesh();
+  frame_is_prepared_ = true;
+
   Object *object = context.object;
   bool needsfree = false;
 
@@ -199,6 +218,9 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
     needsfree = true;
   }
 
+  frame_.mesh = mesh;
+  frame_.needsfree = needsfree;
+
   m_custom_data_config.pack_uvs = args_.export_params->packuv;
   m_custom_data_config.mesh = mesh;
   m_custom_data_config.mpoly = mesh->mpoly;
@@ -208,23 +230,68 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
   m_custom_data_config.totvert = mesh->totvert;
 
   try {
+    get_vertices(mesh, frame_.points);
+    get_topology(mesh, frame_.poly_verts, frame_.loop_counts, frame_.has_flat_shaded_poly);
+
+    if (args_.export_params->uvs) {
+      frame_.uvs_and_indices.uvs.clear();
+      frame_.uvs_and_indices.indices.clear();
+      frame_.uv_name = get_uv_sample(frame_.uvs_and_indices, m_custom_data_config, &mesh->ldata);
+    }
+
     if (is_subd_) {
-      write_subd(context, mesh);
+      get_creases(mesh, frame_.crease_indices, frame_.crease_lengths, frame_.crease_sharpness);
+      return;
     }
-    else {
-      write_mesh(context, mesh);
+
+    if (args_.export_params->normals) {
+      get_loop_normals(mesh, frame_.normals, frame_.has_flat_shaded_poly);
     }
 
-    if (needsfree) {
-      free_export_mesh(mesh);
+    if (liquid_sim_modifier_ != nullptr) {
+      get_velocities(mesh, frame_.velocities);
     }
   }
   catch (...) {
-    if (needsfree) {
-      free_export_mesh(mesh);
+    free_frame_mesh();
+    throw;
+  }
+}
+
+void ABCGenericMeshWriter::do_write(HierarchyContext &context)
+{
+  if (!frame_is_prepared_) {
+    do_prepare(context);
+  }
+  frame_is_prepared_ = false;
+
+  Mesh *mesh = frame_.mesh;
+  if (mesh == nullptr) {
+    return;
+  }
+
+  try {
+    if (is_subd_) {
+      write_subd(context, mesh);
     }
+    else {
+      write_mesh(context, mesh);
+    }
+  }
+  catch (...) {
+    free_frame_mesh();
     throw;
   }
+  free_frame_mesh();
+}
+
+void ABCGenericMeshWriter::free_frame_mesh()
+{
+  if (frame_.needsfree) {
+    free_export_mesh(frame_.mesh);
+  }
+  frame_.mesh = nullptr;
+  frame_.needsfree = false;
 }
 
 void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
@@ -234,25 +301,17 @@ void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
 
 void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
 {
-  std::vector<Imath::V3f> points, normals;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<Imath::V3f> velocities;
-  bool has_flat_shaded_poly = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_shaded_poly);
-
   if (!frame_has_been_written_ && args_.export_params->face_sets) {
     write_face_sets(context.object, mesh, abc_poly_mesh_schema_);
   }
 
   OPolyMeshSchema::Sample mesh_sample = OPolyMeshSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
-
-  UVSample uvs_and_indices;
+      V3fArraySample(frame_.points),
+      Int32ArraySample(frame_.poly_verts),
+      Int32ArraySample(frame_.loop_counts));
 
   if (args_.export_params->uvs) {
-    const char *name = get_uv_sample(uvs_and_indices, m_custom_data_config, &mesh->ldata);
+    const UVSample &uvs_and_indices = frame_.uvs_and_indices;
 
     if (!uvs_and_indices.indices.empty() && !uvs_and_indices.uvs.empty()) {
       OV2fGeomParam::Sample uv_sample;
@@ -260,7 +319,7 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
       uv_sample.setIndices(UInt32ArraySample(uvs_and_indices.indices));
       uv_sample.setScope(kFacevaryingScope);
 
-      abc_poly_mesh_schema_.setUVSourceName(name);
+      abc_poly_mesh_schema_.setUVSourceName(frame_.uv_name);
       mesh_sample.setUVs(uv_sample);
     }
 
@@ -269,12 +328,10 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
   }
 
   if (args_.export_params->normals) {
-    get_loop_normals(mesh, normals, has_flat_shaded_poly);
-
     ON3fGeomParam::Sample normals_sample;
-    if (!normals.empty()) {
+    if (!frame_.normals.empty()) {
       normals_sample.setScope(kFacevaryingScope);
-      normals_sample.setVals(V3fArraySample(normals));
+      normals_sample.setVals(V3fArraySample(frame_.normals));
     }
 
     mesh_sample.setNormals(normals_sample);
@@ -285,8 +342,7 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
   }
 
   if (liquid_sim_modifier_ != nullptr) {
-    get_velocities(mesh, velocities);
-    mesh_sample.setVelocities(V3fArraySample(velocities));
+    mesh_sample.setVelocities(V3fArraySample(frame_.velocities));
   }
 
   update_bounding_box(context.object);
@@ -299,26 +355,16 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
 
 void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *mesh)
 {
-  std::vector<float> crease_sharpness;
-  std::vector<Imath::V3f> points;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<int32_t> crease_indices, crease_lengths;
-  bool has_flat_poly = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_poly);
-  get_creases(mesh, crease_indices, crease_lengths, crease_sharpness);
-
   if (!frame_has_been_written_ && args_.export_params->face_sets) {
     write_face_sets(context.object, mesh, abc_subdiv_schema_);
   }
 
-  OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+  OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(V3fArraySample(frame_.points),
+                                                          Int32ArraySample(frame_.poly_verts),
+                                                          Int32ArraySample(frame_.loop_counts));
 
-  UVSample sample;
   if (args_.export_params->uvs) {
-    const char *name = get_uv_sample(sample, m_custom_data_config, &mesh->ldata);
+    const UVSample &sample = frame_.uvs_and_indices;
 
     if (!sample.indices.empty() && !sample.uvs.empty()) {
       OV2fGeomParam::Sample uv_sample;
@@ -326,7 +372,7 @@ void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *me
       uv_sample.setIndices(UInt32ArraySample(sample.indices));
       uv_sample.setScope(kFacevaryingScope);
 
-      abc_subdiv_schema_.setUVSourceName(name);
+      abc_subdiv_schema_.setUVSourceName(frame_.uv_name);
       subdiv_sample.setUVs(uv_sample);
     }
 
@@ -338,10 +384,10 @@ void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *me
     write_generated_coordinates(abc_poly_mesh_schema_.getArbGeomParams(), m_custom_data_config);
   }
 
-  if (!crease_indices.empty()) {
-    subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices));
-    subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths));
-    subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness));
+  if (!frame_.crease_indices.empty()) {
+    subdiv_sample.setCreaseIndices(Int32ArraySample(frame_.crease_indices));
+    subdiv_sample.setCreaseLengths(Int32ArraySample(frame_.crease_lengths));
+    subdiv_sample.setCreaseSharpnesses(FloatArraySample(frame_.crease_sharpness));
   }
 
   update_bounding_box(context.object);
@@ -536,9 +582,51 @@ static void get_loop_normals(struct Mesh *mesh,
     return;
   }
 
-  BKE_mesh_calc_normals_split(mesh);
-  const float(*lnors)[3] = static_cast<float(*)[3]>(CustomData_get_layer(&mesh->ldata, CD_NORMAL));
-  BLI_assert(lnors != nullptr || !"BKE_mesh_calc_normals_split() should have computed CD_NORMAL");
+  /* Compute the normals into a temporary array instead of a CD_NORMAL layer: the evaluated mesh
+   * can be shared by writers which extract their data at the same time. */
+  const bool use_split_normals = (mesh->flag & ME_AUTOSMOOTH) != 0;
+  const float split_angle = use_split_normals ? mesh->smoothresh : float(M_PI);
+
+  float(*polynors)[3] = static_cast<float(*)[3]>(CustomData_get_layer(&mesh->pdata, CD_NORMAL));
+  const bool free_polynors = (polynors == nullptr);
+  if (free_polynors) {
+    polynors = static_cast<float(*)[3]>(
+        MEM_malloc_arrayN(mesh->totpoly, sizeof(float[3]), __func__));
+    BKE_mesh_calc_normals_poly(mesh->mvert,
+                               nullptr,
+                               mesh->totvert,
+                               mesh->mloop,
+                               mesh->mpoly,
+                               mesh->totloop,
+                               mesh->totpoly,
+                               polynors,
+                               true);
+  }
+
+  float(*lnors)[3] = static_cast<float(*)[3]>(
+      MEM_calloc_arrayN(mesh->totloop, sizeof(float[3]), __func__));
+  short(*clnors)[2] = static_cast<short(*)[2]>(
+      CustomData_get_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL));
+
+  BKE_mesh_normals_loop_split(mesh->mvert,
+                              mesh->totvert,
+                              mesh->medge,
+                              mesh->totedge,
+                              mesh->mloop,
+                              lnors,
+                              mesh->totloop,
+                              mesh->mpoly,
+                              polynors,
+                              mesh->totpoly,
+                              use_split_normals,
+                              split_angle,
+                              nullptr,
+                              clnors,
+                              nullptr);
+
+  if (free_polynors) {
+    MEM_freeN(polynors);
+  }
 
   normals.resize(mesh->totloop);
 
@@ -551,6 +639,8 @@ static void get_loop_normals(struct Mesh *mesh,
       copy_yup_from_zup(normals[abc_index].getValue(), lnors[blender_index]);
     }
   }
+
+  MEM_freeN(lnors);
 }
 
 ABCMeshWriter::ABCMeshWriter(const ABCWriterConstructorArgs &args) : ABCGenericMeshWriter(args)
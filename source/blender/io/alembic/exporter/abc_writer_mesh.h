@@ -49,15 +49,41 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
 
   CDStreamConfig m_custom_data_config;
 
+  /* Data of the current frame, extracted by do_prepare() and written to Alembic by do_write().
+   * The arrays are kept between frames, to avoid reallocating them for every frame. */
+  struct FrameData {
+    Mesh *mesh = nullptr;
+    bool needsfree = false;
+    bool has_flat_shaded_poly = false;
+
+    std::vector<Imath::V3f> points;
+    std::vector<int32_t> poly_verts;
+    std::vector<int32_t> loop_counts;
+    std::vector<Imath::V3f> normals;
+    std::vector<Imath::V3f> velocities;
+    std::vector<int32_t> crease_indices;
+    std::vector<int32_t> crease_lengths;
+    std::vector<float> crease_sharpness;
+
+    UVSample uvs_and_indices;
+    const char *uv_name = nullptr;
+  };
+  FrameData frame_;
+  bool frame_is_prepared_;
+
  public:
   explicit ABCGenericMeshWriter(const ABCWriterConstructorArgs &args);
+  virtual ~ABCGenericMeshWriter();
 
   virtual void create_alembic_objects(const HierarchyContext *context) override;
   virtual Alembic::Abc::OObject get_alembic_object() const override;
   Alembic::Abc::OCompoundProperty abc_prop_for_custom_props() override;
 
+  virtual bool supports_prepare() const override;
+
  protected:
   virtual bool is_supported(const HierarchyContext *context) const override;
+  virtual void do_prepare(HierarchyContext &context) override;
   virtual void do_write(HierarchyContext &context) override;
 
   virtual Mesh *get_export_mesh(Object *object_eval, bool &r_needsfree) = 0;
@@ -68,6 +94,7 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
  private:
   void write_mesh(HierarchyContext &context, Mesh *mesh);
   void write_subd(HierarchyContext &context, Mesh *mesh);
+  void free_frame_mesh();
   template<typename Schema> void write_face_sets(Object *object, Mesh *mesh, Schema &schema);
 
   ModifierData *get_liquid_sim_modifier(Scene *scene_eval, Object *ob_eval);
@@ -0,0 +1,283 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup balembic
+ */
+
+#include "abc_mesh_sample_cache.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+
+#include "BLI_task.h"
+#include "BLI_vector.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+namespace blender::io::alembic {
+
+/** Samples decoded ahead of the current one, when the memory limit allows it. */
+static const int prefetch_samples_max = 8;
+
+struct DecodeTask {
+  MeshSampleCache::index_t index;
+  int read_flag;
+};
+
+static size_t customdata_size_in_bytes(const CustomData &data, const int elements_num)
+{
+  size_t size = 0;
+  for (int i = 0; i < data.totlayer; i++) {
+    const CustomDataLayer &layer = data.layers[i];
+    /* Layers referenced from the topology mesh are not owned. */
+    if ((layer.flag & CD_FLAG_NOFREE) == 0) {
+      size += static_cast<size_t>(CustomData_sizeof(layer.type)) * elements_num;
+    }
+  }
+  return size;
+}
+
+static size_t mesh_size_in_bytes(const Mesh *mesh)
+{
+  if (mesh == nullptr) {
+    return 0;
+  }
+  return sizeof(Mesh) + customdata_size_in_bytes(mesh->vdata, mesh->totvert) +
+         customdata_size_in_bytes(mesh->edata, mesh->totedge) +
+         customdata_size_in_bytes(mesh->ldata, mesh->totloop) +
+         customdata_size_in_bytes(mesh->pdata, mesh->totpoly);
+}
+
+static void mesh_free(Mesh *mesh)
+{
+  if (mesh != nullptr) {
+    BKE_id_free(nullptr, mesh);
+  }
+}
+
+MeshSampleCache::MeshSampleCache(DecodeFn decode_fn,
+                                 index_t samples_num,
+                                 bool share_topology,
+                                 std::shared_ptr<MeshSampleCacheBudget> budget)
+    : decode_fn_(std::move(decode_fn)),
+      samples_num_(samples_num),
+      share_topology_(share_topology),
+      budget_(std::move(budget)),
+      topology_mesh_(nullptr),
+      read_flag_(0),
+      memory_used_(0),
+      last_index_(0),
+      direction_(1)
+{
+  /* Tasks are pushed from whatever thread evaluates the modifier, so no isolation. */
+  task_pool_ = BLI_task_pool_create_background(this, TASK_PRIORITY_LOW, TASK_ISOLATION_OFF);
+}
+
+MeshSampleCache::~MeshSampleCache()
+{
+  BLI_task_pool_cancel(task_pool_);
+  BLI_task_pool_free(task_pool_);
+  free_samples();
+}
+
+const Mesh *MeshSampleCache::lookup(index_t index, int read_flag)
+{
+  if (read_flag != read_flag_) {
+    /* Samples decoded with other data layers cannot be used. */
+    BLI_task_pool_cancel(task_pool_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_samples();
+    read_flag_ = read_flag;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index != last_index_) {
+      direction_ = (index < last_index_) ? -1 : 1;
+      last_index_ = index;
+    }
+    const Sample *sample = samples_.lookup_ptr(index);
+    if (sample != nullptr) {
+      return sample->mesh;
+    }
+  }
+
+  /* The sample is missing or still being decoded by a worker. Waiting for the worker could
+   * dead-lock when all threads are busy evaluating the depsgraph, so decode it here. */
+  Mesh *mesh = decode(index, read_flag);
+  add_sample(index, read_flag, mesh);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return samples_.lookup(index).mesh;
+}
+
+void MeshSampleCache::prefetch(index_t index)
+{
+  Vector<index_t> indices_to_decode;
+  int read_flag;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict_passed_samples(index);
+    evict_samples(index);
+
+    /* Assume upcoming samples are about as large as the decoded ones. */
+    const size_t sample_size = samples_.is_empty() ? 0 : memory_used_ / samples_.size();
+    const size_t memory_limit = budget_->memory_limit();
+    size_t memory_scheduled = budget_->memory_used() + pending_.size() * sample_size;
+
+    for (int i = 1; i <= prefetch_samples_max; i++) {
+      const index_t next_index = index + i * direction_;
+      if (next_index < 0 || next_index >= samples_num_) {
+        break;
+      }
+      if (samples_.contains(next_index) || pending_.contains(next_index)) {
+        continue;
+      }
+      if (memory_scheduled + sample_size > memory_limit) {
+        break;
+      }
+      memory_scheduled += sample_size;
+      pending_.add_new(next_index);
+      indices_to_decode.append(next_index);
+    }
+    read_flag = read_flag_;
+  }
+
+  for (const index_t next_index : indices_to_decode) {
+    DecodeTask *task = static_cast<DecodeTask *>(MEM_mallocN(sizeof(DecodeTask), __func__));
+    task->index = next_index;
+    task->read_flag = read_flag;
+    BLI_task_pool_push(task_pool_, decode_task_run, task, true, nullptr);
+  }
+}
+
+void MeshSampleCache::decode_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  MeshSampleCache *cache = static_cast<MeshSampleCache *>(BLI_task_pool_user_data(pool));
+  const DecodeTask *task = static_cast<const DecodeTask *>(taskdata);
+
+  Mesh *mesh = cache->decode(task->index, task->read_flag);
+  cache->add_sample(task->index, task->read_flag, mesh);
+}
+
+Mesh *MeshSampleCache::decode(index_t index, int read_flag)
+{
+  const Mesh *topology_mesh;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    topology_mesh = share_topology_ ? topology_mesh_ : nullptr;
+  }
+  /* The topology mesh is never freed while tasks are running. */
+  return decode_fn_(index, read_flag, topology_mesh);
+}
+
+void MeshSampleCache::add_sample(index_t index, int read_flag, Mesh *mesh)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_.remove(index);
+
+  if (read_flag != read_flag_ || samples_.contains(index)) {
+    /* Decoded twice, or for settings that changed in the meantime. */
+    lock.unlock();
+    mesh_free(mesh);
+    return;
+  }
+
+  if (share_topology_ && topology_mesh_ == nullptr && mesh != nullptr) {
+    topology_mesh_ = BKE_mesh_copy_for_eval(mesh, false);
+    const size_t topology_size = mesh_size_in_bytes(topology_mesh_);
+    memory_used_ += topology_size;
+    budget_->add(topology_size);
+  }
+
+  const size_t size = mesh_size_in_bytes(mesh);
+  samples_.add_new(index, {mesh, size});
+  memory_used_ += size;
+  budget_->add(size);
+
+  /* Other meshes may have filled the budget since this sample was scheduled. */
+  evict_samples(last_index_);
+}
+
+void MeshSampleCache::free_samples()
+{
+  for (const Sample &sample : samples_.values()) {
+    mesh_free(sample.mesh);
+  }
+  samples_.clear();
+  pending_.clear();
+
+  /* Freed last, the other samples may reference its arrays. */
+  mesh_free(topology_mesh_);
+  topology_mesh_ = nullptr;
+  budget_->remove(memory_used_);
+  memory_used_ = 0;
+}
+
+void MeshSampleCache::free_sample(index_t index)
+{
+  const Sample sample = samples_.pop(index);
+  mesh_free(sample.mesh);
+  memory_used_ -= sample.size_in_bytes;
+  budget_->remove(sample.size_in_bytes);
+}
+
+void MeshSampleCache::evict_passed_samples(index_t index)
+{
+  /* Played samples are not needed again until playback loops, keep only the neighbor behind the
+   * current sample which is used for interpolation. */
+  Vector<index_t> passed_indices;
+  for (const index_t sample_index : samples_.keys()) {
+    if ((sample_index - index) * direction_ < -1) {
+      passed_indices.append(sample_index);
+    }
+  }
+  for (const index_t sample_index : passed_indices) {
+    free_sample(sample_index);
+  }
+}
+
+void MeshSampleCache::evict_samples(index_t index)
+{
+  while (budget_->is_exceeded()) {
+    /* Drop the samples furthest ahead of the current one. The current sample and its neighbors
+     * used for interpolation are kept, samples of other meshes are dropped by their own cache. */
+    index_t evict_index = -1;
+    index_t evict_priority = 0;
+    for (const index_t sample_index : samples_.keys()) {
+      const index_t distance = (sample_index - index) * direction_;
+      if (distance >= -1 && distance <= 1) {
+        continue;
+      }
+      const index_t priority = (distance < 0) ? samples_num_ - distance : distance;
+      if (priority > evict_priority) {
+        evict_index = sample_index;
+        evict_priority = priority;
+      }
+    }
+    if (evict_index == -1) {
+      break;
+    }
+    free_sample(evict_index);
+  }
+}
+
+}  // namespace blender::io::alembic
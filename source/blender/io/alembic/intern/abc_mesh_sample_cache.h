@@ -0,0 +1,147 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup balembic
+ */
+
+#include <Alembic/AbcGeom/All.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+
+struct Mesh;
+struct TaskPool;
+
+namespace blender::io::alembic {
+
+/**
+ * Memory limit shared by the sample caches of all meshes read from one archive, so that the memory
+ * used for a cache file does not grow with the number of animated meshes in it.
+ */
+class MeshSampleCacheBudget {
+  std::atomic<size_t> memory_limit_{0};
+  std::atomic<size_t> memory_used_{0};
+
+ public:
+  void set_memory_limit(size_t memory_limit)
+  {
+    memory_limit_ = memory_limit;
+  }
+  size_t memory_limit() const
+  {
+    return memory_limit_;
+  }
+  size_t memory_used() const
+  {
+    return memory_used_;
+  }
+  bool is_exceeded() const
+  {
+    return memory_used_ > memory_limit_;
+  }
+
+  void add(size_t size)
+  {
+    memory_used_ += size;
+  }
+  void remove(size_t size)
+  {
+    memory_used_ -= size;
+  }
+};
+
+/**
+ * Decoded samples of an animated mesh, keyed by sample index.
+ *
+ * Every lookup schedules the decoding of the following samples (in the direction of playback) on
+ * worker threads, so that the evaluation thread only has to copy ready-to-use mesh arrays. When
+ * the topology of the mesh does not change over time, the samples share the topology arrays of
+ * the first decoded sample. Samples that playback has passed are dropped right away, and the
+ * samples furthest ahead are dropped while the memory budget shared with the other meshes of the
+ * archive is exceeded.
+ */
+class MeshSampleCache {
+ public:
+  using index_t = Alembic::AbcGeom::index_t;
+  /**
+   * Decode the sample at the index into a new mesh, or return null on failure. Called from
+   * worker threads. When `topology` is given, the new mesh can reference its arrays.
+   */
+  using DecodeFn = std::function<Mesh *(index_t index, int read_flag, const Mesh *topology)>;
+
+ private:
+  struct Sample {
+    /** Null when decoding failed. */
+    Mesh *mesh;
+    size_t size_in_bytes;
+  };
+
+  DecodeFn decode_fn_;
+  index_t samples_num_;
+  bool share_topology_;
+  TaskPool *task_pool_;
+  std::shared_ptr<MeshSampleCacheBudget> budget_;
+
+  /** Protects all members below. */
+  std::mutex mutex_;
+  Map<index_t, Sample> samples_;
+  Set<index_t> pending_;
+  /** Owned copy of the first decoded sample, referenced by the other samples. */
+  Mesh *topology_mesh_;
+  int read_flag_;
+  /** Memory of the samples of this cache, also accounted in the budget. */
+  size_t memory_used_;
+  index_t last_index_;
+  int direction_;
+
+ public:
+  MeshSampleCache(DecodeFn decode_fn,
+                  index_t samples_num,
+                  bool share_topology,
+                  std::shared_ptr<MeshSampleCacheBudget> budget);
+  ~MeshSampleCache();
+
+  /**
+   * Get the decoded sample, decoding it on the calling thread when it is not ready yet. The mesh
+   * is owned by the cache and stays valid until the next call to #lookup.
+   */
+  const Mesh *lookup(index_t index, int read_flag);
+
+  /**
+   * Drop the samples that playback has passed and schedule decoding of the samples after the
+   * index. Only called after #lookup.
+   */
+  void prefetch(index_t index);
+
+ private:
+  static void decode_task_run(TaskPool *__restrict pool, void *taskdata);
+
+  Mesh *decode(index_t index, int read_flag);
+  void add_sample(index_t index, int read_flag, Mesh *mesh);
+  void free_samples();
+  void free_sample(index_t index);
+  void evict_passed_samples(index_t index);
+  void evict_samples(index_t index);
+};
+
+}  // namespace blender::io::alembic
@@ -22,11 +22,14 @@
  */
 
 #include "abc_reader_archive.h"
+#include "abc_mesh_sample_cache.h"
 
 #include "BKE_main.h"
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 
 #ifdef WIN32
 #  include "utfconv.h"
@@ -82,18 +85,29 @@ ArchiveReader::ArchiveReader(struct Main *bmain, const char *filename)
   BLI_strncpy(abs_filename, filename, FILE_MAX);
   BLI_path_abs(abs_filename, BKE_main_blendfile_path(bmain));
 
+  /* Mesh samples are prefetched by worker threads. */
+  const int streams_num = max_ii(1, min_ii(BLI_system_thread_count(), 8));
+
 #ifdef WIN32
   UTF16_ENCODE(abs_filename);
   std::wstring wstr(abs_filename_16);
-  m_infile.open(wstr.c_str(), std::ios::in | std::ios::binary);
-  UTF16_UN_ENCODE(abs_filename);
+#endif
+  for (int i = 0; i < streams_num; i++) {
+    std::unique_ptr<std::ifstream> infile = std::make_unique<std::ifstream>();
+#ifdef WIN32
+    infile->open(wstr.c_str(), std::ios::in | std::ios::binary);
 #else
-  m_infile.open(abs_filename, std::ios::in | std::ios::binary);
+    infile->open(abs_filename, std::ios::in | std::ios::binary);
+#endif
+    m_streams.push_back(infile.get());
+    m_infiles.push_back(std::move(infile));
+  }
+#ifdef WIN32
+  UTF16_UN_ENCODE(abs_filename);
 #endif
-
-  m_streams.push_back(&m_infile);
 
   m_archive = open_archive(abs_filename, m_streams);
+  m_mesh_sample_budget = std::make_shared<MeshSampleCacheBudget>();
 }
 
 bool ArchiveReader::valid() const
@@ -106,4 +120,9 @@ Alembic::Abc::IObject ArchiveReader::getTop()
   return m_archive.getTop();
 }
 
+const std::shared_ptr<MeshSampleCacheBudget> &ArchiveReader::mesh_sample_budget() const
+{
+  return m_mesh_sample_budget;
+}
+
 }  // namespace blender::io::alembic
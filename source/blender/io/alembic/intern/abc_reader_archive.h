@@ -26,11 +26,14 @@
 #include <Alembic/AbcCoreOgawa/All.h>
 
 #include <fstream>
+#include <memory>
 
 struct Main;
 
 namespace blender::io::alembic {
 
+class MeshSampleCacheBudget;
+
 /* Wrappers around input and output archives. The goal is to be able to use
  * streams so that unicode paths work on Windows (T49112), and to make sure that
  * the stream objects remain valid as long as the archives are open.
@@ -38,8 +41,11 @@ namespace blender::io::alembic {
 
 class ArchiveReader {
   Alembic::Abc::IArchive m_archive;
-  std::ifstream m_infile;
+  /* Ogawa reads from any stream that is not in use, so that samples can be read in parallel. */
+  std::vector<std::unique_ptr<std::ifstream>> m_infiles;
   std::vector<std::istream *> m_streams;
+  /* Shared by the prefetched samples of all meshes, the readers may outlive the archive. */
+  std::shared_ptr<MeshSampleCacheBudget> m_mesh_sample_budget;
 
  public:
   ArchiveReader(struct Main *bmain, const char *filename);
@@ -47,6 +53,8 @@ class ArchiveReader {
   bool valid() const;
 
   Alembic::Abc::IObject getTop();
+
+  const std::shared_ptr<MeshSampleCacheBudget> &mesh_sample_budget() const;
 };
 
 }  // namespace blender::io::alembic
@@ -35,7 +35,9 @@
 #include "BLI_compiler_compat.h"
 #include "BLI_listbase.h"
 #include "BLI_math_geom.h"
+#include "BLI_math_vector.h"
 
+#include "BKE_customdata.h"
 #include "BKE_main.h"
 #include "BKE_material.h"
 #include "BKE_mesh.h"
@@ -416,7 +418,8 @@ static void read_mesh_sample(const std::string &iobject_full_name,
                              ImportSettings *settings,
                              const IPolyMeshSchema &schema,
                              const ISampleSelector &selector,
-                             CDStreamConfig &config)
+                             CDStreamConfig &config,
+                             const bool reuse_topology = false)
 {
   const IPolyMeshSchema::Sample sample = schema.getValue(selector);
 
@@ -433,7 +436,7 @@ static void read_mesh_sample(const std::string &iobject_full_name,
     abc_mesh_data.ceil_positions = ceil_sample.getPositions();
   }
 
-  if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0) {
+  if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0 && !reuse_topology) {
     read_uvs_params(config, abc_mesh_data, schema.getUVsParam(), selector);
   }
 
@@ -443,15 +446,84 @@ static void read_mesh_sample(const std::string &iobject_full_name,
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
-    read_mpolys(config, abc_mesh_data);
+    if (!reuse_topology) {
+      read_mpolys(config, abc_mesh_data);
+    }
     process_normals(config, schema.getNormalsParam(), selector);
   }
 
-  if ((settings->read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
+  /* With reused topology, the constant UVs and colors are part of it. */
+  if ((settings->read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0 &&
+      !reuse_topology) {
     read_custom_data(iobject_full_name, schema.getArbGeomParams(), config, selector);
   }
 }
 
+/**
+ * Copy the data of a decoded sample into a mesh with the same number of vertices, polygons and
+ * loops. Like #read_mesh_sample, only the data in `read_flag` is copied.
+ */
+static void copy_mesh_sample(const Mesh *sample, Mesh *mesh, const int read_flag)
+{
+  BLI_assert(sample->totvert == mesh->totvert && sample->totpoly == mesh->totpoly &&
+             sample->totloop == mesh->totloop);
+
+  if ((read_flag & MOD_MESHSEQ_READ_VERT) != 0) {
+    for (int i = 0; i < mesh->totvert; i++) {
+      MVert &mvert = mesh->mvert[i];
+      copy_v3_v3(mvert.co, sample->mvert[i].co);
+      copy_v3_v3_short(mvert.no, sample->mvert[i].no);
+      mvert.bweight = 0;
+    }
+
+    const void *orco = CustomData_get_layer(&sample->vdata, CD_ORCO);
+    if (orco != nullptr) {
+      void *cd_data = CustomData_get_layer(&mesh->vdata, CD_ORCO);
+      if (cd_data == nullptr) {
+        cd_data = CustomData_add_layer(&mesh->vdata, CD_ORCO, CD_CALLOC, nullptr, mesh->totvert);
+      }
+      memcpy(cd_data, orco, sizeof(float[3]) * mesh->totvert);
+    }
+  }
+
+  if ((read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
+    /* Cheap compared to rebuilding the edges, which the sample already did. */
+    memcpy(mesh->mpoly, sample->mpoly, sizeof(MPoly) * mesh->totpoly);
+    memcpy(mesh->mloop, sample->mloop, sizeof(MLoop) * mesh->totloop);
+    if (mesh->totedge == sample->totedge) {
+      memcpy(mesh->medge, sample->medge, sizeof(MEdge) * mesh->totedge);
+    }
+    else {
+      CustomData_free(&mesh->edata, mesh->totedge);
+      mesh->totedge = sample->totedge;
+      CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_DUPLICATE, sample->medge, sample->totedge);
+      BKE_mesh_update_customdata_pointers(mesh, false);
+    }
+
+    const void *clnors = CustomData_get_layer(&sample->ldata, CD_CUSTOMLOOPNORMAL);
+    if (clnors != nullptr) {
+      void *cd_data = CustomData_get_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL);
+      if (cd_data == nullptr) {
+        cd_data = CustomData_add_layer(
+            &mesh->ldata, CD_CUSTOMLOOPNORMAL, CD_CALLOC, nullptr, mesh->totloop);
+      }
+      memcpy(cd_data, clnors, sizeof(short[2]) * mesh->totloop);
+      mesh->flag |= ME_AUTOSMOOTH;
+    }
+  }
+
+  if ((read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
+    for (int i = 0; i < sample->ldata.totlayer; i++) {
+      const CustomDataLayer &layer = sample->ldata.layers[i];
+      if (!ELEM(layer.type, CD_MLOOPUV, CD_MLOOPCOL)) {
+        continue;
+      }
+      void *cd_data = add_customdata_cb(mesh, layer.name, layer.type);
+      memcpy(cd_data, layer.data, CustomData_sizeof(layer.type) * mesh->totloop);
+    }
+  }
+}
+
 CDStreamConfig get_config(Mesh *mesh, const bool use_vertex_interpolation)
 {
   CDStreamConfig config;
@@ -624,6 +696,14 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
                                int read_flag,
                                const char **err_str)
 {
+  if (m_sample_cache) {
+    Mesh *mesh = read_mesh_from_cache(existing_mesh, sample_sel, read_flag);
+    if (mesh != nullptr) {
+      return mesh;
+    }
+    /* Reading the sample directly reports what went wrong. */
+  }
+
   IPolyMeshSchema::Sample sample;
   try {
     sample = m_schema.getValue(sample_sel);
@@ -711,6 +791,150 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   return existing_mesh;
 }
 
+void AbcMeshReader::set_prefetch_budget(std::shared_ptr<MeshSampleCacheBudget> budget)
+{
+  BLI_assert(!m_sample_cache);
+  m_sample_budget = std::move(budget);
+}
+
+void AbcMeshReader::set_prefetch_memory_limit(size_t memory_limit)
+{
+  if (memory_limit == 0 || m_schema.getNumSamples() < 2) {
+    m_sample_cache.reset();
+    return;
+  }
+
+  if (!m_sample_budget) {
+    m_sample_budget = std::make_shared<MeshSampleCacheBudget>();
+  }
+  m_sample_budget->set_memory_limit(memory_limit);
+
+  if (!m_sample_cache) {
+    /* Samples can share the topology arrays if nothing that is stored per loop changes. */
+    IV2fGeomParam uvs_param = m_schema.getUVsParam();
+    const bool share_topology = m_schema.getTopologyVariance() !=
+                                    Alembic::AbcGeom::kHeterogeneousTopology &&
+                                (!uvs_param.valid() || uvs_param.isConstant()) &&
+                                !has_animated_geom_params(m_schema.getArbGeomParams());
+
+    m_sample_cache = std::make_unique<MeshSampleCache>(
+        [this](Alembic::AbcGeom::index_t index, int read_flag, const Mesh *topology_mesh) {
+          return this->decode_sample(index, read_flag, topology_mesh);
+        },
+        m_schema.getNumSamples(),
+        share_topology,
+        m_sample_budget);
+  }
+}
+
+Mesh *AbcMeshReader::decode_sample(Alembic::AbcGeom::index_t index,
+                                   int read_flag,
+                                   const Mesh *topology_mesh)
+{
+  const ISampleSelector sample_sel(index);
+  try {
+    const IPolyMeshSchema::Sample sample = m_schema.getValue(sample_sel);
+    const int vert_count = sample.getPositions()->size();
+    const int poly_count = sample.getFaceCounts()->size();
+    const int loop_count = sample.getFaceIndices()->size();
+    if (poly_count > 0 && loop_count < poly_count * 2) {
+      /* Invalid, reading the sample directly reports the error. */
+      return nullptr;
+    }
+
+    const bool reuse_topology = topology_mesh != nullptr &&
+                                topology_mesh->totvert == vert_count &&
+                                topology_mesh->totpoly == poly_count &&
+                                topology_mesh->totloop == loop_count;
+    Mesh *mesh;
+    if (reuse_topology) {
+      /* Reference the topology arrays, and only own the layers that are read. */
+      mesh = BKE_mesh_copy_for_eval(const_cast<Mesh *>(topology_mesh), true);
+      CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
+      CustomData_duplicate_referenced_layer(&mesh->vdata, CD_ORCO, mesh->totvert);
+      CustomData_duplicate_referenced_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL, mesh->totloop);
+      if ((read_flag & MOD_MESHSEQ_READ_POLY) != 0 && m_schema.getNormalsParam().valid()) {
+        /* Setting custom normals tags edges as sharp. Own the edges, and start from the edges
+         * without the tags of the normals of the topology sample. */
+        MEdge *medge = static_cast<MEdge *>(
+            CustomData_duplicate_referenced_layer(&mesh->edata, CD_MEDGE, mesh->totedge));
+        for (int i = 0; i < mesh->totedge; i++) {
+          medge[i].flag &= ~ME_SHARP;
+        }
+      }
+      BKE_mesh_update_customdata_pointers(mesh, false);
+    }
+    else {
+      mesh = BKE_mesh_new_nomain(vert_count, 0, 0, loop_count, poly_count);
+    }
+
+    ImportSettings settings;
+    settings.read_flag = read_flag;
+
+    /* Samples are decoded exactly, interpolation happens when they are used. */
+    CDStreamConfig config = get_config(mesh, false);
+    config.time = m_schema.getTimeSampling()->getSampleTime(index);
+    read_mesh_sample(
+        m_iobject.getFullName(), &settings, m_schema, sample_sel, config, reuse_topology);
+
+    if (!reuse_topology && mesh->totpoly > 0) {
+      std::map<std::string, int> mat_map;
+      assign_facesets_to_mpoly(sample_sel, mesh->mpoly, mesh->totpoly, mat_map);
+    }
+    return mesh;
+  }
+  catch (Alembic::Util::Exception &) {
+    /* Reading the sample directly reports the error. */
+    return nullptr;
+  }
+}
+
+Mesh *AbcMeshReader::read_mesh_from_cache(Mesh *existing_mesh,
+                                          const ISampleSelector &sample_sel,
+                                          int read_flag)
+{
+  Alembic::AbcGeom::index_t index, ceil_index;
+  const float weight = get_weight_and_index(sample_sel.getRequestedTime(),
+                                            m_schema.getTimeSampling(),
+                                            m_schema.getNumSamples(),
+                                            index,
+                                            ceil_index);
+
+  /* Everything is decoded, so the samples work for meshes with changing topology. */
+  const Mesh *sample = m_sample_cache->lookup(index, MOD_MESHSEQ_READ_ALL);
+  if (sample == nullptr) {
+    return nullptr;
+  }
+  const Mesh *ceil_sample = nullptr;
+  if ((read_flag & MOD_MESHSEQ_INTERPOLATE_VERTICES) != 0 && weight != 0.0f &&
+      ceil_index != index) {
+    ceil_sample = m_sample_cache->lookup(ceil_index, MOD_MESHSEQ_READ_ALL);
+  }
+
+  Mesh *mesh = existing_mesh;
+  if (sample->totvert != existing_mesh->totvert || sample->totpoly != existing_mesh->totpoly ||
+      sample->totloop != existing_mesh->totloop) {
+    /* Same as #read_mesh: the material slots of the existing mesh are assumed to be valid. */
+    mesh = BKE_mesh_new_nomain_from_template(
+        existing_mesh, sample->totvert, sample->totedge, 0, sample->totloop, sample->totpoly);
+    read_flag |= MOD_MESHSEQ_READ_ALL;
+  }
+  copy_mesh_sample(sample, mesh, read_flag);
+
+  if (ceil_sample != nullptr && ceil_sample->totvert == mesh->totvert &&
+      (read_flag & MOD_MESHSEQ_READ_VERT) != 0) {
+    for (int i = 0; i < mesh->totvert; i++) {
+      interp_v3_v3v3(mesh->mvert[i].co, sample->mvert[i].co, ceil_sample->mvert[i].co, weight);
+    }
+    if (!CustomData_has_layer(&sample->ldata, CD_CUSTOMLOOPNORMAL)) {
+      BKE_mesh_calc_normals(mesh);
+    }
+  }
+
+  m_sample_cache->prefetch(index);
+  return mesh;
+}
+
 void AbcMeshReader::assign_facesets_to_mpoly(const ISampleSelector &sample_sel,
                                              MPoly *mpoly,
                                              int totpoly,
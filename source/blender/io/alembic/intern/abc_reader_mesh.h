@@ -20,8 +20,11 @@
  */
 
 #include "abc_customdata.h"
+#include "abc_mesh_sample_cache.h"
 #include "abc_reader_object.h"
 
+#include <memory>
+
 struct Mesh;
 
 namespace blender::io::alembic {
@@ -31,6 +34,11 @@ class AbcMeshReader : public AbcObjectReader {
 
   CDStreamConfig m_mesh_data;
 
+  /** Decoded samples for playback, only when prefetching is enabled. */
+  std::unique_ptr<MeshSampleCache> m_sample_cache;
+  /** Memory budget shared with the other meshes of the archive. */
+  std::shared_ptr<MeshSampleCacheBudget> m_sample_budget;
+
  public:
   AbcMeshReader(const Alembic::Abc::IObject &object, ImportSettings &settings);
 
@@ -47,7 +55,22 @@ class AbcMeshReader : public AbcObjectReader {
   bool topology_changed(Mesh *existing_mesh,
                         const Alembic::Abc::ISampleSelector &sample_sel) override;
 
+  /** Share the memory limit of prefetched samples, must be called before prefetching is set. */
+  void set_prefetch_budget(std::shared_ptr<MeshSampleCacheBudget> budget);
+
+  /**
+   * Decode upcoming samples on worker threads in #read_mesh. The given number of bytes is the
+   * limit of the whole budget, shared with the other meshes of the archive when it was set with
+   * #set_prefetch_budget. Zero disables prefetching.
+   */
+  void set_prefetch_memory_limit(size_t memory_limit);
+
  private:
+  Mesh *read_mesh_from_cache(Mesh *existing_mesh,
+                             const Alembic::Abc::ISampleSelector &sample_sel,
+                             int read_flag);
+  Mesh *decode_sample(Alembic::AbcGeom::index_t index, int read_flag, const Mesh *topology_mesh);
+
   void readFaceSetsSample(Main *bmain,
                           Mesh *mesh,
                           const Alembic::AbcGeom::ISampleSelector &sample_sel);
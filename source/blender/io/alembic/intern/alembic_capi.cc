@@ -810,6 +810,17 @@ bool ABC_mesh_topology_changed(
   return abc_reader->topology_changed(existing_mesh, sample_sel);
 }
 
+void ABC_mesh_prefetch_set(CacheReader *reader, int memory_limit_mb)
+{
+  AbcMeshReader *mesh_reader = dynamic_cast<AbcMeshReader *>(
+      reinterpret_cast<AbcObjectReader *>(reader));
+  if (mesh_reader == nullptr) {
+    return;
+  }
+  mesh_reader->set_prefetch_memory_limit(static_cast<size_t>(std::max(memory_limit_mb, 0)) *
+                                         1024 * 1024);
+}
+
 /* ************************************************************************** */
 
 void CacheReader_free(CacheReader *reader)
@@ -857,6 +868,9 @@ CacheReader *CacheReader_open_alembic_object(AbcArchiveHandle *handle,
     return nullptr;
   }
   abc_reader->object(object);
+  if (AbcMeshReader *mesh_reader = dynamic_cast<AbcMeshReader *>(abc_reader)) {
+    mesh_reader->set_prefetch_budget(archive->mesh_sample_budget());
+  }
   abc_reader->incref();
 
   return reinterpret_cast<CacheReader *>(abc_reader);
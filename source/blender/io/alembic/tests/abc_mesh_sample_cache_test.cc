@@ -0,0 +1,119 @@
+#include "testing/testing.h"
+
+#include "intern/abc_mesh_sample_cache.h"
+
+#include "DNA_mesh_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include <atomic>
+
+namespace blender::io::alembic {
+
+class abc_mesh_sample_cache : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  std::atomic<int> decode_count{0};
+  std::atomic<int> first_sample_decode_count{0};
+  std::shared_ptr<MeshSampleCacheBudget> budget = std::make_shared<MeshSampleCacheBudget>();
+
+  MeshSampleCache::DecodeFn decode_fn()
+  {
+    /* The number of vertices is the sample index, so the samples can be told apart. */
+    return [this](MeshSampleCache::index_t index, int /*read_flag*/, const Mesh * /*topology*/) {
+      decode_count++;
+      if (index == 0) {
+        first_sample_decode_count++;
+      }
+      return BKE_mesh_new_nomain(static_cast<int>(index) + 1, 0, 0, 0, 0);
+    };
+  }
+};
+
+TEST_F(abc_mesh_sample_cache, lookup_decodes_once)
+{
+  MeshSampleCache cache(decode_fn(), 10, false, budget);
+
+  const Mesh *mesh = cache.lookup(3, 0);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->totvert, 4);
+  EXPECT_EQ(decode_count, 1);
+
+  EXPECT_EQ(cache.lookup(3, 0), mesh);
+  EXPECT_EQ(decode_count, 1);
+}
+
+TEST_F(abc_mesh_sample_cache, read_flag_change_decodes_again)
+{
+  MeshSampleCache cache(decode_fn(), 10, false, budget);
+
+  cache.lookup(3, 0);
+  cache.lookup(3, 1);
+  EXPECT_EQ(decode_count, 2);
+}
+
+TEST_F(abc_mesh_sample_cache, memory_limit_evicts_passed_samples)
+{
+  /* Without memory nothing is prefetched, and only the current sample and its neighbors stay. */
+  MeshSampleCache cache(decode_fn(), 10, false, budget);
+
+  cache.lookup(0, 0);
+  cache.prefetch(0);
+  cache.lookup(1, 0);
+  cache.prefetch(1);
+  cache.lookup(5, 0);
+  cache.prefetch(5);
+  EXPECT_EQ(decode_count, 3);
+
+  /* Sample 5 is kept, the others were dropped. */
+  cache.lookup(5, 0);
+  EXPECT_EQ(decode_count, 3);
+  cache.lookup(0, 0);
+  EXPECT_EQ(decode_count, 4);
+}
+
+TEST_F(abc_mesh_sample_cache, passed_samples_evicted_without_memory_limit)
+{
+  budget->set_memory_limit(size_t(1) << 30);
+  MeshSampleCache cache(decode_fn(), 10, false, budget);
+
+  cache.lookup(0, 0);
+  cache.prefetch(0);
+  EXPECT_EQ(cache.lookup(0, 0)->totvert, 1);
+  EXPECT_EQ(first_sample_decode_count, 1);
+
+  /* Playback passed the first sample, it is dropped even though memory is left. Prefetching runs
+   * forward, so only the lookup decodes it again. */
+  cache.lookup(5, 0);
+  cache.prefetch(5);
+  EXPECT_EQ(cache.lookup(0, 0)->totvert, 1);
+  EXPECT_EQ(first_sample_decode_count, 2);
+}
+
+TEST_F(abc_mesh_sample_cache, memory_budget_shared)
+{
+  {
+    MeshSampleCache cache_a(decode_fn(), 10, false, budget);
+    MeshSampleCache cache_b(decode_fn(), 10, false, budget);
+
+    cache_a.lookup(3, 0);
+    const size_t memory_a = budget->memory_used();
+    EXPECT_GT(memory_a, size_t(0));
+
+    cache_b.lookup(3, 0);
+    EXPECT_EQ(budget->memory_used(), memory_a * 2);
+
+    /* The budget is exceeded by the current samples, which are always kept. */
+    cache_b.prefetch(3);
+    EXPECT_EQ(budget->memory_used(), memory_a * 2);
+    EXPECT_EQ(decode_count, 2);
+  }
+  EXPECT_EQ(budget->memory_used(), size_t(0));
+}
+
+}  // namespace blender::io::alembic
@@ -181,6 +181,9 @@ void DocumentImporter::finish()
     return;
   }
 
+  /* The meshes are completed in the background while parsing. */
+  mesh_importer.finish_geometries();
+
   Main *bmain = CTX_data_main(mContext);
   /* TODO: create a new scene except the selected <visual_scene> -
    * use current blender scene for it */
@@ -19,6 +19,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 
 /* COLLADABU_ASSERT, may be able to remove later */
@@ -42,6 +43,7 @@
 #include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 
 #include "ArmatureImporter.h"
 #include "MeshImporter.h"
@@ -199,11 +201,17 @@ MeshImporter::MeshImporter(
       m_bmain(bmain),
       scene(sce),
       view_layer(view_layer),
-      armature_importer(arm)
+      armature_importer(arm),
+      geometry_task_pool(nullptr)
 {
   /* pass */
 }
 
+MeshImporter::~MeshImporter()
+{
+  finish_geometries();
+}
+
 bool MeshImporter::set_poly_indices(
     MPoly *mpoly, MLoop *mloop, int loop_index, const unsigned int *indices, int loop_count)
 {
@@ -347,13 +355,13 @@ void MeshImporter::read_vertices(COLLADAFW::Mesh *mesh, Mesh *me)
 
   me->totvert = pos.getFloatValues()->getCount() / stride;
   me->mvert = (MVert *)CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, nullptr, me->totvert);
+  MVert *mvert = me->mvert;
 
-  MVert *mvert;
-  int i;
-
-  for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
-    get_vector(mvert->co, pos, i, stride);
-  }
+  blender::parallel_for(blender::IndexRange(me->totvert), 4096, [&](blender::IndexRange range) {
+    for (const int i : range) {
+      get_vector(mvert[i].co, pos, i, stride);
+    }
+  });
 }
 
 /* =====================================================================
@@ -596,20 +604,14 @@ void MeshImporter::mesh_add_edges(Mesh *mesh, int len)
 
 /* =================================================================
  * Read all loose edges.
- * Important: This function assumes that all edges from existing
- * faces have already been generated and added to me->medge
- * So this function MUST be called after read_faces() (see below)
+ * The edges are only added to the mesh by add_loose_edges(),
+ * after all edges from existing faces have been generated.
  * ================================================================= */
-void MeshImporter::read_lines(COLLADAFW::Mesh *mesh, Mesh *me)
+void MeshImporter::read_lines(COLLADAFW::Mesh *mesh, LooseEdges &r_loose_edges)
 {
   unsigned int loose_edge_count = get_loose_edge_count(mesh);
   if (loose_edge_count > 0) {
-
-    unsigned int face_edge_count = me->totedge;
-    /* unsigned int total_edge_count = loose_edge_count + face_edge_count; */ /* UNUSED */
-
-    mesh_add_edges(me, loose_edge_count);
-    MEdge *med = me->medge + face_edge_count;
+    r_loose_edges.reserve(loose_edge_count);
 
     COLLADAFW::MeshPrimitiveArray &prim_arr = mesh->getMeshPrimitives();
 
@@ -621,22 +623,45 @@ void MeshImporter::read_lines(COLLADAFW::Mesh *mesh, Mesh *me)
         unsigned int edge_count = mp->getFaceCount();
         unsigned int *indices = mp->getPositionIndices().getData();
 
-        for (int j = 0; j < edge_count; j++, med++) {
-          med->bweight = 0;
-          med->crease = 0;
-          med->flag |= ME_LOOSEEDGE;
-          med->v1 = indices[2 * j];
-          med->v2 = indices[2 * j + 1];
+        for (int j = 0; j < edge_count; j++) {
+          r_loose_edges.emplace_back(indices[2 * j], indices[2 * j + 1]);
         }
       }
     }
   }
 }
 
+/* =================================================================
+ * Add the loose edges after the face edges.
+ * Important: This function assumes that all edges from existing
+ * faces have already been generated and added to me->medge
+ * Otherwise the loose edges will be silently deleted again.
+ * ================================================================= */
+void MeshImporter::add_loose_edges(Mesh *me, const LooseEdges &loose_edges)
+{
+  if (loose_edges.empty()) {
+    return;
+  }
+
+  unsigned int face_edge_count = me->totedge;
+
+  mesh_add_edges(me, loose_edges.size());
+  MEdge *med = me->medge + face_edge_count;
+
+  for (const std::pair<unsigned int, unsigned int> &loose_edge : loose_edges) {
+    med->bweight = 0;
+    med->crease = 0;
+    med->flag |= ME_LOOSEEDGE;
+    med->v1 = loose_edge.first;
+    med->v2 = loose_edge.second;
+    med++;
+  }
+}
+
 /* =======================================================================
  * Read all faces from TRIANGLES, TRIANGLE_FANS, POLYLIST, POLYGON
- * Important: This function MUST be called before read_lines()
- * Otherwise we will lose all edges from faces (see read_lines() above)
+ * Important: The face edges MUST be generated before add_loose_edges()
+ * Otherwise we will lose all loose edges (see add_loose_edges() above)
  *
  * TODO: import uv set names
  * ======================================================================== */
@@ -721,91 +746,127 @@ void MeshImporter::read_polys(COLLADAFW::Mesh *collada_mesh, Mesh *me)
         collada_meshtype == COLLADAFW::MeshPrimitive::POLYGONS ||
         collada_meshtype == COLLADAFW::MeshPrimitive::TRIANGLES) {
       COLLADAFW::Polygons *mpvc = (COLLADAFW::Polygons *)mp;
-      unsigned int start_index = 0;
 
       COLLADAFW::IndexListArray &index_list_array_uvcoord = mp->getUVCoordIndicesArray();
       COLLADAFW::IndexListArray &index_list_array_vcolor = mp->getColorIndicesArray();
 
-      int invalid_loop_holes = 0;
-      for (unsigned int j = 0; j < prim_totpoly; j++) {
-
-        /* Vertices in polygon: */
-        int vcount = get_vertex_count(mpvc, j);
-        if (vcount < 0) {
-          continue; /* TODO: add support for holes */
-        }
-
-        bool broken_loop = set_poly_indices(mpoly, mloop, loop_index, position_indices, vcount);
-        if (broken_loop) {
-          invalid_loop_holes += 1;
+      /* Look up the layers once per primitive instead of once per polygon. */
+      std::vector<MLoopUV *> mloopuvs(index_list_array_uvcoord.getCount());
+      for (unsigned int uvset_index = 0; uvset_index < index_list_array_uvcoord.getCount();
+           uvset_index++) {
+        /* get mtface by face index and uv set index */
+        COLLADAFW::IndexList &index_list = *index_list_array_uvcoord[uvset_index];
+        mloopuvs[uvset_index] = (MLoopUV *)CustomData_get_layer_named(
+            &me->ldata, CD_MLOOPUV, index_list.getName().c_str());
+        if (mloopuvs[uvset_index] == nullptr) {
+          fprintf(stderr,
+                  "Collada import: Mesh [%s] : Unknown reference to TEXCOORD [#%s].\n",
+                  me->id.name,
+                  index_list.getName().c_str());
         }
+      }
 
-        for (unsigned int uvset_index = 0; uvset_index < index_list_array_uvcoord.getCount();
-             uvset_index++) {
-          /* get mtface by face index and uv set index */
-          COLLADAFW::IndexList &index_list = *index_list_array_uvcoord[uvset_index];
-          MLoopUV *mloopuv = (MLoopUV *)CustomData_get_layer_named(
-              &me->ldata, CD_MLOOPUV, index_list.getName().c_str());
-          if (mloopuv == nullptr) {
+      std::vector<MLoopCol *> mloopcols;
+      if (mp->hasColorIndices()) {
+        mloopcols.resize(index_list_array_vcolor.getCount());
+        for (unsigned int vcolor_index = 0; vcolor_index < mloopcols.size(); vcolor_index++) {
+          COLLADAFW::IndexList &color_index_list = *mp->getColorIndices(vcolor_index);
+          COLLADAFW::String colname = extract_vcolname(color_index_list.getName());
+          mloopcols[vcolor_index] = (MLoopCol *)CustomData_get_layer_named(
+              &me->ldata, CD_MLOOPCOL, colname.c_str());
+          if (mloopcols[vcolor_index] == nullptr) {
             fprintf(stderr,
-                    "Collada import: Mesh [%s] : Unknown reference to TEXCOORD [#%s].\n",
+                    "Collada import: Mesh [%s] : Unknown reference to VCOLOR [#%s].\n",
                     me->id.name,
-                    index_list.getName().c_str());
-          }
-          else {
-            set_face_uv(mloopuv + loop_index,
-                        uvs,
-                        start_index,
-                        *index_list_array_uvcoord[uvset_index],
-                        vcount);
+                    color_index_list.getName().c_str());
           }
         }
+      }
 
-        if (mp_has_normals) {
-          if (!is_flat_face(normal_indices, nor, vcount)) {
-            mpoly->flag |= ME_SMOOTH;
-          }
-        }
-
-        if (mp->hasColorIndices()) {
-          int vcolor_count = index_list_array_vcolor.getCount();
-
-          for (unsigned int vcolor_index = 0; vcolor_index < vcolor_count; vcolor_index++) {
+      /* Offsets of every polygon into the polygons and loops of this primitive, so that the
+       * polygons can be filled in parallel. Empty polygons are skipped, like in
+       * allocate_poly_data(). */
+      std::vector<int> poly_offsets(prim_totpoly);
+      std::vector<int> loop_offsets(prim_totpoly);
+      int prim_poly_count = 0;
+      int prim_loop_count = 0;
+      for (unsigned int j = 0; j < prim_totpoly; j++) {
+        poly_offsets[j] = prim_poly_count;
+        loop_offsets[j] = prim_loop_count;
 
-            COLLADAFW::IndexList &color_index_list = *mp->getColorIndices(vcolor_index);
-            COLLADAFW::String colname = extract_vcolname(color_index_list.getName());
-            MLoopCol *mloopcol = (MLoopCol *)CustomData_get_layer_named(
-                &me->ldata, CD_MLOOPCOL, colname.c_str());
-            if (mloopcol == nullptr) {
-              fprintf(stderr,
-                      "Collada import: Mesh [%s] : Unknown reference to VCOLOR [#%s].\n",
-                      me->id.name,
-                      color_index_list.getName().c_str());
-            }
-            else {
-              set_vcol(mloopcol + loop_index, vcol, start_index, color_index_list, vcount);
-            }
-          }
+        int vcount = get_vertex_count(mpvc, j);
+        if (vcount > 0) {
+          prim_poly_count++;
+          prim_loop_count += vcount;
         }
+      }
 
-        mpoly++;
-        mloop += vcount;
-        loop_index += vcount;
-        start_index += vcount;
-        prim.totpoly++;
+      std::atomic<int> invalid_loop_holes(0);
+      blender::parallel_for(
+          blender::IndexRange(prim_totpoly), 1024, [&](blender::IndexRange range) {
+            int range_invalid_loop_holes = 0;
+
+            for (const int j : range) {
+              /* Vertices in polygon: */
+              int vcount = get_vertex_count(mpvc, j);
+              if (vcount <= 0) {
+                continue; /* TODO: add support for holes */
+              }
+
+              MPoly *poly = mpoly + poly_offsets[j];
+              const int start_index = loop_offsets[j];
+              const int poly_loop_index = loop_index + start_index;
+
+              bool broken_loop = set_poly_indices(poly,
+                                                  mloop + start_index,
+                                                  poly_loop_index,
+                                                  position_indices + start_index,
+                                                  vcount);
+              if (broken_loop) {
+                range_invalid_loop_holes += 1;
+              }
+
+              for (unsigned int uvset_index = 0; uvset_index < mloopuvs.size(); uvset_index++) {
+                if (mloopuvs[uvset_index] != nullptr) {
+                  set_face_uv(mloopuvs[uvset_index] + poly_loop_index,
+                              uvs,
+                              start_index,
+                              *index_list_array_uvcoord[uvset_index],
+                              vcount);
+                }
+              }
+
+              if (mp_has_normals) {
+                if (!is_flat_face(normal_indices + start_index, nor, vcount)) {
+                  poly->flag |= ME_SMOOTH;
+                }
+              }
+
+              for (unsigned int vcolor_index = 0; vcolor_index < mloopcols.size();
+                   vcolor_index++) {
+                if (mloopcols[vcolor_index] != nullptr) {
+                  set_vcol(mloopcols[vcolor_index] + poly_loop_index,
+                           vcol,
+                           start_index,
+                           *mp->getColorIndices(vcolor_index),
+                           vcount);
+                }
+              }
+            }
 
-        if (mp_has_normals) {
-          normal_indices += vcount;
-        }
+            invalid_loop_holes += range_invalid_loop_holes;
+          });
 
-        position_indices += vcount;
-      }
+      mpoly += prim_poly_count;
+      mloop += prim_loop_count;
+      loop_index += prim_loop_count;
+      prim.totpoly += prim_poly_count;
 
       if (invalid_loop_holes > 0) {
         fprintf(stderr,
                 "Collada import: Mesh [%s] : contains %d unsupported loops (holes).\n",
                 me->id.name,
-                invalid_loop_holes);
+                invalid_loop_holes.load());
       }
     }
 
@@ -1194,10 +1255,45 @@ bool MeshImporter::write_geometry(const COLLADAFW::Geometry *geom)
 
   read_vertices(mesh, me);
   read_polys(mesh, me);
-  BKE_mesh_calc_edges(me, false, false);
-  /* read_lines() must be called after the face edges have been generated.
-   * Otherwise the loose edges will be silently deleted again. */
-  read_lines(mesh, me);
+
+  /* The COLLADA geometry is only valid during this call, but the edges only depend on the mesh.
+   * Generate them in the background while the rest of the document is parsed. */
+  FinishMeshTaskData *task_data = new FinishMeshTaskData();
+  task_data->me = me;
+  read_lines(mesh, task_data->loose_edges);
+
+  if (geometry_task_pool == nullptr) {
+    geometry_task_pool = BLI_task_pool_create_background(
+        this, TASK_PRIORITY_LOW, TASK_ISOLATION_ON);
+  }
+  BLI_task_pool_push(
+      geometry_task_pool, finish_mesh_task, task_data, true, finish_mesh_task_free);
 
   return true;
 }
+
+void MeshImporter::finish_mesh_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  FinishMeshTaskData *task_data = (FinishMeshTaskData *)taskdata;
+
+  BKE_mesh_calc_edges(task_data->me, false, false);
+  /* The loose edges must be added after the face edges have been generated.
+   * Otherwise the loose edges will be silently deleted again. */
+  add_loose_edges(task_data->me, task_data->loose_edges);
+}
+
+void MeshImporter::finish_mesh_task_free(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  delete (FinishMeshTaskData *)taskdata;
+}
+
+void MeshImporter::finish_geometries()
+{
+  if (geometry_task_pool == nullptr) {
+    return;
+  }
+
+  BLI_task_pool_work_and_wait(geometry_task_pool);
+  BLI_task_pool_free(geometry_task_pool);
+  geometry_task_pool = nullptr;
+}
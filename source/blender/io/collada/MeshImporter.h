@@ -21,6 +21,8 @@
 #pragma once
 
 #include <map>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "COLLADAFWIndexList.h"
@@ -38,6 +40,7 @@
 #include "collada_utils.h"
 
 #include "BLI_edgehash.h"
+#include "BLI_task.h"
 
 #include "DNA_material_types.h"
 #include "DNA_mesh_types.h"
@@ -74,6 +77,18 @@ class VCOLDataWrapper {
   void get_vcol(int v_index, MLoopCol *mloopcol);
 };
 
+/* Hash function to use unique ids as keys of unordered maps. */
+struct UniqueIdHash {
+  size_t operator()(const COLLADAFW::UniqueId &uid) const
+  {
+    const std::hash<unsigned long long> hasher;
+    size_t hash = hasher((unsigned long long)uid.getObjectId());
+    hash = hash * 37 + hasher((unsigned long long)uid.getClassId());
+    hash = hash * 37 + hasher((unsigned long long)uid.getFileId());
+    return hash;
+  }
+};
+
 class MeshImporter : public MeshImporterBase {
  private:
   UnitConverter *unitconverter;
@@ -84,10 +99,16 @@ class MeshImporter : public MeshImporterBase {
 
   ArmatureImporter *armature_importer;
 
-  std::map<std::string, std::string> mesh_geom_map;       /* needed for correct shape key naming */
-  std::map<COLLADAFW::UniqueId, Mesh *> uid_mesh_map;     /* geometry unique id-to-mesh map */
-  std::map<COLLADAFW::UniqueId, Object *> uid_object_map; /* geom uid-to-object */
-  std::vector<Object *> imported_objects;                 /* list of imported objects */
+  std::map<std::string, std::string> mesh_geom_map; /* needed for correct shape key naming */
+  /* geometry unique id-to-mesh map */
+  std::unordered_map<COLLADAFW::UniqueId, Mesh *, UniqueIdHash> uid_mesh_map;
+  /* geom uid-to-object */
+  std::unordered_map<COLLADAFW::UniqueId, Object *, UniqueIdHash> uid_object_map;
+  std::vector<Object *> imported_objects; /* list of imported objects */
+
+  /* Finishes the meshes (edges) in the background while the rest of the document is parsed.
+   * Created on the first imported geometry. */
+  TaskPool *geometry_task_pool;
 
   /* this structure is used to assign material indices to polygons
    * it holds a portion of Mesh faces and corresponds to a DAE primitive list
@@ -98,7 +119,8 @@ class MeshImporter : public MeshImporterBase {
   };
   typedef std::map<COLLADAFW::MaterialId, std::vector<Primitive>> MaterialIdPrimitiveArrayMap;
   /* crazy name! */
-  std::map<COLLADAFW::UniqueId, MaterialIdPrimitiveArrayMap> geom_uid_mat_mapping_map;
+  std::unordered_map<COLLADAFW::UniqueId, MaterialIdPrimitiveArrayMap, UniqueIdHash>
+      geom_uid_mat_mapping_map;
   /* < materials that have already been mapped to a geometry.
    * A pair/of geom uid and mat uid, one geometry can have several materials */
   std::multimap<COLLADAFW::UniqueId, COLLADAFW::UniqueId> materials_mapped_to_geom;
@@ -133,13 +155,25 @@ class MeshImporter : public MeshImporterBase {
 
   unsigned int get_loose_edge_count(COLLADAFW::Mesh *mesh);
 
+  /* Vertex indices of the loose edges, the edges are added once the face edges exist. */
+  typedef std::vector<std::pair<unsigned int, unsigned int>> LooseEdges;
+
+  struct FinishMeshTaskData {
+    Mesh *me;
+    LooseEdges loose_edges;
+  };
+
+  static void add_loose_edges(Mesh *me, const LooseEdges &loose_edges);
+  static void finish_mesh_task(TaskPool *__restrict pool, void *taskdata);
+  static void finish_mesh_task_free(TaskPool *__restrict pool, void *taskdata);
+
   CustomData create_edge_custom_data(EdgeHash *eh);
 
   void allocate_poly_data(COLLADAFW::Mesh *collada_mesh, Mesh *me);
 
   /* TODO: import uv set names */
   void read_polys(COLLADAFW::Mesh *mesh, Mesh *me);
-  void read_lines(COLLADAFW::Mesh *mesh, Mesh *me);
+  void read_lines(COLLADAFW::Mesh *mesh, LooseEdges &r_loose_edges);
   unsigned int get_vertex_count(COLLADAFW::Polygons *mp, int index);
 
   void get_vector(float v[3], COLLADAFW::MeshVertexData &arr, int i, int stride);
@@ -154,6 +188,7 @@ class MeshImporter : public MeshImporterBase {
                Main *bmain,
                Scene *sce,
                ViewLayer *view_layer);
+  ~MeshImporter();
 
   virtual Object *get_object_by_geom_uid(const COLLADAFW::UniqueId &geom_uid);
 
@@ -174,5 +209,7 @@ class MeshImporter : public MeshImporterBase {
 
   /* create a mesh storing a pointer in a map so it can be retrieved later by geometry UID */
   bool write_geometry(const COLLADAFW::Geometry *geom);
+  /* Wait until all meshes created by write_geometry() are complete. */
+  void finish_geometries();
   std::string *get_geometry_name(const std::string &mesh_name);
 };
@@ -42,6 +42,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 struct Depsgraph;
 struct DupliObject;
@@ -120,11 +121,27 @@ struct HierarchyContext {
  * that's the first frame to be exported, but can be later, for example when objects are
  * instantiated by particles. The AbstractHierarchyWriter::write() function is called on every
  * frame the object exists in the dependency graph and should be exported.
+ *
+ * Writing a frame can be split into two stages. Writers that return true from supports_prepare()
+ * get their prepare() function called before write(). The prepare() calls of all writers of the
+ * frame run in parallel, and should extract the data to write from the evaluated depsgraph into
+ * storage owned by the writer. The write() calls are still done one by one, in hierarchy order,
+ * and are the only place where the output file may be touched.
  */
 class AbstractHierarchyWriter {
  public:
   virtual ~AbstractHierarchyWriter() = default;
   virtual void write(HierarchyContext &context) = 0;
+
+  /* Return true when prepare() does anything; writers that do not support it are never called
+   * from other threads. */
+  virtual bool supports_prepare() const;
+  /* Extract the data of the current frame, to be written by the following write() call. Called
+   * from multiple threads at once (each writer from one thread only), so this should only read
+   * from the evaluated depsgraph and must not write to the output file or to data shared with
+   * other writers. */
+  virtual void prepare(HierarchyContext &context);
+
   /* TODO(Sybren): add function like absent() that's called when a writer was previously created,
    * but wasn't used while exporting the current frame (for example, a particle-instanced mesh of
    * which the particle is no longer alive). */
@@ -170,6 +187,7 @@ class EnsuredWriter {
   /* These operators make an EnsuredWriter* act as an AbstractHierarchyWriter* */
   operator bool() const;
   AbstractHierarchyWriter *operator->();
+  AbstractHierarchyWriter *get();
 };
 
 /* Unique identifier for a (potentially duplicated) object.
@@ -224,6 +242,15 @@ class AbstractHierarchyIterator {
   WriterMap writers_;
   ExportSubset export_subset_;
 
+  /* A write() call that is postponed until all writers of the current iteration are known, so
+   * that their prepare() calls can run in parallel. */
+  struct DeferredWrite {
+    AbstractHierarchyWriter *writer;
+    HierarchyContext context;
+  };
+  /* Writes of the current iteration, in the order of the export hierarchy. */
+  std::vector<DeferredWrite> deferred_writes_;
+
  public:
   explicit AbstractHierarchyIterator(Depsgraph *depsgraph);
   virtual ~AbstractHierarchyIterator();
@@ -279,11 +306,15 @@ class AbstractHierarchyIterator {
   void determine_duplication_references(const HierarchyContext *parent_context,
                                         std::string indent);
 
-  /* These three functions create writers and call their write() method. */
+  /* These three functions create writers and schedule their write() calls. */
   void make_writers(const HierarchyContext *parent_context);
   void make_writer_object_data(const HierarchyContext *context);
   void make_writers_particle_systems(const HierarchyContext *context);
 
+  void schedule_write(AbstractHierarchyWriter *writer, const HierarchyContext &context);
+  /* Prepare the scheduled writes in parallel, then write them in the order they were scheduled. */
+  void write_scheduled();
+
   /* Return the appropriate HierarchyContext for the data of the object represented by
    * object_context. */
   HierarchyContext context_for_object_data(const HierarchyContext *object_context) const;
@@ -34,6 +34,7 @@
 #include "BLI_assert.h"
 #include "BLI_listbase.h"
 #include "BLI_math_matrix.h"
+#include "BLI_task.hh"
 
 #include "DNA_ID.h"
 #include "DNA_layer_types.h"
@@ -137,6 +138,11 @@ AbstractHierarchyWriter *EnsuredWriter::operator->()
   return writer_;
 }
 
+AbstractHierarchyWriter *EnsuredWriter::get()
+{
+  return writer_;
+}
+
 bool AbstractHierarchyWriter::check_is_animated(const HierarchyContext &context) const
 {
   const Object *object = context.object;
@@ -165,6 +171,15 @@ bool AbstractHierarchyWriter::check_is_animated(const HierarchyContext &context)
   return false;
 }
 
+bool AbstractHierarchyWriter::supports_prepare() const
+{
+  return false;
+}
+
+void AbstractHierarchyWriter::prepare(HierarchyContext & /*context*/)
+{
+}
+
 bool AbstractHierarchyWriter::check_has_physics(const HierarchyContext &context)
 {
   const RigidBodyOb *rbo = context.object->rigidbody_object;
@@ -200,6 +215,7 @@ void AbstractHierarchyIterator::iterate_and_write()
   determine_export_paths(HierarchyContext::root());
   determine_duplication_references(HierarchyContext::root(), "");
   make_writers(HierarchyContext::root());
+  write_scheduled();
   export_graph_clear();
 }
 
@@ -605,7 +621,7 @@ void AbstractHierarchyIterator::make_writers(const HierarchyContext *parent_cont
       /* XXX This can lead to too many XForms being written. For example, a camera writer can
        * refuse to write an orthographic camera. By the time that this is known, the XForm has
        * already been written. */
-      transform_writer->write(*context);
+      schedule_write(transform_writer.get(), *context);
     }
 
     if (!context->weak_export) {
@@ -655,7 +671,7 @@ void AbstractHierarchyIterator::make_writer_object_data(const HierarchyContext *
   }
 
   if (data_writer.is_newly_created() || export_subset_.shapes) {
-    data_writer->write(data_context);
+    schedule_write(data_writer.get(), data_context);
   }
 }
 
@@ -691,8 +707,39 @@ void AbstractHierarchyIterator::make_writers_particle_systems(
 
     /* Always write upon creation, otherwise depend on which subset is active. */
     if (writer.is_newly_created() || export_subset_.shapes) {
-      writer->write(hair_context);
+      schedule_write(writer.get(), hair_context);
+    }
+  }
+}
+
+void AbstractHierarchyIterator::schedule_write(AbstractHierarchyWriter *writer,
+                                               const HierarchyContext &context)
+{
+  deferred_writes_.push_back({writer, context});
+}
+
+void AbstractHierarchyIterator::write_scheduled()
+{
+  /* Take ownership, so that nothing is left behind when a writer throws an exception. */
+  std::vector<DeferredWrite> deferred_writes = std::move(deferred_writes_);
+  deferred_writes_.clear();
+
+  std::vector<DeferredWrite *> to_prepare;
+  for (DeferredWrite &deferred_write : deferred_writes) {
+    if (deferred_write.writer->supports_prepare()) {
+      to_prepare.push_back(&deferred_write);
+    }
+  }
+
+  /* Each writer occurs only once per iteration, as writers are unique per export path. */
+  parallel_for(IndexRange(to_prepare.size()), 1, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      to_prepare[i]->writer->prepare(to_prepare[i]->context);
     }
+  });
+
+  for (DeferredWrite &deferred_write : deferred_writes) {
+    deferred_write.writer->write(deferred_write.context);
   }
 }
 
@@ -61,6 +61,35 @@ class TestHierarchyWriter : public AbstractHierarchyWriter {
   }
 };
 
+/* Writer that extracts its data in prepare(), which is called from multiple threads. */
+class TestPreparingHierarchyWriter : public TestHierarchyWriter {
+ public:
+  std::string prepared_export_path;
+
+  TestPreparingHierarchyWriter(const std::string &writer_type, used_writers &writers_map)
+      : TestHierarchyWriter(writer_type, writers_map)
+  {
+  }
+
+  bool supports_prepare() const override
+  {
+    return true;
+  }
+
+  void prepare(HierarchyContext &context) override
+  {
+    EXPECT_TRUE(prepared_export_path.empty());
+    prepared_export_path = context.export_path;
+  }
+
+  void write(HierarchyContext &context) override
+  {
+    EXPECT_EQ(prepared_export_path, context.export_path);
+    prepared_export_path.clear();
+    TestHierarchyWriter::write(context);
+  }
+};
+
 }  // namespace
 
 class TestingHierarchyIterator : public AbstractHierarchyIterator {
@@ -102,6 +131,20 @@ class TestingHierarchyIterator : public AbstractHierarchyIterator {
   }
 };
 
+class TestingPreparingHierarchyIterator : public TestingHierarchyIterator {
+ public:
+  explicit TestingPreparingHierarchyIterator(Depsgraph *depsgraph)
+      : TestingHierarchyIterator(depsgraph)
+  {
+  }
+
+ protected:
+  AbstractHierarchyWriter *create_data_writer(const HierarchyContext * /*context*/) override
+  {
+    return new TestPreparingHierarchyWriter("data", data_writers);
+  }
+};
+
 class AbstractHierarchyIteratorTest : public BlendfileLoadingBaseTest {
  protected:
   TestingHierarchyIterator *iterator;
@@ -321,6 +364,28 @@ TEST_F(AbstractHierarchyIteratorTest, ExportSubsetTest)
   EXPECT_EQ(expected_data, iterator->data_writers);
 }
 
+TEST_F(AbstractHierarchyIteratorTest, PreparedWritersTest)
+{
+  if (!blendfile_load("usd/usd_hierarchy_export_test.blend")) {
+    return;
+  }
+  depsgraph_create(DAG_EVAL_RENDER);
+  iterator_create();
+  iterator->iterate_and_write();
+
+  /* Writers that are prepared in parallel should write exactly the same as those that are not. */
+  TestingPreparingHierarchyIterator preparing_iterator(depsgraph);
+  preparing_iterator.iterate_and_write();
+  EXPECT_EQ(iterator->transform_writers, preparing_iterator.transform_writers);
+  EXPECT_EQ(iterator->data_writers, preparing_iterator.data_writers);
+
+  /* Writers that exist already are prepared again for the next frame. */
+  preparing_iterator.transform_writers.clear();
+  preparing_iterator.data_writers.clear();
+  preparing_iterator.iterate_and_write();
+  EXPECT_EQ(iterator->data_writers, preparing_iterator.data_writers);
+}
+
 /* Test class that constructs a depsgraph in such a way that it includes invisible objects. */
 class AbstractHierarchyIteratorInvisibleTest : public AbstractHierarchyIteratorTest {
  protected:
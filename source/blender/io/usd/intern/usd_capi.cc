@@ -19,6 +19,7 @@
 
 #include "usd.h"
 #include "usd_hierarchy_iterator.h"
+#include "usd_reader_stage.h"
 
 #include <pxr/base/plug/registry.h>
 #include <pxr/pxr.h>
@@ -31,18 +32,25 @@
 #include "DEG_depsgraph_build.h"
 #include "DEG_depsgraph_query.h"
 
+#include "DNA_collection_types.h"
+#include "DNA_layer_types.h"
 #include "DNA_scene_types.h"
 
 #include "BKE_appdir.h"
 #include "BKE_blender_version.h"
+#include "BKE_collection.h"
 #include "BKE_context.h"
 #include "BKE_global.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
 #include "BKE_scene.h"
 
 #include "BLI_fileops.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 
+#include "ED_undo.h"
+
 #include "WM_api.h"
 #include "WM_types.h"
 
@@ -183,6 +191,187 @@ static void export_endjob(void *customdata)
   WM_set_locked_interface(data->wm, false);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Import
+ * \{ */
+
+enum {
+  USD_NO_ERROR = 0,
+  USD_STAGE_FAIL,
+};
+
+struct ImportJobData {
+  bContext *C;
+  Main *bmain;
+  Scene *scene;
+  ViewLayer *view_layer;
+  wmWindowManager *wm;
+
+  char filename[FILE_MAX];
+  USDImportParams params;
+
+  USDStageReader *stage_reader;
+
+  char error_code;
+  bool was_cancelled;
+  bool import_ok;
+  bool is_background_job;
+};
+
+static bool import_is_cancelled(ImportJobData *data, const short *stop)
+{
+  if (G.is_break || (stop != nullptr && *stop)) {
+    data->was_cancelled = true;
+  }
+  return data->was_cancelled;
+}
+
+static void import_startjob(void *customdata, short *stop, short *do_update, float *progress)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+
+  WM_set_locked_interface(data->wm, true);
+
+  data->stage_reader = new USDStageReader(data->filename, data->params);
+  if (!data->stage_reader->valid()) {
+    data->error_code = USD_STAGE_FAIL;
+    return;
+  }
+  USDStageReader &stage_reader = *data->stage_reader;
+
+  *progress = 0.05f;
+  *do_update = true;
+
+  stage_reader.collect_readers(data->bmain);
+
+  /* Reading prims is most of the work and happens in parallel, creating objects is serial. */
+  const pxr::UsdTimeCode time = pxr::UsdTimeCode::EarliestTime();
+  stage_reader.read_prims(time);
+
+  *progress = 0.6f;
+  *do_update = true;
+  if (import_is_cancelled(data, stop)) {
+    return;
+  }
+
+  Span<USDPrimReader *> readers = stage_reader.readers();
+  const float size = static_cast<float>(std::max<int64_t>(readers.size(), 1));
+
+  for (const int64_t i : readers.index_range()) {
+    readers[i]->create_object(data->bmain, time);
+    *progress = 0.6f + 0.2f * (i / size);
+    *do_update = true;
+    if (import_is_cancelled(data, stop)) {
+      return;
+    }
+  }
+
+  /* All objects exist now, so parents can be assigned. */
+  for (const int64_t i : readers.index_range()) {
+    readers[i]->read_object_data(data->bmain, time);
+    *progress = 0.8f + 0.2f * (i / size);
+    *do_update = true;
+    if (import_is_cancelled(data, stop)) {
+      return;
+    }
+  }
+
+  pxr::UsdStageRefPtr stage = stage_reader.stage();
+  if (data->params.set_frame_range && stage->HasAuthoredTimeCodeRange()) {
+    Scene *scene = data->scene;
+    const double frames_per_time_code = FPS / stage->GetTimeCodesPerSecond();
+    SFRA = static_cast<int>(round(stage->GetStartTimeCode() * frames_per_time_code));
+    EFRA = static_cast<int>(round(stage->GetEndTimeCode() * frames_per_time_code));
+    CFRA = SFRA;
+  }
+}
+
+static void import_endjob(void *customdata)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+
+  if (data->stage_reader != nullptr && data->stage_reader->valid()) {
+    Vector<Object *> objects;
+    Vector<Collection *> collections;
+
+    if (data->was_cancelled) {
+      /* Objects and collections are not linked into the scene yet. */
+      for (USDPrimReader *reader : data->stage_reader->readers()) {
+        objects.clear();
+        reader->append_objects(objects);
+        for (Object *ob : objects) {
+          BKE_id_free_us(data->bmain, ob);
+        }
+      }
+      for (const auto &item : data->stage_reader->settings().prototype_collections) {
+        BKE_id_free(data->bmain, item.second);
+      }
+    }
+    else {
+      ViewLayer *view_layer = data->view_layer;
+      BKE_view_layer_base_deselect_all(view_layer);
+      LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+
+      for (USDPrimReader *reader : data->stage_reader->readers()) {
+        objects.clear();
+        reader->append_objects(objects);
+
+        /* Objects of prototypes only go to their collection, which is instanced. */
+        Collection *collection = reader->collection() ? reader->collection() : lc->collection;
+        for (Object *ob : objects) {
+          BKE_collection_object_add(data->bmain, collection, ob);
+
+          if (reader->collection() == nullptr) {
+            Base *base = BKE_view_layer_base_find(view_layer, ob);
+            BKE_view_layer_base_select_and_set_active(view_layer, base);
+          }
+
+          DEG_id_tag_update_ex(data->bmain,
+                               &ob->id,
+                               ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_ANIMATION |
+                                   ID_RECALC_BASE_FLAGS);
+        }
+        collections.append_non_duplicates(collection);
+      }
+
+      for (Collection *collection : collections) {
+        DEG_id_tag_update(&collection->id, ID_RECALC_COPY_ON_WRITE);
+      }
+      DEG_id_tag_update(&data->scene->id, ID_RECALC_BASE_FLAGS);
+      DEG_relations_tag_update(data->bmain);
+
+      if (data->is_background_job) {
+        /* Blender already returned from the import operator, so we need to store our own extra
+         * undo step. */
+        ED_undo_push(data->C, "USD Import Finished");
+      }
+    }
+  }
+
+  WM_set_locked_interface(data->wm, false);
+
+  switch (data->error_code) {
+    default:
+    case USD_NO_ERROR:
+      data->import_ok = !data->was_cancelled;
+      break;
+    case USD_STAGE_FAIL:
+      WM_reportf(RPT_ERROR, "USD Import: unable to open stage %s", data->filename);
+      break;
+  }
+
+  WM_main_add_notifier(NC_SCENE | ND_FRAME, data->scene);
+}
+
+static void import_freejob(void *customdata)
+{
+  ImportJobData *data = static_cast<ImportJobData *>(customdata);
+  delete data->stage_reader;
+  delete data;
+}
+
+/** \} */
+
 }  // namespace blender::io::usd
 
 bool USD_export(bContext *C,
@@ -237,6 +426,65 @@ bool USD_export(bContext *C,
   return export_ok;
 }
 
+bool USD_import(bContext *C,
+                const char *filepath,
+                const USDImportParams *params,
+                bool as_background_job)
+{
+  blender::io::usd::ensure_usd_plugin_path_registered();
+
+  /* Using new here since MEM_* functions do not call constructor to properly initialize data. */
+  blender::io::usd::ImportJobData *job = new blender::io::usd::ImportJobData();
+  job->C = C;
+  job->bmain = CTX_data_main(C);
+  job->scene = CTX_data_scene(C);
+  job->view_layer = CTX_data_view_layer(C);
+  job->wm = CTX_wm_manager(C);
+  BLI_strncpy(job->filename, filepath, sizeof(job->filename));
+  job->params = *params;
+  job->stage_reader = nullptr;
+  job->error_code = blender::io::usd::USD_NO_ERROR;
+  job->was_cancelled = false;
+  job->import_ok = false;
+  job->is_background_job = as_background_job;
+
+  G.is_break = false;
+
+  bool import_ok = false;
+  if (as_background_job) {
+    wmJob *wm_job = WM_jobs_get(job->wm,
+                                CTX_wm_window(C),
+                                job->scene,
+                                "USD Import",
+                                WM_JOB_PROGRESS,
+                                WM_JOB_TYPE_ALEMBIC);
+
+    /* setup job */
+    WM_jobs_customdata_set(wm_job, job, blender::io::usd::import_freejob);
+    WM_jobs_timer(wm_job, 0.1, NC_SCENE | ND_FRAME, NC_SCENE | ND_FRAME);
+    WM_jobs_callbacks(wm_job,
+                      blender::io::usd::import_startjob,
+                      nullptr,
+                      nullptr,
+                      blender::io::usd::import_endjob);
+
+    WM_jobs_start(CTX_wm_manager(C), wm_job);
+  }
+  else {
+    /* Fake a job context, so that we don't need NULL pointer checks while importing. */
+    short stop = 0, do_update = 0;
+    float progress = 0.0f;
+
+    blender::io::usd::import_startjob(job, &stop, &do_update, &progress);
+    blender::io::usd::import_endjob(job);
+    import_ok = job->import_ok;
+
+    blender::io::usd::import_freejob(job);
+  }
+
+  return import_ok;
+}
+
 int USD_get_version(void)
 {
   /* USD 19.11 defines:
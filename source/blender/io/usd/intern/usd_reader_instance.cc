@@ -0,0 +1,159 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "usd_reader_instance.h"
+
+#include <pxr/usd/usdGeom/pointInstancer.h>
+
+#include "BKE_lib_id.h"
+#include "BKE_object.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+static Collection *find_prototype_collection(const ImportSettings &settings,
+                                             const std::string &prototype_path)
+{
+  std::map<std::string, Collection *>::const_iterator it = settings.prototype_collections.find(
+      prototype_path);
+  return it == settings.prototype_collections.end() ? nullptr : it->second;
+}
+
+static void set_instance_collection(Object *ob, Collection *collection)
+{
+  ob->instance_collection = collection;
+  ob->transflag |= OB_DUPLICOLLECTION;
+  id_us_plus(&collection->id);
+}
+
+USDInstanceReader::USDInstanceReader(const pxr::UsdPrim &prim,
+                                     const USDImportParams &import_params,
+                                     ImportSettings &settings)
+    : USDXformReader(prim, import_params, settings),
+      prototype_path_(prim.GetPrototype().GetPath().GetString())
+{
+}
+
+bool USDInstanceReader::reads_children() const
+{
+  return false;
+}
+
+void USDInstanceReader::create_object(Main *bmain, pxr::UsdTimeCode time)
+{
+  USDXformReader::create_object(bmain, time);
+  if (Collection *collection = find_prototype_collection(settings_, prototype_path_)) {
+    set_instance_collection(object_, collection);
+  }
+}
+
+USDPointInstancerReader::USDPointInstancerReader(const pxr::UsdPrim &prim,
+                                                 const USDImportParams &import_params,
+                                                 ImportSettings &settings)
+    : USDXformReader(prim, import_params, settings)
+{
+  pxr::SdfPathVector targets;
+  pxr::UsdGeomPointInstancer(prim).GetPrototypesRel().GetForwardedTargets(&targets);
+  for (const pxr::SdfPath &target : targets) {
+    prototype_paths_.append(target.GetString());
+  }
+}
+
+Span<std::string> USDPointInstancerReader::prototype_paths() const
+{
+  return prototype_paths_;
+}
+
+bool USDPointInstancerReader::reads_children() const
+{
+  return false;
+}
+
+void USDPointInstancerReader::read_prim_data(pxr::UsdTimeCode time)
+{
+  USDXformReader::read_prim_data(time);
+
+  pxr::UsdGeomPointInstancer instancer(prim_);
+  pxr::VtIntArray proto_indices;
+  pxr::VtMatrix4dArray transforms;
+  instancer.GetProtoIndicesAttr().Get(&proto_indices, time);
+  /* The transforms of the prototype roots are part of the prototype collections. The mask is
+   * applied below, to keep the transforms in sync with the prototype indices. */
+  if (!instancer.ComputeInstanceTransformsAtTime(&transforms,
+                                                 time,
+                                                 time,
+                                                 pxr::UsdGeomPointInstancer::ExcludeProtoXform,
+                                                 pxr::UsdGeomPointInstancer::IgnoreMask) ||
+      transforms.size() != proto_indices.size()) {
+    return;
+  }
+  const std::vector<bool> mask = instancer.ComputeMaskAtTime(time);
+
+  for (size_t i = 0; i < transforms.size(); i++) {
+    const int proto_index = proto_indices[i];
+    if ((!mask.empty() && !mask[i]) || proto_index < 0 ||
+        proto_index >= prototype_paths_.size()) {
+      continue;
+    }
+    float4x4 matrix;
+    for (int j = 0; j < 4; j++) {
+      for (int k = 0; k < 4; k++) {
+        matrix.values[j][k] = static_cast<float>(transforms[i][j][k]);
+      }
+    }
+    proto_indices_.append(proto_index);
+    instance_matrices_.append(matrix);
+  }
+}
+
+void USDPointInstancerReader::create_object(Main *bmain, pxr::UsdTimeCode time)
+{
+  USDXformReader::create_object(bmain, time);
+
+  instance_objects_.reserve(proto_indices_.size());
+  for (const int proto_index : proto_indices_) {
+    Object *ob = BKE_object_add_only_object(bmain, OB_EMPTY, name_.c_str());
+    ob->empty_drawsize = 0.1f;
+    ob->parent = object_;
+    if (Collection *collection = find_prototype_collection(settings_,
+                                                           prototype_paths_[proto_index])) {
+      set_instance_collection(ob, collection);
+    }
+    instance_objects_.append(ob);
+  }
+}
+
+void USDPointInstancerReader::read_object_data(Main *bmain, pxr::UsdTimeCode time)
+{
+  USDXformReader::read_object_data(bmain, time);
+
+  for (const int i : instance_objects_.index_range()) {
+    BKE_object_apply_mat4(instance_objects_[i], instance_matrices_[i].values, true, false);
+  }
+}
+
+void USDPointInstancerReader::append_objects(Vector<Object *> &r_objects) const
+{
+  USDXformReader::append_objects(r_objects);
+  r_objects.extend(instance_objects_);
+}
+
+}  // namespace blender::io::usd
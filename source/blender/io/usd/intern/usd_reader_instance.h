@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd_reader_xform.h"
+
+#include "BLI_float4x4.hh"
+
+namespace blender::io::usd {
+
+/**
+ * Instanceable prim, imported as an empty that instances the collection of its prototype. The
+ * objects of the prototype are only created once.
+ */
+class USDInstanceReader : public USDXformReader {
+  std::string prototype_path_;
+
+ public:
+  USDInstanceReader(const pxr::UsdPrim &prim,
+                    const USDImportParams &import_params,
+                    ImportSettings &settings);
+
+  bool reads_children() const override;
+  void create_object(Main *bmain, pxr::UsdTimeCode time) override;
+};
+
+/**
+ * Point instancer, imported as an empty with a child empty for every instance, which instances
+ * the collection of the prototype.
+ */
+class USDPointInstancerReader : public USDXformReader {
+  Vector<std::string> prototype_paths_;
+  Vector<int> proto_indices_;
+  Vector<float4x4> instance_matrices_;
+  Vector<Object *> instance_objects_;
+
+ public:
+  USDPointInstancerReader(const pxr::UsdPrim &prim,
+                          const USDImportParams &import_params,
+                          ImportSettings &settings);
+
+  Span<std::string> prototype_paths() const;
+
+  bool reads_children() const override;
+  void read_prim_data(pxr::UsdTimeCode time) override;
+  void create_object(Main *bmain, pxr::UsdTimeCode time) override;
+  void read_object_data(Main *bmain, pxr::UsdTimeCode time) override;
+  void append_objects(Vector<Object *> &r_objects) const override;
+};
+
+}  // namespace blender::io::usd
@@ -0,0 +1,335 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "usd_reader_mesh.h"
+
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/primvarsAPI.h>
+#include <pxr/usd/usdGeom/subset.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdShade/materialBindingAPI.h>
+
+#include <iostream>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_array.hh"
+#include "BLI_edgehash.h"
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+USDMeshReader::USDMeshReader(const pxr::UsdPrim &prim,
+                             const USDImportParams &import_params,
+                             ImportSettings &settings)
+    : USDXformReader(prim, import_params, settings), mesh_(nullptr)
+{
+}
+
+USDMeshReader::~USDMeshReader()
+{
+  if (mesh_) {
+    BKE_id_free(nullptr, mesh_);
+  }
+}
+
+static bool faces_are_valid(const pxr::VtIntArray &face_counts,
+                            const pxr::VtIntArray &face_indices,
+                            const int verts_num)
+{
+  size_t corners_num = 0;
+  for (const int count : face_counts) {
+    if (count < 3) {
+      return false;
+    }
+    corners_num += size_t(count);
+  }
+  if (corners_num != face_indices.size()) {
+    return false;
+  }
+  for (const int index : face_indices) {
+    if (index < 0 || index >= verts_num) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int USDMeshReader::material_index(const pxr::UsdShadeMaterial &usd_material)
+{
+  for (const int i : materials_.index_range()) {
+    if (materials_[i].GetPath() == usd_material.GetPath()) {
+      return i;
+    }
+  }
+  materials_.append(usd_material);
+  return int(materials_.size() - 1);
+}
+
+/* Set the edge creases, the inverse of the exporter. */
+static void read_creases(Mesh *mesh, const pxr::UsdGeomMesh &usd_mesh, pxr::UsdTimeCode time)
+{
+  pxr::VtIntArray crease_indices, crease_lengths;
+  pxr::VtFloatArray crease_sharpnesses;
+  usd_mesh.GetCreaseIndicesAttr().Get(&crease_indices, time);
+  usd_mesh.GetCreaseLengthsAttr().Get(&crease_lengths, time);
+  usd_mesh.GetCreaseSharpnessesAttr().Get(&crease_sharpnesses, time);
+  if (crease_lengths.empty() || crease_lengths.size() != crease_sharpnesses.size()) {
+    return;
+  }
+
+  EdgeHash *edge_hash = BLI_edgehash_new_ex(__func__, uint(mesh->totedge));
+  for (int i = 0; i < mesh->totedge; i++) {
+    BLI_edgehash_insert(edge_hash, mesh->medge[i].v1, mesh->medge[i].v2, POINTER_FROM_INT(i));
+  }
+
+  size_t index_start = 0;
+  for (size_t crease = 0; crease < crease_lengths.size(); crease++) {
+    const size_t length = size_t(crease_lengths[crease]);
+    if (index_start + length > crease_indices.size()) {
+      break;
+    }
+    const float sharpness = crease_sharpnesses[crease];
+    const char crease_value = (sharpness == pxr::UsdGeomMesh::SHARPNESS_INFINITE) ?
+                                  char(255) :
+                                  char(clamp_f(sharpness, 0.0f, 1.0f) * 255.0f);
+    /* Creases are chains of vertices, every consecutive pair is an edge. */
+    for (size_t i = index_start; i + 1 < index_start + length; i++) {
+      void **edge_index = BLI_edgehash_lookup_p(
+          edge_hash, uint(crease_indices[i]), uint(crease_indices[i + 1]));
+      if (edge_index) {
+        mesh->medge[POINTER_AS_INT(*edge_index)].crease = crease_value;
+        mesh->cd_flag |= ME_CDFLAG_EDGE_CREASE;
+      }
+    }
+    index_start += length;
+  }
+  BLI_edgehash_free(edge_hash, nullptr);
+}
+
+/* Add a UV map for every texture coordinate primvar. */
+static void read_uv_maps(Mesh *mesh,
+                         const pxr::UsdPrim &prim,
+                         Span<int> loop_corners,
+                         pxr::UsdTimeCode time)
+{
+  for (const pxr::UsdGeomPrimvar &primvar : pxr::UsdGeomPrimvarsAPI(prim).GetPrimvars()) {
+    const pxr::SdfValueTypeName type = primvar.GetTypeName();
+    if (type != pxr::SdfValueTypeNames->TexCoord2fArray &&
+        type != pxr::SdfValueTypeNames->Float2Array) {
+      continue;
+    }
+    const pxr::TfToken interpolation = primvar.GetInterpolation();
+    const bool per_corner = interpolation == pxr::UsdGeomTokens->faceVarying;
+    const bool per_vertex = ELEM(
+        interpolation, pxr::UsdGeomTokens->vertex, pxr::UsdGeomTokens->varying);
+    pxr::VtVec2fArray uvs;
+    if (!(per_corner || per_vertex) || !primvar.ComputeFlattened(&uvs, time)) {
+      continue;
+    }
+    if (uvs.size() != size_t(per_corner ? mesh->totloop : mesh->totvert)) {
+      continue;
+    }
+
+    const std::string name = primvar.GetPrimvarName().GetString();
+    MLoopUV *mloopuv = static_cast<MLoopUV *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop, name.c_str()));
+    for (const int loop : IndexRange(mesh->totloop)) {
+      const pxr::GfVec2f &uv = uvs[per_corner ? loop_corners[loop] : int(mesh->mloop[loop].v)];
+      mloopuv[loop].uv[0] = uv[0];
+      mloopuv[loop].uv[1] = uv[1];
+    }
+  }
+}
+
+/* Authored normals become custom normals, returns false if there are none. */
+static bool read_normals(Mesh *mesh,
+                         const pxr::UsdGeomMesh &usd_mesh,
+                         Span<int> loop_corners,
+                         pxr::UsdTimeCode time)
+{
+  pxr::VtVec3fArray normals;
+  if (!usd_mesh.GetNormalsAttr().Get(&normals, time) || normals.empty()) {
+    return false;
+  }
+
+  const pxr::TfToken interpolation = usd_mesh.GetNormalsInterpolation();
+  if (ELEM(interpolation, pxr::UsdGeomTokens->vertex, pxr::UsdGeomTokens->varying)) {
+    if (normals.size() != size_t(mesh->totvert)) {
+      return false;
+    }
+    BKE_mesh_set_custom_normals_from_vertices(
+        mesh, reinterpret_cast<float(*)[3]>(normals.data()));
+    return true;
+  }
+
+  const bool per_corner = interpolation == pxr::UsdGeomTokens->faceVarying;
+  const bool per_face = interpolation == pxr::UsdGeomTokens->uniform;
+  if (!(per_corner || per_face) ||
+      normals.size() != size_t(per_corner ? mesh->totloop : mesh->totpoly)) {
+    return false;
+  }
+  Array<float3> loop_normals(mesh->totloop);
+  for (const int poly_index : IndexRange(mesh->totpoly)) {
+    const MPoly &poly = mesh->mpoly[poly_index];
+    for (const int loop : IndexRange(poly.loopstart, poly.totloop)) {
+      const pxr::GfVec3f &normal = normals[per_corner ? loop_corners[loop] : poly_index];
+      loop_normals[loop] = float3(normal[0], normal[1], normal[2]);
+    }
+  }
+  BKE_mesh_set_custom_normals(mesh, reinterpret_cast<float(*)[3]>(loop_normals.data()));
+  return true;
+}
+
+void USDMeshReader::read_prim_data(pxr::UsdTimeCode time)
+{
+  USDXformReader::read_prim_data(time);
+
+  pxr::UsdGeomMesh usd_mesh(prim_);
+  pxr::VtVec3fArray points;
+  pxr::VtIntArray face_counts, face_indices;
+  usd_mesh.GetPointsAttr().Get(&points, time);
+  usd_mesh.GetFaceVertexCountsAttr().Get(&face_counts, time);
+  usd_mesh.GetFaceVertexIndicesAttr().Get(&face_indices, time);
+
+  const int verts_num = int(points.size());
+  if (!faces_are_valid(face_counts, face_indices, verts_num)) {
+    std::cerr << "USD import: invalid faces in " << prim_path_ << ", only reading points\n";
+    face_counts.clear();
+    face_indices.clear();
+  }
+
+  pxr::TfToken orientation, subdivision_scheme;
+  usd_mesh.GetOrientationAttr().Get(&orientation);
+  usd_mesh.GetSubdivisionSchemeAttr().Get(&subdivision_scheme);
+  const bool left_handed = orientation == pxr::UsdGeomTokens->leftHanded;
+  const bool smooth = subdivision_scheme != pxr::UsdGeomTokens->none;
+
+  mesh_ = BKE_mesh_new_nomain(
+      verts_num, 0, 0, int(face_indices.size()), int(face_counts.size()));
+
+  parallel_for(IndexRange(verts_num), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      copy_v3_v3(mesh_->mvert[i].co, points[i].data());
+    }
+  });
+
+  /* The face corner of every loop, left-handed faces are flipped for Blender. */
+  Array<int> loop_corners(mesh_->totloop);
+  int loop_start = 0;
+  for (const int poly_index : IndexRange(mesh_->totpoly)) {
+    MPoly &poly = mesh_->mpoly[poly_index];
+    const int count = face_counts[poly_index];
+    poly.loopstart = loop_start;
+    poly.totloop = count;
+    poly.flag = smooth ? ME_SMOOTH : 0;
+    for (const int i : IndexRange(count)) {
+      const int corner = loop_start + ((left_handed && i > 0) ? count - i : i);
+      loop_corners[loop_start + i] = corner;
+      mesh_->mloop[loop_start + i].v = uint(face_indices[corner]);
+    }
+    loop_start += count;
+  }
+
+  /* The material of the whole mesh is the first slot, geometry subsets override it. Faces outside
+   * of the subsets use the first slot, which stays empty when the mesh has no material. */
+  pxr::UsdShadeMaterialBindingAPI binding_api(prim_);
+  const std::vector<pxr::UsdGeomSubset> subsets = binding_api.GetMaterialBindSubsets();
+  if (pxr::UsdShadeMaterial usd_material = binding_api.ComputeBoundMaterial()) {
+    material_index(usd_material);
+  }
+  else if (!subsets.empty()) {
+    materials_.append(pxr::UsdShadeMaterial());
+  }
+  for (const pxr::UsdGeomSubset &subset : subsets) {
+    pxr::UsdShadeMaterial usd_material =
+        pxr::UsdShadeMaterialBindingAPI(subset.GetPrim()).ComputeBoundMaterial();
+    pxr::VtIntArray subset_faces;
+    if (!usd_material || !subset.GetIndicesAttr().Get(&subset_faces, time)) {
+      continue;
+    }
+    const short mat_nr = short(std::min(material_index(usd_material), MAXMAT - 1));
+    for (const int face : subset_faces) {
+      if (face >= 0 && face < mesh_->totpoly) {
+        mesh_->mpoly[face].mat_nr = mat_nr;
+      }
+    }
+  }
+
+  read_uv_maps(mesh_, prim_, loop_corners, time);
+
+  BKE_mesh_calc_edges(mesh_, false, false);
+  read_creases(mesh_, usd_mesh, time);
+  if (import_params_.validate_meshes) {
+    BKE_mesh_validate(mesh_, false, false);
+  }
+  BKE_mesh_calc_normals(mesh_);
+
+  /* Validation may remove loops, which would make the authored normals not match anymore. */
+  if (mesh_->totloop == loop_corners.size() && read_normals(mesh_, usd_mesh, loop_corners, time)) {
+    mesh_->flag |= ME_AUTOSMOOTH;
+    for (const int i : IndexRange(mesh_->totpoly)) {
+      mesh_->mpoly[i].flag |= ME_SMOOTH;
+    }
+  }
+}
+
+void USDMeshReader::create_object(Main *bmain, pxr::UsdTimeCode /*time*/)
+{
+  Mesh *mesh = BKE_mesh_add(bmain, name_.c_str());
+  object_ = BKE_object_add_only_object(bmain, OB_MESH, name_.c_str());
+  object_->data = mesh;
+}
+
+void USDMeshReader::read_object_data(Main *bmain, pxr::UsdTimeCode time)
+{
+  USDXformReader::read_object_data(bmain, time);
+
+  Mesh *mesh = static_cast<Mesh *>(object_->data);
+  if (mesh_ != nullptr) {
+    /* The flags are taken from the target mesh. */
+    mesh->flag |= mesh_->flag & ME_AUTOSMOOTH;
+    BKE_mesh_nomain_to_mesh(mesh_, mesh, object_, &CD_MASK_MESH, true);
+    mesh_ = nullptr;
+  }
+
+  /* Faces of later materials were clamped to the last slot. */
+  for (const int i : IndexRange(std::min(int(materials_.size()), MAXMAT))) {
+    if (!materials_[i]) {
+      continue;
+    }
+    Material *material = ensure_material(bmain, materials_[i], settings_);
+    BKE_object_material_assign(bmain, object_, material, i + 1, BKE_MAT_ASSIGN_OBDATA);
+  }
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,49 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd_reader_xform.h"
+
+#include <pxr/usd/usdShade/material.h>
+
+struct Mesh;
+
+namespace blender::io::usd {
+
+class USDMeshReader : public USDXformReader {
+  /* Mesh outside of #Main, read in parallel with the other prims. */
+  Mesh *mesh_;
+  /* Materials of the mesh prim and its geometry subsets, in the order of the material slots. */
+  Vector<pxr::UsdShadeMaterial> materials_;
+
+ public:
+  USDMeshReader(const pxr::UsdPrim &prim,
+                const USDImportParams &import_params,
+                ImportSettings &settings);
+  ~USDMeshReader() override;
+
+  void read_prim_data(pxr::UsdTimeCode time) override;
+  void create_object(Main *bmain, pxr::UsdTimeCode time) override;
+  void read_object_data(Main *bmain, pxr::UsdTimeCode time) override;
+
+ private:
+  int material_index(const pxr::UsdShadeMaterial &usd_material);
+};
+
+}  // namespace blender::io::usd
@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/usdShade/shader.h>
+
+#include "BKE_lib_id.h"
+#include "BKE_material.h"
+
+#include "DNA_material_types.h"
+
+/* TfToken objects are not cheap to construct, so we do it once. */
+namespace usdtokens {
+/* Materials, the ones written by the exporter. */
+static const pxr::TfToken diffuse_color("diffuseColor", pxr::TfToken::Immortal);
+static const pxr::TfToken metallic("metallic", pxr::TfToken::Immortal);
+static const pxr::TfToken opacity("opacity", pxr::TfToken::Immortal);
+static const pxr::TfToken preview_surface("UsdPreviewSurface", pxr::TfToken::Immortal);
+static const pxr::TfToken roughness("roughness", pxr::TfToken::Immortal);
+}  // namespace usdtokens
+
+namespace blender::io::usd {
+
+USDPrimReader::USDPrimReader(const pxr::UsdPrim &prim,
+                             const USDImportParams &import_params,
+                             ImportSettings &settings)
+    : name_(prim.GetName().GetString()),
+      prim_path_(prim.GetPath().GetString()),
+      object_(nullptr),
+      prim_(prim),
+      import_params_(import_params),
+      settings_(settings),
+      parent_reader_(nullptr),
+      collection_(nullptr)
+{
+}
+
+const pxr::UsdPrim &USDPrimReader::prim() const
+{
+  return prim_;
+}
+
+const std::string &USDPrimReader::name() const
+{
+  return name_;
+}
+
+const std::string &USDPrimReader::prim_path() const
+{
+  return prim_path_;
+}
+
+Object *USDPrimReader::object() const
+{
+  return object_;
+}
+
+USDPrimReader *USDPrimReader::parent() const
+{
+  return parent_reader_;
+}
+
+void USDPrimReader::parent(USDPrimReader *parent_reader)
+{
+  parent_reader_ = parent_reader;
+}
+
+Collection *USDPrimReader::collection() const
+{
+  return collection_;
+}
+
+void USDPrimReader::collection(Collection *collection)
+{
+  collection_ = collection;
+}
+
+bool USDPrimReader::valid() const
+{
+  return prim_.IsValid();
+}
+
+bool USDPrimReader::reads_children() const
+{
+  return true;
+}
+
+void USDPrimReader::read_prim_data(pxr::UsdTimeCode /*time*/)
+{
+}
+
+void USDPrimReader::read_object_data(Main * /*bmain*/, pxr::UsdTimeCode /*time*/)
+{
+}
+
+void USDPrimReader::append_objects(Vector<Object *> &r_objects) const
+{
+  if (object_) {
+    r_objects.append(object_);
+  }
+}
+
+template<typename T>
+static bool get_input_value(const pxr::UsdShadeShader &shader,
+                            const pxr::TfToken &name,
+                            T &r_value)
+{
+  const pxr::UsdShadeInput input = shader.GetInput(name);
+  return input && input.Get(&r_value);
+}
+
+Material *ensure_material(Main *bmain,
+                          const pxr::UsdShadeMaterial &usd_material,
+                          ImportSettings &settings)
+{
+  const std::string path = usd_material.GetPath().GetString();
+  std::map<std::string, Material *>::const_iterator it = settings.materials.find(path);
+  if (it != settings.materials.end()) {
+    return it->second;
+  }
+
+  Material *material = BKE_material_add(bmain, usd_material.GetPrim().GetName().GetText());
+  /* The users are added when the material is assigned. */
+  id_us_min(&material->id);
+  settings.materials[path] = material;
+
+  /* Read the viewport settings from the preview surface, the inverse of the exporter. */
+  pxr::UsdShadeShader shader = usd_material.ComputeSurfaceSource();
+  pxr::TfToken shader_id;
+  if (!shader || !shader.GetShaderId(&shader_id) || shader_id != usdtokens::preview_surface) {
+    return material;
+  }
+
+  pxr::GfVec3f diffuse_color;
+  if (get_input_value(shader, usdtokens::diffuse_color, diffuse_color)) {
+    material->r = diffuse_color[0];
+    material->g = diffuse_color[1];
+    material->b = diffuse_color[2];
+  }
+  float value;
+  if (get_input_value(shader, usdtokens::roughness, value)) {
+    material->roughness = value;
+  }
+  if (get_input_value(shader, usdtokens::metallic, value)) {
+    material->metallic = value;
+  }
+  if (get_input_value(shader, usdtokens::opacity, value)) {
+    material->a = value;
+  }
+  return material;
+}
+
+}  // namespace blender::io::usd
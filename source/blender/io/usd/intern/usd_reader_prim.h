@@ -0,0 +1,104 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd.h"
+
+#include "BLI_vector.hh"
+
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/timeCode.h>
+#include <pxr/usd/usdShade/material.h>
+
+#include <map>
+#include <string>
+
+struct Collection;
+struct Main;
+struct Material;
+struct Object;
+
+namespace blender::io::usd {
+
+struct ImportSettings {
+  /* Conversion of the root prims from the stage's up axis and units to Blender's. */
+  float conversion_mat[4][4];
+
+  /* Materials of the stage, by the path of their prim. Only accessed while creating objects. */
+  std::map<std::string, Material *> materials;
+  /* Collections holding the objects of instance prototypes and point instancer prototypes,
+   * by the path of the prototype prim. Created before the readers. */
+  std::map<std::string, Collection *> prototype_collections;
+};
+
+/**
+ * Base class of the readers that turn USD prims into objects. Reading happens in two steps, like
+ * for the Alembic readers: the prim data is read without touching #Main in #read_prim_data(),
+ * which runs in parallel for all readers of a stage. The objects are created and get their data
+ * serially in #create_object() and #read_object_data().
+ */
+class USDPrimReader {
+ protected:
+  std::string name_;
+  std::string prim_path_;
+  Object *object_;
+  pxr::UsdPrim prim_;
+  const USDImportParams &import_params_;
+  ImportSettings &settings_;
+
+  /* Reader of the parent prim, null for root prims and roots of prototypes. */
+  USDPrimReader *parent_reader_;
+  /* Collection the object is added to, null for the collection of the import. */
+  Collection *collection_;
+
+ public:
+  USDPrimReader(const pxr::UsdPrim &prim,
+                const USDImportParams &import_params,
+                ImportSettings &settings);
+  virtual ~USDPrimReader() = default;
+
+  const pxr::UsdPrim &prim() const;
+  const std::string &name() const;
+  const std::string &prim_path() const;
+
+  Object *object() const;
+  USDPrimReader *parent() const;
+  void parent(USDPrimReader *parent_reader);
+  Collection *collection() const;
+  void collection(Collection *collection);
+
+  virtual bool valid() const;
+  /* Children of the prim get their own readers, false when they are part of a prototype. */
+  virtual bool reads_children() const;
+
+  /* Read the data of the prim that is needed by #read_object_data(). Must not access #Main. */
+  virtual void read_prim_data(pxr::UsdTimeCode time);
+  virtual void create_object(Main *bmain, pxr::UsdTimeCode time) = 0;
+  virtual void read_object_data(Main *bmain, pxr::UsdTimeCode time);
+
+  /* Add the objects created by this reader, usually just #object(). */
+  virtual void append_objects(Vector<Object *> &r_objects) const;
+};
+
+/* Material for a USD material prim, created from its preview surface on first use. */
+Material *ensure_material(Main *bmain,
+                          const pxr::UsdShadeMaterial &usd_material,
+                          ImportSettings &settings);
+
+}  // namespace blender::io::usd
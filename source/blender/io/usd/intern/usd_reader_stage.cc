@@ -0,0 +1,204 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "usd_reader_stage.h"
+#include "usd_reader_instance.h"
+#include "usd_reader_mesh.h"
+#include "usd_reader_xform.h"
+
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/metrics.h>
+#include <pxr/usd/usdGeom/pointInstancer.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xformable.h>
+
+#include "BKE_collection.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_task.hh"
+
+#include "DNA_collection_types.h"
+
+namespace blender::io::usd {
+
+USDStageReader::USDStageReader(const char *filepath, const USDImportParams &params)
+    : params_(params)
+{
+  /* Without loading, prims with payloads are imported as placeholders. */
+  stage_ = pxr::UsdStage::Open(filepath,
+                               params.load_payloads ? pxr::UsdStage::LoadAll :
+                                                      pxr::UsdStage::LoadNone);
+
+  unit_m4(settings_.conversion_mat);
+  if (!stage_) {
+    return;
+  }
+
+  if (pxr::UsdGeomGetStageUpAxis(stage_) == pxr::UsdGeomTokens->y) {
+    rotate_m4(settings_.conversion_mat, 'X', M_PI_2);
+  }
+
+  /* The fallback of USD is centimeters, only use the unit when the stage specifies it. */
+  float scale = params.scale;
+  if (pxr::UsdGeomStageHasAuthoredMetersPerUnit(stage_)) {
+    scale *= static_cast<float>(pxr::UsdGeomGetStageMetersPerUnit(stage_));
+  }
+  float scale_mat[4][4];
+  scale_m4_fl(scale_mat, scale);
+  mul_m4_m4m4(settings_.conversion_mat, scale_mat, settings_.conversion_mat);
+}
+
+USDStageReader::~USDStageReader()
+{
+  for (USDPrimReader *reader : readers_) {
+    delete reader;
+  }
+}
+
+bool USDStageReader::valid() const
+{
+  return bool(stage_);
+}
+
+pxr::UsdStageRefPtr USDStageReader::stage() const
+{
+  return stage_;
+}
+
+ImportSettings &USDStageReader::settings()
+{
+  return settings_;
+}
+
+Span<USDPrimReader *> USDStageReader::readers() const
+{
+  return readers_;
+}
+
+void USDStageReader::collect_readers(Main *bmain)
+{
+  if (params_.import_instancing) {
+    /* Nested prototypes are part of the list as well. */
+    for (const pxr::UsdPrim &prototype : stage_->GetPrototypes()) {
+      add_prototype(bmain, prototype, false);
+    }
+  }
+
+  visit_children(bmain, stage_->GetPseudoRoot(), nullptr, nullptr);
+}
+
+void USDStageReader::read_prims(pxr::UsdTimeCode time)
+{
+  /* Reading from a stage is thread safe, and the readers only write their own data. */
+  parallel_for(IndexRange(readers_.size()), 16, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      readers_[i]->read_prim_data(time);
+    }
+  });
+}
+
+USDPrimReader *USDStageReader::create_reader(Main *bmain, const pxr::UsdPrim &prim)
+{
+  if (prim.HasAuthoredPayloads() && !prim.IsLoaded()) {
+    return new USDPayloadPlaceholderReader(prim, params_, settings_);
+  }
+  if (params_.import_instancing && prim.IsInstance()) {
+    return new USDInstanceReader(prim, params_, settings_);
+  }
+  if (prim.IsA<pxr::UsdGeomPointInstancer>()) {
+    USDPointInstancerReader *reader = new USDPointInstancerReader(prim, params_, settings_);
+    for (const std::string &path : reader->prototype_paths()) {
+      add_prototype(bmain, stage_->GetPrimAtPath(pxr::SdfPath(path)), true);
+    }
+    return reader;
+  }
+  if (prim.IsA<pxr::UsdGeomMesh>()) {
+    return new USDMeshReader(prim, params_, settings_);
+  }
+  if (prim.IsA<pxr::UsdGeomXformable>()) {
+    return new USDXformReader(prim, params_, settings_);
+  }
+  return nullptr;
+}
+
+void USDStageReader::visit_prim(Main *bmain,
+                                const pxr::UsdPrim &prim,
+                                USDPrimReader *parent_reader,
+                                Collection *collection)
+{
+  USDPrimReader *reader = create_reader(bmain, prim);
+  if (reader == nullptr) {
+    /* Unsupported prims like scopes are skipped, their children keep the parent. */
+    visit_children(bmain, prim, parent_reader, collection);
+    return;
+  }
+
+  reader->parent(parent_reader);
+  reader->collection(collection);
+  readers_.append(reader);
+
+  if (reader->reads_children()) {
+    visit_children(bmain, prim, reader, collection);
+  }
+}
+
+void USDStageReader::visit_children(Main *bmain,
+                                    const pxr::UsdPrim &prim,
+                                    USDPrimReader *parent_reader,
+                                    Collection *collection)
+{
+  /* Unloaded prims are kept so payloads can be imported as placeholders. */
+  pxr::Usd_PrimFlagsPredicate predicate = pxr::UsdPrimIsActive && pxr::UsdPrimIsDefined &&
+                                          !pxr::UsdPrimIsAbstract;
+  if (!params_.import_instancing) {
+    /* Instances are imported as copies of their prototype. */
+    predicate = pxr::UsdTraverseInstanceProxies(predicate);
+  }
+
+  for (const pxr::UsdPrim &child : prim.GetFilteredChildren(predicate)) {
+    visit_prim(bmain, child, parent_reader, collection);
+  }
+}
+
+void USDStageReader::add_prototype(Main *bmain, const pxr::UsdPrim &prototype, bool include_root)
+{
+  if (!prototype) {
+    return;
+  }
+  const std::string path = prototype.GetPath().GetString();
+  if (settings_.prototype_collections.count(path)) {
+    return;
+  }
+
+  /* The collection has no users until the instancing objects are created. */
+  Collection *collection = BKE_collection_add(bmain, nullptr, prototype.GetName().GetText());
+  settings_.prototype_collections[path] = collection;
+
+  if (include_root) {
+    /* Point instancer prototypes are regular prims, including their own transform. */
+    visit_prim(bmain, prototype, nullptr, collection);
+  }
+  else {
+    visit_children(bmain, prototype, nullptr, collection);
+  }
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,66 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd_reader_prim.h"
+
+#include <pxr/usd/usd/stage.h>
+
+namespace blender::io::usd {
+
+/**
+ * Opens a stage and creates the readers for its prims, like the Alembic #ArchiveReader together
+ * with its object visitor. Scene graph instances and point instancers share collections with the
+ * objects of their prototypes.
+ */
+class USDStageReader {
+  pxr::UsdStageRefPtr stage_;
+  USDImportParams params_;
+  ImportSettings settings_;
+  Vector<USDPrimReader *> readers_;
+
+ public:
+  USDStageReader(const char *filepath, const USDImportParams &params);
+  ~USDStageReader();
+
+  bool valid() const;
+  pxr::UsdStageRefPtr stage() const;
+  ImportSettings &settings();
+  Span<USDPrimReader *> readers() const;
+
+  /* Create readers for the supported prims, and the collections of the prototypes. */
+  void collect_readers(Main *bmain);
+  /* Read the prim data of all readers in parallel. */
+  void read_prims(pxr::UsdTimeCode time);
+
+ private:
+  USDPrimReader *create_reader(Main *bmain, const pxr::UsdPrim &prim);
+  /* Create the reader of the prim and recurse into its children. */
+  void visit_prim(Main *bmain,
+                  const pxr::UsdPrim &prim,
+                  USDPrimReader *parent_reader,
+                  Collection *collection);
+  void visit_children(Main *bmain,
+                      const pxr::UsdPrim &prim,
+                      USDPrimReader *parent_reader,
+                      Collection *collection);
+  void add_prototype(Main *bmain, const pxr::UsdPrim &prototype, bool include_root);
+};
+
+}  // namespace blender::io::usd
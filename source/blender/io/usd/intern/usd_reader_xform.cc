@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "usd_reader_xform.h"
+
+#include <pxr/usd/usdGeom/imageable.h>
+#include <pxr/usd/usdGeom/modelAPI.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xformable.h>
+
+#include "BKE_object.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_matrix.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_object_types.h"
+
+namespace blender::io::usd {
+
+USDXformReader::USDXformReader(const pxr::UsdPrim &prim,
+                               const USDImportParams &import_params,
+                               ImportSettings &settings)
+    : USDPrimReader(prim, import_params, settings), resets_xform_stack_(false), is_visible_(true)
+{
+  unit_m4(local_matrix_);
+}
+
+void USDXformReader::read_prim_data(pxr::UsdTimeCode time)
+{
+  pxr::UsdGeomXformable xformable(prim_);
+  pxr::GfMatrix4d transform(1.0);
+  if (xformable && xformable.GetLocalTransformation(&transform, &resets_xform_stack_, time)) {
+    /* USD matrices store the translation in the last row, the same memory layout as ours. */
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 4; j++) {
+        local_matrix_[i][j] = static_cast<float>(transform[i][j]);
+      }
+    }
+  }
+
+  pxr::UsdGeomImageable imageable(prim_);
+  is_visible_ = !imageable || imageable.ComputeVisibility(time) != pxr::UsdGeomTokens->invisible;
+}
+
+void USDXformReader::create_object(Main *bmain, pxr::UsdTimeCode /*time*/)
+{
+  object_ = BKE_object_add_only_object(bmain, OB_EMPTY, name_.c_str());
+  object_->empty_drawsize = 0.1f;
+}
+
+bool USDXformReader::is_root() const
+{
+  return (parent_reader_ == nullptr || resets_xform_stack_) && collection_ == nullptr;
+}
+
+void USDXformReader::read_object_data(Main * /*bmain*/, pxr::UsdTimeCode /*time*/)
+{
+  float matrix[4][4];
+  if (is_root()) {
+    mul_m4_m4m4(matrix, settings_.conversion_mat, local_matrix_);
+  }
+  else {
+    copy_m4_m4(matrix, local_matrix_);
+  }
+  BKE_object_apply_mat4(object_, matrix, true, false);
+
+  if (parent_reader_ && !resets_xform_stack_) {
+    object_->parent = parent_reader_->object();
+  }
+
+  if (!is_visible_) {
+    object_->restrictflag |= OB_RESTRICT_VIEWPORT | OB_RESTRICT_RENDER;
+  }
+}
+
+USDPayloadPlaceholderReader::USDPayloadPlaceholderReader(const pxr::UsdPrim &prim,
+                                                         const USDImportParams &import_params,
+                                                         ImportSettings &settings)
+    : USDXformReader(prim, import_params, settings), size_(1.0f)
+{
+}
+
+bool USDPayloadPlaceholderReader::reads_children() const
+{
+  /* The children are only known once the payload is loaded. */
+  return false;
+}
+
+void USDPayloadPlaceholderReader::read_prim_data(pxr::UsdTimeCode time)
+{
+  USDXformReader::read_prim_data(time);
+
+  pxr::VtVec3fArray extents;
+  if (pxr::UsdGeomModelAPI(prim_).GetExtentsHint(&extents, time) && extents.size() >= 2) {
+    const pxr::GfVec3f half_size = (extents[1] - extents[0]) * 0.5f;
+    size_ = max_fff(half_size[0], half_size[1], half_size[2]);
+  }
+}
+
+void USDPayloadPlaceholderReader::create_object(Main *bmain, pxr::UsdTimeCode time)
+{
+  USDXformReader::create_object(bmain, time);
+  object_->empty_drawtype = OB_CUBE;
+  object_->empty_drawsize = size_;
+}
+
+}  // namespace blender::io::usd
@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "usd_reader_prim.h"
+
+namespace blender::io::usd {
+
+/* Xformable prims without a more specific reader become empties. */
+class USDXformReader : public USDPrimReader {
+ protected:
+  float local_matrix_[4][4];
+  /* The transform does not inherit the transforms of the parent prims. */
+  bool resets_xform_stack_;
+  bool is_visible_;
+
+ public:
+  USDXformReader(const pxr::UsdPrim &prim,
+                 const USDImportParams &import_params,
+                 ImportSettings &settings);
+
+  void read_prim_data(pxr::UsdTimeCode time) override;
+  void create_object(Main *bmain, pxr::UsdTimeCode time) override;
+  void read_object_data(Main *bmain, pxr::UsdTimeCode time) override;
+
+  /* The transform is not relative to a parent object or a prototype. */
+  bool is_root() const;
+};
+
+/**
+ * Placeholder for a prim whose payload is not loaded. The empty has the size of the extents hint
+ * of the model. The payload cannot be loaded from Blender later, the file has to be imported again
+ * with payloads enabled.
+ */
+class USDPayloadPlaceholderReader : public USDXformReader {
+  float size_;
+
+ public:
+  USDPayloadPlaceholderReader(const pxr::UsdPrim &prim,
+                              const USDImportParams &import_params,
+                              ImportSettings &settings);
+
+  bool reads_children() const override;
+  void read_prim_data(pxr::UsdTimeCode time) override;
+  void create_object(Main *bmain, pxr::UsdTimeCode time) override;
+};
+
+}  // namespace blender::io::usd
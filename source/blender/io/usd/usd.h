@@ -39,6 +39,16 @@ struct USDExportParams {
   enum eEvaluationMode evaluation_mode;
 };
 
+struct USDImportParams {
+  float scale;
+  bool set_frame_range;
+  /** Keep scene graph instances and point instancers as collection instances. */
+  bool import_instancing;
+  /** When disabled, prims with payloads are imported as placeholder empties. */
+  bool load_payloads;
+  bool validate_meshes;
+};
+
 /* The USD_export takes a as_background_job parameter, and returns a boolean.
  *
  * When as_background_job=true, returns false immediately after scheduling
@@ -53,6 +63,13 @@ bool USD_export(struct bContext *C,
                 const struct USDExportParams *params,
                 bool as_background_job);
 
+/* Import the prims of a USD stage as objects in the active collection. Like USD_export, returns
+ * false immediately after scheduling a background job when as_background_job=true. */
+bool USD_import(struct bContext *C,
+                const char *filepath,
+                const struct USDImportParams *params,
+                bool as_background_job);
+
 int USD_get_version(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include "BLI_path_util.h"
+
+#include "DEG_depsgraph.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct bContext;
+
+struct OBJExportParams {
+  /** Full path to the destination OBJ file. */
+  char filepath[FILE_MAX];
+
+  /** Write one file per frame, with the frame number added to the file name. */
+  bool export_animation;
+  int start_frame;
+  int end_frame;
+
+  /* Geometry transform options. Axes are `OB_POSX` .. `OB_NEGZ`. */
+  int forward_axis;
+  int up_axis;
+  float scaling_factor;
+
+  /* File write options. */
+  bool export_selected_objects;
+  enum eEvaluationMode export_eval_mode;
+  bool export_uv;
+  bool export_normals;
+  bool export_materials;
+  bool export_triangulated_mesh;
+  bool export_object_groups;
+  bool export_smooth_groups;
+};
+
+struct OBJImportParams {
+  /** Full path to the source OBJ file. */
+  char filepath[FILE_MAX];
+
+  /** Scale the imported objects down to fit this size, 0 to disable. */
+  float clamp_size;
+  /* Axes are `OB_POSX` .. `OB_NEGZ`. */
+  int forward_axis;
+  int up_axis;
+
+  /** Create a new object for every `o` statement. */
+  bool split_by_object;
+  /** Create a new object for every `g` statement. */
+  bool split_by_group;
+  bool import_edges;
+  bool validate_meshes;
+};
+
+/**
+ * Export the scene, or its selected objects, to an OBJ file, and its materials to an MTL file
+ * next to it. Returns false when a file could not be written.
+ */
+bool OBJ_export(struct bContext *C, const struct OBJExportParams *export_params);
+
+/**
+ * Import the objects of an OBJ file into the active collection, and select them.
+ * Returns false when the file could not be read.
+ */
+bool OBJ_import(struct bContext *C, const struct OBJImportParams *import_params);
+
+#ifdef __cplusplus
+}
+#endif
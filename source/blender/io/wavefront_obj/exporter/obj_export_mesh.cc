@@ -0,0 +1,460 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdarg>
+#include <utility>
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_float2.hh"
+#include "BLI_map.hh"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "bmesh.h"
+#include "bmesh_tools.h"
+
+#include "obj_export_mesh.hh"
+
+namespace blender::io::obj {
+
+/* Elements per chunk of parallel formatting. */
+static const int64_t format_chunk_size = 16384;
+
+void append_format(std::string &str, const char *format, ...)
+{
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  const int len = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (len < 0) {
+    return;
+  }
+  if (len < int(sizeof(buffer))) {
+    str.append(buffer, size_t(len));
+    return;
+  }
+  /* Long names, format again into the string itself. */
+  const size_t old_size = str.size();
+  str.resize(old_size + size_t(len) + 1);
+  va_start(args, format);
+  vsnprintf(&str[old_size], size_t(len) + 1, format, args);
+  va_end(args);
+  str.resize(old_size + size_t(len));
+}
+
+static void append_int(std::string &str, const int64_t value)
+{
+  char buffer[24];
+  const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  str.append(buffer, result.ptr);
+}
+
+std::string obj_valid_name(const std::string &name)
+{
+  std::string valid_name(name);
+  std::replace(valid_name.begin(), valid_name.end(), ' ', '_');
+  std::replace(valid_name.begin(), valid_name.end(), '\t', '_');
+  return valid_name;
+}
+
+/**
+ * Call `format_item(str, i)` for every index below `size`, in parallel chunks, and append the
+ * formatted chunks to `r_text` in order.
+ */
+template<typename FormatFn>
+static void format_parallel(std::string &r_text, const int64_t size, const FormatFn &format_item)
+{
+  const int64_t chunks_num = (size + format_chunk_size - 1) / format_chunk_size;
+  if (chunks_num <= 1) {
+    for (int64_t i = 0; i < size; i++) {
+      format_item(r_text, i);
+    }
+    return;
+  }
+
+  Array<std::string> chunks(chunks_num);
+  parallel_for(IndexRange(chunks_num), 1, [&](IndexRange range) {
+    for (const int64_t chunk_index : range) {
+      std::string &chunk = chunks[chunk_index];
+      const int64_t start = chunk_index * format_chunk_size;
+      const int64_t end = std::min(start + format_chunk_size, size);
+      for (int64_t i = start; i < end; i++) {
+        format_item(chunk, i);
+      }
+    }
+  });
+
+  size_t total_size = r_text.size();
+  for (const std::string &chunk : chunks) {
+    total_size += chunk.size();
+  }
+  r_text.reserve(total_size);
+  for (const std::string &chunk : chunks) {
+    r_text.append(chunk);
+  }
+}
+
+OBJWriteState::OBJWriteState(FILE *outfile, const OBJExportParams &params)
+    : outfile(outfile), params(params)
+{
+  float axes[3][3];
+  unit_m3(axes);
+  mat3_from_axis_conversion(params.forward_axis, params.up_axis, OB_POSY, OB_POSZ, axes);
+  mul_m3_fl(axes, params.scaling_factor);
+  copy_m4_m3(world_to_file.ptr(), axes);
+}
+
+OBJMeshWriter::OBJMeshWriter(OBJWriteState &state) : state_(state)
+{
+}
+
+OBJMeshWriter::~OBJMeshWriter()
+{
+  free_mesh();
+}
+
+bool OBJMeshWriter::supports_prepare() const
+{
+  return true;
+}
+
+void OBJMeshWriter::free_mesh()
+{
+  if (mesh_needs_free_) {
+    BKE_id_free(nullptr, mesh_);
+  }
+  mesh_ = nullptr;
+  mesh_needs_free_ = false;
+}
+
+void OBJMeshWriter::prepare(HierarchyContext &context)
+{
+  BLI_assert(mesh_ == nullptr);
+  const OBJExportParams &params = state_.params;
+  is_prepared_ = true;
+
+  Object *object = context.object;
+  Mesh *mesh = BKE_object_get_evaluated_mesh(object);
+  if (mesh == nullptr) {
+    return;
+  }
+
+  if (params.export_triangulated_mesh) {
+    struct BMeshCreateParams bmcp = {false};
+    struct BMeshFromMeshParams bmfmp = {true, false, false, 0};
+    BMesh *bm = BKE_mesh_to_bmesh_ex(mesh, &bmcp, &bmfmp);
+    BM_mesh_triangulate(bm,
+                        MOD_TRIANGULATE_QUAD_SHORTEDGE,
+                        MOD_TRIANGULATE_NGON_BEAUTY,
+                        4,
+                        false,
+                        nullptr,
+                        nullptr,
+                        nullptr);
+    mesh = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, mesh);
+    BM_mesh_free(bm);
+    mesh_needs_free_ = true;
+  }
+  mesh_ = mesh;
+
+  /* The data context is a child of the object, use the name of the object. */
+  const std::string &object_path = context.higher_up_export_path;
+  object_name_ = object_path.substr(object_path.rfind('/') + 1);
+
+  const float4x4 matrix = state_.world_to_file * float4x4(context.matrix_world);
+  const MVert *mvert = mesh->mvert;
+  vertex_text_.clear();
+  format_parallel(vertex_text_, mesh->totvert, [&](std::string &str, const int64_t i) {
+    const float3 co = matrix * float3(mvert[i].co);
+    append_format(str, "v %.6f %.6f %.6f\n", co.x, co.y, co.z);
+  });
+
+  if (params.export_uv) {
+    prepare_uvs(vertex_text_);
+  }
+  else {
+    uv_num_ = 0;
+    loop_uv_indices_ = Array<int>();
+  }
+
+  if (params.export_normals) {
+    prepare_normals(matrix, vertex_text_);
+  }
+  else {
+    normal_num_ = 0;
+    loop_normal_indices_ = Array<int>();
+  }
+
+  prepare_loose_edges();
+
+  materials_.clear();
+  for (int i = 0; i < object->totcol; i++) {
+    materials_.append(BKE_object_material_get(object, short(i + 1)));
+  }
+}
+
+/* UV coordinates are de-duplicated per mesh, at the precision they are written with. */
+void OBJMeshWriter::prepare_uvs(std::string &r_text)
+{
+  const Mesh *mesh = mesh_;
+  const MLoopUV *mloopuv = static_cast<const MLoopUV *>(
+      CustomData_get_layer(&mesh->ldata, CD_MLOOPUV));
+  if (mloopuv == nullptr) {
+    uv_num_ = 0;
+    loop_uv_indices_ = Array<int>();
+    return;
+  }
+
+  loop_uv_indices_.reinitialize(mesh->totloop);
+  /* 64 bit per component, UDIM and other large coordinates overflow 32 bit at this precision. */
+  Map<std::pair<int64_t, int64_t>, int> uv_indices;
+  Vector<float2> uvs;
+  for (int i = 0; i < mesh->totloop; i++) {
+    const float2 uv(mloopuv[i].uv);
+    const std::pair<int64_t, int64_t> key(std::llround(double(uv.x) * 1e6),
+                                          std::llround(double(uv.y) * 1e6));
+    loop_uv_indices_[i] = uv_indices.lookup_or_add_cb(key, [&]() {
+      uvs.append(uv);
+      return int(uvs.size() - 1);
+    });
+  }
+  uv_num_ = uvs.size();
+
+  format_parallel(r_text, uvs.size(), [&](std::string &str, const int64_t i) {
+    append_format(str, "vt %.6f %.6f\n", uvs[i].x, uvs[i].y);
+  });
+}
+
+/* Face corner normals, which take sharp edges, auto smooth and custom normals into account. They
+ * are de-duplicated per mesh, at the precision they are written with. */
+void OBJMeshWriter::prepare_normals(const float4x4 &matrix, std::string &r_text)
+{
+  Mesh *mesh = mesh_;
+
+  /* Computed into temporary arrays, the evaluated mesh can be shared with other writers. */
+  const bool use_split_normals = (mesh->flag & ME_AUTOSMOOTH) != 0;
+  const float split_angle = use_split_normals ? mesh->smoothresh : float(M_PI);
+  Array<float3> poly_normals(mesh->totpoly);
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             nullptr,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             reinterpret_cast<float(*)[3]>(poly_normals.data()),
+                             true);
+  Array<float3> loop_normals(mesh->totloop, float3(0.0f));
+  short(*clnors)[2] = static_cast<short(*)[2]>(
+      CustomData_get_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL));
+  BKE_mesh_normals_loop_split(mesh->mvert,
+                              mesh->totvert,
+                              mesh->medge,
+                              mesh->totedge,
+                              mesh->mloop,
+                              reinterpret_cast<float(*)[3]>(loop_normals.data()),
+                              mesh->totloop,
+                              mesh->mpoly,
+                              reinterpret_cast<const float(*)[3]>(poly_normals.data()),
+                              mesh->totpoly,
+                              use_split_normals,
+                              split_angle,
+                              nullptr,
+                              clnors,
+                              nullptr);
+
+  const float4x4 normal_matrix = matrix.inverted_transposed_affine();
+  parallel_for(loop_normals.index_range(), 4096, [&](IndexRange range) {
+    for (const int64_t i : range) {
+      mul_mat3_m4_v3(normal_matrix.ptr(), loop_normals[i]);
+      normalize_v3(loop_normals[i]);
+    }
+  });
+
+  loop_normal_indices_.reinitialize(mesh->totloop);
+  Map<uint64_t, int> normal_indices;
+  Vector<float3> normals;
+  for (int i = 0; i < mesh->totloop; i++) {
+    const float3 &normal = loop_normals[i];
+    uint64_t key = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      key = (key << 16) | uint64_t(int(std::round(normal[axis] * 1e4f)) + 10000);
+    }
+    loop_normal_indices_[i] = normal_indices.lookup_or_add_cb(key, [&]() {
+      normals.append(normal);
+      return int(normals.size() - 1);
+    });
+  }
+  normal_num_ = normals.size();
+
+  format_parallel(r_text, normals.size(), [&](std::string &str, const int64_t i) {
+    append_format(str, "vn %.4f %.4f %.4f\n", normals[i].x, normals[i].y, normals[i].z);
+  });
+}
+
+void OBJMeshWriter::prepare_loose_edges()
+{
+  const Mesh *mesh = mesh_;
+  loose_edge_verts_.clear();
+
+  Array<bool> edge_used(mesh->totedge, false);
+  for (int i = 0; i < mesh->totloop; i++) {
+    edge_used[mesh->mloop[i].e] = true;
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    if (!edge_used[i]) {
+      loose_edge_verts_.append(int(mesh->medge[i].v1));
+      loose_edge_verts_.append(int(mesh->medge[i].v2));
+    }
+  }
+}
+
+const Material *OBJMeshWriter::poly_material(const int64_t poly_index) const
+{
+  const int mat_nr = mesh_->mpoly[poly_index].mat_nr;
+  return (mat_nr < materials_.size()) ? materials_[mat_nr] : nullptr;
+}
+
+void OBJMeshWriter::format_faces(std::string &r_text) const
+{
+  const OBJExportParams &params = state_.params;
+  const Mesh *mesh = mesh_;
+  const MPoly *mpoly = mesh->mpoly;
+  const MLoop *mloop = mesh->mloop;
+  const bool use_uvs = !loop_uv_indices_.is_empty();
+  const bool use_normals = !loop_normal_indices_.is_empty();
+  /* OBJ indices start at 1. */
+  const int64_t vertex_offset = state_.vertex_offset + 1;
+  const int64_t uv_offset = state_.uv_offset + 1;
+  const int64_t normal_offset = state_.normal_offset + 1;
+
+  format_parallel(r_text, mesh->totpoly, [&](std::string &str, const int64_t i) {
+    const MPoly &poly = mpoly[i];
+
+    /* Every face only depends on the one before it, so chunks can be formatted independently. */
+    if (params.export_materials) {
+      const Material *material = poly_material(i);
+      if (material != (i == 0 ? state_.current_material : poly_material(i - 1))) {
+        /* Faces without a material use the name other exporters write for them. */
+        str.append("usemtl ");
+        str.append(material ? obj_valid_name(material->id.name + 2) : "(null)");
+        str.push_back('\n');
+      }
+    }
+    if (params.export_smooth_groups) {
+      const bool smooth = (poly.flag & ME_SMOOTH) != 0;
+      if (i == 0 || smooth != ((mpoly[i - 1].flag & ME_SMOOTH) != 0)) {
+        str.append(smooth ? "s 1\n" : "s off\n");
+      }
+    }
+
+    str.push_back('f');
+    for (int j = poly.loopstart; j < poly.loopstart + poly.totloop; j++) {
+      str.push_back(' ');
+      append_int(str, vertex_offset + mloop[j].v);
+      if (use_uvs || use_normals) {
+        str.push_back('/');
+        if (use_uvs) {
+          append_int(str, uv_offset + loop_uv_indices_[j]);
+        }
+        if (use_normals) {
+          str.push_back('/');
+          append_int(str, normal_offset + loop_normal_indices_[j]);
+        }
+      }
+    }
+    str.push_back('\n');
+  });
+
+  for (int64_t i = 0; i < loose_edge_verts_.size(); i += 2) {
+    r_text.append("l ");
+    append_int(r_text, vertex_offset + loose_edge_verts_[i]);
+    r_text.push_back(' ');
+    append_int(r_text, vertex_offset + loose_edge_verts_[i + 1]);
+    r_text.push_back('\n');
+  }
+}
+
+void OBJMeshWriter::write(HierarchyContext &context)
+{
+  if (!is_prepared_) {
+    prepare(context);
+  }
+  is_prepared_ = false;
+
+  if (mesh_ == nullptr) {
+    return;
+  }
+
+  std::string text;
+  text.append("o ");
+  text.append(object_name_);
+  text.push_back('\n');
+  if (state_.params.export_object_groups) {
+    text.append("g ");
+    text.append(object_name_);
+    text.push_back('\n');
+  }
+  text.append(vertex_text_);
+  format_faces(text);
+
+  if (fwrite(text.data(), 1, text.size(), state_.outfile) != text.size()) {
+    state_.write_failed = true;
+  }
+
+  if (state_.params.export_materials) {
+    for (Material *material : materials_) {
+      if (material != nullptr) {
+        state_.materials.add(material);
+      }
+    }
+    if (mesh_->totpoly > 0) {
+      state_.current_material = poly_material(mesh_->totpoly - 1);
+    }
+  }
+
+  state_.vertex_offset += mesh_->totvert;
+  state_.uv_offset += uv_num_;
+  state_.normal_offset += normal_num_;
+
+  /* The text of big meshes can take a lot of memory, don't keep it around between frames. */
+  std::string().swap(vertex_text_);
+  free_mesh();
+}
+
+}  // namespace blender::io::obj
@@ -0,0 +1,109 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include "BLI_array.hh"
+#include "BLI_compiler_attrs.h"
+#include "BLI_float4x4.hh"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+#include "IO_abstract_hierarchy_iterator.h"
+#include "IO_wavefront_obj.h"
+
+struct Material;
+struct Mesh;
+
+namespace blender::io::obj {
+
+/* State shared by the writers of one OBJ file. Only used from write(), which is called for one
+ * writer at a time. */
+struct OBJWriteState {
+  FILE *outfile;
+  const OBJExportParams &params;
+  /* From Blender's world space to the space of the file, for the axis and scale options. */
+  float4x4 world_to_file;
+
+  /* Indices in OBJ files are global, so every writer continues where the previous one ended. */
+  int64_t vertex_offset = 0;
+  int64_t uv_offset = 0;
+  int64_t normal_offset = 0;
+
+  /* Materials of the written meshes, in order of first use, to be written to the MTL file. */
+  VectorSet<Material *> materials;
+  /* Material of the last written face, "usemtl" stays in effect in the next objects. */
+  const Material *current_material = nullptr;
+
+  bool write_failed = false;
+
+  OBJWriteState(FILE *outfile, const OBJExportParams &params);
+};
+
+/* Writes a mesh object. The vertex, UV and normal lines are formatted in prepare(), which runs
+ * in parallel for all meshes of the file. The face lines depend on the number of elements written
+ * by earlier writers, so they are formatted in write(), in parallel chunks of faces. */
+class OBJMeshWriter : public AbstractHierarchyWriter {
+ private:
+  OBJWriteState &state_;
+
+  /* Data of the current frame, from prepare(). */
+  bool is_prepared_ = false;
+  Mesh *mesh_ = nullptr;
+  bool mesh_needs_free_ = false;
+  std::string object_name_;
+  std::string vertex_text_;
+  int64_t uv_num_ = 0;
+  int64_t normal_num_ = 0;
+  /* Indices of the UV coordinate and normal of every face corner, or -1 when not exported. */
+  Array<int> loop_uv_indices_;
+  Array<int> loop_normal_indices_;
+  /* Material of every material slot, can contain nulls. */
+  Vector<Material *> materials_;
+  /* Pairs of vertex indices of edges that are not used by any face. */
+  Vector<int> loose_edge_verts_;
+
+ public:
+  explicit OBJMeshWriter(OBJWriteState &state);
+  ~OBJMeshWriter() override;
+
+  bool supports_prepare() const override;
+  void prepare(HierarchyContext &context) override;
+  void write(HierarchyContext &context) override;
+
+ private:
+  void free_mesh();
+  void prepare_uvs(std::string &r_text);
+  void prepare_normals(const float4x4 &matrix, std::string &r_text);
+  void prepare_loose_edges();
+  const Material *poly_material(int64_t poly_index) const;
+  void format_faces(std::string &r_text) const;
+};
+
+/* Append to a string, with printf() formatting. */
+void append_format(std::string &str, const char *format, ...) ATTR_PRINTF_FORMAT(2, 3);
+
+/* Replace the characters that are not allowed in OBJ and MTL names. */
+std::string obj_valid_name(const std::string &name);
+
+}  // namespace blender::io::obj
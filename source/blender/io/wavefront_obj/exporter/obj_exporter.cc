@@ -0,0 +1,238 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cstdio>
+#include <string>
+
+#include "BKE_blender_version.h"
+#include "BKE_context.h"
+#include "BKE_scene.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_material_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "obj_export_mesh.hh"
+#include "obj_exporter.hh"
+
+namespace blender::io::obj {
+
+/* OBJ files have no hierarchy, transforms are applied to the vertices by the mesh writer. The
+ * transform writer only exists because the hierarchy iterator needs one for every object. */
+class OBJTransformWriter : public AbstractHierarchyWriter {
+ public:
+  void write(HierarchyContext & /*context*/) override
+  {
+  }
+};
+
+class OBJHierarchyIterator : public AbstractHierarchyIterator {
+ private:
+  OBJWriteState &state_;
+
+ public:
+  OBJHierarchyIterator(Depsgraph *depsgraph, OBJWriteState &state)
+      : AbstractHierarchyIterator(depsgraph), state_(state)
+  {
+  }
+
+  std::string make_valid_name(const std::string &name) const override
+  {
+    return obj_valid_name(name);
+  }
+
+ protected:
+  bool mark_as_weak_export(const Object *object) const override
+  {
+    return state_.params.export_selected_objects && (object->base_flag & BASE_SELECTED) == 0;
+  }
+
+  AbstractHierarchyWriter *create_transform_writer(const HierarchyContext * /*context*/) override
+  {
+    return new OBJTransformWriter();
+  }
+
+  AbstractHierarchyWriter *create_data_writer(const HierarchyContext *context) override
+  {
+    if (context->object->type != OB_MESH) {
+      return nullptr;
+    }
+    return new OBJMeshWriter(state_);
+  }
+
+  AbstractHierarchyWriter *create_hair_writer(const HierarchyContext * /*context*/) override
+  {
+    return nullptr;
+  }
+
+  AbstractHierarchyWriter *create_particle_writer(const HierarchyContext * /*context*/) override
+  {
+    return nullptr;
+  }
+
+  void release_writer(AbstractHierarchyWriter *writer) override
+  {
+    delete writer;
+  }
+};
+
+static void mtl_filepath_get(const char *obj_filepath, char r_mtl_filepath[FILE_MAX])
+{
+  BLI_strncpy(r_mtl_filepath, obj_filepath, FILE_MAX);
+  BLI_path_extension_replace(r_mtl_filepath, FILE_MAX, ".mtl");
+}
+
+static bool write_mtl_file(const char *filepath, const OBJWriteState &state)
+{
+  FILE *outfile = BLI_fopen(filepath, "wb");
+  if (outfile == nullptr) {
+    WM_reportf(RPT_ERROR, "OBJ Export: cannot open '%s' for writing", filepath);
+    return false;
+  }
+
+  std::string text;
+  append_format(text, "# Blender %s MTL File\n", BKE_blender_version_string());
+  append_format(text, "# Material Count: %d\n", int(state.materials.size()));
+
+  /* The viewport display settings of the materials, the inverse of how the importer reads them. */
+  for (const Material *material : state.materials) {
+    const float shininess = (1.0f - material->roughness) * (1.0f - material->roughness) * 1000.0f;
+    text.append("\nnewmtl ");
+    text.append(obj_valid_name(material->id.name + 2));
+    text.push_back('\n');
+    append_format(text, "Ns %.6f\n", shininess);
+    append_format(text,
+                  "Ka %.6f %.6f %.6f\n",
+                  material->metallic,
+                  material->metallic,
+                  material->metallic);
+    append_format(text, "Kd %.6f %.6f %.6f\n", material->r, material->g, material->b);
+    append_format(text,
+                  "Ks %.6f %.6f %.6f\n",
+                  material->specr * material->spec,
+                  material->specg * material->spec,
+                  material->specb * material->spec);
+    append_format(text, "d %.6f\n", material->a);
+    text.append("illum 2\n");
+  }
+
+  const bool ok = fwrite(text.data(), 1, text.size(), outfile) == text.size();
+  fclose(outfile);
+  if (!ok) {
+    WM_reportf(RPT_ERROR, "OBJ Export: error writing '%s'", filepath);
+  }
+  return ok;
+}
+
+static bool export_frame(Depsgraph *depsgraph,
+                         const OBJExportParams &export_params,
+                         const char *filepath)
+{
+  FILE *outfile = BLI_fopen(filepath, "wb");
+  if (outfile == nullptr) {
+    WM_reportf(RPT_ERROR, "OBJ Export: cannot open '%s' for writing", filepath);
+    return false;
+  }
+
+  OBJWriteState state(outfile, export_params);
+  char mtl_filepath[FILE_MAX];
+  mtl_filepath_get(filepath, mtl_filepath);
+
+  std::string header;
+  append_format(header, "# Blender %s\n# www.blender.org\n", BKE_blender_version_string());
+  if (export_params.export_materials) {
+    append_format(header, "mtllib %s\n", BLI_path_basename(mtl_filepath));
+  }
+  fputs(header.c_str(), outfile);
+
+  OBJHierarchyIterator iter(depsgraph, state);
+  iter.iterate_and_write();
+  iter.release_writers();
+
+  const bool write_failed = state.write_failed || ferror(outfile);
+  fclose(outfile);
+  if (write_failed) {
+    WM_reportf(RPT_ERROR, "OBJ Export: error writing '%s'", filepath);
+    return false;
+  }
+
+  /* Materials are evaluated data, write them while the depsgraph is still at this frame. */
+  if (export_params.export_materials) {
+    return write_mtl_file(mtl_filepath, state);
+  }
+  return true;
+}
+
+/* Insert the frame number before the extension, e.g. `/path/to/file_000042.obj`. */
+static void frame_filepath_get(const char *filepath, const int frame, char r_filepath[FILE_MAX])
+{
+  char filepath_no_ext[FILE_MAX];
+  BLI_strncpy(filepath_no_ext, filepath, sizeof(filepath_no_ext));
+  BLI_path_extension_replace(filepath_no_ext, sizeof(filepath_no_ext), "");
+  BLI_snprintf(r_filepath, FILE_MAX, "%s_%06d.obj", filepath_no_ext, frame);
+}
+
+bool exporter_main(bContext *C, const OBJExportParams &export_params)
+{
+  Main *bmain = CTX_data_main(C);
+  Scene *scene = CTX_data_scene(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+
+  Depsgraph *depsgraph = DEG_graph_new(bmain, scene, view_layer, export_params.export_eval_mode);
+  DEG_graph_build_from_view_layer(depsgraph);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  bool ok = true;
+  if (!export_params.export_animation) {
+    ok = export_frame(depsgraph, export_params, export_params.filepath);
+  }
+  else {
+    const int orig_frame = CFRA;
+    for (int frame = export_params.start_frame; frame <= export_params.end_frame && ok; frame++) {
+      char filepath[FILE_MAX];
+      frame_filepath_get(export_params.filepath, frame, filepath);
+
+      CFRA = frame;
+      BKE_scene_graph_update_for_newframe(depsgraph);
+      ok = export_frame(depsgraph, export_params, filepath);
+    }
+    if (CFRA != orig_frame) {
+      CFRA = orig_frame;
+      BKE_scene_graph_update_for_newframe(depsgraph);
+    }
+  }
+
+  DEG_graph_free(depsgraph);
+  return ok;
+}
+
+}  // namespace blender::io::obj
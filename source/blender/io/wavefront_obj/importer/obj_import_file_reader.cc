@@ -0,0 +1,705 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "obj_import_file_reader.hh"
+
+namespace blender::io::obj {
+
+/* Size of the parts of the file that are read at once. */
+static constexpr int64_t chunk_size = 64 * 1024 * 1024;
+/* Chunks are split into blocks of about this size, which are parsed in parallel. */
+static constexpr int64_t block_size = 1024 * 1024;
+
+/* Statement that affects the elements after it. */
+struct StateChange {
+  enum Type { Object, Group, Material, Smooth, MtlLib };
+  Type type;
+  /* The change applies to the element with this index in the block and all following ones. */
+  int element_index;
+  std::string value;
+  bool smooth;
+};
+
+/* A face or a polyline. */
+struct BlockElement {
+  int corner_start;
+  int corner_count;
+  bool is_edge;
+};
+
+/* Corner index that is relative to the end of the previous block, from negative indices. */
+struct RelativeRef {
+  int corner;
+  enum Field : uint8_t { Vert, UV, Normal } field;
+};
+
+struct ParsedBlock {
+  Vector<float3> vertices;
+  Vector<float2> uv_vertices;
+  Vector<float3> vertex_normals;
+  Vector<FaceCorner> corners;
+  Vector<BlockElement> elements;
+  Vector<StateChange> state_changes;
+  Vector<RelativeRef> relative_refs;
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Line Parsing
+ * \{ */
+
+static bool is_whitespace(const char c)
+{
+  return ELEM(c, ' ', '\t', '\r', '\f', '\v');
+}
+
+static bool is_digit(const char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static const char *skip_whitespace(const char *p, const char *end)
+{
+  while (p < end && is_whitespace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static const char *skip_token(const char *p, const char *end)
+{
+  while (p < end && !is_whitespace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+/* Rest of the line without surrounding whitespace. */
+static StringRef rest_of_line(const char *p, const char *end)
+{
+  p = skip_whitespace(p, end);
+  while (end > p && is_whitespace(end[-1])) {
+    end--;
+  }
+  return StringRef(p, end);
+}
+
+/**
+ * Parse a decimal number, much faster than `strtof` because it does not depend on the locale.
+ * Returns the position after the number, or \a p when there is no number.
+ */
+static const char *parse_float(const char *p,
+                               const char *end,
+                               const float fallback,
+                               float &r_value)
+{
+  static const double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  p = skip_whitespace(p, end);
+  const char *start = p;
+
+  bool negative = false;
+  if (p < end && ELEM(*p, '-', '+')) {
+    negative = *p == '-';
+    p++;
+  }
+
+  /* Digits beyond the precision of the mantissa only change the exponent. */
+  const uint64_t mantissa_max = 100000000000000000ull;
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  int digits_num = 0;
+  for (; p < end && is_digit(*p); p++, digits_num++) {
+    if (mantissa < mantissa_max) {
+      mantissa = mantissa * 10 + uint64_t(*p - '0');
+    }
+    else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (p++; p < end && is_digit(*p); p++, digits_num++) {
+      if (mantissa < mantissa_max) {
+        mantissa = mantissa * 10 + uint64_t(*p - '0');
+        exponent--;
+      }
+    }
+  }
+  if (digits_num == 0) {
+    r_value = fallback;
+    return start;
+  }
+
+  if (p < end && ELEM(*p, 'e', 'E')) {
+    const char *exponent_start = p;
+    p++;
+    bool exponent_negative = false;
+    if (p < end && ELEM(*p, '-', '+')) {
+      exponent_negative = *p == '-';
+      p++;
+    }
+    if (p < end && is_digit(*p)) {
+      int value = 0;
+      for (; p < end && is_digit(*p); p++) {
+        value = std::min(value * 10 + (*p - '0'), 10000);
+      }
+      exponent += exponent_negative ? -value : value;
+    }
+    else {
+      p = exponent_start;
+    }
+  }
+
+  double value = double(mantissa);
+  if (exponent >= 0 && exponent <= 22) {
+    value *= powers_of_ten[exponent];
+  }
+  else if (exponent < 0 && exponent >= -22) {
+    value /= powers_of_ten[-exponent];
+  }
+  else {
+    value *= std::pow(10.0, double(exponent));
+  }
+  r_value = float(negative ? -value : value);
+  return p;
+}
+
+/* Returns the position after the number, or \a p when there is no number. */
+static const char *parse_int(const char *p, const char *end, int &r_value)
+{
+  const char *start = p;
+  bool negative = false;
+  if (p < end && ELEM(*p, '-', '+')) {
+    negative = *p == '-';
+    p++;
+  }
+  if (p == end || !is_digit(*p)) {
+    return start;
+  }
+  int64_t value = 0;
+  for (; p < end && is_digit(*p); p++) {
+    value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+  }
+  r_value = int(negative ? -value : value);
+  return p;
+}
+
+/**
+ * Convert a one-based or negative index of the file to a zero-based index.
+ * Negative indices are relative to \a count, the number of elements in the block so far.
+ * Returns false for the invalid index zero.
+ */
+static bool resolve_index(const int index,
+                          const int count,
+                          const int corner,
+                          const RelativeRef::Field field,
+                          ParsedBlock &block,
+                          int &r_index)
+{
+  if (index > 0) {
+    r_index = index - 1;
+    return true;
+  }
+  if (index < 0) {
+    r_index = count + index;
+    block.relative_refs.append({corner, field});
+    return true;
+  }
+  return false;
+}
+
+/* Parse the corners of an `f` or `l` statement, returns false if the statement is invalid. */
+static bool parse_element(const char *p, const char *end, const bool is_edge, ParsedBlock &block)
+{
+  const int corner_start = int(block.corners.size());
+  const int64_t relative_refs_num = block.relative_refs.size();
+  bool valid = true;
+
+  while (true) {
+    p = skip_whitespace(p, end);
+    if (p == end) {
+      break;
+    }
+    const int corner = int(block.corners.size());
+    FaceCorner face_corner = {-1, -1, -1};
+    int index = 0;
+    const char *next = parse_int(p, end, index);
+    if (next == p || !resolve_index(index,
+                                    int(block.vertices.size()),
+                                    corner,
+                                    RelativeRef::Vert,
+                                    block,
+                                    face_corner.vert_index)) {
+      valid = false;
+      break;
+    }
+    p = next;
+    if (p < end && *p == '/') {
+      p++;
+      next = parse_int(p, end, index);
+      if (next != p) {
+        if (!resolve_index(index,
+                           int(block.uv_vertices.size()),
+                           corner,
+                           RelativeRef::UV,
+                           block,
+                           face_corner.uv_index)) {
+          valid = false;
+          break;
+        }
+        p = next;
+      }
+      if (p < end && *p == '/') {
+        p++;
+        next = parse_int(p, end, index);
+        if (next != p) {
+          if (!resolve_index(index,
+                             int(block.vertex_normals.size()),
+                             corner,
+                             RelativeRef::Normal,
+                             block,
+                             face_corner.normal_index)) {
+            valid = false;
+            break;
+          }
+          p = next;
+        }
+      }
+    }
+    if (p < end && !is_whitespace(*p)) {
+      valid = false;
+      break;
+    }
+    block.corners.append(face_corner);
+  }
+
+  const int corner_count = int(block.corners.size()) - corner_start;
+  if (!valid || corner_count < (is_edge ? 2 : 3)) {
+    block.corners.resize(corner_start);
+    block.relative_refs.resize(relative_refs_num);
+    return false;
+  }
+  block.elements.append({corner_start, corner_count, is_edge});
+  return true;
+}
+
+static void add_state_change(ParsedBlock &block,
+                             const StateChange::Type type,
+                             const StringRef value,
+                             const bool smooth = false)
+{
+  block.state_changes.append({type, int(block.elements.size()), value, smooth});
+}
+
+static void parse_block(const StringRef text, ParsedBlock &block)
+{
+  const char *p = text.data();
+  const char *text_end = p + text.size();
+
+  while (p < text_end) {
+    const char *line_end = static_cast<const char *>(memchr(p, '\n', size_t(text_end - p)));
+    if (line_end == nullptr) {
+      line_end = text_end;
+    }
+    const char *keyword_start = skip_whitespace(p, line_end);
+    const char *keyword_end = skip_token(keyword_start, line_end);
+    const StringRef keyword(keyword_start, keyword_end);
+    const char *args = keyword_end;
+
+    if (keyword == "v") {
+      float3 co;
+      args = parse_float(args, line_end, 0.0f, co.x);
+      args = parse_float(args, line_end, 0.0f, co.y);
+      parse_float(args, line_end, 0.0f, co.z);
+      block.vertices.append(co);
+    }
+    else if (keyword == "vt") {
+      float2 uv;
+      args = parse_float(args, line_end, 0.0f, uv.x);
+      parse_float(args, line_end, 0.0f, uv.y);
+      block.uv_vertices.append(uv);
+    }
+    else if (keyword == "vn") {
+      float3 normal;
+      args = parse_float(args, line_end, 0.0f, normal.x);
+      args = parse_float(args, line_end, 0.0f, normal.y);
+      parse_float(args, line_end, 0.0f, normal.z);
+      block.vertex_normals.append(normal);
+    }
+    else if (keyword == "f") {
+      parse_element(args, line_end, false, block);
+    }
+    else if (keyword == "l") {
+      parse_element(args, line_end, true, block);
+    }
+    else if (keyword == "o") {
+      add_state_change(block, StateChange::Object, rest_of_line(args, line_end));
+    }
+    else if (keyword == "g") {
+      const StringRef name = rest_of_line(args, line_end);
+      if (!name.is_empty()) {
+        add_state_change(block, StateChange::Group, name);
+      }
+    }
+    else if (keyword == "usemtl") {
+      add_state_change(block, StateChange::Material, rest_of_line(args, line_end));
+    }
+    else if (keyword == "s") {
+      const StringRef value = rest_of_line(args, line_end);
+      add_state_change(block, StateChange::Smooth, "", !ELEM(value, "off", "0", ""));
+    }
+    else if (keyword == "mtllib") {
+      add_state_change(block, StateChange::MtlLib, rest_of_line(args, line_end));
+    }
+    /* Comments, free-form geometry and other unsupported statements are ignored. */
+
+    p = line_end + 1;
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Merging Blocks
+ * \{ */
+
+OBJParser::OBJParser(const OBJImportParams &import_params) : import_params_(import_params)
+{
+}
+
+OBJParser::~OBJParser() = default;
+
+Geometry &OBJParser::ensure_geometry()
+{
+  if (current_geometry_ == nullptr) {
+    start_geometry(default_name_);
+  }
+  return *current_geometry_;
+}
+
+void OBJParser::start_geometry(const std::string &name)
+{
+  current_material_index_ = -1;
+  /* Reuse geometries without elements, e.g. for a group directly after an object statement. */
+  if (current_geometry_ && current_geometry_->is_empty()) {
+    current_geometry_->geometry_name = name;
+    current_geometry_->material_names.clear();
+    return;
+  }
+  geometries_.append(std::make_unique<Geometry>());
+  current_geometry_ = geometries_.last().get();
+  current_geometry_->geometry_name = name;
+}
+
+void OBJParser::apply_state_change(const StateChange &change)
+{
+  switch (change.type) {
+    case StateChange::Object:
+      if (import_params_.split_by_object) {
+        start_geometry(change.value.empty() ? default_name_ : change.value);
+      }
+      break;
+    case StateChange::Group:
+      if (import_params_.split_by_group) {
+        start_geometry(change.value);
+      }
+      break;
+    case StateChange::Material:
+      /* Exporters write this name to switch back to no material. */
+      current_material_ = (change.value == "(null)") ? "" : change.value;
+      current_material_index_ = -1;
+      break;
+    case StateChange::Smooth:
+      current_smooth_ = change.smooth;
+      break;
+    case StateChange::MtlLib: {
+      const char *p = change.value.c_str();
+      const char *end = p + change.value.size();
+      while ((p = skip_whitespace(p, end)) < end) {
+        const char *name_end = skip_token(p, end);
+        std::string name(p, name_end);
+        if (!mtl_libraries_.contains(name)) {
+          mtl_libraries_.append(std::move(name));
+        }
+        p = name_end;
+      }
+      break;
+    }
+  }
+}
+
+void OBJParser::merge_block(ParsedBlock &block)
+{
+  const int vert_offset = int(global_vertices_.vertices.size());
+  const int uv_offset = int(global_vertices_.uv_vertices.size());
+  const int normal_offset = int(global_vertices_.vertex_normals.size());
+  global_vertices_.vertices.extend(block.vertices);
+  global_vertices_.uv_vertices.extend(block.uv_vertices);
+  global_vertices_.vertex_normals.extend(block.vertex_normals);
+
+  for (const RelativeRef &ref : block.relative_refs) {
+    FaceCorner &corner = block.corners[ref.corner];
+    switch (ref.field) {
+      case RelativeRef::Vert:
+        corner.vert_index += vert_offset;
+        break;
+      case RelativeRef::UV:
+        corner.uv_index += uv_offset;
+        break;
+      case RelativeRef::Normal:
+        corner.normal_index += normal_offset;
+        break;
+    }
+  }
+
+  int64_t change_index = 0;
+  for (const int element_index : block.elements.index_range()) {
+    while (change_index < block.state_changes.size() &&
+           block.state_changes[change_index].element_index == element_index) {
+      apply_state_change(block.state_changes[change_index++]);
+    }
+
+    const BlockElement &element = block.elements[element_index];
+    const Span<FaceCorner> corners = block.corners.as_span().slice(element.corner_start,
+                                                                   element.corner_count);
+    if (element.is_edge && !import_params_.import_edges) {
+      continue;
+    }
+    Geometry &geometry = ensure_geometry();
+    if (element.is_edge) {
+      for (const int i : IndexRange(corners.size() - 1)) {
+        geometry.edge_verts.append(corners[i].vert_index);
+        geometry.edge_verts.append(corners[i + 1].vert_index);
+      }
+      continue;
+    }
+
+    if (current_material_index_ == -1 && !current_material_.empty()) {
+      current_material_index_ = int(geometry.material_names.index_of_or_add(current_material_));
+    }
+    geometry.face_elements.append({int(geometry.face_corners.size()),
+                                   element.corner_count,
+                                   current_material_index_,
+                                   current_smooth_});
+    for (const FaceCorner &corner : corners) {
+      geometry.has_uvs |= corner.uv_index != -1;
+      geometry.has_normals |= corner.normal_index != -1;
+    }
+    geometry.face_corners.extend(corners);
+  }
+  for (; change_index < block.state_changes.size(); change_index++) {
+    apply_state_change(block.state_changes[change_index]);
+  }
+}
+
+void OBJParser::parse_chunk(const StringRef text)
+{
+  /* Split into blocks at line endings. */
+  Vector<StringRef> block_texts;
+  int64_t start = 0;
+  while (start < text.size()) {
+    int64_t end = std::min(start + block_size, text.size());
+    if (end < text.size()) {
+      const void *line_end = memchr(text.data() + end, '\n', size_t(text.size() - end));
+      end = line_end ? static_cast<const char *>(line_end) - text.data() + 1 : text.size();
+    }
+    block_texts.append(text.substr(start, end - start));
+    start = end;
+  }
+
+  Array<ParsedBlock> blocks(block_texts.size());
+  parallel_for(block_texts.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      parse_block(block_texts[i], blocks[i]);
+    }
+  });
+
+  for (ParsedBlock &block : blocks) {
+    merge_block(block);
+  }
+}
+
+bool OBJParser::parse_file(const char *filepath)
+{
+  FILE *file = BLI_fopen(filepath, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+
+  char name[FILE_MAX];
+  BLI_strncpy(name, BLI_path_basename(filepath), sizeof(name));
+  BLI_path_extension_replace(name, sizeof(name), "");
+  default_name_ = name;
+
+  /* Statements that continue after the end of the buffer are moved to its start. */
+  Vector<char> buffer(chunk_size);
+  int64_t carry_size = 0;
+  bool success = true;
+  while (true) {
+    const size_t read_size = fread(
+        buffer.data() + carry_size, 1, size_t(buffer.size() - carry_size), file);
+    if (ferror(file)) {
+      success = false;
+      break;
+    }
+    const int64_t filled_size = carry_size + int64_t(read_size);
+    const bool is_last = int64_t(read_size) < buffer.size() - carry_size;
+
+    int64_t parse_size = filled_size;
+    if (!is_last) {
+      while (parse_size > 0 && buffer[parse_size - 1] != '\n') {
+        parse_size--;
+      }
+      if (parse_size == 0) {
+        /* A single line fills the whole buffer. */
+        carry_size = filled_size;
+        buffer.resize(buffer.size() * 2);
+        continue;
+      }
+    }
+
+    parse_chunk(StringRef(buffer.data(), parse_size));
+    if (is_last) {
+      break;
+    }
+    carry_size = filled_size - parse_size;
+    memmove(buffer.data(), buffer.data() + parse_size, size_t(carry_size));
+  }
+  fclose(file);
+  return success;
+}
+
+const GlobalVertices &OBJParser::global_vertices() const
+{
+  return global_vertices_;
+}
+
+Span<std::unique_ptr<Geometry>> OBJParser::geometries() const
+{
+  return geometries_;
+}
+
+Span<std::string> OBJParser::mtl_libraries() const
+{
+  return mtl_libraries_;
+}
+
+Vector<std::unique_ptr<Geometry>> OBJParser::take_geometries()
+{
+  Vector<std::unique_ptr<Geometry>> geometries;
+  for (std::unique_ptr<Geometry> &geometry : geometries_) {
+    if (!geometry->is_empty()) {
+      geometries.append(std::move(geometry));
+    }
+  }
+  if (geometries.is_empty() && !global_vertices_.vertices.is_empty()) {
+    geometries.append(std::make_unique<Geometry>());
+    geometries.last()->geometry_name = default_name_;
+    geometries.last()->use_all_vertices = true;
+  }
+  geometries_.clear();
+  current_geometry_ = nullptr;
+  return geometries;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name MTL Files
+ * \{ */
+
+static void parse_color(const char *p, const char *end, float3 &r_color)
+{
+  p = parse_float(p, end, r_color.x, r_color.x);
+  /* A single value is used for all channels. */
+  const char *next = parse_float(p, end, r_color.x, r_color.y);
+  parse_float(next, end, next == p ? r_color.x : r_color.y, r_color.z);
+}
+
+bool parse_mtl_file(const char *filepath, Vector<MTLMaterial> &r_materials)
+{
+  size_t size;
+  char *text = static_cast<char *>(BLI_file_read_text_as_mem(filepath, 0, &size));
+  if (text == nullptr) {
+    return false;
+  }
+
+  MTLMaterial *material = nullptr;
+  const char *p = text;
+  const char *text_end = text + size;
+  while (p < text_end) {
+    const char *line_end = static_cast<const char *>(memchr(p, '\n', size_t(text_end - p)));
+    if (line_end == nullptr) {
+      line_end = text_end;
+    }
+    const char *keyword_start = skip_whitespace(p, line_end);
+    const char *keyword_end = skip_token(keyword_start, line_end);
+    const StringRef keyword(keyword_start, keyword_end);
+
+    if (keyword == "newmtl") {
+      r_materials.append({});
+      material = &r_materials.last();
+      material->name = rest_of_line(keyword_end, line_end);
+    }
+    else if (material == nullptr) {
+      /* Statements before the first material are ignored. */
+    }
+    else if (keyword == "Ka") {
+      parse_color(keyword_end, line_end, material->Ka);
+    }
+    else if (keyword == "Kd") {
+      parse_color(keyword_end, line_end, material->Kd);
+    }
+    else if (keyword == "Ks") {
+      parse_color(keyword_end, line_end, material->Ks);
+    }
+    else if (keyword == "Ns") {
+      parse_float(keyword_end, line_end, material->Ns, material->Ns);
+    }
+    else if (keyword == "d") {
+      parse_float(keyword_end, line_end, material->d, material->d);
+    }
+    else if (keyword == "Tr") {
+      float transparency;
+      parse_float(keyword_end, line_end, 1.0f - material->d, transparency);
+      material->d = 1.0f - transparency;
+    }
+    p = line_end + 1;
+  }
+
+  MEM_freeN(text);
+  return true;
+}
+
+/** \} */
+
+}  // namespace blender::io::obj
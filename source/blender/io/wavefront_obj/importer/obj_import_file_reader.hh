@@ -0,0 +1,142 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "BLI_float2.hh"
+#include "BLI_float3.hh"
+#include "BLI_string_ref.hh"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+#include "IO_wavefront_obj.h"
+
+namespace blender::io::obj {
+
+/* Vertex positions, UV coordinates and normals of the whole file. The faces of all geometries
+ * index into these. */
+struct GlobalVertices {
+  Vector<float3> vertices;
+  Vector<float2> uv_vertices;
+  Vector<float3> vertex_normals;
+};
+
+/* Indices into #GlobalVertices, -1 when the corner has no UV coordinate or normal. */
+struct FaceCorner {
+  int vert_index;
+  int uv_index;
+  int normal_index;
+};
+
+struct FaceElem {
+  /* First corner in #Geometry::face_corners. */
+  int start;
+  int corner_count;
+  /* Index into #Geometry::material_names, -1 when no material was set. */
+  int material_index;
+  bool shaded_smooth;
+};
+
+/* Faces and edges that become one mesh object. */
+struct Geometry {
+  std::string geometry_name;
+  VectorSet<std::string> material_names;
+  Vector<FaceElem> face_elements;
+  Vector<FaceCorner> face_corners;
+  /* Pairs of vertex indices, from `l` statements. */
+  Vector<int> edge_verts;
+  bool has_uvs = false;
+  bool has_normals = false;
+  /* Use all vertices of the file, for files that only contain vertices. */
+  bool use_all_vertices = false;
+
+  bool is_empty() const
+  {
+    return face_elements.is_empty() && edge_verts.is_empty();
+  }
+};
+
+/* One part of a chunk of the file, parsed independently from the others. */
+struct ParsedBlock;
+struct StateChange;
+
+/**
+ * Reads OBJ files in chunks, each chunk is split into blocks of lines that are parsed in
+ * parallel. The blocks are then merged in file order, which resolves relative indices and assigns
+ * the faces to geometries.
+ */
+class OBJParser {
+ private:
+  const OBJImportParams &import_params_;
+  GlobalVertices global_vertices_;
+  Vector<std::unique_ptr<Geometry>> geometries_;
+  Vector<std::string> mtl_libraries_;
+  /* Name of geometries before the first object or group statement. */
+  std::string default_name_ = "OBJ";
+
+  /* State of the statements that apply to the following faces. */
+  Geometry *current_geometry_ = nullptr;
+  std::string current_material_;
+  int current_material_index_ = -1;
+  bool current_smooth_ = false;
+
+ public:
+  explicit OBJParser(const OBJImportParams &import_params);
+  ~OBJParser();
+
+  /* Parse the whole file, returns false when it cannot be read. */
+  bool parse_file(const char *filepath);
+  /**
+   * Parse the next part of the file. It must consist of whole lines, statements are not allowed
+   * to continue in the next part.
+   */
+  void parse_chunk(StringRef text);
+
+  const GlobalVertices &global_vertices() const;
+  Span<std::unique_ptr<Geometry>> geometries() const;
+  Span<std::string> mtl_libraries() const;
+
+  /* Give ownership of the geometries to the caller, empty geometries are skipped. */
+  Vector<std::unique_ptr<Geometry>> take_geometries();
+
+ private:
+  void merge_block(ParsedBlock &block);
+  void apply_state_change(const StateChange &change);
+  Geometry &ensure_geometry();
+  void start_geometry(const std::string &name);
+};
+
+/* Material settings from an MTL file. */
+struct MTLMaterial {
+  std::string name;
+  float3 Ka{0.0f};
+  float3 Kd{0.8f};
+  float3 Ks{0.5f};
+  float Ns = 250.0f;
+  float d = 1.0f;
+};
+
+/* Add the materials of an MTL file, returns false when it cannot be read. */
+bool parse_mtl_file(const char *filepath, Vector<MTLMaterial> &r_materials);
+
+}  // namespace blender::io::obj
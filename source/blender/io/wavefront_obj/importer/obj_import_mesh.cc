@@ -0,0 +1,190 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_vector.h"
+#include "BLI_task.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+
+#include "obj_import_mesh.hh"
+
+namespace blender::io::obj {
+
+Mesh *mesh_from_geometry(const Geometry &geometry,
+                         const GlobalVertices &global_vertices,
+                         const float4x4 &transform,
+                         const bool validate)
+{
+  const int global_verts_num = int(global_vertices.vertices.size());
+  const int global_uvs_num = int(global_vertices.uv_vertices.size());
+  const int global_normals_num = int(global_vertices.vertex_normals.size());
+  const Span<FaceCorner> corners = geometry.face_corners;
+  auto vert_is_valid = [&](const int index) { return index >= 0 && index < global_verts_num; };
+
+  /* Find the faces and edges that only use existing vertices, and the range of vertices they use
+   * so the compaction below does not need a map as large as the file. */
+  Vector<int> valid_faces;
+  Vector<int> valid_edges;
+  int vert_min = INT32_MAX;
+  int vert_max = -1;
+  int loops_num = 0;
+  for (const int face_index : geometry.face_elements.index_range()) {
+    const FaceElem &face = geometry.face_elements[face_index];
+    bool valid = true;
+    for (const FaceCorner &corner : corners.slice(face.start, face.corner_count)) {
+      valid &= vert_is_valid(corner.vert_index);
+    }
+    if (!valid) {
+      continue;
+    }
+    for (const FaceCorner &corner : corners.slice(face.start, face.corner_count)) {
+      vert_min = std::min(vert_min, corner.vert_index);
+      vert_max = std::max(vert_max, corner.vert_index);
+    }
+    valid_faces.append(face_index);
+    loops_num += face.corner_count;
+  }
+  for (int i = 0; i < geometry.edge_verts.size(); i += 2) {
+    const int v1 = geometry.edge_verts[i];
+    const int v2 = geometry.edge_verts[i + 1];
+    if (vert_is_valid(v1) && vert_is_valid(v2) && v1 != v2) {
+      vert_min = std::min({vert_min, v1, v2});
+      vert_max = std::max({vert_max, v1, v2});
+      valid_edges.append(i);
+    }
+  }
+  if (geometry.use_all_vertices && global_verts_num > 0) {
+    vert_min = 0;
+    vert_max = global_verts_num - 1;
+  }
+
+  /* Number the used vertices in file order. */
+  Array<int> local_vert_index(std::max(vert_max - vert_min + 1, 0), -1);
+  if (geometry.use_all_vertices) {
+    for (const int i : local_vert_index.index_range()) {
+      local_vert_index[i] = int(i);
+    }
+  }
+  else {
+    for (const int face_index : valid_faces) {
+      const FaceElem &face = geometry.face_elements[face_index];
+      for (const FaceCorner &corner : corners.slice(face.start, face.corner_count)) {
+        local_vert_index[corner.vert_index - vert_min] = 0;
+      }
+    }
+    for (const int i : valid_edges) {
+      local_vert_index[geometry.edge_verts[i] - vert_min] = 0;
+      local_vert_index[geometry.edge_verts[i + 1] - vert_min] = 0;
+    }
+  }
+  Vector<int> global_vert_index;
+  for (const int i : local_vert_index.index_range()) {
+    if (local_vert_index[i] != -1) {
+      local_vert_index[i] = int(global_vert_index.size());
+      global_vert_index.append(vert_min + int(i));
+    }
+  }
+
+  Mesh *mesh = BKE_mesh_new_nomain(int(global_vert_index.size()),
+                                   int(valid_edges.size()),
+                                   0,
+                                   loops_num,
+                                   int(valid_faces.size()));
+
+  parallel_for(global_vert_index.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const float3 co = transform * global_vertices.vertices[global_vert_index[i]];
+      copy_v3_v3(mesh->mvert[i].co, co);
+    }
+  });
+
+  for (const int i : valid_edges.index_range()) {
+    MEdge &edge = mesh->medge[i];
+    edge.v1 = uint(local_vert_index[geometry.edge_verts[valid_edges[i]] - vert_min]);
+    edge.v2 = uint(local_vert_index[geometry.edge_verts[valid_edges[i] + 1] - vert_min]);
+    edge.flag = ME_EDGEDRAW | ME_EDGERENDER | ME_LOOSEEDGE;
+  }
+
+  Array<int> loop_starts(valid_faces.size());
+  int loop_start = 0;
+  for (const int i : valid_faces.index_range()) {
+    loop_starts[i] = loop_start;
+    loop_start += geometry.face_elements[valid_faces[i]].corner_count;
+  }
+
+  MLoopUV *mloopuv = nullptr;
+  if (geometry.has_uvs) {
+    mloopuv = static_cast<MLoopUV *>(CustomData_add_layer_named(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, loops_num, "UVMap"));
+  }
+  float(*loop_normals)[3] = nullptr;
+  if (geometry.has_normals) {
+    loop_normals = static_cast<float(*)[3]>(
+        MEM_calloc_arrayN(size_t(loops_num), sizeof(float[3]), __func__));
+  }
+  parallel_for(valid_faces.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const FaceElem &face = geometry.face_elements[valid_faces[i]];
+      MPoly &poly = mesh->mpoly[i];
+      poly.loopstart = loop_starts[i];
+      poly.totloop = face.corner_count;
+      poly.mat_nr = short(std::max(face.material_index, 0));
+      poly.flag = face.shaded_smooth ? ME_SMOOTH : 0;
+      for (const int j : IndexRange(face.corner_count)) {
+        const FaceCorner &corner = corners[face.start + j];
+        const int loop_index = loop_starts[i] + j;
+        mesh->mloop[loop_index].v = uint(local_vert_index[corner.vert_index - vert_min]);
+        if (mloopuv && corner.uv_index >= 0 && corner.uv_index < global_uvs_num) {
+          copy_v2_v2(mloopuv[loop_index].uv, global_vertices.uv_vertices[corner.uv_index]);
+        }
+        /* Zero normals are replaced by the automatic ones. */
+        if (loop_normals && corner.normal_index >= 0 && corner.normal_index < global_normals_num) {
+          const float3 normal = transform.ref_3x3() *
+                                global_vertices.vertex_normals[corner.normal_index];
+          normalize_v3_v3(loop_normals[loop_index], normal);
+        }
+      }
+    }
+  });
+
+  BKE_mesh_calc_edges(mesh, true, false);
+  if (validate) {
+    BKE_mesh_validate(mesh, false, false);
+  }
+  BKE_mesh_calc_normals(mesh);
+  if (loop_normals) {
+    /* Validation may have removed loops, the normals would not match them anymore. */
+    if (mesh->totloop == loops_num) {
+      mesh->flag |= ME_AUTOSMOOTH;
+      BKE_mesh_set_custom_normals(mesh, loop_normals);
+    }
+    MEM_freeN(loop_normals);
+  }
+  return mesh;
+}
+
+}  // namespace blender::io::obj
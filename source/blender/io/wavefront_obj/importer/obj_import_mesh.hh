@@ -0,0 +1,41 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#pragma once
+
+#include "BLI_float4x4.hh"
+
+#include "obj_import_file_reader.hh"
+
+struct Mesh;
+
+namespace blender::io::obj {
+
+/**
+ * Create a mesh outside of #Main from the faces and edges of a geometry, only containing the
+ * vertices it uses. Positions are transformed by \a transform, normals only by its rotation.
+ * Faces with invalid vertex indices are skipped. Can run in parallel for different geometries.
+ */
+Mesh *mesh_from_geometry(const Geometry &geometry,
+                         const GlobalVertices &global_vertices,
+                         const float4x4 &transform,
+                         bool validate);
+
+}  // namespace blender::io::obj
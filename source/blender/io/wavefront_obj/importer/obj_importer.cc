@@ -0,0 +1,204 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup obj
+ */
+
+#include <string>
+
+#include "BKE_collection.h"
+#include "BKE_context.h"
+#include "BKE_customdata.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_material.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+#include "BLI_math.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.hh"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "DNA_collection_types.h"
+#include "DNA_material_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "WM_api.h"
+#include "WM_types.h"
+
+#include "obj_import_file_reader.hh"
+#include "obj_import_mesh.hh"
+#include "obj_importer.hh"
+
+namespace blender::io::obj {
+
+/* Conversion from the axes of the file to Blender's, scaled down by powers of ten until the
+ * vertices fit in the clamp size. */
+static float4x4 import_transform(const OBJImportParams &import_params,
+                                 const GlobalVertices &global_vertices)
+{
+  float axis_mat[3][3];
+  mat3_from_axis_conversion(
+      OB_POSY, OB_POSZ, import_params.forward_axis, import_params.up_axis, axis_mat);
+
+  float scale = 1.0f;
+  if (import_params.clamp_size > 0.0f && !global_vertices.vertices.is_empty()) {
+    float3 min(FLT_MAX), max(-FLT_MAX);
+    for (const float3 &co : global_vertices.vertices) {
+      minmax_v3v3_v3(min, max, co);
+    }
+    const float3 size = max - min;
+    const float size_max = std::max({size.x, size.y, size.z});
+    while (import_params.clamp_size < size_max * scale) {
+      scale /= 10.0f;
+    }
+  }
+
+  float4x4 transform;
+  unit_m4(transform.values);
+  copy_m4_m3(transform.values, axis_mat);
+  mul_mat3_m4_fl(transform.values, scale);
+  return transform;
+}
+
+/* Create the materials of the MTL files, keyed by their names in the file. */
+static Map<std::string, Material *> create_materials(Main *bmain,
+                                                     const char *obj_filepath,
+                                                     Span<std::string> mtl_libraries,
+                                                     Span<std::unique_ptr<Geometry>> geometries)
+{
+  char dir[FILE_MAX];
+  BLI_split_dir_part(obj_filepath, dir, sizeof(dir));
+
+  Vector<MTLMaterial> mtl_materials;
+  for (const std::string &mtl_library : mtl_libraries) {
+    char mtl_filepath[FILE_MAX];
+    BLI_join_dirfile(mtl_filepath, sizeof(mtl_filepath), dir, mtl_library.c_str());
+    if (!parse_mtl_file(mtl_filepath, mtl_materials)) {
+      fprintf(stderr, "OBJ import: cannot read material library '%s'\n", mtl_filepath);
+    }
+  }
+
+  /* Materials of the MTL files, the inverse of how the exporter writes them. */
+  Map<std::string, Material *> materials;
+  for (const MTLMaterial &mtl_material : mtl_materials) {
+    if (materials.contains(mtl_material.name)) {
+      continue;
+    }
+    Material *material = BKE_material_add(bmain, mtl_material.name.c_str());
+    copy_v3_v3(&material->r, mtl_material.Kd);
+    material->a = clamp_f(mtl_material.d, 0.0f, 1.0f);
+    material->metallic = clamp_f(mtl_material.Ka.x, 0.0f, 1.0f);
+    material->roughness = clamp_f(
+        1.0f - sqrtf(max_ff(mtl_material.Ns, 0.0f) / 1000.0f), 0.0f, 1.0f);
+    material->spec = max_fff(mtl_material.Ks.x, mtl_material.Ks.y, mtl_material.Ks.z);
+    if (material->spec > 0.0f) {
+      mul_v3_v3fl(&material->specr, mtl_material.Ks, 1.0f / material->spec);
+    }
+    if (material->a < 1.0f) {
+      material->blend_method = MA_BM_BLEND;
+    }
+    /* The name is only used to find the material, the mesh users add their own. */
+    id_us_min(&material->id);
+    materials.add_new(mtl_material.name, material);
+  }
+
+  /* Materials that are used but not defined get default settings. */
+  for (const std::unique_ptr<Geometry> &geometry : geometries) {
+    for (const std::string &name : geometry->material_names) {
+      materials.lookup_or_add_cb(name, [&]() {
+        Material *material = BKE_material_add(bmain, name.c_str());
+        id_us_min(&material->id);
+        return material;
+      });
+    }
+  }
+  return materials;
+}
+
+bool importer_main(bContext *C, const OBJImportParams &import_params)
+{
+  Main *bmain = CTX_data_main(C);
+  Scene *scene = CTX_data_scene(C);
+  ViewLayer *view_layer = CTX_data_view_layer(C);
+
+  OBJParser parser(import_params);
+  if (!parser.parse_file(import_params.filepath)) {
+    WM_reportf(RPT_ERROR, "OBJ import: cannot read '%s'", import_params.filepath);
+    return false;
+  }
+  const GlobalVertices &global_vertices = parser.global_vertices();
+  const Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  const Map<std::string, Material *> materials = create_materials(
+      bmain, import_params.filepath, parser.mtl_libraries(), geometries);
+
+  /* Building the meshes does not touch #Main, so it runs in parallel. */
+  const float4x4 transform = import_transform(import_params, global_vertices);
+  Array<Mesh *> meshes(geometries.size());
+  parallel_for(geometries.index_range(), 1, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      meshes[i] = mesh_from_geometry(
+          *geometries[i], global_vertices, transform, import_params.validate_meshes);
+    }
+  });
+
+  BKE_view_layer_base_deselect_all(view_layer);
+  LayerCollection *lc = BKE_layer_collection_get_active(view_layer);
+
+  for (const int64_t i : geometries.index_range()) {
+    const Geometry &geometry = *geometries[i];
+    const char *name = geometry.geometry_name.c_str();
+    Mesh *mesh = BKE_mesh_add(bmain, name);
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+    ob->data = mesh;
+
+    /* Custom normals are only used with auto smooth, the flag is taken from the target mesh. */
+    if (meshes[i]->flag & ME_AUTOSMOOTH) {
+      mesh->flag |= ME_AUTOSMOOTH;
+    }
+    BKE_mesh_nomain_to_mesh(meshes[i], mesh, ob, &CD_MASK_MESH, true);
+
+    for (const int material_index : IndexRange(geometry.material_names.size())) {
+      Material *material = materials.lookup(geometry.material_names[material_index]);
+      BKE_object_material_assign(
+          bmain, ob, material, material_index + 1, BKE_MAT_ASSIGN_USERPREF);
+    }
+
+    BKE_collection_object_add(bmain, lc->collection, ob);
+    Base *base = BKE_view_layer_base_find(view_layer, ob);
+    BKE_view_layer_base_select_and_set_active(view_layer, base);
+
+    DEG_id_tag_update(&lc->collection->id, ID_RECALC_COPY_ON_WRITE);
+    DEG_id_tag_update_ex(
+        bmain, &ob->id, ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY | ID_RECALC_BASE_FLAGS);
+  }
+
+  DEG_id_tag_update(&scene->id, ID_RECALC_BASE_FLAGS);
+  DEG_relations_tag_update(bmain);
+  return true;
+}
+
+}  // namespace blender::io::obj
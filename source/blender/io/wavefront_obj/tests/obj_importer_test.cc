@@ -0,0 +1,227 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+#include "testing/testing.h"
+
+#include <string>
+
+#include "importer/obj_import_file_reader.hh"
+
+namespace blender::io::obj::tests {
+
+class OBJParserTest : public testing::Test {
+ protected:
+  OBJImportParams params_ = {};
+
+  void SetUp() override
+  {
+    params_.split_by_object = true;
+    params_.import_edges = true;
+  }
+};
+
+TEST_F(OBJParserTest, faces)
+{
+  OBJParser parser(params_);
+  parser.parse_chunk(
+      "# Comment\n"
+      "v 1 2 3\n"
+      "v -1.5 .5 2e2\n"
+      "v 1E-2 +4 -0.25\r\n"
+      "vt 0.5 0.25\n"
+      "vn 0 0 1\n"
+      "f 1/1/1 2/1/1 3/1/1\n"
+      "f 3 2 1\n");
+
+  const GlobalVertices &global_vertices = parser.global_vertices();
+  ASSERT_EQ(global_vertices.vertices.size(), 3);
+  EXPECT_V3_NEAR(global_vertices.vertices[0], float3(1, 2, 3), 1e-6f);
+  EXPECT_V3_NEAR(global_vertices.vertices[1], float3(-1.5f, 0.5f, 200.0f), 1e-6f);
+  EXPECT_V3_NEAR(global_vertices.vertices[2], float3(0.01f, 4.0f, -0.25f), 1e-6f);
+  ASSERT_EQ(global_vertices.uv_vertices.size(), 1);
+  EXPECT_V2_NEAR(global_vertices.uv_vertices[0], float2(0.5f, 0.25f), 1e-6f);
+  ASSERT_EQ(global_vertices.vertex_normals.size(), 1);
+
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 1);
+  const Geometry &geometry = *geometries[0];
+  EXPECT_TRUE(geometry.has_uvs);
+  EXPECT_TRUE(geometry.has_normals);
+  ASSERT_EQ(geometry.face_elements.size(), 2);
+  ASSERT_EQ(geometry.face_corners.size(), 6);
+  EXPECT_EQ(geometry.face_corners[1].vert_index, 1);
+  EXPECT_EQ(geometry.face_corners[1].uv_index, 0);
+  EXPECT_EQ(geometry.face_corners[1].normal_index, 0);
+  EXPECT_EQ(geometry.face_corners[3].vert_index, 2);
+  EXPECT_EQ(geometry.face_corners[3].uv_index, -1);
+  EXPECT_EQ(geometry.face_corners[3].normal_index, -1);
+}
+
+TEST_F(OBJParserTest, invalid_faces)
+{
+  OBJParser parser(params_);
+  parser.parse_chunk(
+      "v 0 0 0\n"
+      "v 1 0 0\n"
+      "v 1 1 0\n"
+      "f 1 2\n"
+      "f 1 0 3\n"
+      "f 1 2 x\n"
+      "f 1//1 2//1 3//1\n");
+
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 1);
+  EXPECT_EQ(geometries[0]->face_elements.size(), 1);
+  EXPECT_FALSE(geometries[0]->has_uvs);
+  EXPECT_TRUE(geometries[0]->has_normals);
+}
+
+TEST_F(OBJParserTest, objects_materials_smooth)
+{
+  OBJParser parser(params_);
+  parser.parse_chunk(
+      "mtllib a.mtl b.mtl\n"
+      "v 0 0 0\n"
+      "v 1 0 0\n"
+      "v 1 1 0\n"
+      "v 0 1 0\n"
+      "o First\n"
+      "usemtl Red\n"
+      "s 1\n"
+      "f 1 2 3\n"
+      "usemtl Blue\n"
+      "s off\n"
+      "f 1 3 4\n"
+      "o Second\n"
+      "g Ignored\n"
+      "f 2 3 4\n"
+      "l 1 2 3\n");
+
+  EXPECT_EQ(parser.mtl_libraries().size(), 2);
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 2);
+
+  const Geometry &first = *geometries[0];
+  EXPECT_EQ(first.geometry_name, "First");
+  ASSERT_EQ(first.material_names.size(), 2);
+  EXPECT_EQ(first.material_names[0], "Red");
+  ASSERT_EQ(first.face_elements.size(), 2);
+  EXPECT_EQ(first.face_elements[0].material_index, 0);
+  EXPECT_TRUE(first.face_elements[0].shaded_smooth);
+  EXPECT_EQ(first.face_elements[1].material_index, 1);
+  EXPECT_FALSE(first.face_elements[1].shaded_smooth);
+
+  /* The material and smooth state continue in the next object. */
+  const Geometry &second = *geometries[1];
+  EXPECT_EQ(second.geometry_name, "Second");
+  ASSERT_EQ(second.material_names.size(), 1);
+  EXPECT_EQ(second.material_names[0], "Blue");
+  EXPECT_EQ(second.face_elements[0].material_index, 0);
+  EXPECT_EQ(second.edge_verts.size(), 4);
+}
+
+TEST_F(OBJParserTest, null_material)
+{
+  OBJParser parser(params_);
+  parser.parse_chunk(
+      "v 0 0 0\n"
+      "v 1 0 0\n"
+      "v 1 1 0\n"
+      "o Mesh\n"
+      "usemtl Red\n"
+      "f 1 2 3\n"
+      "usemtl (null)\n"
+      "f 1 3 2\n");
+
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 1);
+  const Geometry &geometry = *geometries[0];
+  ASSERT_EQ(geometry.material_names.size(), 1);
+  EXPECT_EQ(geometry.material_names[0], "Red");
+  ASSERT_EQ(geometry.face_elements.size(), 2);
+  EXPECT_EQ(geometry.face_elements[0].material_index, 0);
+  EXPECT_EQ(geometry.face_elements[1].material_index, -1);
+}
+
+TEST_F(OBJParserTest, split_by_group)
+{
+  params_.split_by_object = false;
+  params_.split_by_group = true;
+  OBJParser parser(params_);
+  parser.parse_chunk(
+      "v 0 0 0\n"
+      "v 1 0 0\n"
+      "v 1 1 0\n"
+      "o Ignored\n"
+      "g A\n"
+      "f 1 2 3\n"
+      "g B\n"
+      "f 1 2 3\n");
+
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 2);
+  EXPECT_EQ(geometries[0]->geometry_name, "A");
+  EXPECT_EQ(geometries[1]->geometry_name, "B");
+}
+
+TEST_F(OBJParserTest, only_vertices)
+{
+  OBJParser parser(params_);
+  parser.parse_chunk("v 0 0 0\nv 1 0 0\n");
+
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 1);
+  EXPECT_TRUE(geometries[0]->use_all_vertices);
+}
+
+/* Relative indices and statements across chunks and the blocks that are parsed in parallel. */
+TEST_F(OBJParserTest, relative_indices_in_many_blocks)
+{
+  const int quads_num = 100000;
+  std::string first_chunk, second_chunk;
+  for (int i = 0; i < quads_num; i++) {
+    std::string &text = i < quads_num / 2 ? first_chunk : second_chunk;
+    for (int j = 0; j < 4; j++) {
+      text += "v " + std::to_string(i) + " " + std::to_string(j) + " 0\n";
+    }
+    if (i == quads_num / 4) {
+      text += "usemtl Material\n";
+    }
+    text += "f -4 -3 -2 -1\n";
+  }
+
+  OBJParser parser(params_);
+  parser.parse_chunk(first_chunk);
+  parser.parse_chunk(second_chunk);
+
+  EXPECT_EQ(parser.global_vertices().vertices.size(), quads_num * 4);
+  Vector<std::unique_ptr<Geometry>> geometries = parser.take_geometries();
+  ASSERT_EQ(geometries.size(), 1);
+  const Geometry &geometry = *geometries[0];
+  ASSERT_EQ(geometry.face_elements.size(), quads_num);
+  for (const int i : IndexRange(quads_num)) {
+    const FaceElem &face = geometry.face_elements[i];
+    EXPECT_EQ(face.corner_count, 4);
+    EXPECT_EQ(face.material_index, i >= quads_num / 4 ? 0 : -1);
+    for (const int j : IndexRange(4)) {
+      EXPECT_EQ(geometry.face_corners[face.start + j].vert_index, i * 4 + j);
+    }
+  }
+}
+
+}  // namespace blender::io::obj::tests
@@ -35,6 +35,8 @@
     .is_sequence = false, \
     .scale = 1.0f, \
     .object_paths ={NULL, NULL}, \
+    .use_prefetch = 1, \
+    .prefetch_cache_size = 1024, \
  \
     .handle = NULL, \
     .handle_filepath[0] = '\0', \
@@ -84,12 +84,18 @@ typedef struct CacheFile {
   short flag;
   short draw_flag; /* UNUSED */
 
-  char _pad[3];
+  /** Decode upcoming mesh samples on worker threads during playback. */
+  char use_prefetch;
+  char _pad[2];
 
   char velocity_unit;
   /* Name of the velocity property in the Alembic file. */
   char velocity_name[64];
 
+  /** Memory limit of the decoded samples of all meshes, in megabytes. */
+  int prefetch_cache_size;
+  char _pad1[4];
+
   /* Runtime */
   struct AbcArchiveHandle *handle;
   char handle_filepath[1024];
@@ -21,6 +21,8 @@
  * \ingroup RNA
  */
 
+#include <limits.h>
+
 #include "DNA_cachefile_types.h"
 #include "DNA_scene_types.h"
 
@@ -200,6 +202,24 @@ static void rna_def_cachefile(BlenderRNA *brna)
   RNA_def_property_update(prop, 0, "rna_CacheFile_update");
   RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
 
+  prop = RNA_def_property(srna, "use_prefetch", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(
+      prop,
+      "Use Prefetch",
+      "Decode upcoming frames of animated meshes on worker threads during playback");
+  RNA_def_property_update(prop, 0, "rna_CacheFile_update");
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+
+  prop = RNA_def_property(srna, "prefetch_cache_size", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_range(prop, 0, INT_MAX);
+  RNA_def_property_ui_range(prop, 64, 16384, 64, -1);
+  RNA_def_property_ui_text(
+      prop,
+      "Prefetch Cache Size",
+      "Memory usage limit in megabytes for the decoded frames of all animated meshes");
+  RNA_def_property_update(prop, 0, "rna_CacheFile_update");
+  RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+
   RNA_define_lib_overridable(false);
 
   rna_def_cachefile_object_paths(brna, prop);
@@ -92,6 +92,10 @@ static const EnumPropertyItem space_items[] = {
 
 #  include "MEM_guardedalloc.h"
 
+#  ifdef WITH_PYTHON
+#    include "BPY_extern.h"
+#  endif
+
 static void rna_Object_select_set(
     Object *ob, bContext *C, ReportList *reports, bool select, ViewLayer *view_layer)
 {
@@ -396,7 +400,20 @@ static Mesh *rna_Object_to_mesh(Object *object,
       return NULL;
   }
 
-  return BKE_object_to_mesh(depsgraph, object, preserve_all_data_layers);
+  Mesh *mesh;
+
+#  ifdef WITH_PYTHON
+  /* The new mesh is not reachable from Python until it's returned. */
+  BPy_BEGIN_ALLOW_THREADS;
+#  endif
+
+  mesh = BKE_object_to_mesh(depsgraph, object, preserve_all_data_layers);
+
+#  ifdef WITH_PYTHON
+  BPy_END_ALLOW_THREADS;
+#  endif
+
+  return mesh;
 }
 
 static void rna_Object_to_mesh_clear(Object *object)
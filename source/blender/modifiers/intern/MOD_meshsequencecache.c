@@ -156,6 +156,9 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
     }
   }
 
+  ABC_mesh_prefetch_set(mcmd->reader,
+                        cache_file->use_prefetch ? cache_file->prefetch_cache_size : 0);
+
   Mesh *result = ABC_read_mesh(mcmd->reader, ctx->object, mesh, time, &err_str, mcmd->read_flag);
 
   mcmd->velocity_delta = 1.0f;
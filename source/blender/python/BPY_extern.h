@@ -58,7 +58,18 @@ typedef void *BPy_ThreadStatePtr;
 BPy_ThreadStatePtr BPY_thread_save(void);
 void BPY_thread_restore(BPy_ThreadStatePtr tstate);
 
-/* our own wrappers to Py_BEGIN_ALLOW_THREADS/Py_END_ALLOW_THREADS */
+/**
+ * Our own wrappers to Py_BEGIN_ALLOW_THREADS/Py_END_ALLOW_THREADS.
+ *
+ * Used by API functions doing long running work (evaluating the depsgraph, reading and writing
+ * files...) so other Python threads can run meanwhile. Threading contract:
+ * - Between the two macros no Python objects may be accessed,
+ *   convert arguments before and create return values after.
+ * - Code called in between may run Python (drivers, handlers, registered classes),
+ *   it must acquire the GIL with #PyGILState_Ensure, as #bpy_context_set does.
+ * - Blender data is not locked, Python threads running meanwhile must not access `bpy`
+ *   until the call returns, only pure Python work (I/O, bookkeeping...) is supported.
+ */
 #define BPy_BEGIN_ALLOW_THREADS \
   { \
     BPy_ThreadStatePtr _bpy_saved_tstate = BPY_thread_save(); \
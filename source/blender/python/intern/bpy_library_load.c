@@ -46,6 +46,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BPY_extern.h"
+
 #include "bpy_capi_utils.h"
 #include "bpy_library.h"
 
@@ -258,7 +260,10 @@ static PyObject *bpy_lib_enter(BPy_Library *self)
 
   BKE_reports_init(&reports, RPT_STORE);
 
+  /* Reading (and decompressing) the file doesn't involve any Python data. */
+  BPy_BEGIN_ALLOW_THREADS;
   self->blo_handle = BLO_blendhandle_from_file(self->abspath, &reports);
+  BPy_END_ALLOW_THREADS;
 
   if (self->blo_handle == NULL) {
     if (BPy_reports_to_error(&reports, PyExc_IOError, true) != -1) {
@@ -426,12 +431,17 @@ static PyObject *bpy_lib_exit(BPy_Library *self, PyObject *UNUSED(args))
   }
 
   Library *lib = mainl->curlib; /* newly added lib, assign before append end */
+  GHash *old_to_new_ids = BLI_ghash_ptr_new(__func__);
+
+  /* Reading the linked data-blocks and making them local is where most of the time is spent,
+   * the names have been resolved above so Python data isn't needed until the capsules are
+   * swapped below. */
+  BPy_BEGIN_ALLOW_THREADS;
+
   BLO_library_link_end(mainl, &(self->blo_handle), &liblink_params);
   BLO_blendhandle_close(self->blo_handle);
   self->blo_handle = NULL;
 
-  GHash *old_to_new_ids = BLI_ghash_ptr_new(__func__);
-
   /* copied from wm_operator.c */
   {
     /* mark all library linked objects to be updated */
@@ -445,6 +455,8 @@ static PyObject *bpy_lib_exit(BPy_Library *self, PyObject *UNUSED(args))
 
   BKE_main_id_tag_all(bmain, LIB_TAG_PRE_EXISTING, false);
 
+  BPy_END_ALLOW_THREADS;
+
   /* finally swap the capsules for real bpy objects
    * important since BLO_library_append_end initializes NodeTree types used by srna->refine */
 #ifdef USE_RNA_DATABLOCKS
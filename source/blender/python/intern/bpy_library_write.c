@@ -37,6 +37,8 @@
 
 #include "BLO_writefile.h"
 
+#include "BPY_extern.h"
+
 #include "RNA_types.h"
 
 #include "bpy_capi_utils.h"
@@ -175,8 +177,12 @@ static PyObject *bpy_lib_write(BPy_PropertyRNA *self, PyObject *args, PyObject *
   ReportList reports;
 
   BKE_reports_init(&reports, RPT_STORE);
+
+  /* Only touches the tagged data-blocks and the file, see #BPy_BEGIN_ALLOW_THREADS. */
+  BPy_BEGIN_ALLOW_THREADS;
   retval = BKE_blendfile_write_partial(
       bmain_src, filepath_abs, write_flags, path_remap.value_found, &reports);
+  BPy_END_ALLOW_THREADS;
 
   /* cleanup state */
   BKE_blendfile_write_partial_end(bmain_src);
@@ -5456,6 +5456,244 @@ static PyObject *pyrna_prop_collection_foreach_set(BPy_PropertyRNA *self, PyObje
   return foreach_getset(self, args, 1);
 }
 
+/* --- collection view: start --- */
+/* Exposes the memory of a raw collection array through the buffer protocol.
+ * The array is looked up again for every buffer request, so reallocated data
+ * is picked up by new buffers. */
+
+static const char *foreach_view_format(RawPropertyType raw_type, bool attr_signed)
+{
+  switch (raw_type) {
+    case PROP_RAW_CHAR:
+      return attr_signed ? "b" : "B";
+    case PROP_RAW_SHORT:
+      return attr_signed ? "h" : "H";
+    case PROP_RAW_INT:
+      return attr_signed ? "i" : "I";
+    case PROP_RAW_BOOLEAN:
+      return "?";
+    case PROP_RAW_FLOAT:
+      return "f";
+    case PROP_RAW_DOUBLE:
+      return "d";
+    case PROP_RAW_UNSET:
+      break;
+  }
+  return NULL;
+}
+
+static int pyrna_prop_collection_view_getbuffer(BPy_PropertyCollectionViewRNA *self,
+                                                Py_buffer *view,
+                                                int flags)
+{
+  BPy_PropertyRNA *collection = self->collection;
+  RawArray raw;
+
+  view->obj = NULL;
+
+  PYRNA_PROP_CHECK_INT(collection);
+
+  if (!RNA_property_collection_raw_array(
+          &collection->ptr, collection->prop, self->itemprop, &raw)) {
+    PyErr_Format(PyExc_BufferError,
+                 "'%.200s.%.200s[...]' is not stored as an editable array",
+                 RNA_struct_identifier(collection->ptr.type),
+                 RNA_property_identifier(collection->prop));
+    return -1;
+  }
+
+  if (raw.len == 0) {
+    /* The raw type is only known from an item, use the closest match for empty collections. */
+    switch (RNA_property_type(self->itemprop)) {
+      case PROP_FLOAT:
+        raw.type = PROP_RAW_FLOAT;
+        break;
+      case PROP_BOOLEAN:
+        raw.type = PROP_RAW_BOOLEAN;
+        break;
+      default:
+        raw.type = PROP_RAW_INT;
+        break;
+    }
+  }
+
+  const bool attr_signed = (RNA_property_subtype(self->itemprop) != PROP_UNSIGNED);
+  const char *format = foreach_view_format(raw.type, attr_signed);
+  if (format == NULL) {
+    PyErr_SetString(PyExc_BufferError, "unsupported property type");
+    return -1;
+  }
+
+  const int itemsize = RNA_raw_type_sizeof(raw.type);
+  const int values_per_item = MAX2(self->attr_tot, 1);
+  /* Values of an item are always adjacent, items may be interleaved with other data
+   * (e.g. the 12 bytes of `MeshVertex.co` in a stride of 20). */
+  const bool is_c_contiguous = (raw.len <= 1) || (raw.stride == itemsize * values_per_item);
+  const bool is_f_contiguous = is_c_contiguous && (raw.len <= 1 || self->attr_tot <= 1);
+
+  if (!(flags & PyBUF_STRIDES) && !is_c_contiguous) {
+    PyErr_SetString(PyExc_BufferError,
+                    "values are interleaved with other data, strides must be requested");
+    return -1;
+  }
+  if ((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS && !is_c_contiguous) {
+    PyErr_SetString(PyExc_BufferError,
+                    "values are interleaved with other data, not C-contiguous");
+    return -1;
+  }
+  if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && !is_f_contiguous) {
+    PyErr_SetString(PyExc_BufferError, "values are not Fortran contiguous");
+    return -1;
+  }
+  if ((flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS && !is_c_contiguous) {
+    PyErr_SetString(PyExc_BufferError, "values are interleaved with other data, not contiguous");
+    return -1;
+  }
+
+  /* Shape followed by the strides, freed when the buffer is released. */
+  Py_ssize_t *shape = PyMem_Malloc(sizeof(*shape) * 4);
+  Py_ssize_t *strides = shape + 2;
+  shape[0] = raw.len;
+  shape[1] = self->attr_tot;
+  strides[0] = raw.stride;
+  strides[1] = itemsize;
+
+  /* Empty collections have no array, buffers still need valid memory. */
+  static char empty_buf[1];
+
+  view->buf = raw.array ? raw.array : empty_buf;
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->len = (Py_ssize_t)raw.len * values_per_item * itemsize;
+  view->readonly = 0;
+  view->itemsize = itemsize;
+  view->format = (flags & PyBUF_FORMAT) ? (char *)format : NULL;
+  view->ndim = (self->attr_tot != 0) ? 2 : 1;
+  view->shape = (flags & PyBUF_ND) ? shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) ? strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = shape;
+
+  return 0;
+}
+
+static void pyrna_prop_collection_view_releasebuffer(BPy_PropertyCollectionViewRNA *UNUSED(self),
+                                                     Py_buffer *view)
+{
+  PyMem_Free(view->internal);
+}
+
+static PyBufferProcs pyrna_prop_collection_view_as_buffer = {
+    (getbufferproc)pyrna_prop_collection_view_getbuffer,
+    (releasebufferproc)pyrna_prop_collection_view_releasebuffer,
+};
+
+PyDoc_STRVAR(pyrna_prop_collection_view_update_doc,
+             ".. method:: update()\n"
+             "\n"
+             "   Notify Blender that values were changed through the view,\n"
+             "   running the update of the viewed property.\n");
+static PyObject *pyrna_prop_collection_view_update(BPy_PropertyCollectionViewRNA *self)
+{
+  BPy_PropertyRNA *collection = self->collection;
+  PointerRNA itemptr;
+
+  PYRNA_PROP_CHECK_OBJ(collection);
+
+  /* Updates act on the owner ID, running it for the first item is enough. */
+  if (RNA_property_collection_lookup_int(&collection->ptr, collection->prop, 0, &itemptr)) {
+    RNA_property_update(BPY_context_get(), &itemptr, self->itemprop);
+  }
+
+  Py_RETURN_NONE;
+}
+
+static struct PyMethodDef pyrna_prop_collection_view_methods[] = {
+    {"update",
+     (PyCFunction)pyrna_prop_collection_view_update,
+     METH_NOARGS,
+     pyrna_prop_collection_view_update_doc},
+    {NULL, NULL, 0, NULL},
+};
+
+static void pyrna_prop_collection_view_dealloc(BPy_PropertyCollectionViewRNA *self)
+{
+  Py_DECREF(self->collection);
+  PyObject_DEL(self);
+}
+
+static PyTypeObject pyrna_prop_collection_view_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "bpy_prop_collection_view",
+    .tp_basicsize = sizeof(BPy_PropertyCollectionViewRNA),
+    .tp_dealloc = (destructor)pyrna_prop_collection_view_dealloc,
+    .tp_as_buffer = &pyrna_prop_collection_view_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_methods = pyrna_prop_collection_view_methods,
+};
+
+PyDoc_STRVAR(
+    pyrna_prop_collection_foreach_view_doc,
+    ".. method:: foreach_view(attr)\n"
+    "\n"
+    "   Return a view of an attribute of all items, sharing the memory of the collection\n"
+    "   so no values are copied. The view supports the buffer protocol,\n"
+    "   e.g. ``numpy.asarray(mesh.vertices.foreach_view(\"co\"))``.\n"
+    "   This is only supported for collections stored as arrays, such as mesh elements\n"
+    "   and attribute data.\n"
+    "\n"
+    "   :arg attr: Name of the property of the items.\n"
+    "   :type attr: string\n"
+    "   :return: View on the values, call its ``update()`` method after changing them.\n"
+    "\n"
+    "   .. warning:: Buffers obtained from the view must not be used once the collection\n"
+    "      is resized or freed.\n");
+static PyObject *pyrna_prop_collection_foreach_view(BPy_PropertyRNA *self, PyObject *args)
+{
+  const char *attr;
+  PointerRNA itemptr_base;
+  RawArray raw;
+
+  PYRNA_PROP_CHECK_OBJ(self);
+
+  if (!PyArg_ParseTuple(args, "s:foreach_view", &attr)) {
+    return NULL;
+  }
+
+  RNA_pointer_create(NULL, RNA_property_pointer_type(&self->ptr, self->prop), NULL, &itemptr_base);
+  PropertyRNA *itemprop = RNA_struct_find_property(&itemptr_base, attr);
+
+  if (itemprop == NULL) {
+    PyErr_Format(PyExc_AttributeError,
+                 "foreach_view '%.200s.%.200s[...]' elements have no attribute '%.200s'",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  if ((RNA_property_flag(itemprop) & PROP_DYNAMIC) ||
+      !RNA_property_collection_raw_array(&self->ptr, self->prop, itemprop, &raw)) {
+    PyErr_Format(PyExc_TypeError,
+                 "foreach_view '%.200s.%.200s[...].%.200s' is not stored as an editable array, "
+                 "use foreach_get/set instead",
+                 RNA_struct_identifier(self->ptr.type),
+                 RNA_property_identifier(self->prop),
+                 attr);
+    return NULL;
+  }
+
+  BPy_PropertyCollectionViewRNA *view = PyObject_New(BPy_PropertyCollectionViewRNA,
+                                                     &pyrna_prop_collection_view_Type);
+  view->collection = self;
+  Py_INCREF(self);
+  view->itemprop = itemprop;
+  view->attr_tot = RNA_property_array_length(&itemptr_base, itemprop);
+
+  return (PyObject *)view;
+}
+
+/* --- collection view: end --- */
+
 static PyObject *pyprop_array_foreach_getset(BPy_PropertyArrayRNA *self,
                                              PyObject *args,
                                              const bool do_set)
@@ -5793,6 +6031,10 @@ static struct PyMethodDef pyrna_prop_collection_methods[] = {
      (PyCFunction)pyrna_prop_collection_foreach_set,
      METH_VARARGS,
      pyrna_prop_collection_foreach_set_doc},
+    {"foreach_view",
+     (PyCFunction)pyrna_prop_collection_foreach_view,
+     METH_VARARGS,
+     pyrna_prop_collection_foreach_view_doc},
 
     {"keys", (PyCFunction)pyrna_prop_collection_keys, METH_NOARGS, pyrna_prop_collection_keys_doc},
     {"items",
@@ -7665,6 +7907,10 @@ void BPY_rna_init(void)
     return;
   }
 #endif
+
+  if (PyType_Ready(&pyrna_prop_collection_view_Type) < 0) {
+    return;
+  }
 }
 
 /* 'bpy.data' from Python. */
@@ -168,6 +168,17 @@ typedef struct {
   CollectionPropertyIterator iter;
 } BPy_PropertyCollectionIterRNA;
 
+/** View sharing the memory of a property of all collection items, see `foreach_view`. */
+typedef struct {
+  PyObject_HEAD /* required python macro   */
+  /** The viewed collection, kept alive by the view. */
+  BPy_PropertyRNA *collection;
+  /** Property of the collection items. */
+  PropertyRNA *itemprop;
+  /** Number of values per item, zero when the property is not an array. */
+  int attr_tot;
+} BPy_PropertyCollectionViewRNA;
+
 typedef struct {
   PyObject_HEAD /* required python macro   */
 #ifdef USE_WEAKREFS
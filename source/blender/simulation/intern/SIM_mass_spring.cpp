@@ -32,6 +32,7 @@
 
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -573,6 +574,44 @@ static void hair_get_boundbox(ClothModifierData *clmd, float gmin[3], float gmax
   }
 }
 
+#ifdef CLOTH_FORCE_GRAVITY
+struct CalcVertexForcesData {
+  ClothModifierData *clmd;
+  const float *gravity;
+  float time;
+};
+
+static void cloth_calc_vertex_forces_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const CalcVertexForcesData *vert_data = (const CalcVertexForcesData *)userdata;
+  ClothModifierData *clmd = vert_data->clmd;
+  Cloth *cloth = clmd->clothObject;
+  Implicit_Data *data = cloth->implicit;
+  ClothVertex *vert = &cloth->verts[i];
+
+  SIM_mass_spring_force_gravity(data, i, vert->mass, vert_data->gravity);
+
+  /* Vertex goal springs */
+  if ((!(vert->flags & CLOTH_VERT_FLAG_PINNED)) && (vert->goal > FLT_EPSILON)) {
+    float goal_x[3], goal_v[3];
+    float k;
+
+    /* divide by time_scale to prevent goal vertices' delta locations from being multiplied */
+    interp_v3_v3v3(
+        goal_x, vert->xold, vert->xconst, vert_data->time / clmd->sim_parms->time_scale);
+    sub_v3_v3v3(goal_v, vert->xconst, vert->xold); /* distance covered over dt==1 */
+
+    k = vert->goal * clmd->sim_parms->goalspring /
+        (clmd->sim_parms->avg_spring_len + FLT_EPSILON);
+
+    SIM_mass_spring_force_spring_goal(
+        data, i, goal_x, goal_v, k, clmd->sim_parms->goalfrict * 0.01f);
+  }
+}
+#endif
+
 static void cloth_calc_force(
     Scene *scene, ClothModifierData *clmd, float UNUSED(frame), ListBase *effectors, float time)
 {
@@ -596,25 +635,18 @@ static void cloth_calc_force(
                 0.001f * clmd->sim_parms->effector_weights->global_gravity);
   }
 
-  vert = cloth->verts;
-  for (i = 0; i < cloth->mvert_num; i++, vert++) {
-    SIM_mass_spring_force_gravity(data, i, vert->mass, gravity);
-
-    /* Vertex goal springs */
-    if ((!(vert->flags & CLOTH_VERT_FLAG_PINNED)) && (vert->goal > FLT_EPSILON)) {
-      float goal_x[3], goal_v[3];
-      float k;
-
-      /* divide by time_scale to prevent goal vertices' delta locations from being multiplied */
-      interp_v3_v3v3(goal_x, vert->xold, vert->xconst, time / clmd->sim_parms->time_scale);
-      sub_v3_v3v3(goal_v, vert->xconst, vert->xold); /* distance covered over dt==1 */
-
-      k = vert->goal * clmd->sim_parms->goalspring /
-          (clmd->sim_parms->avg_spring_len + FLT_EPSILON);
-
-      SIM_mass_spring_force_spring_goal(
-          data, i, goal_x, goal_v, k, clmd->sim_parms->goalfrict * 0.01f);
-    }
+  {
+    /* Gravity and goal springs only touch the vertex' own force and diagonal blocks. */
+    CalcVertexForcesData vert_data;
+    vert_data.clmd = clmd;
+    vert_data.gravity = gravity;
+    vert_data.time = time;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (mvert_num > 1024);
+    settings.min_iter_per_thread = 256;
+    BLI_task_parallel_range(0, mvert_num, &vert_data, cloth_calc_vertex_forces_cb, &settings);
   }
 #endif
 
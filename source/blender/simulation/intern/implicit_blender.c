@@ -34,6 +34,7 @@
 #  include "DNA_texture_types.h"
 
 #  include "BLI_math.h"
+#  include "BLI_task.h"
 #  include "BLI_utildefines.h"
 
 #  include "BKE_cloth.h"
@@ -50,6 +51,11 @@
 #    define CLOTH_OPENMP_LIMIT 512
 #  endif
 
+/* Minimum number of vertices before long vector and big matrix operations are threaded. */
+#  define CLOTH_PARALLEL_LIMIT 1024
+/* Fixed chunk size for reductions, so results don't depend on the number of threads. */
+#  define CLOTH_REDUCE_CHUNK_SIZE 1024
+
 //#define DEBUG_TIME
 
 #  ifdef DEBUG_TIME
@@ -192,35 +198,116 @@ DO_INLINE void submul_lfvectorS(float (*to)[3],
     VECSUBMUL(to[i], fLongVector[i], scalar);
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Threaded Long Vector Operations
+ *
+ * Element-wise operations write each element from exactly one thread,
+ * reductions are split into chunks of a fixed size which are summed in order.
+ * Results are therefore identical for any number of threads.
+ * \{ */
+
+typedef struct LfVectorOpData {
+  float (*to)[3];
+  float (*a)[3];
+  float (*b)[3];
+  float aS, bS;
+  /* Only used by reductions, one partial sum per chunk. */
+  float *chunk_sums;
+  unsigned int verts;
+} LfVectorOpData;
+
+BLI_INLINE void lfvector_parallel_range(unsigned int verts,
+                                        LfVectorOpData *op_data,
+                                        TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (verts > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, (int)verts, op_data, func, &settings);
+}
+
+static void dot_lfvector_chunk_cb(void *__restrict userdata,
+                                  const int chunk,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorOpData *op_data = userdata;
+  const unsigned int start = (unsigned int)chunk * CLOTH_REDUCE_CHUNK_SIZE;
+  const unsigned int end = min_uu(start + CLOTH_REDUCE_CHUNK_SIZE, op_data->verts);
+  float temp = 0.0f;
+
+  for (unsigned int i = start; i < end; i++) {
+    temp += dot_v3v3(op_data->a[i], op_data->b[i]);
+  }
+  op_data->chunk_sums[chunk] = temp;
+}
+
 /* dot product for big vector */
 DO_INLINE float dot_lfvector(float (*fLongVectorA)[3],
                              float (*fLongVectorB)[3],
                              unsigned int verts)
 {
-  long i = 0;
-  float temp = 0.0;
-  /* XXX brecht, disabled this for now (first schedule line was already disabled),
-   * due to non-commutative nature of floating point ops this makes the sim give
-   * different results each time you run it!
-   * schedule(guided, 2) */
-  //#pragma omp parallel for reduction(+: temp) if (verts > CLOTH_OPENMP_LIMIT)
-  for (i = 0; i < (long)verts; i++) {
-    temp += dot_v3v3(fLongVectorA[i], fLongVectorB[i]);
+  /* Summing in parallel with a regular reduction gives different results each run
+   * (floating point addition is not associative), so every chunk is summed on its own
+   * and the partial sums are then accumulated in a fixed order. */
+  const unsigned int chunks_num = (verts + CLOTH_REDUCE_CHUNK_SIZE - 1) /
+                                  CLOTH_REDUCE_CHUNK_SIZE;
+  float chunk_sums_stack[64];
+  float *chunk_sums = (chunks_num <= ARRAY_SIZE(chunk_sums_stack)) ?
+                          chunk_sums_stack :
+                          MEM_mallocN(sizeof(float) * chunks_num, __func__);
+  float temp = 0.0f;
+
+  LfVectorOpData op_data = {
+      .a = fLongVectorA,
+      .b = fLongVectorB,
+      .chunk_sums = chunk_sums,
+      .verts = verts,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (chunks_num > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, (int)chunks_num, &op_data, dot_lfvector_chunk_cb, &settings);
+
+  for (unsigned int chunk = 0; chunk < chunks_num; chunk++) {
+    temp += chunk_sums[chunk];
+  }
+
+  if (chunk_sums != chunk_sums_stack) {
+    MEM_freeN(chunk_sums);
   }
   return temp;
 }
+
+static void add_lfvector_lfvector_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorOpData *op_data = userdata;
+  add_v3_v3v3(op_data->to[i], op_data->a[i], op_data->b[i]);
+}
+
 /* A = B + C  --> for big vector */
 DO_INLINE void add_lfvector_lfvector(float (*to)[3],
                                      float (*fLongVectorA)[3],
                                      float (*fLongVectorB)[3],
                                      unsigned int verts)
 {
-  unsigned int i = 0;
+  LfVectorOpData op_data = {.to = to, .a = fLongVectorA, .b = fLongVectorB};
+  lfvector_parallel_range(verts, &op_data, add_lfvector_lfvector_cb);
+}
 
-  for (i = 0; i < verts; i++) {
-    add_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
-  }
+static void add_lfvector_lfvectorS_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorOpData *op_data = userdata;
+  VECADDS(op_data->to[i], op_data->a[i], op_data->b[i], op_data->bS);
 }
+
 /* A = B + C * float --> for big vector */
 DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
                                       float (*fLongVectorA)[3],
@@ -228,12 +315,18 @@ DO_INLINE void add_lfvector_lfvectorS(float (*to)[3],
                                       float bS,
                                       unsigned int verts)
 {
-  unsigned int i = 0;
+  LfVectorOpData op_data = {.to = to, .a = fLongVectorA, .b = fLongVectorB, .bS = bS};
+  lfvector_parallel_range(verts, &op_data, add_lfvector_lfvectorS_cb);
+}
 
-  for (i = 0; i < verts; i++) {
-    VECADDS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
-  }
+static void add_lfvectorS_lfvectorS_cb(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorOpData *op_data = userdata;
+  VECADDSS(op_data->to[i], op_data->a[i], op_data->aS, op_data->b[i], op_data->bS);
 }
+
 /* A = B * float + C * float --> for big vector */
 DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
                                        float (*fLongVectorA)[3],
@@ -242,12 +335,11 @@ DO_INLINE void add_lfvectorS_lfvectorS(float (*to)[3],
                                        float bS,
                                        unsigned int verts)
 {
-  unsigned int i = 0;
-
-  for (i = 0; i < verts; i++) {
-    VECADDSS(to[i], fLongVectorA[i], aS, fLongVectorB[i], bS);
-  }
+  LfVectorOpData op_data = {
+      .to = to, .a = fLongVectorA, .b = fLongVectorB, .aS = aS, .bS = bS};
+  lfvector_parallel_range(verts, &op_data, add_lfvectorS_lfvectorS_cb);
 }
+
 /* A = B - C * float --> for big vector */
 DO_INLINE void sub_lfvector_lfvectorS(float (*to)[3],
                                       float (*fLongVectorA)[3],
@@ -260,18 +352,27 @@ DO_INLINE void sub_lfvector_lfvectorS(float (*to)[3],
     VECSUBS(to[i], fLongVectorA[i], fLongVectorB[i], bS);
   }
 }
+
+static void sub_lfvector_lfvector_cb(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LfVectorOpData *op_data = userdata;
+  sub_v3_v3v3(op_data->to[i], op_data->a[i], op_data->b[i]);
+}
+
 /* A = B - C --> for big vector */
 DO_INLINE void sub_lfvector_lfvector(float (*to)[3],
                                      float (*fLongVectorA)[3],
                                      float (*fLongVectorB)[3],
                                      unsigned int verts)
 {
-  unsigned int i = 0;
-
-  for (i = 0; i < verts; i++) {
-    sub_v3_v3v3(to[i], fLongVectorA[i], fLongVectorB[i]);
-  }
+  LfVectorOpData op_data = {.to = to, .a = fLongVectorA, .b = fLongVectorB};
+  lfvector_parallel_range(verts, &op_data, sub_lfvector_lfvector_cb);
 }
+
+/** \} */
+
 ///////////////////////////
 // 3x3 matrix
 ///////////////////////////
@@ -644,18 +745,167 @@ DO_INLINE void mul_bfmatrix_lfvector(float (*to)[3], fmatrix3x3 *from, lfVector
   del_lfvector(temp);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Block Row Index
+ *
+ * Big matrices only store the diagonal blocks and the lower triangle of the off-diagonal
+ * blocks, which makes a matrix-vector product scatter into two rows per block.
+ * The row index lists for every row the blocks contributing to it (CSR layout over the
+ * existing block storage), so each row of the product can be computed by one thread
+ * without any synchronization, in the same order every time.
+ *
+ * All matrices of the solver share the same block layout, so one index serves them all.
+ * \{ */
+
+typedef struct BlockRowIndex {
+  /** Start of each row in #entries, `vcount + 1` items. */
+  unsigned int *row_offsets;
+  /** Block index shifted left by one, the lowest bit set when the block is transposed. */
+  unsigned int *entries;
+} BlockRowIndex;
+
+static void block_row_index_alloc(BlockRowIndex *rows, unsigned int verts, unsigned int springs)
+{
+  rows->row_offsets = MEM_callocN(sizeof(*rows->row_offsets) * (verts + 1), __func__);
+  rows->entries = MEM_mallocN(sizeof(*rows->entries) * (verts + 2 * springs), __func__);
+}
+
+static void block_row_index_free(BlockRowIndex *rows)
+{
+  MEM_SAFE_FREE(rows->row_offsets);
+  MEM_SAFE_FREE(rows->entries);
+}
+
+/**
+ * Fill the index for the first \a blocks_num off-diagonal blocks of \a matrix.
+ * Blocks past that are unused and zero, so they are skipped.
+ */
+static void block_row_index_build(BlockRowIndex *rows,
+                                  const fmatrix3x3 *matrix,
+                                  unsigned int blocks_num)
+{
+  const unsigned int vcount = matrix[0].vcount;
+  const unsigned int blocks_end = vcount + blocks_num;
+  unsigned int *offsets = rows->row_offsets;
+
+  BLI_assert(blocks_num <= matrix[0].scount);
+
+  /* Count, one diagonal block per row plus both halves of every off-diagonal block. */
+  for (unsigned int i = 0; i < vcount; i++) {
+    offsets[i] = 1;
+  }
+  offsets[vcount] = 0;
+  for (unsigned int i = vcount; i < blocks_end; i++) {
+    offsets[matrix[i].r]++;
+    offsets[matrix[i].c]++;
+  }
+
+  /* Exclusive prefix sum. */
+  unsigned int total = 0;
+  for (unsigned int i = 0; i <= vcount; i++) {
+    const unsigned int count = offsets[i];
+    offsets[i] = total;
+    total += count;
+  }
+
+  /* Fill, using the offsets as insertion cursors and shifting them back afterwards. */
+  for (unsigned int i = 0; i < vcount; i++) {
+    rows->entries[offsets[i]++] = i << 1;
+  }
+  for (unsigned int i = vcount; i < blocks_end; i++) {
+    rows->entries[offsets[matrix[i].r]++] = i << 1;
+    rows->entries[offsets[matrix[i].c]++] = (i << 1) | 1;
+  }
+  for (unsigned int i = vcount; i > 0; i--) {
+    offsets[i] = offsets[i - 1];
+  }
+  offsets[0] = 0;
+}
+
+typedef struct BfMatrixMulData {
+  float (*to)[3];
+  const fmatrix3x3 *matrix;
+  const BlockRowIndex *rows;
+  float (*vector)[3];
+} BfMatrixMulData;
+
+static void mul_bfmatrix_lfvector_row_cb(void *__restrict userdata,
+                                         const int row,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BfMatrixMulData *data = userdata;
+  const unsigned int *entries = data->rows->entries;
+  const unsigned int entry_end = data->rows->row_offsets[row + 1];
+  float *r_row = data->to[row];
+
+  zero_v3(r_row);
+
+  for (unsigned int entry = data->rows->row_offsets[row]; entry < entry_end; entry++) {
+    const fmatrix3x3 *block = &data->matrix[entries[entry] >> 1];
+    if (entries[entry] & 1) {
+      /* This is the lower triangle of the sparse matrix,
+       * therefore multiplication occurs with transposed submatrices. */
+      muladd_fmatrixT_fvector(r_row, block->m, data->vector[block->r]);
+    }
+    else {
+      muladd_fmatrix_fvector(r_row, block->m, data->vector[block->c]);
+    }
+  }
+}
+
+/* SPARSE SYMMETRIC multiply big matrix with long vector, using the row index */
+static void mul_bfmatrix_lfvector_rows(float (*to)[3],
+                                       const fmatrix3x3 *from,
+                                       const BlockRowIndex *rows,
+                                       lfVector *fLongVector)
+{
+  const unsigned int vcount = from[0].vcount;
+  BfMatrixMulData data = {
+      .to = to,
+      .matrix = from,
+      .rows = rows,
+      .vector = fLongVector,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (vcount > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, (int)vcount, &data, mul_bfmatrix_lfvector_row_cb, &settings);
+}
+
+/** \} */
+
+typedef struct BfMatrixSubAddData {
+  fmatrix3x3 *to;
+  fmatrix3x3 *from;
+  fmatrix3x3 *matrix;
+  float aS, bS;
+} BfMatrixSubAddData;
+
+static void subadd_bfmatrixS_bfmatrixS_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BfMatrixSubAddData *data = userdata;
+  subadd_fmatrixS_fmatrixS(data->to[i].m, data->from[i].m, data->aS, data->matrix[i].m, data->bS);
+}
+
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
 /* A -= B * float + C * float --> for big matrix */
 /* VERIFIED */
 DO_INLINE void subadd_bfmatrixS_bfmatrixS(
     fmatrix3x3 *to, fmatrix3x3 *from, float aS, fmatrix3x3 *matrix, float bS)
 {
-  unsigned int i = 0;
+  const unsigned int blocks_num = matrix[0].vcount + matrix[0].scount;
+  BfMatrixSubAddData data = {.to = to, .from = from, .matrix = matrix, .aS = aS, .bS = bS};
 
-  /* process diagonal elements */
-  for (i = 0; i < matrix[0].vcount + matrix[0].scount; i++) {
-    subadd_fmatrixS_fmatrixS(to[i].m, from[i].m, aS, matrix[i].m, bS);
-  }
+  /* Every block is independent, so assembly can be split freely. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (blocks_num > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, (int)blocks_num, &data, subadd_bfmatrixS_bfmatrixS_cb, &settings);
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -683,6 +933,7 @@ typedef struct Implicit_Data {
   lfVector *z;          /* target velocity in constrained directions */
   fmatrix3x3 *S;        /* filtering matrix for constraints */
   fmatrix3x3 *P, *Pinv; /* pre-conditioning matrix */
+  BlockRowIndex rows;   /* row index of the block layout, rebuilt for every solve */
 } Implicit_Data;
 
 Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
@@ -708,6 +959,8 @@ Implicit_Data *SIM_mass_spring_solver_create(int numverts, int numsprings)
   id->dV = create_lfvector(numverts);
   id->z = create_lfvector(numverts);
 
+  block_row_index_alloc(&id->rows, numverts, numsprings);
+
   initdiag_bfmatrix(id->bigI, I);
 
   return id;
@@ -734,6 +987,8 @@ void SIM_mass_spring_solver_free(Implicit_Data *id)
   del_lfvector(id->dV);
   del_lfvector(id->z);
 
+  block_row_index_free(&id->rows);
+
   MEM_freeN(id);
 }
 
@@ -771,15 +1026,87 @@ BLI_INLINE void root_to_world_m3(Implicit_Data *data,
 
 /* ================================ */
 
+typedef struct FilterData {
+  lfVector *V;
+  fmatrix3x3 *S;
+} FilterData;
+
+static void filter_cb(void *__restrict userdata,
+                      const int i,
+                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  FilterData *data = userdata;
+  mul_m3_v3(data->S[i].m, data->V[data->S[i].r]);
+}
+
 DO_INLINE void filter(lfVector *V, fmatrix3x3 *S)
 {
-  unsigned int i = 0;
+  /* S only has diagonal blocks, each writes its own element. */
+  FilterData data = {.V = V, .S = S};
 
-  for (i = 0; i < S[0].vcount; i++) {
-    mul_m3_v3(S[i].m, V[S[i].r]);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (S[0].vcount > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, (int)S[0].vcount, &data, filter_cb, &settings);
+}
+
+/* ================================ */
+
+/* Block-Jacobi preconditioner: the inverses of the diagonal blocks of A, which couple the three
+ * axes of a vertex (e.g. stiff springs along one direction) without coupling vertices. */
+
+typedef struct PreconditionerData {
+  fmatrix3x3 *A;
+  fmatrix3x3 *Pinv;
+  float (*to)[3];
+  lfVector *from;
+} PreconditionerData;
+
+static void block_jacobi_build_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PreconditionerData *data = userdata;
+  /* The first blocks of A are its diagonal. */
+  if (!invert_m3_m3(data->Pinv[i].m, data->A[i].m)) {
+    unit_m3(data->Pinv[i].m);
   }
 }
 
+static void block_jacobi_apply_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PreconditionerData *data = userdata;
+  zero_v3(data->to[i]);
+  muladd_fmatrix_fvector(data->to[i], data->Pinv[i].m, data->from[i]);
+}
+
+static void block_jacobi_range(PreconditionerData *data, TaskParallelRangeFunc func)
+{
+  const unsigned int vcount = data->A[0].vcount;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (vcount > CLOTH_PARALLEL_LIMIT);
+  settings.min_iter_per_thread = CLOTH_PARALLEL_LIMIT / 4;
+  BLI_task_parallel_range(0, (int)vcount, data, func, &settings);
+}
+
+static void block_jacobi_build(fmatrix3x3 *A, fmatrix3x3 *Pinv)
+{
+  PreconditionerData data = {.A = A, .Pinv = Pinv};
+  block_jacobi_range(&data, block_jacobi_build_cb);
+}
+
+/* to = P^-1 * from */
+static void block_jacobi_apply(float (*to)[3], fmatrix3x3 *A, fmatrix3x3 *Pinv, lfVector *from)
+{
+  PreconditionerData data = {.A = A, .Pinv = Pinv, .to = to, .from = from};
+  block_jacobi_range(&data, block_jacobi_apply_cb);
+}
+
 /* this version of the CG algorithm does not work very well with partial constraints
  * (where S has non-zero elements). */
 #  if 0
@@ -852,9 +1179,11 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 
 static int cg_filtered(lfVector *ldV,
                        fmatrix3x3 *lA,
+                       const BlockRowIndex *rows,
                        lfVector *lB,
                        lfVector *z,
                        fmatrix3x3 *S,
+                       fmatrix3x3 *Pinv,
                        ImplicitSolverResult *result)
 {
   /* Solves for unknown X in equation AX=B */
@@ -870,21 +1199,24 @@ static int cg_filtered(lfVector *ldV,
   lfVector *s = create_lfvector(numverts);
   float bnorm2, delta_new, delta_old, delta_target, alpha;
 
+  block_jacobi_build(lA, Pinv);
+
   cp_lfvector(ldV, z, numverts);
 
-  /* d0 = filter(B)^T * P * filter(B) */
+  /* d0 = filter(B)^T * P^-1 * filter(B) */
   cp_lfvector(fB, lB, numverts);
   filter(fB, S);
-  bnorm2 = dot_lfvector(fB, fB, numverts);
+  block_jacobi_apply(s, lA, Pinv, fB);
+  bnorm2 = dot_lfvector(fB, s, numverts);
   delta_target = conjgrad_epsilon * conjgrad_epsilon * bnorm2;
 
   /* r = filter(B - A * dV) */
-  mul_bfmatrix_lfvector(AdV, lA, ldV);
+  mul_bfmatrix_lfvector_rows(AdV, lA, rows, ldV);
   sub_lfvector_lfvector(r, lB, AdV, numverts);
   filter(r, S);
 
   /* c = filter(P^-1 * r) */
-  cp_lfvector(c, r, numverts);
+  block_jacobi_apply(c, lA, Pinv, r);
   filter(c, S);
 
   /* delta = r^T * c */
@@ -902,7 +1234,7 @@ static int cg_filtered(lfVector *ldV,
 #  endif
 
   while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-    mul_bfmatrix_lfvector(q, lA, c);
+    mul_bfmatrix_lfvector_rows(q, lA, rows, c);
     filter(q, S);
 
     alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -912,7 +1244,7 @@ static int cg_filtered(lfVector *ldV,
     add_lfvector_lfvectorS(r, r, q, -alpha, numverts);
 
     /* s = P^-1 * r */
-    cp_lfvector(s, r, numverts);
+    block_jacobi_apply(s, lA, Pinv, r);
     delta_old = delta_new;
     delta_new = dot_lfvector(r, s, numverts);
 
@@ -1158,11 +1490,14 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
   lfVector *dFdXmV = create_lfvector(numverts);
   zero_lfvector(data->dV, numverts);
 
+  /* The block layout only changes when forces are added, build its row index once here. */
+  block_row_index_build(&data->rows, data->A, (unsigned int)data->num_blocks);
+
   cp_bfmatrix(data->A, data->M);
 
   subadd_bfmatrixS_bfmatrixS(data->A, data->dFdV, dt, data->dFdX, (dt * dt));
 
-  mul_bfmatrix_lfvector(dFdXmV, data->dFdX, data->V);
+  mul_bfmatrix_lfvector_rows(dFdXmV, data->dFdX, &data->rows, data->V);
 
   add_lfvectorS_lfvectorS(data->B, data->F, dt, dFdXmV, (dt * dt), numverts);
 
@@ -1171,7 +1506,7 @@ bool SIM_mass_spring_solve_velocities(Implicit_Data *data, float dt, ImplicitSol
 #  endif
 
   /* Conjugate gradient algorithm to solve Ax=b. */
-  cg_filtered(data->dV, data->A, data->B, data->z, data->S, result);
+  cg_filtered(data->dV, data->A, &data->rows, data->B, data->z, data->S, data->Pinv, result);
 
   // cg_filtered_pre(id->dV, id->A, id->B, id->z, id->S, id->P, id->Pinv, id->bigI);
 
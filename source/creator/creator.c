@@ -318,17 +318,23 @@ int main(int argc,
    *       guarded allocator before any allocation happened.
    */
   {
+    bool use_guarded_allocator = false;
     int i;
     for (i = 0; i < argc; i++) {
       if (STR_ELEM(argv[i], "-d", "--debug", "--debug-memory", "--debug-all")) {
         printf("Switching to fully guarded memory allocator.\n");
         MEM_use_guarded_allocator();
+        use_guarded_allocator = true;
         break;
       }
       if (STREQ(argv[i], "--")) {
         break;
       }
     }
+    if (!use_guarded_allocator) {
+      /* Avoid contention on shared counters when many threads allocate. */
+      MEM_use_lockfree_thread_local_stats(false);
+    }
     MEM_init_memleak_detection();
   }
 
@@ -0,0 +1,73 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --python tests/python/bl_pyapi_prop_collection_view.py -- --verbose
+import bpy
+import ctypes
+import unittest
+import numpy as np
+
+
+class TestPropCollectionView(unittest.TestCase):
+    def setUp(self):
+        self.mesh = bpy.data.meshes.new("TestPropCollectionView")
+        self.mesh.vertices.add(8)
+
+    def tearDown(self):
+        bpy.data.meshes.remove(self.mesh)
+
+    def test_vertex_co(self):
+        co = np.asarray(self.mesh.vertices.foreach_view("co"))
+        self.assertEqual(co.shape, (8, 3))
+        self.assertEqual(co.dtype, np.float32)
+
+        co[:] = np.arange(24, dtype=np.float32).reshape(8, 3)
+        self.mesh.vertices.foreach_view("co").update()
+
+        # Writes through the view are seen by the regular API, without copying.
+        expected = np.empty(24, dtype=np.float32)
+        self.mesh.vertices.foreach_get("co", expected)
+        self.assertTrue(np.array_equal(co.ravel(), expected))
+        self.assertEqual(tuple(self.mesh.vertices[2].co), (6.0, 7.0, 8.0))
+
+    def test_attribute_value(self):
+        attribute = self.mesh.attributes.new("test", 'FLOAT', 'POINT')
+        values = np.asarray(attribute.data.foreach_view("value"))
+        self.assertEqual(values.shape, (8,))
+
+        values[:] = np.linspace(0.0, 1.0, 8, dtype=np.float32)
+        self.assertEqual(attribute.data[7].value, 1.0)
+
+    def test_memoryview(self):
+        view = memoryview(self.mesh.vertices.foreach_view("co"))
+        self.assertEqual(view.format, "f")
+        self.assertEqual(view.shape, (8, 3))
+        self.assertFalse(view.readonly)
+
+    def test_contiguous(self):
+        # Vertex coordinates are interleaved with the other vertex data.
+        co_view = self.mesh.vertices.foreach_view("co")
+        self.assertFalse(memoryview(co_view).c_contiguous)
+        # Requests without strides can't describe the layout.
+        with self.assertRaises(BufferError):
+            (ctypes.c_float * 24).from_buffer(co_view)
+
+        attribute = self.mesh.attributes.new("test", 'FLOAT', 'POINT')
+        values_view = attribute.data.foreach_view("value")
+        self.assertTrue(memoryview(values_view).c_contiguous)
+        values = (ctypes.c_float * 8).from_buffer(values_view)
+        values[7] = 1.0
+        self.assertEqual(attribute.data[7].value, 1.0)
+
+    def test_unsupported(self):
+        # Flags are not stored as an array of values.
+        with self.assertRaises(TypeError):
+            self.mesh.vertices.foreach_view("select")
+
+        with self.assertRaises(AttributeError):
+            self.mesh.vertices.foreach_view("not_a_property")
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()
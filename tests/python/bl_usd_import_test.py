@@ -0,0 +1,152 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+./blender.bin --background -noaudio --factory-startup --python tests/python/bl_usd_import_test.py
+"""
+
+import pathlib
+import sys
+import tempfile
+import unittest
+
+import bpy
+
+STAGE_USDA = """#usda 1.0
+(
+    defaultPrim = "World"
+    upAxis = "Z"
+)
+
+def Xform "World"
+{
+    def Xform "Asset" (
+        payload = @./payload.usda@
+    )
+    {
+        float3[] extentsHint = [(-2, -2, -2), (2, 2, 2)]
+    }
+
+    def Mesh "Quads" (
+        prepend apiSchemas = ["MaterialBindingAPI"]
+    )
+    {
+        int[] faceVertexCounts = [4, 4]
+        int[] faceVertexIndices = [0, 1, 4, 3, 1, 2, 5, 4]
+        point3f[] points = [(0, 0, 0), (1, 0, 0), (2, 0, 0), (0, 1, 0), (1, 1, 0), (2, 1, 0)]
+
+        def GeomSubset "RedFaces" (
+            prepend apiSchemas = ["MaterialBindingAPI"]
+        )
+        {
+            uniform token elementType = "face"
+            uniform token familyName = "materialBind"
+            int[] indices = [1]
+            rel material:binding = </World/Materials/Red>
+        }
+    }
+
+    def Scope "Materials"
+    {
+        def Material "Red"
+        {
+        }
+    }
+}
+"""
+
+PAYLOAD_USDA = """#usda 1.0
+(
+    defaultPrim = "Asset"
+)
+
+def Xform "Asset"
+{
+    def Mesh "PayloadMesh"
+    {
+        int[] faceVertexCounts = [3]
+        int[] faceVertexIndices = [0, 1, 2]
+        point3f[] points = [(0, 0, 0), (1, 0, 0), (0, 1, 0)]
+    }
+}
+"""
+
+
+class USDImportTest(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+
+        self.tempdir_handle = tempfile.TemporaryDirectory()
+        tempdir = pathlib.Path(self.tempdir_handle.name)
+        (tempdir / "payload.usda").write_text(PAYLOAD_USDA)
+        self.filepath = tempdir / "stage.usda"
+        self.filepath.write_text(STAGE_USDA)
+
+    def tearDown(self):
+        self.tempdir_handle.cleanup()
+
+    def import_stage(self, load_payloads):
+        result = bpy.ops.wm.usd_import(filepath=str(self.filepath), load_payloads=load_payloads)
+        self.assertEqual({'FINISHED'}, result)
+
+    def test_unloaded_payload_placeholder(self):
+        self.import_stage(load_payloads=False)
+
+        asset = bpy.data.objects["Asset"]
+        self.assertEqual('EMPTY', asset.type)
+        self.assertEqual('CUBE', asset.empty_display_type)
+        # Half the size of the extents hint.
+        self.assertAlmostEqual(2.0, asset.empty_display_size)
+        # The contents of the payload are not imported.
+        self.assertEqual(0, len(asset.children))
+        self.assertNotIn("PayloadMesh", bpy.data.objects)
+
+    def test_loaded_payload(self):
+        self.import_stage(load_payloads=True)
+
+        payload_mesh = bpy.data.objects["PayloadMesh"]
+        self.assertEqual('MESH', payload_mesh.type)
+        self.assertEqual(bpy.data.objects["Asset"], payload_mesh.parent)
+
+    def test_unbound_faces_unassigned(self):
+        self.import_stage(load_payloads=False)
+
+        quads = bpy.data.objects["Quads"]
+        # The mesh has no material of its own, so the first slot stays empty.
+        self.assertEqual(2, len(quads.material_slots))
+        self.assertIsNone(quads.material_slots[0].material)
+        self.assertEqual("Red", quads.material_slots[1].material.name)
+
+        polygons = quads.data.polygons
+        self.assertEqual(0, polygons[0].material_index)
+        self.assertEqual(1, polygons[1].material_index)
+
+
+def main():
+    if '--' in sys.argv:
+        argv = [sys.argv[0]] + sys.argv[sys.argv.index('--') + 1:]
+    else:
+        argv = sys.argv
+
+    unittest.main(argv=argv)
+
+
+if __name__ == "__main__":
+    main()
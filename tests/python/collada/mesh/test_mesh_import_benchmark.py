@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+#
+# Measures the time needed to import large meshes, the test data is generated so no
+# reference files are needed.
+#
+# Call as follows:
+# blender --background --factory-startup --python test_mesh_import_benchmark.py -- \
+#     --grid-size 1000 --objects 8 --repeat 3
+#
+import sys
+import bpy
+import argparse
+import functools
+import shutil
+import tempfile
+import time
+import unittest
+import pathlib
+
+
+def with_tempdir(wrapped):
+    """Creates a temporary directory for the function, cleaning up after it returns normally.
+
+    When the wrapped function raises an exception, the contents of the temporary directory
+    remain available for manual inspection.
+
+    The wrapped function is called with an extra positional argument containing
+    the pathlib.Path() of the temporary directory.
+    """
+
+    @functools.wraps(wrapped)
+    def decorator(*args, **kwargs):
+        dirname = tempfile.mkdtemp(prefix='blender-collada-test')
+        try:
+            retval = wrapped(*args, pathlib.Path(dirname), **kwargs)
+        except:
+            print('Exception in %s, not cleaning up temporary directory %s' % (wrapped, dirname))
+            raise
+        else:
+            shutil.rmtree(dirname)
+        return retval
+
+    return decorator
+
+
+LINE = "+----------------------------------------------------------------"
+
+
+class MeshImportBenchmark(unittest.TestCase):
+
+    def create_scene(self):
+        """
+        Create grids with UVs, each of them is exported as its own geometry.
+        """
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+
+        for index in range(args.objects):
+            bpy.ops.mesh.primitive_grid_add(
+                x_subdivisions=args.grid_size,
+                y_subdivisions=args.grid_size,
+                size=2.0,
+                calc_uvs=True,
+                location=(index * 2.5, 0.0, 0.0),
+            )
+
+        return [(ob.name, len(ob.data.vertices), len(ob.data.polygons))
+                for ob in bpy.context.scene.objects]
+
+    @with_tempdir
+    def test_import_large_meshes(self, tempdir: pathlib.Path):
+        expected = sorted(self.create_scene())
+        dae_file = tempdir / "mesh_import_benchmark.dae"
+
+        bpy.ops.wm.collada_export(filepath=str(dae_file), selected=False, triangulate=False)
+
+        timings = []
+        for _ in range(args.repeat):
+            bpy.ops.wm.read_factory_settings(use_empty=True)
+
+            start_time = time.perf_counter()
+            bpy.ops.wm.collada_import(filepath=str(dae_file))
+            timings.append(time.perf_counter() - start_time)
+
+            imported = sorted((ob.name, len(ob.data.vertices), len(ob.data.polygons))
+                              for ob in bpy.context.scene.objects if ob.type == 'MESH')
+            self.assertEqual(expected, imported)
+
+        print("\n%s" % LINE)
+        print("| COLLADA import: %d objects, %d vertices each, %.1f MB" %
+              (args.objects, expected[0][1], dae_file.stat().st_size / (1024.0 * 1024.0)))
+        print("| best: %.3f s, average: %.3f s over %d runs" %
+              (min(timings), sum(timings) / len(timings), len(timings)))
+        print("%s\n" % LINE)
+
+
+if __name__ == '__main__':
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--grid-size', type=int, default=256,
+                        help="Number of subdivisions of the grids along each axis")
+    parser.add_argument('--objects', type=int, default=4, help="Number of grids to import")
+    parser.add_argument('--repeat', type=int, default=1, help="Number of timed imports")
+    args, remaining = parser.parse_known_args()
+    unittest.main(argv=sys.argv[0:1] + remaining)
@@ -0,0 +1,75 @@
+# Apache License, Version 2.0
+
+# ./blender.bin --background -noaudio --factory-startup --python tests/python/physics_particle_newtonian.py -- --verbose
+import bpy
+import unittest
+
+
+def simulate(noise, frames=10):
+    """Emit particles from a grid in a noisy wind, return their locations at the last frame."""
+    scene = bpy.context.scene
+
+    mesh = bpy.data.meshes.new("Emitter")
+    size = 20
+    verts = [(x / size, y / size, 0.0) for y in range(size + 1) for x in range(size + 1)]
+    faces = [(y * (size + 1) + x,
+              y * (size + 1) + x + 1,
+              (y + 1) * (size + 1) + x + 1,
+              (y + 1) * (size + 1) + x) for y in range(size) for x in range(size)]
+    mesh.from_pydata(verts, [], faces)
+    emitter = bpy.data.objects.new("Emitter", mesh)
+    scene.collection.objects.link(emitter)
+
+    emitter.modifiers.new("Particles", 'PARTICLE_SYSTEM')
+    settings = emitter.particle_systems[0].settings
+    # Enough particles for the step to run on multiple threads.
+    settings.count = 5000
+    settings.frame_start = 1
+    settings.frame_end = 1
+    settings.lifetime = 100
+    settings.physics_type = 'NEWTON'
+    settings.brownian_factor = 0.5
+
+    wind = bpy.data.objects.new("Wind", None)
+    scene.collection.objects.link(wind)
+    wind.rotation_euler = (1.0, 0.0, 0.0)
+    wind.field.type = 'WIND'
+    wind.field.strength = 5.0
+    wind.field.noise = noise
+
+    for frame in range(1, frames + 1):
+        scene.frame_set(frame)
+
+    depsgraph = bpy.context.evaluated_depsgraph_get()
+    particles = emitter.evaluated_get(depsgraph).particle_systems[0].particles
+    locations = [tuple(particle.location) for particle in particles]
+
+    bpy.data.objects.remove(emitter)
+    bpy.data.objects.remove(wind)
+    bpy.data.meshes.remove(mesh)
+    bpy.data.particles.remove(settings)
+    scene.frame_set(1)
+
+    return locations
+
+
+class TestParticleNewtonian(unittest.TestCase):
+    def setUp(self):
+        bpy.ops.wm.read_factory_settings(use_empty=True)
+
+    def test_noisy_wind_deterministic(self):
+        # Wind noise is drawn per particle while the particles are stepped in parallel,
+        # so the same simulation gives the same result every time.
+        first = simulate(noise=2.0)
+        second = simulate(noise=2.0)
+        self.assertEqual(len(first), 5000)
+        self.assertEqual(first, second)
+
+    def test_noisy_wind_has_effect(self):
+        self.assertNotEqual(simulate(noise=2.0), simulate(noise=0.0))
+
+
+if __name__ == '__main__':
+    import sys
+    sys.argv = [__file__] + (sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else [])
+    unittest.main()